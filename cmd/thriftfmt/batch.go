@@ -0,0 +1,256 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strings"
+	"sync"
+	"sync/atomic"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+	"github.com/kpumuk/thrift-weaver/internal/daemon"
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// fileListArg reads a NUL-separated file list from stdin in batch mode.
+const fileListArg = "-"
+
+// batchResult is the buffered outcome of one file in a batch run.
+type batchResult struct {
+	stdout bytes.Buffer
+	stderr bytes.Buffer
+	code   int
+	ready  chan struct{}
+}
+
+// runBatch formats every file named by opts.paths, or the changed lines of
+// every file named by --diff and --lines, on a pool of workers, each owning a
+// reusable parser, and streams per-file results in input order. The exit
+// code is the most severe one of any file.
+func runBatch(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, opts cliOptions) int {
+	var (
+		paths   []string
+		changed changedLines
+		err     error
+	)
+	if opts.lines {
+		changed, err = readChangedLines(stdin, opts)
+		paths = changed.paths
+	} else {
+		paths, err = expandPaths(stdin, opts.paths)
+	}
+	if err != nil {
+		writef(stderr, "thriftfmt: %v\n", err)
+		return exitInternal
+	}
+
+	results := make([]batchResult, len(paths))
+	for i := range results {
+		results[i].ready = make(chan struct{})
+	}
+	workers := opts.jobs
+	if workers <= 0 {
+		workers = runtime.GOMAXPROCS(0)
+	}
+	workers = min(workers, len(paths))
+
+	// Changed-line runs format ranges, which neither the cache nor a daemon
+	// serves.
+	var (
+		fmtCache *cache.Cache
+		daemons  *daemon.Finder
+	)
+	if !opts.lines {
+		fmtCache = openFormatCache(stderr, opts)
+		daemons = newDaemonFinder(opts)
+	}
+	defer func() { _ = fmtCache.Close() }()
+
+	var (
+		next atomic.Int64
+		wg   sync.WaitGroup
+	)
+	for range workers {
+		wg.Go(func() {
+			parser := syntax.NewReusableParser()
+			defer parser.Close()
+			for {
+				i := int(next.Add(1) - 1)
+				if i >= len(paths) {
+					return
+				}
+				if opts.lines {
+					formatBatchLines(ctx, parser, paths[i], changed.lines[paths[i]], opts, &results[i])
+				} else {
+					formatBatchFile(ctx, parser, fmtCache, daemons, paths[i], opts, &results[i])
+				}
+				close(results[i].ready)
+			}
+		})
+	}
+
+	code := exitOK
+	for i := range results {
+		r := &results[i]
+		<-r.ready
+		_, _ = stdout.Write(r.stdout.Bytes())
+		_, _ = stderr.Write(r.stderr.Bytes())
+		code = max(code, r.code)
+		r.stdout, r.stderr = bytes.Buffer{}, bytes.Buffer{}
+	}
+	wg.Wait()
+	return code
+}
+
+// formatBatchFile formats one file of a batch run into res.
+func formatBatchFile(ctx context.Context, parser *syntax.ReusableParser, c *cache.Cache, daemons *daemon.Finder, path string, opts cliOptions, res *batchResult) {
+	//nolint:gosec // CLI intentionally reads user-provided file paths.
+	src, err := os.ReadFile(path)
+	if err != nil {
+		writef(&res.stderr, "thriftfmt: read %s: %v\n", path, err)
+		res.code = exitInternal
+		return
+	}
+	key, changed, cached := cachedVerdict(c, src)
+	if cached && (!opts.write || !changed) {
+		reportBatchVerdict(path, opts, changed, res)
+		return
+	}
+	if client := daemonFor(ctx, daemons, path); client != nil {
+		out, formatErr, err, ok := formatWithDaemon(ctx, client, c, key, src, path, path, opts)
+		var parseErr *daemon.ParseError
+		switch {
+		case !ok:
+			// The daemon went away; format in-process.
+		case errors.As(formatErr, &parseErr):
+			writef(&res.stderr, "thriftfmt: %s: parse failed: %v\n", path, formatErr)
+			res.code = exitInternal
+			return
+		case formatErr != nil:
+			tree := &syntax.Tree{URI: path, Source: src}
+			res.code = handleFormatError(&res.stderr, tree, out.Diagnostics, fmt.Errorf("%s: %w", path, formatErr))
+			return
+		case err != nil:
+			writef(&res.stderr, "thriftfmt: write %s: %v\n", path, err)
+			res.code = exitInternal
+			return
+		default:
+			reportBatchVerdict(path, opts, out.Changed, res)
+			return
+		}
+	}
+
+	tree, err := parser.Parse(ctx, src, syntax.ParseOptions{URI: path})
+	if err != nil {
+		writef(&res.stderr, "thriftfmt: %s: parse failed: %v\n", path, err)
+		res.code = exitInternal
+		return
+	}
+	defer tree.Close()
+
+	out, formatErr, err := formatFile(ctx, c, key, tree, format.Options{LineWidth: opts.lineWidth}, path, opts.write)
+	switch {
+	case formatErr != nil:
+		res.code = handleFormatError(&res.stderr, tree, out.Diagnostics, fmt.Errorf("%s: %w", path, formatErr))
+		return
+	case err != nil:
+		writef(&res.stderr, "thriftfmt: write %s: %v\n", path, err)
+		res.code = exitInternal
+		return
+	}
+	reportBatchVerdict(path, opts, out.Changed, res)
+}
+
+// reportBatchVerdict records in res whether path needed formatting.
+func reportBatchVerdict(path string, opts cliOptions, changed bool, res *batchResult) {
+	if !changed {
+		return
+	}
+	if opts.list {
+		writef(&res.stdout, "%s\n", path)
+	}
+	if opts.check {
+		res.code = exitCheck
+	}
+}
+
+// expandPaths turns batch arguments into a file list in input order:
+// directories expand to the .thrift files below them in lexical order, and
+// "-" to the NUL-separated paths read from stdin.
+func expandPaths(stdin io.Reader, args []string) ([]string, error) {
+	var out []string
+	for _, arg := range args {
+		if arg == fileListArg {
+			list, err := readFileList(stdin)
+			if err != nil {
+				return nil, err
+			}
+			out = append(out, list...)
+			continue
+		}
+		st, err := os.Stat(arg)
+		if err != nil {
+			return nil, err
+		}
+		if !st.IsDir() {
+			out = append(out, arg)
+			continue
+		}
+		files, err := thriftFilesUnder(arg)
+		if err != nil {
+			return nil, err
+		}
+		out = append(out, files...)
+	}
+	return out, nil
+}
+
+// thriftFilesUnder lists .thrift files below root, skipping hidden directories.
+func thriftFilesUnder(root string) ([]string, error) {
+	var out []string
+	err := filepath.WalkDir(root, func(path string, d fs.DirEntry, err error) error {
+		if err != nil {
+			return err
+		}
+		if d.IsDir() {
+			if path != root && strings.HasPrefix(d.Name(), ".") {
+				return filepath.SkipDir
+			}
+			return nil
+		}
+		if filepath.Ext(path) == ".thrift" {
+			out = append(out, path)
+		}
+		return nil
+	})
+	if err != nil {
+		return nil, fmt.Errorf("walk %s: %w", root, err)
+	}
+	return out, nil
+}
+
+func readFileList(stdin io.Reader) ([]string, error) {
+	var out []string
+	r := bufio.NewReader(stdin)
+	for {
+		entry, err := r.ReadString(0)
+		if entry = strings.TrimSuffix(entry, "\x00"); entry != "" {
+			out = append(out, entry)
+		}
+		if errors.Is(err, io.EOF) {
+			return out, nil
+		}
+		if err != nil {
+			return nil, fmt.Errorf("read file list: %w", err)
+		}
+	}
+}
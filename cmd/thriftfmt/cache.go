@@ -0,0 +1,51 @@
+package main
+
+import (
+	"fmt"
+	"io"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/format"
+)
+
+// Cached verdicts of --check, --list and --write: whether formatting a
+// source changes it.
+const (
+	verdictFormatted byte = 'f'
+	verdictChanged   byte = 'c'
+)
+
+// openFormatCache opens the result cache for opts, or returns nil when it is
+// disabled or not needed by the run.
+func openFormatCache(stderr io.Writer, opts cliOptions) *cache.Cache {
+	if !opts.write && !opts.check && !opts.list {
+		return nil
+	}
+	if opts.rangeSpec != "" || opts.debugTokens || opts.debugCST {
+		return nil
+	}
+	fopts := format.Options{LineWidth: opts.lineWidth}
+	return cliutil.OpenCache(stderr, "thriftfmt", opts.cacheDir, opts.noCache, fmt.Sprintf("%+v", fopts))
+}
+
+// cachedVerdict looks up whether formatting src changes it.
+func cachedVerdict(c *cache.Cache, src []byte) (key cache.Key, changed, ok bool) {
+	if c == nil {
+		return key, false, false
+	}
+	key = c.Key(src)
+	data, ok := c.Get(key)
+	if !ok || len(data) != 1 || (data[0] != verdictFormatted && data[0] != verdictChanged) {
+		return key, false, false
+	}
+	return key, data[0] == verdictChanged, true
+}
+
+func storeVerdict(c *cache.Cache, key cache.Key, changed bool) {
+	if changed {
+		c.Put(key, []byte{verdictChanged})
+		return
+	}
+	c.Put(key, []byte{verdictFormatted})
+}
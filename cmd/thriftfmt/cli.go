@@ -1,15 +1,20 @@
 package main
 
 import (
+	"bufio"
+	"bytes"
 	"context"
 	"errors"
 	"flag"
 	"fmt"
 	"io"
 	"os"
+	"path/filepath"
+	"slices"
 	"strconv"
 	"strings"
 
+	"github.com/kpumuk/thrift-weaver/internal/cache"
 	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
 	"github.com/kpumuk/thrift-weaver/internal/format"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
@@ -34,6 +39,18 @@ type cliOptions struct {
 	debugTokens    bool
 	debugCST       bool
 	path           string
+	list           bool
+	jobs           int
+	cacheDir       string
+	noCache        bool
+	noDaemon       bool
+	diffPath       string
+	lineSpecs      []string
+	// batch formats paths as a set: several files, directories, or "-".
+	batch bool
+	paths []string
+	// lines formats only the lines selected by --diff and --lines.
+	lines bool
 }
 
 func run(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, args []string) int {
@@ -42,6 +59,9 @@ func run(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, args []
 		writef(stderr, "thriftfmt: %v\n\n%s", err, usage)
 		return exitInternal
 	}
+	if opts.batch {
+		return runBatch(ctx, stdin, stdout, stderr, opts)
+	}
 
 	src, pathURI, err := readInput(stdin, opts)
 	if err != nil {
@@ -49,6 +69,25 @@ func run(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, args []
 		return exitInternal
 	}
 
+	fmtCache := openFormatCache(stderr, opts)
+	defer func() { _ = fmtCache.Close() }()
+	key, changed, cached := cachedVerdict(fmtCache, src)
+	switch {
+	case cached && opts.check:
+		return checkExitCode(changed)
+	case cached && opts.write && !changed:
+		return exitOK
+	}
+	inputPath := opts.path
+	if opts.stdin {
+		inputPath = opts.assumeFilename
+	}
+	if client := daemonFor(ctx, newDaemonFinder(opts), inputPath); client != nil {
+		if code, ok := runWithDaemon(ctx, stdout, stderr, opts, client, fmtCache, key, src, pathURI); ok {
+			return code
+		}
+	}
+
 	tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: pathURI})
 	if err != nil {
 		writef(stderr, "thriftfmt: parse failed: %v\n", err)
@@ -75,11 +114,15 @@ func run(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, args []
 
 	fopts := format.Options{LineWidth: opts.lineWidth}
 	if rangeSpan == nil {
+		if opts.write || opts.check {
+			return streamDocumentResult(ctx, stderr, opts, fmtCache, key, tree, fopts)
+		}
 		res, err := format.Document(ctx, tree, fopts)
 		if err != nil {
 			return handleFormatError(stderr, tree, res.Diagnostics, err)
 		}
-		return handleDocumentResult(stdout, stderr, opts, src, res)
+		writeDocumentResult(stdout, opts, src, res)
+		return exitOK
 	}
 
 	res, err := format.Range(ctx, tree, *rangeSpan, fopts)
@@ -97,6 +140,9 @@ func parseArgs(args []string) (cliOptions, string, error) {
 	fs.BoolVar(&opts.write, "write", false, "write result in-place")
 	fs.BoolVar(&opts.write, "w", false, "write result in-place")
 	fs.BoolVar(&opts.check, "check", false, "exit non-zero if formatting changes are needed")
+	fs.BoolVar(&opts.list, "list", false, "print paths of files whose formatting differs")
+	fs.BoolVar(&opts.list, "l", false, "print paths of files whose formatting differs")
+	fs.IntVar(&opts.jobs, "jobs", 0, "maximum files formatted in parallel (0 uses all CPUs)")
 	fs.BoolVar(&opts.stdin, "stdin", false, "read input from stdin")
 	fs.BoolVar(&opts.stdout, "stdout", false, "write formatted output to stdout")
 	fs.StringVar(&opts.assumeFilename, "assume-filename", "", "filename/URI used for parser context and diagnostics")
@@ -104,6 +150,11 @@ func parseArgs(args []string) (cliOptions, string, error) {
 	fs.StringVar(&opts.rangeSpec, "range", "", "optional byte range start:end (half-open)")
 	fs.BoolVar(&opts.debugTokens, "debug-tokens", false, "dump lexer tokens")
 	fs.BoolVar(&opts.debugCST, "debug-cst", false, "dump CST nodes")
+	fs.StringVar(&opts.cacheDir, "cache-dir", "", "cache --check/--list/--write verdicts of unchanged files in this directory")
+	fs.BoolVar(&opts.noCache, "no-cache", false, "disable the result cache, even with --cache-dir")
+	fs.BoolVar(&opts.noDaemon, "no-daemon", false, "format in-process even when a thriftls daemon is running")
+	fs.StringVar(&opts.diffPath, "diff", "", "format only the lines a unified diff adds to .thrift files (- reads stdin)")
+	fs.Var((*cliutil.MultiStringFlag)(&opts.lineSpecs), "lines", "format only lines of a file, as PATH:START-END (repeatable)")
 
 	usage := cliUsage(fs)
 	if err := fs.Parse(args); err != nil {
@@ -121,24 +172,60 @@ func parseArgs(args []string) (cliOptions, string, error) {
 	}
 
 	rest := fs.Args()
+	if opts.diffPath != "" || len(opts.lineSpecs) > 0 {
+		switch {
+		case opts.stdin || len(rest) > 0:
+			return cliOptions{}, usage, errors.New("--diff and --lines select their own files; positional paths and --stdin are not allowed")
+		case opts.stdout || opts.rangeSpec != "" || opts.debugTokens || opts.debugCST:
+			return cliOptions{}, usage, errors.New("--stdout, --range and --debug-* apply to a single file")
+		case !opts.write && !opts.check && !opts.list:
+			return cliOptions{}, usage, errors.New("--diff and --lines require --write, --check or --list")
+		case opts.jobs < 0:
+			return cliOptions{}, usage, errors.New("--jobs must not be negative")
+		}
+		opts.batch, opts.lines = true, true
+		return opts, usage, nil
+	}
 	switch {
 	case opts.stdin && len(rest) > 0:
 		return cliOptions{}, usage, errors.New("positional file path is not allowed with --stdin")
+	case opts.stdin && opts.list:
+		return cliOptions{}, usage, errors.New("--list and --stdin may not be used together")
 	case !opts.stdin && len(rest) == 0:
-		return cliOptions{}, usage, errors.New("exactly one input file path is required (or use --stdin)")
-	case !opts.stdin && len(rest) != 1:
-		return cliOptions{}, usage, errors.New("formatting multiple files in one invocation is not supported")
+		return cliOptions{}, usage, errors.New("at least one input path is required (or use --stdin)")
+	case opts.jobs < 0:
+		return cliOptions{}, usage, errors.New("--jobs must not be negative")
 	}
-	if !opts.stdin {
+	if opts.stdin {
+		return opts, usage, nil
+	}
+
+	opts.batch = opts.list || len(rest) > 1 || slices.Contains(rest, fileListArg) || isDir(rest[0])
+	if !opts.batch {
 		opts.path = rest[0]
+		return opts, usage, nil
+	}
+	opts.paths = rest
+	switch {
+	case opts.stdout || opts.rangeSpec != "" || opts.debugTokens || opts.debugCST:
+		return cliOptions{}, usage, errors.New("--stdout, --range and --debug-* apply to a single file")
+	case !opts.write && !opts.check && !opts.list:
+		return cliOptions{}, usage, errors.New("formatting several files requires --write, --check or --list")
 	}
 	return opts, usage, nil
 }
 
+func isDir(path string) bool {
+	st, err := os.Stat(path)
+	return err == nil && st.IsDir()
+}
+
 func cliUsage(fs *flag.FlagSet) string {
 	var b strings.Builder
 	b.WriteString("Usage:\n")
 	b.WriteString("  thriftfmt [flags] path/to/file.thrift\n")
+	b.WriteString("  thriftfmt --write|--check|--list [flags] path/to/dir file.thrift ...\n")
+	b.WriteString("  find . -name '*.thrift' -print0 | thriftfmt --check -\n")
 	b.WriteString("  thriftfmt --stdin [--assume-filename foo.thrift] [flags]\n\n")
 	b.WriteString("Flags:\n")
 	fs.VisitAll(func(f *flag.Flag) {
@@ -167,26 +254,64 @@ func readInput(stdin io.Reader, opts cliOptions) ([]byte, string, error) {
 	return src, opts.path, nil
 }
 
-func handleDocumentResult(stdout, stderr io.Writer, opts cliOptions, original []byte, res format.Result) int {
-	if opts.check {
+// streamDocumentResult handles --check and --write without holding the
+// formatted document in memory.
+func streamDocumentResult(ctx context.Context, stderr io.Writer, opts cliOptions, c *cache.Cache, key cache.Key, tree *syntax.Tree, fopts format.Options) int {
+	res, formatErr, err := formatFile(ctx, c, key, tree, fopts, opts.path, opts.write)
+	switch {
+	case formatErr != nil:
+		return handleFormatError(stderr, tree, res.Diagnostics, formatErr)
+	case err != nil:
+		writef(stderr, "thriftfmt: write %s: %v\n", opts.path, err)
+		return exitInternal
+	case opts.check:
 		return checkExitCode(res.Changed)
 	}
-	if opts.write {
-		if !res.Changed {
-			return exitOK
+	return exitOK
+}
+
+// formatFile formats tree for --check, --list and --write. Without write the
+// tree is only checked against its formatting, or with write the output is
+// streamed into a temporary file that replaces path only if it changed.
+// formatErr reports a formatting failure and err a failed write. The verdicts
+// for the source and for written output are recorded in c under their keys.
+func formatFile(ctx context.Context, c *cache.Cache, key cache.Key, tree *syntax.Tree, fopts format.Options, path string, write bool) (res format.Result, formatErr, err error) {
+	if !write {
+		res, formatErr = format.Check(ctx, tree, fopts)
+		if formatErr == nil && c != nil {
+			storeVerdict(c, key, res.Changed)
 		}
-		if err := writeOutputFile(opts.path, res.Output); err != nil {
-			writef(stderr, "thriftfmt: write %s: %v\n", opts.path, err)
-			return exitInternal
+		return res, formatErr, nil
+	}
+	h := c.NewHash()
+	err = writeFileAtomic(path, tree.Source, func(w io.Writer) (bool, error) {
+		if c != nil {
+			w = io.MultiWriter(w, h)
 		}
-		return exitOK
+		res, formatErr = format.DocumentTo(ctx, tree, fopts, w)
+		return res.Changed, formatErr
+	})
+	if err != nil {
+		return res, nil, err
+	}
+	if formatErr != nil || c == nil {
+		return res, formatErr, nil
 	}
+	storeVerdict(c, key, res.Changed)
+	if res.Changed {
+		storeVerdict(c, cache.SumKey(h), false)
+	}
+	return res, nil, nil
+}
+
+// writeDocumentResult prints the formatted document, or the original bytes
+// when formatting changed nothing.
+func writeDocumentResult(stdout io.Writer, opts cliOptions, original []byte, res format.Result) {
 	if !res.Changed && !opts.stdout {
 		_, _ = stdout.Write(original)
-		return exitOK
+		return
 	}
 	_, _ = stdout.Write(res.Output)
-	return exitOK
 }
 
 func handleRangeResult(stdout, stderr io.Writer, opts cliOptions, original []byte, res format.RangeResult) int {
@@ -303,6 +428,26 @@ func dumpCST(w io.Writer, tree *syntax.Tree) {
 }
 
 func writeOutputFile(path string, data []byte) error {
+	return writeFileAtomic(path, nil, func(w io.Writer) (bool, error) {
+		_, err := w.Write(data)
+		return true, err
+	})
+}
+
+// writeFileAtomic streams new contents for path into a temporary file next
+// to it and renames it over path if write reports a change, so readers never
+// see a partially written file. The original permissions are kept and a
+// symlinked path has its target replaced.
+//
+// src is the current content of path. The temporary file is only created
+// once the output first differs from it, so rewriting a file with its own
+// content never touches the filesystem. An error returned by write abandons
+// the file and is left to the caller; the returned error reports a failure
+// to create or replace the file.
+func writeFileAtomic(path string, src []byte, write func(io.Writer) (bool, error)) error {
+	if resolved, err := filepath.EvalSymlinks(path); err == nil {
+		path = resolved
+	}
 	mode := os.FileMode(0o600)
 	//nolint:gosec // CLI reads metadata for a user-specified output path.
 	if st, err := os.Stat(path); err == nil {
@@ -311,8 +456,94 @@ func writeOutputFile(path string, data []byte) error {
 			mode = 0o600
 		}
 	}
-	//nolint:gosec // CLI writes formatter output to a user-specified path.
-	return os.WriteFile(path, data, mode)
+	var (
+		tmp       *os.File
+		committed bool
+	)
+	defer func() {
+		if tmp != nil && !committed {
+			_ = tmp.Close()
+			_ = os.Remove(tmp.Name())
+		}
+	}()
+
+	out := &divergingWriter{src: src, open: func() (*bufio.Writer, error) {
+		var err error
+		tmp, err = os.CreateTemp(filepath.Dir(path), "."+filepath.Base(path)+".*.tmp")
+		if err != nil {
+			return nil, err
+		}
+		return bufio.NewWriterSize(tmp, 64<<10), nil
+	}}
+	changed, err := write(out)
+	if out.err != nil {
+		return out.err
+	}
+	if err != nil || !changed {
+		return nil
+	}
+	if err := out.start(); err != nil {
+		return err
+	}
+	if err := out.w.Flush(); err != nil {
+		return err
+	}
+	if err := tmp.Chmod(mode); err != nil {
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		return err
+	}
+	if err := os.Rename(tmp.Name(), path); err != nil {
+		return err
+	}
+	committed = true
+	return nil
+}
+
+// divergingWriter discards output while it matches a prefix of src. At the
+// first byte that differs it opens its destination, copies the matched
+// prefix into it and forwards everything after.
+type divergingWriter struct {
+	src  []byte
+	off  int
+	open func() (*bufio.Writer, error)
+	w    *bufio.Writer
+	err  error
+}
+
+func (d *divergingWriter) Write(p []byte) (int, error) {
+	if d.w == nil {
+		if end := d.off + len(p); end <= len(d.src) && bytes.Equal(p, d.src[d.off:end]) {
+			d.off = end
+			return len(p), nil
+		}
+		if err := d.start(); err != nil {
+			return 0, err
+		}
+	}
+	n, err := d.w.Write(p)
+	if err != nil {
+		d.err = err
+	}
+	return n, err
+}
+
+// start opens the destination and writes the matched prefix of src to it.
+func (d *divergingWriter) start() error {
+	if d.w != nil {
+		return nil
+	}
+	w, err := d.open()
+	if err == nil {
+		_, err = w.Write(d.src[:d.off])
+	}
+	if err != nil {
+		d.err = err
+		return err
+	}
+	d.w = w
+	return nil
 }
 
 func checkExitCode(changed bool) int {
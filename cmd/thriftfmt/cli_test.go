@@ -9,6 +9,7 @@ import (
 	"strings"
 	"testing"
 
+	"github.com/kpumuk/thrift-weaver/internal/format"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
 )
 
@@ -117,6 +118,134 @@ func TestRunWriteUpdatesFileInPlace(t *testing.T) {
 	}
 }
 
+func TestRunWriteLeavesFormattedFileInReadOnlyDirectory(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	path := filepath.Join(dir, "x.thrift")
+	src := "struct A {\n  1: i32 id,\n}\n"
+	if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	if err := os.Chmod(dir, 0o555); err != nil {
+		t.Fatalf("Chmod: %v", err)
+	}
+	t.Cleanup(func() { _ = os.Chmod(dir, 0o700) })
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--write", "--no-cache", path})
+	if code != exitOK {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	entries, err := os.ReadDir(dir)
+	if err != nil {
+		t.Fatalf("ReadDir: %v", err)
+	}
+	if len(entries) != 1 {
+		t.Fatalf("temporary files left behind: %v", entries)
+	}
+}
+
+func TestRunWriteReplacesSymlinkTargetAndKeepsMode(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	target := filepath.Join(dir, "real.thrift")
+	link := filepath.Join(dir, "link.thrift")
+	if err := os.WriteFile(target, []byte("struct A{1:i32 id}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	if err := os.Chmod(target, 0o640); err != nil {
+		t.Fatalf("Chmod: %v", err)
+	}
+	if err := os.Symlink(target, link); err != nil {
+		t.Skipf("Symlink: %v", err)
+	}
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--write", link})
+	if code != exitOK {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	got, err := os.ReadFile(target)
+	if err != nil {
+		t.Fatalf("ReadFile: %v", err)
+	}
+	if string(got) != "struct A {\n  1: i32 id,\n}\n" {
+		t.Fatalf("formatted file mismatch: %q", got)
+	}
+	if st, err := os.Lstat(link); err != nil || st.Mode()&os.ModeSymlink == 0 {
+		t.Fatalf("symlink replaced: %v", err)
+	}
+	if st, err := os.Stat(target); err != nil || st.Mode().Perm() != 0o640 {
+		t.Fatalf("target mode = %v (%v), want 0640", st.Mode().Perm(), err)
+	}
+	entries, err := os.ReadDir(dir)
+	if err != nil {
+		t.Fatalf("ReadDir: %v", err)
+	}
+	if len(entries) != 2 {
+		t.Fatalf("temporary files left behind: %v", entries)
+	}
+}
+
+func TestRunCheckAndWriteUseResultCache(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	cacheDir := filepath.Join(dir, "cache")
+	path := filepath.Join(dir, "x.thrift")
+	if err := os.WriteFile(path, []byte("struct A{1:i32 id}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	check := func(extra ...string) int {
+		t.Helper()
+		var out, errb bytes.Buffer
+		return run(context.Background(), strings.NewReader(""), &out, &errb, append(append([]string{"--check", "--cache-dir", cacheDir}, extra...), path))
+	}
+
+	if code := check(); code != exitCheck {
+		t.Fatalf("cold --check exit code = %d, want %d", code, exitCheck)
+	}
+	// A poisoned verdict proves the warm run is answered from the cache.
+	overwriteCacheEntries(t, cacheDir, "f")
+	if code := check(); code != exitOK {
+		t.Fatalf("warm --check exit code = %d, want cached %d", code, exitOK)
+	}
+	if code := check("--no-cache"); code != exitCheck {
+		t.Fatalf("--no-cache exit code = %d, want %d", code, exitCheck)
+	}
+
+	// --write also records the verdict of the output it writes.
+	written := filepath.Join(dir, "y.thrift")
+	if err := os.WriteFile(written, []byte("struct B{1:i32 id}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	var out, errb bytes.Buffer
+	if code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--write", "--cache-dir", cacheDir, written}); code != exitOK {
+		t.Fatalf("--write exit code = %d; stderr=%q", code, errb.String())
+	}
+	overwriteCacheEntries(t, cacheDir, "c")
+	if code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--check", "--cache-dir", cacheDir, written}); code != exitCheck {
+		t.Fatalf("--check of written file exit code = %d, want cached %d", code, exitCheck)
+	}
+}
+
+// overwriteCacheEntries replaces every result cache entry below dir.
+func overwriteCacheEntries(t *testing.T, dir, data string) {
+	t.Helper()
+
+	err := filepath.WalkDir(dir, func(path string, d os.DirEntry, err error) error {
+		if err != nil || d.IsDir() || !strings.HasSuffix(path, "-r") {
+			return err
+		}
+		return os.WriteFile(path, []byte(data), 0o600)
+	})
+	if err != nil {
+		t.Fatalf("overwrite cache entries: %v", err)
+	}
+}
+
 func TestRunRangeFormatsSelectedAncestorAndPrintsToStdout(t *testing.T) {
 	t.Parallel()
 
@@ -230,3 +359,198 @@ func TestDiagnosticDisplayTextHumanizesParserRecoveryDiagnostics(t *testing.T) {
 		t.Fatalf("unexpected parser missing details: %#v", details)
 	}
 }
+
+func TestRunBatchWritesDirectoryRecursively(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	unformatted := "struct Foo{1:required i32 id;}\n"
+	files := map[string]string{
+		"a.thrift":             unformatted,
+		"nested/b.thrift":      unformatted,
+		"nested/notes.txt":     unformatted,
+		".hidden/c.thrift":     unformatted,
+		"nested/ok.thrift":     "const i32 X = 1\n",
+		"nested/deep/d.thrift": unformatted,
+	}
+	for name, src := range files {
+		path := filepath.Join(dir, filepath.FromSlash(name))
+		if err := os.MkdirAll(filepath.Dir(path), 0o700); err != nil {
+			t.Fatalf("MkdirAll: %v", err)
+		}
+		if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile: %v", err)
+		}
+	}
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--write", "--list", "--jobs", "2", dir})
+	if code != exitOK {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	want := strings.Join([]string{
+		filepath.Join(dir, "a.thrift"),
+		filepath.Join(dir, "nested", "b.thrift"),
+		filepath.Join(dir, "nested", "deep", "d.thrift"),
+	}, "\n") + "\n"
+	if out.String() != want {
+		t.Fatalf("listed files = %q, want %q", out.String(), want)
+	}
+	for name, src := range files {
+		data, err := os.ReadFile(filepath.Join(dir, filepath.FromSlash(name)))
+		if err != nil {
+			t.Fatalf("ReadFile: %v", err)
+		}
+		got := string(data)
+		changed := got != src
+		wantChanged := strings.HasSuffix(name, ".thrift") && !strings.HasPrefix(name, ".hidden") && !strings.HasSuffix(name, "ok.thrift")
+		if changed != wantChanged {
+			t.Fatalf("%s changed = %v, want %v; content=%q", name, changed, wantChanged, got)
+		}
+	}
+}
+
+func TestRunBatchChecksFileListFromStdinInInputOrder(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	var list []string
+	for i := range 8 {
+		path := filepath.Join(dir, fmt.Sprintf("f%d.thrift", 7-i))
+		src := "const i32 X = 1\n"
+		if i%3 == 0 {
+			src = "struct Foo{1:required i32 id;}\n"
+		}
+		if i == 4 {
+			src = "const string X = 'unterminated\n"
+		}
+		if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile: %v", err)
+		}
+		list = append(list, path)
+	}
+
+	var out, errb bytes.Buffer
+	stdin := strings.NewReader(strings.Join(list, "\x00") + "\x00")
+	code := run(context.Background(), stdin, &out, &errb, []string{"--check", "--list", "-"})
+	if code != exitUnsafe {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitUnsafe, errb.String())
+	}
+	want := list[0] + "\n" + list[3] + "\n" + list[6] + "\n"
+	if out.String() != want {
+		t.Fatalf("listed files = %q, want %q", out.String(), want)
+	}
+	if !strings.Contains(errb.String(), list[4]) || !strings.Contains(errb.String(), "LEX_UNTERMINATED_STRING") {
+		t.Fatalf("stderr missing unsafe file report: %q", errb.String())
+	}
+}
+
+func TestRunDiffFormatsOnlyAddedLines(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	a := filepath.Join(dir, "a.thrift")
+	b := filepath.Join(dir, "b.thrift")
+	for _, path := range []string{a, b} {
+		if err := os.WriteFile(path, []byte("struct A{1:i32 a}\nstruct B{1:i32 b}\n"), 0o600); err != nil {
+			t.Fatalf("WriteFile: %v", err)
+		}
+	}
+	diff := strings.Join([]string{
+		"diff --git a/notes.txt b/notes.txt",
+		"+++ b/notes.txt",
+		"@@ -1 +1 @@",
+		"-old",
+		"+new",
+		"diff --git a/" + a + " b/" + a,
+		"--- a/" + a,
+		"+++ b/" + a,
+		"@@ -1,2 +1,2 @@",
+		" struct A{1:i32 a}",
+		"-struct B{}",
+		"+struct B{1:i32 b}",
+		"",
+	}, "\n")
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(diff), &out, &errb, []string{"--write", "--list", "--diff", "-", "--lines", b + ":1"})
+	if code != exitOK {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	if want := a + "\n" + b + "\n"; out.String() != want {
+		t.Fatalf("listed files = %q, want %q", out.String(), want)
+	}
+	for path, want := range map[string]string{
+		a: "struct A{1:i32 a}\nstruct B {\n  1: i32 b\n}\n",
+		b: "struct A {\n  1: i32 a\n}\nstruct B{1:i32 b}\n",
+	} {
+		got, err := os.ReadFile(path)
+		if err != nil {
+			t.Fatalf("ReadFile: %v", err)
+		}
+		if string(got) != want {
+			t.Fatalf("%s = %q, want %q", filepath.Base(path), got, want)
+		}
+	}
+
+	code = run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--check", "--lines", a + ":2-2"})
+	if code != exitOK {
+		t.Fatalf("check exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	code = run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--check", "--lines", a + ":1-2"})
+	if code != exitCheck {
+		t.Fatalf("check exit code = %d, want %d; stderr=%q", code, exitCheck, errb.String())
+	}
+}
+
+func TestRunLinesReportsSkippedLines(t *testing.T) {
+	t.Parallel()
+
+	path := filepath.Join(t.TempDir(), "a.thrift")
+	if err := os.WriteFile(path, []byte("struct A {}\n// note\nstruct B {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--check", "--lines", path + ":2"})
+	if code != exitOK {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitOK, errb.String())
+	}
+	if !strings.Contains(errb.String(), string(format.DiagnosticFormatterRangeNoSafeAncestor)) {
+		t.Fatalf("stderr missing skipped line diagnostic: %q", errb.String())
+	}
+}
+
+func TestRunBatchRequiresWriteCheckOrList(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{dir})
+	if code != exitInternal {
+		t.Fatalf("exit code = %d, want %d", code, exitInternal)
+	}
+	if !strings.Contains(errb.String(), "requires --write, --check or --list") {
+		t.Fatalf("stderr missing batch mode validation: %q", errb.String())
+	}
+}
+
+func TestParseLinesFlag(t *testing.T) {
+	t.Parallel()
+
+	path, r, err := parseLinesFlag("dir/a:b.thrift:3-7")
+	if err != nil {
+		t.Fatalf("parseLinesFlag: %v", err)
+	}
+	if path != "dir/a:b.thrift" || r != (lineRange{start: 3, end: 7}) {
+		t.Fatalf("got %q %+v, want dir/a:b.thrift 3-7", path, r)
+	}
+	if _, r, _ := parseLinesFlag("a.thrift:4"); r != (lineRange{start: 4, end: 4}) {
+		t.Fatalf("single line = %+v, want 4-4", r)
+	}
+	for _, bad := range []string{"a.thrift", ":1-2", "a.thrift:0-1", "a.thrift:5-2"} {
+		if _, _, err := parseLinesFlag(bad); err == nil {
+			t.Fatalf("parseLinesFlag(%q): expected error", bad)
+		}
+	}
+}
@@ -0,0 +1,90 @@
+package main
+
+import (
+	"context"
+	"errors"
+	"io"
+	"path/filepath"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+	"github.com/kpumuk/thrift-weaver/internal/daemon"
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// newDaemonFinder looks up thriftls daemons unless --no-daemon is set. Range
+// formatting and debug dumps need a local tree and always run in-process.
+func newDaemonFinder(opts cliOptions) *daemon.Finder {
+	if opts.noDaemon || opts.rangeSpec != "" || opts.debugTokens || opts.debugCST {
+		return nil
+	}
+	return daemon.NewFinder()
+}
+
+// daemonFor returns a running thriftls daemon serving the directory of path
+// or an ancestor, or nil. Formatting does not depend on the workspace, so
+// any daemon above the file will do.
+func daemonFor(ctx context.Context, daemons *daemon.Finder, path string) *daemon.Client {
+	dir := "."
+	if path != "" {
+		dir = filepath.Dir(path)
+	}
+	return daemons.Find(ctx, dir)
+}
+
+// runWithDaemon handles a single-file run on client. ok is false when the
+// daemon did not answer and the run should continue in-process.
+func runWithDaemon(ctx context.Context, stdout, stderr io.Writer, opts cliOptions, client *daemon.Client, c *cache.Cache, key cache.Key, src []byte, uri string) (code int, ok bool) {
+	res, formatErr, err, ok := formatWithDaemon(ctx, client, c, key, src, uri, opts.path, opts)
+	if !ok {
+		return 0, false
+	}
+	var parseErr *daemon.ParseError
+	switch {
+	case errors.As(formatErr, &parseErr):
+		writef(stderr, "thriftfmt: parse failed: %v\n", formatErr)
+		return exitInternal, true
+	case formatErr != nil:
+		// Diagnostics render from the URI and source of a tree only.
+		return handleFormatError(stderr, &syntax.Tree{URI: uri, Source: src}, res.Diagnostics, formatErr), true
+	case err != nil:
+		writef(stderr, "thriftfmt: write %s: %v\n", opts.path, err)
+		return exitInternal, true
+	case opts.check:
+		return checkExitCode(res.Changed), true
+	case opts.write:
+		return exitOK, true
+	}
+	writeDocumentResult(stdout, opts, src, res)
+	return exitOK, true
+}
+
+// formatWithDaemon formats src on client, writing path and recording
+// verdicts like formatFile does in-process. formatErr reports a parse or
+// formatting failure and err a failed write; ok is false when the daemon did
+// not answer.
+func formatWithDaemon(ctx context.Context, client *daemon.Client, c *cache.Cache, key cache.Key, src []byte, uri, path string, opts cliOptions) (res format.Result, formatErr, err error, ok bool) {
+	if !opts.write && (opts.check || opts.list) {
+		res, formatErr = client.Check(ctx, uri, src, opts.lineWidth)
+	} else {
+		res, formatErr = client.Format(ctx, uri, src, opts.lineWidth)
+	}
+	switch {
+	case errors.Is(formatErr, daemon.ErrUnavailable):
+		return format.Result{}, nil, nil, false
+	case formatErr != nil:
+		return res, formatErr, nil, true
+	}
+	if c != nil {
+		storeVerdict(c, key, res.Changed)
+	}
+	if opts.write && res.Changed {
+		if err := writeOutputFile(path, res.Output); err != nil {
+			return res, nil, err, true
+		}
+		if c != nil {
+			storeVerdict(c, c.Key(res.Output), false)
+		}
+	}
+	return res, nil, nil, true
+}
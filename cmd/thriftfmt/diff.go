@@ -0,0 +1,281 @@
+package main
+
+import (
+	"bufio"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+
+	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// lineRange is an inclusive range of 1-based lines.
+type lineRange struct {
+	start, end int
+}
+
+// changedLines lists the files of a --diff or --lines run in input order with
+// the lines to format in each.
+type changedLines struct {
+	paths []string
+	lines map[string][]lineRange
+}
+
+func (c *changedLines) add(path string, r lineRange) {
+	if c.lines == nil {
+		c.lines = make(map[string][]lineRange)
+	}
+	if _, ok := c.lines[path]; !ok {
+		c.paths = append(c.paths, path)
+	}
+	c.lines[path] = append(c.lines[path], r)
+}
+
+// readChangedLines collects the lines selected by --diff and --lines.
+func readChangedLines(stdin io.Reader, opts cliOptions) (changedLines, error) {
+	var c changedLines
+	if opts.diffPath != "" {
+		r := stdin
+		if opts.diffPath != fileListArg {
+			//nolint:gosec // CLI intentionally reads user-provided file paths.
+			f, err := os.Open(opts.diffPath)
+			if err != nil {
+				return changedLines{}, err
+			}
+			defer func() { _ = f.Close() }()
+			r = f
+		}
+		if err := parseUnifiedDiff(r, &c); err != nil {
+			return changedLines{}, fmt.Errorf("read --diff: %w", err)
+		}
+	}
+	for _, spec := range opts.lineSpecs {
+		path, r, err := parseLinesFlag(spec)
+		if err != nil {
+			return changedLines{}, fmt.Errorf("invalid --lines %q: %w", spec, err)
+		}
+		c.add(path, r)
+	}
+	return c, nil
+}
+
+// parseUnifiedDiff adds the lines each hunk of a unified diff adds to a
+// .thrift file. Paths come from the "+++" headers with git's "b/" prefix
+// removed; deleted files and context lines are skipped.
+func parseUnifiedDiff(r io.Reader, c *changedLines) error {
+	sc := bufio.NewScanner(r)
+	sc.Buffer(make([]byte, 0, 64*1024), 16<<20)
+	var (
+		path          string
+		line          int
+		oldLeft, left int
+		run           lineRange
+	)
+	flush := func() {
+		if run.start > 0 {
+			c.add(path, run)
+			run = lineRange{}
+		}
+	}
+	for sc.Scan() {
+		s := sc.Text()
+		if oldLeft > 0 || left > 0 {
+			switch {
+			case strings.HasPrefix(s, "+"):
+				if path != "" {
+					if run.start == 0 {
+						run.start = line
+					}
+					run.end = line
+				}
+				line++
+				left--
+				continue
+			case strings.HasPrefix(s, "-"):
+				oldLeft--
+			case strings.HasPrefix(s, `\`):
+				// "\ No newline at end of file"
+			default:
+				line++
+				oldLeft--
+				left--
+			}
+			flush()
+			continue
+		}
+		flush()
+		switch {
+		case strings.HasPrefix(s, "+++ "):
+			path = diffPath(strings.TrimPrefix(s, "+++ "))
+		case strings.HasPrefix(s, "@@ "):
+			var err error
+			if oldLeft, line, left, err = parseHunkHeader(s); err != nil {
+				return err
+			}
+		}
+	}
+	flush()
+	return sc.Err()
+}
+
+// diffPath returns the file a "+++" header names, or "" for files that are
+// deleted or not Thrift sources.
+func diffPath(header string) string {
+	name, _, _ := strings.Cut(header, "\t")
+	if name == "/dev/null" || filepath.Ext(name) != ".thrift" {
+		return ""
+	}
+	return strings.TrimPrefix(name, "b/")
+}
+
+// parseHunkHeader parses "@@ -l,s +l,s @@" into the old line count and the
+// first line and line count on the new side.
+func parseHunkHeader(s string) (oldCount, newStart, newCount int, err error) {
+	fields := strings.Fields(s)
+	if len(fields) < 3 || !strings.HasPrefix(fields[1], "-") || !strings.HasPrefix(fields[2], "+") {
+		return 0, 0, 0, fmt.Errorf("malformed hunk header %q", s)
+	}
+	_, oldCount, err = parseHunkRange(fields[1][1:])
+	if err != nil {
+		return 0, 0, 0, fmt.Errorf("malformed hunk header %q: %w", s, err)
+	}
+	newStart, newCount, err = parseHunkRange(fields[2][1:])
+	if err != nil {
+		return 0, 0, 0, fmt.Errorf("malformed hunk header %q: %w", s, err)
+	}
+	return oldCount, newStart, newCount, nil
+}
+
+func parseHunkRange(s string) (start, count int, err error) {
+	startText, countText, hasCount := strings.Cut(s, ",")
+	start, err = strconv.Atoi(startText)
+	if err != nil {
+		return 0, 0, err
+	}
+	count = 1
+	if hasCount {
+		count, err = strconv.Atoi(countText)
+	}
+	return start, count, err
+}
+
+// parseLinesFlag parses PATH:START-END or PATH:LINE.
+func parseLinesFlag(spec string) (string, lineRange, error) {
+	i := strings.LastIndexByte(spec, ':')
+	if i <= 0 {
+		return "", lineRange{}, errors.New("expected PATH:START-END")
+	}
+	path, lines := spec[:i], spec[i+1:]
+	startText, endText, ok := strings.Cut(lines, "-")
+	if !ok {
+		endText = startText
+	}
+	start, err := strconv.Atoi(startText)
+	if err != nil {
+		return "", lineRange{}, fmt.Errorf("parse start line: %w", err)
+	}
+	end, err := strconv.Atoi(endText)
+	if err != nil {
+		return "", lineRange{}, fmt.Errorf("parse end line: %w", err)
+	}
+	if start < 1 || end < start {
+		return "", lineRange{}, errors.New("lines must satisfy 1 <= START <= END")
+	}
+	return path, lineRange{start: start, end: end}, nil
+}
+
+// changedLineSpans turns line ranges into one span per non-blank line,
+// trimmed to its content, so each line widens to its own format-safe ancestor
+// and a hunk spanning several declarations does not widen to the document.
+// Lines past the end of src are ignored.
+func changedLineSpans(src []byte, ranges []lineRange) []text.Span {
+	li := text.NewLineIndex(src)
+	var spans []text.Span
+	for _, r := range ranges {
+		for line := r.start; line <= min(r.end, li.LineCount()); line++ {
+			start, err := li.PointToOffset(text.Point{Line: line - 1})
+			if err != nil {
+				continue
+			}
+			end := text.ByteOffset(len(src))
+			if line < li.LineCount() {
+				if next, err := li.PointToOffset(text.Point{Line: line}); err == nil {
+					end = next
+				}
+			}
+			for start < end && isLineSpace(src[start]) {
+				start++
+			}
+			for end > start && isLineSpace(src[end-1]) {
+				end--
+			}
+			if start < end {
+				spans = append(spans, text.Span{Start: start, End: end})
+			}
+		}
+	}
+	return spans
+}
+
+// skippedRangeDiagnostics returns the diagnostics format.Ranges reports for
+// lines it left unformatted.
+func skippedRangeDiagnostics(diags []syntax.Diagnostic) []syntax.Diagnostic {
+	var out []syntax.Diagnostic
+	for _, d := range diags {
+		if d.Code == format.DiagnosticFormatterRangeNoSafeAncestor || d.Code == format.DiagnosticFormatterRangeUnboundedNode {
+			out = append(out, d)
+		}
+	}
+	return out
+}
+
+func isLineSpace(b byte) bool {
+	return b == ' ' || b == '\t' || b == '\r' || b == '\n'
+}
+
+// formatBatchLines formats the given lines of one file of a --diff or --lines
+// run into res.
+func formatBatchLines(ctx context.Context, parser *syntax.ReusableParser, path string, lines []lineRange, opts cliOptions, res *batchResult) {
+	//nolint:gosec // CLI intentionally reads user-provided file paths.
+	src, err := os.ReadFile(path)
+	if err != nil {
+		writef(&res.stderr, "thriftfmt: read %s: %v\n", path, err)
+		res.code = exitInternal
+		return
+	}
+	tree, err := parser.Parse(ctx, src, syntax.ParseOptions{URI: path})
+	if err != nil {
+		writef(&res.stderr, "thriftfmt: %s: parse failed: %v\n", path, err)
+		res.code = exitInternal
+		return
+	}
+	defer tree.Close()
+
+	out, err := format.Ranges(ctx, tree, changedLineSpans(src, lines), format.Options{LineWidth: opts.lineWidth})
+	if err != nil {
+		res.code = handleFormatError(&res.stderr, tree, out.Diagnostics, fmt.Errorf("%s: %w", path, err))
+		return
+	}
+	cliutil.WriteDiagnostics(&res.stderr, "thriftfmt", tree, skippedRangeDiagnostics(out.Diagnostics), diagnosticDisplayText)
+	changed := len(out.Edits) > 0
+	if opts.write && changed {
+		formatted, err := text.ApplyEdits(src, out.Edits)
+		if err == nil {
+			err = writeOutputFile(path, formatted)
+		}
+		if err != nil {
+			writef(&res.stderr, "thriftfmt: write %s: %v\n", path, err)
+			res.code = exitInternal
+			return
+		}
+	}
+	reportBatchVerdict(path, opts, changed, res)
+}
@@ -0,0 +1,56 @@
+package main
+
+import (
+	"encoding/json"
+	"io"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/lint"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// openLintCache opens the result cache for the local rules of runner, or
+// returns nil when it is disabled. Workspace rules depend on other files and
+// are never cached.
+func openLintCache(stderr io.Writer, runner *lint.Runner, opts cliOptions) *cache.Cache {
+	rules := runner.Rules()
+	ids := make([]string, 0, len(rules))
+	for _, r := range rules {
+		ids = append(ids, r.ID())
+	}
+	return cliutil.OpenCache(stderr, "thriftlint", opts.cacheDir, opts.noCache, ids...)
+}
+
+// cachedLocalLint returns the cached parser and local rule diagnostics of
+// src, and the key they are stored under.
+func cachedLocalLint(c *cache.Cache, src []byte) (*localLint, cache.Key, bool) {
+	if c == nil {
+		return nil, cache.Key{}, false
+	}
+	key := c.Key(src)
+	data, ok := c.Get(key)
+	if !ok {
+		return nil, key, false
+	}
+	var diags []syntax.Diagnostic
+	if err := json.Unmarshal(data, &diags); err != nil {
+		return nil, key, false
+	}
+	res := &localLint{diags: diags}
+	if len(diags) > 0 {
+		res.src = src
+	}
+	return res, key, true
+}
+
+func storeLocalLint(c *cache.Cache, key cache.Key, diags []syntax.Diagnostic) {
+	if c == nil {
+		return
+	}
+	data, err := json.Marshal(diags)
+	if err != nil {
+		return
+	}
+	c.Put(key, data)
+}
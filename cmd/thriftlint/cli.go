@@ -1,6 +1,7 @@
 package main
 
 import (
+	"bytes"
 	"context"
 	"encoding/json"
 	"errors"
@@ -13,10 +14,13 @@ import (
 	"slices"
 	"strings"
 
+	"github.com/kpumuk/thrift-weaver/internal/cache"
 	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/daemon"
 	"github.com/kpumuk/thrift-weaver/internal/index"
 	"github.com/kpumuk/thrift-weaver/internal/lint"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
 )
 
 const (
@@ -36,10 +40,25 @@ type cliOptions struct {
 	stdin          bool
 	assumeFilename string
 	format         string
-	path           string
+	paths          []string
 	crossFile      string
 	workspaceRoots []string
 	includeDirs    []string
+	jobs           int
+	ruleTimings    bool
+	changedSince   string
+	cacheDir       string
+	noCache        bool
+	noDaemon       bool
+}
+
+// lintResult is the rendered outcome of one input. Text diagnostics are
+// rendered by the worker so trees do not outlive their input.
+type lintResult struct {
+	issues bool
+	text   bytes.Buffer
+	json   []diagnosticJSON
+	err    error
 }
 
 type diagnosticJSON struct {
@@ -63,34 +82,190 @@ func run(ctx context.Context, stdin io.Reader, stdout, stderr io.Writer, args []
 		return exitInternal
 	}
 
-	src, uri, err := readInput(stdin, opts)
-	if err != nil {
+	// One pool bounds both the files linted at once and the declaration
+	// chunks of each file.
+	runner := defaultLintRunner.WithPool(lint.NewPool(opts.jobs))
+	var timings *lint.RuleTimings
+	if opts.ruleTimings {
+		timings = &lint.RuleTimings{}
+		runner = runner.WithTimings(timings)
+	}
+
+	lintCache := openLintCache(stderr, runner, opts)
+	defer func() { _ = lintCache.Close() }()
+
+	if isProjectRun(opts) {
+		code := runProject(ctx, stdout, stderr, runner, lintCache, opts)
+		if timings != nil {
+			writeRuleTimings(stderr, timings.Timings())
+		}
+		return code
+	}
+
+	var daemons *daemon.Finder
+	if !opts.noDaemon && !opts.ruleTimings {
+		daemons = daemon.NewFinder()
+	}
+	inputs := max(1, len(opts.paths))
+	results := make([]lintResult, inputs)
+	if err := runner.Pool().Run(ctx, inputs, func(ctx context.Context, i int) error {
+		lintInput(ctx, stdin, runner, lintCache, daemons, opts, i, &results[i])
+		return nil
+	}); err != nil {
 		writef(stderr, "thriftlint: %v\n", err)
 		return exitInternal
 	}
 
-	tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: uri})
+	code := exitOK
+	var payload []diagnosticJSON
+	for i := range results {
+		r := &results[i]
+		switch {
+		case r.err != nil:
+			writef(stderr, "thriftlint: %v\n", r.err)
+			code = exitInternal
+			continue
+		case r.issues && code == exitOK:
+			code = exitIssues
+		}
+		_, _ = stderr.Write(r.text.Bytes())
+		payload = append(payload, r.json...)
+	}
+	if len(payload) > 0 {
+		if err := writeJSONPayload(stdout, payload); err != nil {
+			writef(stderr, "thriftlint: %v\n", err)
+			return exitInternal
+		}
+	}
+	if timings != nil {
+		writeRuleTimings(stderr, timings.Timings())
+	}
+	return code
+}
+
+// lintInput lints input i of opts and renders its diagnostics into res.
+func lintInput(ctx context.Context, stdin io.Reader, runner *lint.Runner, c *cache.Cache, daemons *daemon.Finder, opts cliOptions, i int, res *lintResult) {
+	src, uri, err := readInput(stdin, opts, i)
 	if err != nil {
-		writef(stderr, "thriftlint: parse failed: %v\n", err)
-		return exitInternal
+		res.err = err
+		return
+	}
+	// Batch errors name the file; single-input errors keep their short form.
+	prefix := ""
+	if len(opts.paths) > 1 {
+		prefix = uri + ": "
+	}
+	lintSource(ctx, runner, c, daemons, opts, src, uri, prefix, res)
+}
+
+// lintFile lints the file at path in-process and renders its diagnostics
+// into res.
+func lintFile(ctx context.Context, runner *lint.Runner, c *cache.Cache, opts cliOptions, path, prefix string, res *lintResult) {
+	//nolint:gosec // CLI intentionally reads user-provided file paths.
+	src, err := os.ReadFile(path)
+	if err != nil {
+		res.err = fmt.Errorf("read %s: %w", path, err)
+		return
 	}
-	defer tree.Close()
+	lintSource(ctx, runner, c, nil, opts, src, path, prefix, res)
+}
 
-	diags, err := collectDiagnosticsWithWorkspace(ctx, tree, src, uri, opts)
+// lintSource lints src and renders its diagnostics into res.
+func lintSource(ctx context.Context, runner *lint.Runner, c *cache.Cache, daemons *daemon.Finder, opts cliOptions, src []byte, uri, prefix string, res *lintResult) {
+	diags, li, err := inputDiagnostics(ctx, runner, c, daemons, opts, src, uri, prefix)
 	if err != nil {
-		writef(stderr, "thriftlint: lint failed: %v\n", err)
-		return exitInternal
+		res.err = err
+		return
 	}
 	if len(diags) == 0 {
-		return exitOK
+		return
 	}
+	// Diagnostics render from the URI, source and line index of a tree only.
+	tree := &syntax.Tree{URI: uri, Source: src, LineIndex: li}
+	res.issues = true
+	switch opts.format {
+	case outputFormatText:
+		cliutil.WriteDiagnostics(&res.text, "thriftlint", tree, diags, cliutil.DefaultDiagnosticMessage)
+	case outputFormatJSON:
+		res.json, res.err = jsonDiagnostics(tree, diags)
+	default:
+		res.err = fmt.Errorf("unsupported --format %q", opts.format)
+	}
+}
 
-	if err := writeDiagnosticsOutput(opts.format, stdout, stderr, tree, diags); err != nil {
-		writef(stderr, "thriftlint: %v\n", err)
-		return exitInternal
+// inputDiagnostics lints one input. Local diagnostics come from the result
+// cache, a running thriftls daemon, or an in-process parse; workspace
+// diagnostics from the daemon when it serves the same workspace, or from a
+// fresh index.
+func inputDiagnostics(ctx context.Context, runner *lint.Runner, c *cache.Cache, daemons *daemon.Finder, opts cliOptions, src []byte, uri, prefix string) ([]syntax.Diagnostic, *text.LineIndex, error) {
+	workspace := opts.crossFile != crossFileOff
+	local, key, cached := cachedLocalLint(c, src)
+	if cached && !workspace {
+		return local.diags, nil, nil
+	}
+	if client := daemonForInput(ctx, daemons, opts, uri); client != nil {
+		diags, err := client.Lint(ctx, uri, src, workspace)
+		var parseErr *daemon.ParseError
+		switch {
+		case errors.Is(err, daemon.ErrUnavailable):
+			// The daemon went away; lint in-process.
+		case errors.As(err, &parseErr):
+			return nil, nil, fmt.Errorf("%sparse failed: %w", prefix, err)
+		case err != nil:
+			return nil, nil, fmt.Errorf("%slint failed: %w", prefix, err)
+		default:
+			if !workspace {
+				storeLocalLint(c, key, diags)
+			}
+			return diags, nil, nil
+		}
 	}
 
-	return exitIssues
+	if !cached {
+		tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: uri})
+		if err != nil {
+			return nil, nil, fmt.Errorf("%sparse failed: %w", prefix, err)
+		}
+		diags, err := collectDiagnostics(ctx, runner, tree)
+		tree.Close()
+		if err != nil {
+			return nil, nil, fmt.Errorf("%slint failed: %w", prefix, err)
+		}
+		storeLocalLint(c, key, diags)
+		local = &localLint{diags: diags, lineIndex: tree.LineIndex}
+	}
+	diags := local.diags
+	if workspace {
+		workspaceDiags, err := collectWorkspaceDiagnostics(ctx, runner, src, uri, opts)
+		if err != nil {
+			return nil, nil, fmt.Errorf("%slint failed: %w", prefix, err)
+		}
+		diags = append(slices.Clone(diags), workspaceDiags...)
+		lint.SortDiagnostics(diags)
+	}
+	return diags, local.lineIndex, nil
+}
+
+// daemonForInput returns a running thriftls daemon that can lint uri with
+// opts: any daemon above it for local rules, and one serving exactly the
+// input's workspace for cross-file analysis.
+func daemonForInput(ctx context.Context, daemons *daemon.Finder, opts cliOptions, uri string) *daemon.Client {
+	if daemons == nil {
+		return nil
+	}
+	path, err := filePathFromURI(uri)
+	if err != nil {
+		return nil
+	}
+	client := daemons.Find(ctx, filepath.Dir(path))
+	if client == nil || opts.crossFile == crossFileOff {
+		return client
+	}
+	roots, err := workspaceRootsForInput(opts, uri)
+	if err != nil || !client.Serves(roots, opts.includeDirs) {
+		return nil
+	}
+	return client
 }
 
 func parseArgs(args []string) (cliOptions, string, error) {
@@ -102,8 +277,14 @@ func parseArgs(args []string) (cliOptions, string, error) {
 	fs.StringVar(&opts.assumeFilename, "assume-filename", "", "filename/URI used for parser context and diagnostics")
 	fs.StringVar(&opts.format, "format", outputFormatText, "diagnostic output format: text|json")
 	fs.StringVar(&opts.crossFile, "cross-file", "", "cross-file analysis mode: off|transitive|workspace")
-	fs.Var((*multiStringFlag)(&opts.workspaceRoots), "workspace-root", "workspace root used for cross-file analysis (repeatable)")
-	fs.Var((*multiStringFlag)(&opts.includeDirs), "include-dir", "include directory used for cross-file analysis (repeatable)")
+	fs.Var((*cliutil.MultiStringFlag)(&opts.workspaceRoots), "workspace-root", "workspace root used for cross-file analysis (repeatable)")
+	fs.Var((*cliutil.MultiStringFlag)(&opts.includeDirs), "include-dir", "include directory used for cross-file analysis (repeatable)")
+	fs.IntVar(&opts.jobs, "jobs", 0, "maximum parallel lint workers (0 uses all CPUs)")
+	fs.BoolVar(&opts.ruleTimings, "rule-timings", false, "print time spent in each lint rule to stderr")
+	fs.StringVar(&opts.changedSince, "changed-since", "", "lint only files changed since a git revision, and files that include them")
+	fs.StringVar(&opts.cacheDir, "cache-dir", "", "cache parser and local rule diagnostics of unchanged files in this directory")
+	fs.BoolVar(&opts.noCache, "no-cache", false, "disable the result cache, even with --cache-dir")
+	fs.BoolVar(&opts.noDaemon, "no-daemon", false, "lint in-process even when a thriftls daemon is running")
 
 	usage := cliUsage(fs)
 	if err := fs.Parse(args); err != nil {
@@ -119,18 +300,22 @@ func parseArgs(args []string) (cliOptions, string, error) {
 	if !isSupportedCrossFileMode(opts.crossFile) {
 		return cliOptions{}, usage, errors.New("--cross-file must be one of: off, transitive, workspace")
 	}
+	if opts.jobs < 0 {
+		return cliOptions{}, usage, errors.New("--jobs must not be negative")
+	}
 
 	rest := fs.Args()
 	switch {
 	case opts.stdin && len(rest) > 0:
 		return cliOptions{}, usage, errors.New("positional file path is not allowed with --stdin")
 	case !opts.stdin && len(rest) == 0:
-		return cliOptions{}, usage, errors.New("exactly one input file path is required (or use --stdin)")
-	case !opts.stdin && len(rest) != 1:
-		return cliOptions{}, usage, errors.New("linting multiple files in one invocation is not supported")
+		return cliOptions{}, usage, errors.New("at least one input file path is required (or use --stdin)")
 	}
 	if !opts.stdin {
-		opts.path = rest[0]
+		opts.paths = rest
+	}
+	if opts.changedSince != "" && !isProjectRun(opts) {
+		return cliOptions{}, usage, errors.New("--changed-since requires a directory input")
 	}
 	if opts.stdin && opts.crossFile != crossFileOff && opts.assumeFilename == "" {
 		return cliOptions{}, usage, errors.New("--assume-filename is required when --stdin uses cross-file analysis")
@@ -141,7 +326,8 @@ func parseArgs(args []string) (cliOptions, string, error) {
 func cliUsage(fs *flag.FlagSet) string {
 	var b strings.Builder
 	b.WriteString("Usage:\n")
-	b.WriteString("  thriftlint [flags] path/to/file.thrift\n")
+	b.WriteString("  thriftlint [flags] path/to/file.thrift [more.thrift ...]\n")
+	b.WriteString("  thriftlint [flags] ./... | path/to/dir [--changed-since REV]\n")
 	b.WriteString("  thriftlint --stdin [--assume-filename foo.thrift] [flags]\n\n")
 	b.WriteString("Flags:\n")
 	fs.VisitAll(func(f *flag.Flag) {
@@ -150,7 +336,7 @@ func cliUsage(fs *flag.FlagSet) string {
 	return b.String()
 }
 
-func readInput(stdin io.Reader, opts cliOptions) ([]byte, string, error) {
+func readInput(stdin io.Reader, opts cliOptions, i int) ([]byte, string, error) {
 	if opts.stdin {
 		src, err := io.ReadAll(stdin)
 		if err != nil {
@@ -162,20 +348,21 @@ func readInput(stdin io.Reader, opts cliOptions) ([]byte, string, error) {
 		}
 		return src, uri, nil
 	}
+	path := opts.paths[i]
 	//nolint:gosec // CLI intentionally reads user-provided file paths.
-	src, err := os.ReadFile(opts.path)
+	src, err := os.ReadFile(path)
 	if err != nil {
-		return nil, "", fmt.Errorf("read %s: %w", opts.path, err)
+		return nil, "", fmt.Errorf("read %s: %w", path, err)
 	}
-	return src, opts.path, nil
+	return src, path, nil
 }
 
-func collectDiagnostics(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+func collectDiagnostics(ctx context.Context, runner *lint.Runner, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
 	if tree == nil {
 		return nil, errors.New("nil syntax tree")
 	}
 	combined := slices.Clone(tree.Diagnostics)
-	lintDiags, err := defaultLintRunner.Run(ctx, tree)
+	lintDiags, err := runner.Run(ctx, tree)
 	if err != nil {
 		return nil, err
 	}
@@ -184,30 +371,12 @@ func collectDiagnostics(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagno
 	return combined, nil
 }
 
-func collectDiagnosticsWithWorkspace(ctx context.Context, tree *syntax.Tree, src []byte, uri string, opts cliOptions) ([]syntax.Diagnostic, error) {
-	combined, err := collectDiagnostics(ctx, tree)
-	if err != nil {
-		return nil, err
-	}
-	if opts.crossFile == crossFileOff {
-		return combined, nil
-	}
-
-	workspaceDiags, err := collectWorkspaceDiagnostics(ctx, src, uri, opts)
-	if err != nil {
-		return nil, err
-	}
-	combined = append(combined, workspaceDiags...)
-	lint.SortDiagnostics(combined)
-	return combined, nil
-}
-
-func collectWorkspaceDiagnostics(ctx context.Context, src []byte, uri string, opts cliOptions) ([]syntax.Diagnostic, error) {
+func collectWorkspaceDiagnostics(ctx context.Context, runner *lint.Runner, src []byte, uri string, opts cliOptions) ([]syntax.Diagnostic, error) {
 	view, err := workspaceViewForInput(ctx, src, uri, opts)
 	if err != nil || view == nil {
 		return nil, err
 	}
-	return defaultLintRunner.RunWithWorkspace(ctx, view)
+	return runner.RunWithWorkspace(ctx, view)
 }
 
 func workspaceViewForInput(ctx context.Context, src []byte, uri string, opts cliOptions) (*index.DocumentView, error) {
@@ -257,18 +426,6 @@ func isSupportedOutputFormat(v string) bool {
 	}
 }
 
-func writeDiagnosticsOutput(format string, stdout, stderr io.Writer, tree *syntax.Tree, diags []syntax.Diagnostic) error {
-	switch format {
-	case outputFormatText:
-		cliutil.WriteDiagnostics(stderr, "thriftlint", tree, diags, cliutil.DefaultDiagnosticMessage)
-		return nil
-	case outputFormatJSON:
-		return writeJSONDiagnostics(stdout, tree, diags)
-	default:
-		return fmt.Errorf("unsupported --format %q", format)
-	}
-}
-
 func workspaceRootsForInput(opts cliOptions, uri string) ([]string, error) {
 	roots := slices.Clone(opts.workspaceRoots)
 	if len(roots) > 0 {
@@ -327,25 +484,7 @@ func defaultCrossFileMode(stdin bool) string {
 	return crossFileTransitive
 }
 
-type multiStringFlag []string
-
-func (f *multiStringFlag) String() string {
-	if f == nil {
-		return ""
-	}
-	return strings.Join(*f, ",")
-}
-
-func (f *multiStringFlag) Set(v string) error {
-	v = strings.TrimSpace(v)
-	if v == "" {
-		return errors.New("value must not be empty")
-	}
-	*f = append(*f, v)
-	return nil
-}
-
-func writeJSONDiagnostics(w io.Writer, tree *syntax.Tree, diags []syntax.Diagnostic) error {
+func jsonDiagnostics(tree *syntax.Tree, diags []syntax.Diagnostic) ([]diagnosticJSON, error) {
 	li := cliutil.LineIndexOrBuild(tree)
 	uri := ""
 	if tree != nil {
@@ -355,7 +494,7 @@ func writeJSONDiagnostics(w io.Writer, tree *syntax.Tree, diags []syntax.Diagnos
 	for _, d := range diags {
 		start, end, err := cliutil.DiagnosticPoints(li, d.Span)
 		if err != nil {
-			return err
+			return nil, err
 		}
 		payload = append(payload, diagnosticJSON{
 			URI:       uri,
@@ -369,13 +508,23 @@ func writeJSONDiagnostics(w io.Writer, tree *syntax.Tree, diags []syntax.Diagnos
 			EndCol:    end.Column + 1,
 		})
 	}
+	return payload, nil
+}
 
+func writeJSONPayload(w io.Writer, payload []diagnosticJSON) error {
 	enc := json.NewEncoder(w)
 	enc.SetEscapeHTML(false)
 	enc.SetIndent("", "  ")
 	return enc.Encode(payload)
 }
 
+func writeRuleTimings(w io.Writer, timings []lint.RuleTiming) {
+	writef(w, "thriftlint: rule timings\n")
+	for _, rt := range timings {
+		writef(w, "  %-28s %12s %6d runs\n", rt.Rule, rt.Duration, rt.Runs)
+	}
+}
+
 func writef(w io.Writer, format string, args ...any) {
 	//nolint:gosec // Terminal/debug output helper; format strings are internal callsite constants.
 	_, _ = io.WriteString(w, fmt.Sprintf(format, args...))
@@ -4,8 +4,11 @@ import (
 	"bytes"
 	"context"
 	"encoding/json"
+	"fmt"
 	"os"
+	"os/exec"
 	"path/filepath"
+	"slices"
 	"strings"
 	"testing"
 
@@ -65,6 +68,45 @@ func TestRunIssuesExitAndTextDiagnostics(t *testing.T) {
 	}
 }
 
+func TestRunCachesLocalDiagnostics(t *testing.T) {
+	t.Parallel()
+
+	cacheDir := t.TempDir()
+	src := "struct S {\n  string name xsd_optional,\n}\n"
+	lintStdin := func(extra ...string) (int, string) {
+		t.Helper()
+		var out, errb bytes.Buffer
+		args := append([]string{"--stdin", "--cache-dir", cacheDir}, extra...)
+		code := run(context.Background(), strings.NewReader(src), &out, &errb, args)
+		return code, errb.String()
+	}
+
+	cold, coldStderr := lintStdin()
+	if cold != exitIssues {
+		t.Fatalf("cold exit code = %d, want %d", cold, exitIssues)
+	}
+	if warm, warmStderr := lintStdin(); warm != exitIssues || warmStderr != coldStderr {
+		t.Fatalf("warm run = %d %q, want %d %q", warm, warmStderr, exitIssues, coldStderr)
+	}
+
+	// An emptied entry proves warm runs are answered from the cache.
+	err := filepath.WalkDir(cacheDir, func(path string, d os.DirEntry, err error) error {
+		if err != nil || d.IsDir() || !strings.HasSuffix(path, "-r") {
+			return err
+		}
+		return os.WriteFile(path, []byte("[]"), 0o600)
+	})
+	if err != nil {
+		t.Fatalf("overwrite cache entries: %v", err)
+	}
+	if code, _ := lintStdin(); code != exitOK {
+		t.Fatalf("poisoned cache exit code = %d, want %d", code, exitOK)
+	}
+	if code, _ := lintStdin("--no-cache"); code != exitIssues {
+		t.Fatalf("--no-cache exit code = %d, want %d", code, exitIssues)
+	}
+}
+
 func TestRunJSONDiagnostics(t *testing.T) {
 	t.Parallel()
 
@@ -135,3 +177,279 @@ func TestRunCrossFileWorkspaceRequiresRootForStdin(t *testing.T) {
 		t.Fatalf("stderr missing workspace-root validation: %q", errb.String())
 	}
 }
+
+func TestRunLintsMultipleFilesInInputOrder(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	paths := make([]string, 0, 6)
+	for i := range 6 {
+		path := filepath.Join(dir, fmt.Sprintf("f%d.thrift", i))
+		src := "struct S {\n  1: string name,\n}\n"
+		if i%2 == 1 {
+			src = "struct S {\n  string name,\n}\n"
+		}
+		if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile: %v", err)
+		}
+		paths = append(paths, path)
+	}
+
+	var out, errb bytes.Buffer
+	args := append([]string{"--format", "json", "--cross-file", "off", "--jobs", "3"}, paths...)
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, args)
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	var uris []string
+	for _, d := range payload {
+		uris = append(uris, d.URI)
+	}
+	want := []string{paths[1], paths[3], paths[5]}
+	if !slices.Equal(uris, want) {
+		t.Fatalf("diagnostic URIs = %v, want %v", uris, want)
+	}
+}
+
+func TestRunBatchReportsUnreadableFileAndKeepsGoing(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	path := filepath.Join(dir, "bad.thrift")
+	if err := os.WriteFile(path, []byte("struct S {\n  string name,\n}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	missing := filepath.Join(dir, "missing.thrift")
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--cross-file", "off", "--rule-timings", missing, path})
+	if code != exitInternal {
+		t.Fatalf("exit code = %d, want %d", code, exitInternal)
+	}
+	stderr := errb.String()
+	for _, want := range []string{"read " + missing, "LINT_FIELD_ID_REQUIRED", "rule timings", "field_id_required"} {
+		if !strings.Contains(stderr, want) {
+			t.Fatalf("stderr missing %q: %q", want, stderr)
+		}
+	}
+}
+
+func TestRunProjectLintsDirectoryAgainstSharedIndex(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	writeProjectFiles(t, root, map[string]string{
+		"shared.thrift":    "struct User {\n  1: string name,\n}\n",
+		"main.thrift":      "include \"shared.thrift\"\n\nstruct Holder {\n  1: shared.User user,\n  2: shared.Missing other,\n}\n",
+		"sub/other.thrift": "struct Other {\n  string name,\n}\n",
+		"sub/clean.thrift": "struct Clean {\n  1: string name,\n}\n",
+	})
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--format", "json", filepath.Join(root, "...")})
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	var got []string
+	for _, d := range payload {
+		got = append(got, filepath.Base(d.URI)+":"+d.Code)
+	}
+	want := []string{
+		"main.thrift:" + string(lint.DiagnosticQualifiedReferenceUnknown),
+		"other.thrift:" + string(lint.DiagnosticFieldIDRequired),
+	}
+	if !slices.Equal(got, want) {
+		t.Fatalf("diagnostics = %v, want %v", got, want)
+	}
+}
+
+func TestRunProjectChangedSinceLintsChangedFilesAndDependents(t *testing.T) {
+	t.Parallel()
+
+	if _, err := exec.LookPath("git"); err != nil {
+		t.Skip("git not available")
+	}
+	root := t.TempDir()
+	writeProjectFiles(t, root, map[string]string{
+		"shared.thrift":    "struct User {\n  string name,\n}\n",
+		"main.thrift":      "include \"shared.thrift\"\n\nstruct Holder {\n  shared.User user,\n}\n",
+		"sub/other.thrift": "struct Other {\n  string name,\n}\n",
+	})
+	commitAll(t, root)
+	writeProjectFiles(t, root, map[string]string{"shared.thrift": "struct User {\n  string title,\n}\n"})
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--format", "json", "--changed-since", "HEAD", root})
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	files := map[string]bool{}
+	for _, d := range payload {
+		files[filepath.Base(d.URI)] = true
+	}
+	if !files["shared.thrift"] || !files["main.thrift"] || files["other.thrift"] {
+		t.Fatalf("linted files = %v, want shared.thrift and main.thrift only", files)
+	}
+}
+
+func TestRunProjectChangedSinceAsksEveryRepository(t *testing.T) {
+	t.Parallel()
+
+	if _, err := exec.LookPath("git"); err != nil {
+		t.Skip("git not available")
+	}
+	base := t.TempDir()
+	first, second := filepath.Join(base, "first"), filepath.Join(base, "second")
+	for _, root := range []string{first, second} {
+		writeProjectFiles(t, root, map[string]string{"a.thrift": "struct A {\n  1: string name,\n}\n"})
+		commitAll(t, root)
+	}
+	writeProjectFiles(t, second, map[string]string{"a.thrift": "struct A {\n  string name,\n}\n"})
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--format", "json", "--changed-since", "HEAD", first, second})
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	if len(payload) != 1 || !strings.Contains(payload[0].URI, "/second/") || payload[0].Code != string(lint.DiagnosticFieldIDRequired) {
+		t.Fatalf("diagnostics = %+v, want one %s in the second repository", payload, lint.DiagnosticFieldIDRequired)
+	}
+}
+
+func TestRunProjectChangedSinceLintsIncludersOfDeletedFiles(t *testing.T) {
+	t.Parallel()
+
+	if _, err := exec.LookPath("git"); err != nil {
+		t.Skip("git not available")
+	}
+	root := t.TempDir()
+	writeProjectFiles(t, root, map[string]string{
+		"types/shared.thrift": "struct User {\n  1: string name,\n}\n",
+		"main.thrift":         "include \"types/shared.thrift\"\n\nstruct Holder {\n  1: shared.User user,\n}\n",
+		"other.thrift":        "struct Other {\n  1: string name,\n}\n",
+	})
+	commitAll(t, root)
+	if err := os.Remove(filepath.Join(root, "types", "shared.thrift")); err != nil {
+		t.Fatalf("Remove: %v", err)
+	}
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{"--format", "json", "--changed-since", "HEAD", root})
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	files := map[string]bool{}
+	for _, d := range payload {
+		files[filepath.Base(d.URI)] = true
+	}
+	if !files["main.thrift"] || files["other.thrift"] {
+		t.Fatalf("linted files = %v, want main.thrift only", files)
+	}
+}
+
+// commitAll commits every file under root into a new git repository.
+func commitAll(t *testing.T, root string) {
+	t.Helper()
+	for _, args := range [][]string{{"init", "-q"}, {"add", "."}, {"commit", "-q", "-m", "initial"}} {
+		cmd := exec.Command("git", append([]string{"-c", "user.name=t", "-c", "user.email=t@example.com"}, args...)...)
+		cmd.Dir = root
+		if out, err := cmd.CombinedOutput(); err != nil {
+			t.Fatalf("git %v: %v\n%s", args, err, out)
+		}
+	}
+}
+
+func TestRunProjectLintsExplicitFilesMissingFromIndex(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	bad := "struct S {\n  string name,\n}\n"
+	writeProjectFiles(t, root, map[string]string{
+		".gitignore":     "ignored.thrift\n",
+		"clean.thrift":   "struct Clean {\n  1: string name,\n}\n",
+		"ignored.thrift": bad,
+		"legacy.idl":     bad,
+	})
+	paths := []string{
+		filepath.Join(root, "clean.thrift"),
+		filepath.Join(root, "ignored.thrift"),
+		filepath.Join(root, "legacy.idl"),
+	}
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, append([]string{"--format", "json"}, paths...))
+	if code != exitIssues {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitIssues, errb.String())
+	}
+	var payload []diagnosticJSON
+	if err := json.Unmarshal(out.Bytes(), &payload); err != nil {
+		t.Fatalf("json.Unmarshal: %v; payload=%q", err, out.String())
+	}
+	var got []string
+	for _, d := range payload {
+		got = append(got, filepath.Base(d.URI)+":"+d.Code)
+	}
+	want := []string{
+		"ignored.thrift:" + string(lint.DiagnosticFieldIDRequired),
+		"legacy.idl:" + string(lint.DiagnosticFieldIDRequired),
+	}
+	if !slices.Equal(got, want) {
+		t.Fatalf("diagnostics = %v, want %v", got, want)
+	}
+}
+
+func TestRunProjectReportsMissingFileAndKeepsGoing(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	writeProjectFiles(t, root, map[string]string{
+		"bad.thrift":   "struct S {\n  string name,\n}\n",
+		"clean.thrift": "struct Clean {\n  1: string name,\n}\n",
+	})
+	missing := filepath.Join(root, "missing.thrift")
+
+	var out, errb bytes.Buffer
+	code := run(context.Background(), strings.NewReader(""), &out, &errb, []string{missing, filepath.Join(root, "bad.thrift"), filepath.Join(root, "clean.thrift")})
+	if code != exitInternal {
+		t.Fatalf("exit code = %d, want %d; stderr=%q", code, exitInternal, errb.String())
+	}
+	stderr := errb.String()
+	for _, want := range []string{missing, "LINT_FIELD_ID_REQUIRED"} {
+		if !strings.Contains(stderr, want) {
+			t.Fatalf("stderr missing %q: %q", want, stderr)
+		}
+	}
+}
+
+func writeProjectFiles(t *testing.T, root string, files map[string]string) {
+	t.Helper()
+	for name, src := range files {
+		path := filepath.Join(root, filepath.FromSlash(name))
+		if err := os.MkdirAll(filepath.Dir(path), 0o700); err != nil {
+			t.Fatalf("MkdirAll: %v", err)
+		}
+		if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile: %v", err)
+		}
+	}
+}
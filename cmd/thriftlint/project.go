@@ -0,0 +1,564 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"io"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"slices"
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/index"
+	"github.com/kpumuk/thrift-weaver/internal/lint"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// recursiveSuffix marks a Go-style recursive path argument such as "./...".
+const recursiveSuffix = "..."
+
+// projectInput is one positional argument of a project run. err reports an
+// argument that does not name a readable file or directory.
+type projectInput struct {
+	arg  string
+	path string // canonical absolute path
+	dir  bool
+	err  error
+}
+
+// projectTarget is one file a project run lints: an indexed document, or an
+// explicit file argument the index does not hold (ignored, not a .thrift
+// file, or too large), which is linted on its own like outside a project
+// run. err reports an input that failed.
+type projectTarget struct {
+	doc  *index.DocumentSummary
+	arg  string
+	path string
+	err  error
+}
+
+// localLint is the local lint outcome of one document, computed on the index
+// parse worker that parsed it. Source is kept only when there are diagnostics.
+type localLint struct {
+	diags     []syntax.Diagnostic
+	src       []byte
+	lineIndex *text.LineIndex
+	err       error
+}
+
+// isProjectRun reports whether opts lint a set of files against one shared
+// workspace index instead of one input at a time.
+func isProjectRun(opts cliOptions) bool {
+	if opts.stdin {
+		return false
+	}
+	for _, path := range opts.paths {
+		if isRecursivePattern(path) || isDir(path) {
+			return true
+		}
+	}
+	return len(opts.paths) > 1 && opts.crossFile != crossFileOff
+}
+
+// runProject lints directories and files with one index.Manager over all
+// roots. Every file is parsed once, by the index parse workers, which also run
+// the local rules; workspace rules then run in parallel against the shared
+// snapshot. Results stream in input order, directories expanded by path.
+func runProject(ctx context.Context, stdout, stderr io.Writer, runner *lint.Runner, c *cache.Cache, opts cliOptions) int {
+	inputs := projectInputs(opts.paths)
+	roots := slices.Clone(opts.workspaceRoots)
+	usable := false
+	for _, in := range inputs {
+		switch {
+		case in.err != nil:
+			continue
+		case len(opts.workspaceRoots) > 0:
+		case in.dir:
+			roots = append(roots, in.path)
+		default:
+			roots = append(roots, filepath.Dir(in.path))
+		}
+		usable = true
+	}
+	if !usable {
+		// Every input reports its own error; there is nothing to index.
+		roots = nil
+	}
+
+	var (
+		changed []string
+		err     error
+	)
+	if opts.changedSince != "" && len(roots) > 0 {
+		if changed, err = gitChangedFiles(ctx, roots, opts.changedSince); err != nil {
+			writef(stderr, "thriftlint: --changed-since: %v\n", err)
+			return exitInternal
+		}
+	}
+
+	var (
+		localMu sync.Mutex
+		local   = make(map[index.DocumentKey]*localLint)
+	)
+	onTree := func(key index.DocumentKey, uri string, tree *syntax.Tree) {
+		// With --changed-since the target set is known only after indexing,
+		// so the few selected files are parsed again then.
+		if opts.changedSince != "" || !matchesInputs(inputs, uri) {
+			return
+		}
+		res, cacheKey, ok := cachedLocalLint(c, tree.Source)
+		if !ok {
+			res = lintTree(ctx, runner, c, cacheKey, tree)
+		}
+		localMu.Lock()
+		local[key] = res
+		localMu.Unlock()
+	}
+
+	var snapshot *index.WorkspaceSnapshot
+	if len(roots) > 0 {
+		manager := index.NewManager(index.Options{
+			WorkspaceRoots: roots,
+			IncludeDirs:    opts.includeDirs,
+			ParseWorkers:   runner.Pool().Workers(),
+			OnParsedTree:   onTree,
+		})
+		defer manager.Close()
+		if err := manager.RescanWorkspace(ctx); err != nil {
+			writef(stderr, "thriftlint: index workspace: %v\n", err)
+			return exitInternal
+		}
+		var ok bool
+		if snapshot, ok = manager.Snapshot(); !ok {
+			writef(stderr, "thriftlint: workspace index is empty\n")
+			return exitInternal
+		}
+	}
+
+	targets := projectTargets(snapshot, inputs)
+	if opts.changedSince != "" {
+		targets = changedTargets(snapshot, targets, changed)
+	}
+
+	results := make([]lintResult, len(targets))
+	ready := make([]chan struct{}, len(targets))
+	for i := range ready {
+		ready[i] = make(chan struct{})
+	}
+	go func() {
+		_ = runner.Pool().Run(ctx, len(targets), func(ctx context.Context, i int) error {
+			defer close(ready[i])
+			target := targets[i]
+			switch {
+			case target.err != nil:
+				results[i].err = target.err
+			case target.doc == nil:
+				lintFile(ctx, runner, c, opts, target.arg, target.arg+": ", &results[i])
+			default:
+				localMu.Lock()
+				res := local[target.doc.Key]
+				localMu.Unlock()
+				lintTarget(ctx, runner, c, snapshot, target.doc, res, opts, &results[i])
+			}
+			return nil
+		})
+		// Tasks skipped after cancellation report it.
+		for i := range ready {
+			select {
+			case <-ready[i]:
+			default:
+				results[i].err = ctx.Err()
+				close(ready[i])
+			}
+		}
+	}()
+
+	code := exitOK
+	var payload []diagnosticJSON
+	for i := range results {
+		<-ready[i]
+		r := &results[i]
+		switch {
+		case r.err != nil:
+			writef(stderr, "thriftlint: %v\n", r.err)
+			code = exitInternal
+			continue
+		case r.issues && code == exitOK:
+			code = exitIssues
+		}
+		_, _ = stderr.Write(r.text.Bytes())
+		r.text = bytes.Buffer{}
+		payload = append(payload, r.json...)
+	}
+	if len(payload) > 0 {
+		if err := writeJSONPayload(stdout, payload); err != nil {
+			writef(stderr, "thriftlint: %v\n", err)
+			return exitInternal
+		}
+	}
+	return code
+}
+
+// lintTree runs parser diagnostics and local rules over a parsed tree and
+// stores them in c under key.
+func lintTree(ctx context.Context, runner *lint.Runner, c *cache.Cache, key cache.Key, tree *syntax.Tree) *localLint {
+	diags, err := collectDiagnostics(ctx, runner, tree)
+	if err != nil {
+		return &localLint{err: fmt.Errorf("%s: lint failed: %w", tree.URI, err)}
+	}
+	storeLocalLint(c, key, diags)
+	res := &localLint{diags: diags}
+	if len(diags) > 0 {
+		res.src = tree.Source
+		res.lineIndex = tree.LineIndex
+	}
+	return res
+}
+
+// lintTarget completes the lint of one indexed document and renders it.
+func lintTarget(ctx context.Context, runner *lint.Runner, c *cache.Cache, snapshot *index.WorkspaceSnapshot, doc *index.DocumentSummary, local *localLint, opts cliOptions, res *lintResult) {
+	path, err := filePathFromURI(doc.URI)
+	if err != nil {
+		res.err = err
+		return
+	}
+	if local == nil {
+		//nolint:gosec // CLI intentionally reads files under user-provided paths.
+		src, err := os.ReadFile(path)
+		if err != nil {
+			res.err = fmt.Errorf("read %s: %w", path, err)
+			return
+		}
+		cached, key, ok := cachedLocalLint(c, src)
+		if ok {
+			local = cached
+		} else {
+			tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: doc.URI})
+			if err != nil {
+				res.err = fmt.Errorf("%s: parse failed: %w", path, err)
+				return
+			}
+			local = lintTree(ctx, runner, c, key, tree)
+			tree.Close()
+		}
+	}
+	if local.err != nil {
+		res.err = local.err
+		return
+	}
+
+	diags := slices.Clone(local.diags)
+	if opts.crossFile != crossFileOff {
+		view, ok, err := index.ViewForDocument(snapshot, doc.URI)
+		if err != nil {
+			res.err = fmt.Errorf("%s: %w", path, err)
+			return
+		}
+		if ok {
+			workspaceDiags, err := runner.RunWithWorkspace(ctx, view)
+			if err != nil {
+				res.err = fmt.Errorf("%s: lint failed: %w", path, err)
+				return
+			}
+			diags = append(diags, workspaceDiags...)
+			lint.SortDiagnostics(diags)
+		}
+	}
+	if len(diags) == 0 {
+		return
+	}
+
+	src, li := local.src, local.lineIndex
+	if src == nil {
+		//nolint:gosec // CLI intentionally reads files under user-provided paths.
+		if src, err = os.ReadFile(path); err != nil {
+			res.err = fmt.Errorf("read %s: %w", path, err)
+			return
+		}
+	}
+	// Diagnostics render from the URI, source and line index of a tree only.
+	tree := &syntax.Tree{URI: displayPath(path), Source: src, LineIndex: li}
+	res.issues = true
+	switch opts.format {
+	case outputFormatText:
+		cliutil.WriteDiagnostics(&res.text, "thriftlint", tree, diags, cliutil.DefaultDiagnosticMessage)
+	case outputFormatJSON:
+		res.json, res.err = jsonDiagnostics(tree, diags)
+	default:
+		res.err = fmt.Errorf("unsupported --format %q", opts.format)
+	}
+}
+
+func projectInputs(paths []string) []projectInput {
+	out := make([]projectInput, 0, len(paths))
+	for _, arg := range paths {
+		in, err := projectInputFor(arg)
+		if err != nil {
+			in = projectInput{err: err}
+		}
+		in.arg = arg
+		out = append(out, in)
+	}
+	return out
+}
+
+func projectInputFor(raw string) (projectInput, error) {
+	recursive := isRecursivePattern(raw)
+	if recursive {
+		raw = strings.TrimSuffix(raw, recursiveSuffix)
+		if raw == "" {
+			raw = "."
+		}
+	}
+	st, err := os.Stat(raw)
+	if err != nil {
+		return projectInput{}, err
+	}
+	if recursive && !st.IsDir() {
+		return projectInput{}, fmt.Errorf("%s%s: not a directory", raw, recursiveSuffix)
+	}
+	abs, err := filepath.Abs(raw)
+	if err != nil {
+		return projectInput{}, err
+	}
+	path, err := filePathFromURI(abs)
+	if err != nil {
+		return projectInput{}, err
+	}
+	return projectInput{path: path, dir: st.IsDir()}, nil
+}
+
+// projectTargets lists the files selected by inputs, in input order with
+// each directory expanded to its indexed documents in path order.
+func projectTargets(snapshot *index.WorkspaceSnapshot, inputs []projectInput) []projectTarget {
+	var documents map[index.DocumentKey]*index.DocumentSummary
+	if snapshot != nil {
+		documents = snapshot.Documents
+	}
+	byPath := make(map[string]*index.DocumentSummary, len(documents))
+	paths := make([]string, 0, len(documents))
+	for _, doc := range documents {
+		path, err := filePathFromURI(doc.URI)
+		if err != nil {
+			continue
+		}
+		byPath[path] = doc
+		paths = append(paths, path)
+	}
+	slices.Sort(paths)
+
+	seen := make(map[string]struct{})
+	var out []projectTarget
+	add := func(t projectTarget) {
+		if _, ok := seen[t.path]; ok {
+			return
+		}
+		seen[t.path] = struct{}{}
+		out = append(out, t)
+	}
+	for _, in := range inputs {
+		switch {
+		case in.err != nil:
+			out = append(out, projectTarget{arg: in.arg, err: in.err})
+		case !in.dir:
+			add(projectTarget{doc: byPath[in.path], arg: in.arg, path: in.path})
+		default:
+			for _, path := range paths {
+				if pathWithin(path, in.path) {
+					add(projectTarget{doc: byPath[path], path: path})
+				}
+			}
+		}
+	}
+	return out
+}
+
+// changedTargets keeps the targets that changed or include a changed file,
+// directly or transitively, and failed inputs. A changed path the index does
+// not hold, such as a file deleted since the revision, marks the documents
+// whose unresolved includes may name it.
+func changedTargets(snapshot *index.WorkspaceSnapshot, targets []projectTarget, changed []string) []projectTarget {
+	changedPaths := make(map[string]struct{}, len(changed))
+	for _, path := range changed {
+		changedPaths[path] = struct{}{}
+	}
+	var impacted map[index.DocumentKey]struct{}
+	if snapshot != nil {
+		var keys []index.DocumentKey
+		indexed := make(map[string]struct{}, len(changed))
+		docPaths := make(map[index.DocumentKey]string, len(snapshot.Documents))
+		for key, doc := range snapshot.Documents {
+			path, err := filePathFromURI(doc.URI)
+			if err != nil {
+				continue
+			}
+			docPaths[key] = path
+			if _, ok := changedPaths[path]; ok {
+				keys = append(keys, key)
+				indexed[path] = struct{}{}
+			}
+		}
+		var gone []string
+		for _, path := range changed {
+			if _, ok := indexed[path]; !ok {
+				gone = append(gone, path)
+			}
+		}
+		if len(gone) > 0 {
+			for key, path := range docPaths {
+				if includesAnyMissing(snapshot.Documents[key], path, gone) {
+					keys = append(keys, key)
+				}
+			}
+		}
+		impacted = snapshot.Dependents(keys)
+	}
+	return slices.DeleteFunc(targets, func(t projectTarget) bool {
+		if t.err != nil {
+			return false
+		}
+		if t.doc == nil {
+			_, ok := changedPaths[t.path]
+			return !ok
+		}
+		_, ok := impacted[t.doc.Key]
+		return !ok
+	})
+}
+
+// includesAnyMissing reports whether doc, stored at path, has an unresolved
+// include that may name one of paths. The include search directories are
+// not recorded for a missing include, so besides the path next to doc any
+// path ending in the include target matches.
+func includesAnyMissing(doc *index.DocumentSummary, path string, paths []string) bool {
+	for _, inc := range doc.Includes {
+		if inc.Status != index.IncludeStatusMissing {
+			continue
+		}
+		target := strings.TrimSpace(inc.RawPath)
+		if unquoted, err := strconv.Unquote(target); err == nil {
+			target = unquoted
+		} else {
+			target = strings.Trim(target, `"'`)
+		}
+		if target == "" {
+			continue
+		}
+		target = filepath.Clean(filepath.FromSlash(target))
+		sibling := filepath.Join(filepath.Dir(path), target)
+		suffix := string(filepath.Separator) + target
+		for _, p := range paths {
+			if p == sibling || strings.HasSuffix(p, suffix) {
+				return true
+			}
+		}
+	}
+	return false
+}
+
+// gitChangedFiles lists files of the repositories containing dirs that were
+// modified since rev, including uncommitted, untracked and deleted ones, as
+// canonical absolute paths. Each repository is asked once.
+func gitChangedFiles(ctx context.Context, dirs []string, rev string) ([]string, error) {
+	var tops []string
+	for _, dir := range dirs {
+		top, err := gitOutput(ctx, dir, "rev-parse", "--show-toplevel")
+		if err != nil {
+			return nil, err
+		}
+		if top = strings.TrimSpace(top); !slices.Contains(tops, top) {
+			tops = append(tops, top)
+		}
+	}
+	var out []string
+	seen := make(map[string]struct{})
+	for _, top := range tops {
+		diff, err := gitOutput(ctx, top, "diff", "--name-only", "-z", rev, "--")
+		if err != nil {
+			return nil, err
+		}
+		untracked, err := gitOutput(ctx, top, "ls-files", "--others", "--exclude-standard", "-z")
+		if err != nil {
+			return nil, err
+		}
+		for _, name := range strings.Split(diff+untracked, "\x00") {
+			if name == "" {
+				continue
+			}
+			path, err := filePathFromURI(filepath.Join(top, filepath.FromSlash(name)))
+			if err != nil {
+				continue
+			}
+			if _, ok := seen[path]; !ok {
+				seen[path] = struct{}{}
+				out = append(out, path)
+			}
+		}
+	}
+	return out, nil
+}
+
+func gitOutput(ctx context.Context, dir string, args ...string) (string, error) {
+	var stdout, stderr bytes.Buffer
+	cmd := exec.CommandContext(ctx, "git", args...)
+	cmd.Dir = dir
+	cmd.Stdout, cmd.Stderr = &stdout, &stderr
+	if err := cmd.Run(); err != nil {
+		msg := strings.TrimSpace(stderr.String())
+		if msg == "" {
+			return "", fmt.Errorf("git %s: %w", args[0], err)
+		}
+		return "", fmt.Errorf("git %s: %s", args[0], msg)
+	}
+	return stdout.String(), nil
+}
+
+func matchesInputs(inputs []projectInput, uri string) bool {
+	path, err := filePathFromURI(uri)
+	if err != nil {
+		return false
+	}
+	for _, in := range inputs {
+		if in.err == nil && (path == in.path || (in.dir && pathWithin(path, in.path))) {
+			return true
+		}
+	}
+	return false
+}
+
+// displayPath shortens path relative to the working directory when it lies
+// below it.
+func displayPath(path string) string {
+	wd, err := os.Getwd()
+	if err != nil {
+		return path
+	}
+	if rel, err := filepath.Rel(wd, path); err == nil && pathWithin(path, wd) {
+		return rel
+	}
+	return path
+}
+
+func pathWithin(path, root string) bool {
+	rel, err := filepath.Rel(root, path)
+	if err != nil {
+		return false
+	}
+	return rel != ".." && !strings.HasPrefix(rel, ".."+string(filepath.Separator))
+}
+
+func isRecursivePattern(path string) bool {
+	return path == recursiveSuffix || strings.HasSuffix(path, string(filepath.Separator)+recursiveSuffix) || strings.HasSuffix(path, "/"+recursiveSuffix)
+}
+
+func isDir(path string) bool {
+	st, err := os.Stat(path)
+	return err == nil && st.IsDir()
+}
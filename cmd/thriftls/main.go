@@ -8,7 +8,11 @@ import (
 	"fmt"
 	"io"
 	"os"
+	"os/signal"
+	"syscall"
 
+	cliutil "github.com/kpumuk/thrift-weaver/internal/cli"
+	"github.com/kpumuk/thrift-weaver/internal/daemon"
 	"github.com/kpumuk/thrift-weaver/internal/lsp"
 )
 
@@ -21,7 +25,11 @@ func main() {
 
 type config struct {
 	workspaceIndexWorkers int
+	watchFiles            bool
 	stdio                 bool
+	daemon                bool
+	workspaceRoot         string
+	includeDirs           []string
 }
 
 func run(ctx context.Context, args []string, stdin io.Reader, stdout io.Writer, stderr io.Writer) error {
@@ -29,11 +37,38 @@ func run(ctx context.Context, args []string, stdin io.Reader, stdout io.Writer,
 	if err != nil {
 		return err
 	}
+	if cfg.daemon {
+		return runDaemon(ctx, cfg, stderr)
+	}
 	return lsp.NewServerWithOptions(lsp.Options{
 		WorkspaceIndexWorkers: cfg.workspaceIndexWorkers,
+		WatchWorkspaceFiles:   cfg.watchFiles,
 	}).Run(ctx, stdin, stdout)
 }
 
+// runDaemon serves format and lint requests from thriftfmt and thriftlint on
+// the socket for cfg.workspaceRoot until interrupted.
+func runDaemon(ctx context.Context, cfg config, stderr io.Writer) error {
+	ctx, stop := signal.NotifyContext(ctx, os.Interrupt, syscall.SIGTERM)
+	defer stop()
+
+	srv, err := daemon.NewServer(daemon.ServerOptions{
+		Root:        cfg.workspaceRoot,
+		IncludeDirs: cfg.includeDirs,
+		Workers:     cfg.workspaceIndexWorkers,
+	})
+	if err != nil {
+		return err
+	}
+	defer srv.Close()
+	ln, err := srv.Listen()
+	if err != nil {
+		return err
+	}
+	_, _ = fmt.Fprintf(stderr, "thriftls: serving %s on %s\n", srv.Root(), ln.Addr())
+	return srv.Serve(ctx, ln)
+}
+
 func parseConfig(args []string, stderr io.Writer) (config, error) {
 	cfg := config{}
 	fs := flag.NewFlagSet("thriftls", flag.ContinueOnError)
@@ -44,12 +79,26 @@ func parseConfig(args []string, stderr io.Writer) (config, error) {
 		0,
 		"number of parallel workspace index parse workers (0 = auto)",
 	)
+	fs.BoolVar(
+		&cfg.watchFiles,
+		"watch-files",
+		false,
+		"watch workspace files natively (Linux inotify) instead of relying only on client notifications",
+	)
 	fs.BoolVar(
 		&cfg.stdio,
 		"stdio",
 		false,
 		"serve LSP over stdio (accepted for client compatibility; stdio is always used)",
 	)
+	fs.BoolVar(
+		&cfg.daemon,
+		"daemon",
+		false,
+		"serve thriftfmt and thriftlint over a Unix domain socket instead of LSP over stdio",
+	)
+	fs.StringVar(&cfg.workspaceRoot, "workspace-root", ".", "workspace root served in --daemon mode")
+	fs.Var((*cliutil.MultiStringFlag)(&cfg.includeDirs), "include-dir", "include directory used in --daemon mode (repeatable)")
 	if err := fs.Parse(args); err != nil {
 		return config{}, err
 	}
@@ -2,6 +2,7 @@ package main
 
 import (
 	"bytes"
+	"slices"
 	"testing"
 )
 
@@ -18,6 +19,19 @@ func TestParseConfigAcceptsWorkspaceIndexWorkers(t *testing.T) {
 	}
 }
 
+func TestParseConfigAcceptsWatchFiles(t *testing.T) {
+	t.Parallel()
+
+	var stderr bytes.Buffer
+	cfg, err := parseConfig([]string{"--watch-files"}, &stderr)
+	if err != nil {
+		t.Fatalf("parseConfig: %v", err)
+	}
+	if !cfg.watchFiles {
+		t.Fatal("watchFiles=false, want true")
+	}
+}
+
 func TestParseConfigAcceptsStdioCompatibilityFlag(t *testing.T) {
 	t.Parallel()
 
@@ -28,6 +42,27 @@ func TestParseConfigAcceptsStdioCompatibilityFlag(t *testing.T) {
 	}
 }
 
+func TestParseConfigAcceptsDaemonMode(t *testing.T) {
+	t.Parallel()
+
+	var stderr bytes.Buffer
+	cfg, err := parseConfig([]string{
+		"--daemon",
+		"--workspace-root", "idl",
+		"--include-dir", "vendor/a",
+		"--include-dir", "vendor/b",
+	}, &stderr)
+	if err != nil {
+		t.Fatalf("parseConfig: %v", err)
+	}
+	if !cfg.daemon || cfg.workspaceRoot != "idl" {
+		t.Fatalf("daemon=%v workspaceRoot=%q, want true and idl", cfg.daemon, cfg.workspaceRoot)
+	}
+	if want := []string{"vendor/a", "vendor/b"}; !slices.Equal(cfg.includeDirs, want) {
+		t.Fatalf("includeDirs=%v, want %v", cfg.includeDirs, want)
+	}
+}
+
 func TestParseConfigRejectsNegativeWorkspaceIndexWorkers(t *testing.T) {
 	t.Parallel()
 
@@ -0,0 +1,217 @@
+// Package cache stores per-file tool results on disk, keyed by content hash,
+// so repeated CLI runs over unchanged files skip parsing.
+package cache
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"errors"
+	"hash"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"runtime/debug"
+	"slices"
+	"strconv"
+	"strings"
+	"time"
+
+	thriftwasm "github.com/kpumuk/thrift-weaver/internal/grammars/thrift"
+)
+
+const (
+	// defaultMaxBytes bounds the total size of cache entries after a trim.
+	defaultMaxBytes = 64 << 20
+	// mtimeInterval is how stale an entry's modification time may get before
+	// a hit refreshes it; the modification time is the LRU clock.
+	mtimeInterval = time.Hour
+	// trimInterval is how often Close looks for entries to evict.
+	trimInterval = time.Hour
+	// trimMarker records the time of the last trim.
+	trimMarker = "trim.txt"
+)
+
+// Key identifies one cache entry.
+type Key [sha256.Size]byte
+
+// Cache is a directory of entries bounded by size with least-recently-used
+// eviction. Entries are keyed by content hash together with the tool build,
+// the embedded grammar checksum and the caller's configuration, so changing
+// any of them misses. Failures to read or write entries are treated as
+// misses. A nil *Cache never hits and stores nothing. Safe for concurrent use
+// and by several processes.
+type Cache struct {
+	dir      string
+	salt     []byte
+	maxBytes int64
+	now      func() time.Time
+}
+
+// Open opens or creates the cache in dir for one tool configuration.
+func Open(dir string, config ...string) (*Cache, error) {
+	if dir == "" {
+		return nil, errors.New("empty cache directory")
+	}
+	if err := os.MkdirAll(dir, 0o750); err != nil {
+		return nil, err
+	}
+	h := sha256.New()
+	for _, part := range append([]string{buildID(), thriftwasm.WASMChecksum()}, config...) {
+		_, _ = h.Write(strconv.AppendInt(nil, int64(len(part)), 10))
+		_, _ = h.Write([]byte{0})
+		_, _ = h.Write([]byte(part))
+	}
+	return &Cache{
+		dir:      dir,
+		salt:     h.Sum(nil),
+		maxBytes: defaultMaxBytes,
+		now:      time.Now,
+	}, nil
+}
+
+// Key returns the key of content under the cache configuration.
+func (c *Cache) Key(content []byte) Key {
+	h := c.NewHash()
+	_, _ = h.Write(content)
+	return SumKey(h)
+}
+
+// NewHash returns a hash that yields the key of the content written to it,
+// for content that is streamed rather than held in memory.
+func (c *Cache) NewHash() hash.Hash {
+	h := sha256.New()
+	if c != nil {
+		_, _ = h.Write(c.salt)
+	}
+	return h
+}
+
+// SumKey returns the key accumulated by a hash from NewHash.
+func SumKey(h hash.Hash) Key {
+	var k Key
+	h.Sum(k[:0])
+	return k
+}
+
+// Get returns the entry stored under k.
+func (c *Cache) Get(k Key) ([]byte, bool) {
+	if c == nil {
+		return nil, false
+	}
+	path := c.entryPath(k)
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return nil, false
+	}
+	if st, err := os.Stat(path); err == nil && c.now().Sub(st.ModTime()) > mtimeInterval {
+		now := c.now()
+		_ = os.Chtimes(path, now, now)
+	}
+	return data, true
+}
+
+// Put stores data under k. The entry is written to a temporary file and
+// renamed into place, so concurrent readers never see partial entries.
+func (c *Cache) Put(k Key, data []byte) {
+	if c == nil {
+		return
+	}
+	path := c.entryPath(k)
+	if err := os.MkdirAll(filepath.Dir(path), 0o750); err != nil {
+		return
+	}
+	tmp, err := os.CreateTemp(filepath.Dir(path), ".tmp-*")
+	if err != nil {
+		return
+	}
+	_, werr := tmp.Write(data)
+	cerr := tmp.Close()
+	if werr != nil || cerr != nil || os.Rename(tmp.Name(), path) != nil {
+		_ = os.Remove(tmp.Name())
+	}
+}
+
+// Close evicts least recently used entries beyond the size bound. To keep
+// warm runs cheap the directory is scanned at most once per trimInterval.
+func (c *Cache) Close() error {
+	if c == nil {
+		return nil
+	}
+	marker := filepath.Join(c.dir, trimMarker)
+	if st, err := os.Stat(marker); err == nil && c.now().Sub(st.ModTime()) < trimInterval {
+		return nil
+	}
+	if err := c.trim(); err != nil {
+		return err
+	}
+	return os.WriteFile(marker, []byte(strconv.FormatInt(c.now().Unix(), 10)), 0o600)
+}
+
+type cacheEntry struct {
+	path  string
+	size  int64
+	mtime time.Time
+}
+
+// trim removes the oldest entries until the rest fit in maxBytes.
+func (c *Cache) trim() error {
+	var entries []cacheEntry
+	err := filepath.WalkDir(c.dir, func(path string, d fs.DirEntry, err error) error {
+		if err != nil {
+			return err
+		}
+		if d.IsDir() || !strings.HasSuffix(path, "-r") {
+			return nil
+		}
+		info, err := d.Info()
+		if err != nil {
+			// Removed by a concurrent trim.
+			return nil
+		}
+		entries = append(entries, cacheEntry{path: path, size: info.Size(), mtime: info.ModTime()})
+		return nil
+	})
+	if err != nil {
+		return err
+	}
+	slices.SortFunc(entries, func(a, b cacheEntry) int {
+		return b.mtime.Compare(a.mtime)
+	})
+	var total int64
+	for _, e := range entries {
+		total += e.size
+		if total > c.maxBytes {
+			_ = os.Remove(e.path)
+		}
+	}
+	return nil
+}
+
+func (c *Cache) entryPath(k Key) string {
+	name := hex.EncodeToString(k[:])
+	return filepath.Join(c.dir, name[:2], name+"-r")
+}
+
+// buildID identifies the running tool build. Release builds carry their
+// module version; development builds fall back to the executable's size and
+// modification time, so rebuilding invalidates the cache.
+func buildID() string {
+	var id []string
+	if info, ok := debug.ReadBuildInfo(); ok {
+		id = append(id, info.Main.Path, info.Main.Version)
+		if info.Main.Version != "" && info.Main.Version != "(devel)" {
+			return strings.Join(id, "@")
+		}
+		for _, s := range info.Settings {
+			if s.Key == "vcs.revision" {
+				id = append(id, s.Value)
+			}
+		}
+	}
+	if exe, err := os.Executable(); err == nil {
+		if st, err := os.Stat(exe); err == nil {
+			id = append(id, exe, strconv.FormatInt(st.Size(), 10), strconv.FormatInt(st.ModTime().UnixNano(), 10))
+		}
+	}
+	return strings.Join(id, "@")
+}
@@ -0,0 +1,83 @@
+package cache
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+)
+
+func TestCacheRoundTripAndConfigMiss(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	c, err := Open(dir, "thriftfmt", "width=100")
+	if err != nil {
+		t.Fatalf("Open: %v", err)
+	}
+	key := c.Key([]byte("struct S {}\n"))
+	if _, ok := c.Get(key); ok {
+		t.Fatal("Get hit on an empty cache")
+	}
+	c.Put(key, []byte("f"))
+	if got, ok := c.Get(key); !ok || string(got) != "f" {
+		t.Fatalf("Get = %q, %v; want \"f\", true", got, ok)
+	}
+
+	h := c.NewHash()
+	_, _ = h.Write([]byte("struct S "))
+	_, _ = h.Write([]byte("{}\n"))
+	if SumKey(h) != key {
+		t.Fatal("streamed key differs from Key")
+	}
+
+	other, err := Open(dir, "thriftfmt", "width=80")
+	if err != nil {
+		t.Fatalf("Open: %v", err)
+	}
+	if _, ok := other.Get(other.Key([]byte("struct S {}\n"))); ok {
+		t.Fatal("Get hit under a different configuration")
+	}
+
+	var disabled *Cache
+	disabled.Put(key, []byte("f"))
+	if _, ok := disabled.Get(key); ok {
+		t.Fatal("nil cache hit")
+	}
+}
+
+func TestCacheCloseEvictsLeastRecentlyUsed(t *testing.T) {
+	t.Parallel()
+
+	c, err := Open(t.TempDir(), "thriftlint")
+	if err != nil {
+		t.Fatalf("Open: %v", err)
+	}
+	base := time.Now()
+	keys := make([]Key, 4)
+	for i := range keys {
+		keys[i] = c.Key([]byte{byte(i)})
+		c.Put(keys[i], make([]byte, 100))
+		mtime := base.Add(time.Duration(i-10) * 2 * time.Hour)
+		if err := os.Chtimes(c.entryPath(keys[i]), mtime, mtime); err != nil {
+			t.Fatalf("Chtimes: %v", err)
+		}
+	}
+	// A hit refreshes the oldest entry.
+	if _, ok := c.Get(keys[0]); !ok {
+		t.Fatal("Get missed")
+	}
+
+	c.maxBytes = 250
+	if err := c.Close(); err != nil {
+		t.Fatalf("Close: %v", err)
+	}
+	for i, want := range []bool{true, false, false, true} {
+		if _, ok := c.Get(keys[i]); ok != want {
+			t.Fatalf("entry %d present = %v, want %v", i, ok, want)
+		}
+	}
+	if _, err := os.Stat(filepath.Join(c.dir, trimMarker)); err != nil {
+		t.Fatalf("trim marker: %v", err)
+	}
+}
@@ -0,0 +1,23 @@
+package cli
+
+import (
+	"fmt"
+	"io"
+
+	"github.com/kpumuk/thrift-weaver/internal/cache"
+)
+
+// OpenCache opens the result cache selected by --cache-dir and --no-cache.
+// The cache is opt-in, so it is nil without a directory. A cache that cannot
+// be opened is reported and the run continues without it.
+func OpenCache(stderr io.Writer, toolName, dir string, disabled bool, config ...string) *cache.Cache {
+	if disabled || dir == "" {
+		return nil
+	}
+	c, err := cache.Open(dir, append([]string{toolName}, config...)...)
+	if err != nil {
+		_, _ = io.WriteString(stderr, fmt.Sprintf("%s: cache disabled: %v\n", toolName, err))
+		return nil
+	}
+	return c
+}
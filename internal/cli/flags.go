@@ -0,0 +1,27 @@
+package cli
+
+import (
+	"errors"
+	"strings"
+)
+
+// MultiStringFlag is a repeatable flag.Value that collects one non-empty
+// value per occurrence.
+type MultiStringFlag []string
+
+func (f *MultiStringFlag) String() string {
+	if f == nil {
+		return ""
+	}
+	return strings.Join(*f, ",")
+}
+
+// Set appends v, trimmed of surrounding space.
+func (f *MultiStringFlag) Set(v string) error {
+	v = strings.TrimSpace(v)
+	if v == "" {
+		return errors.New("value must not be empty")
+	}
+	*f = append(*f, v)
+	return nil
+}
@@ -0,0 +1,207 @@
+package daemon
+
+import (
+	"context"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// dialTimeout bounds connecting to a socket; a live daemon accepts at once.
+const dialTimeout = time.Second
+
+// ParseError reports that the daemon could not parse a source.
+type ParseError struct {
+	Message string
+}
+
+func (e *ParseError) Error() string {
+	return e.Message
+}
+
+// Client sends requests to the daemon serving one workspace root.
+type Client struct {
+	socket      string
+	identity    string
+	root        string
+	includeDirs []string
+}
+
+// Finder looks up daemons for directories, remembering the answer for each
+// directory. A nil *Finder finds nothing. Safe for concurrent use.
+type Finder struct {
+	mu   sync.Mutex
+	dirs map[string]*Client
+}
+
+// NewFinder builds an empty Finder.
+func NewFinder() *Finder {
+	return &Finder{dirs: make(map[string]*Client)}
+}
+
+// Find returns a client for a compatible daemon serving dir or its nearest
+// ancestor with a daemon, or nil when there is none.
+func (f *Finder) Find(ctx context.Context, dir string) *Client {
+	if f == nil {
+		return nil
+	}
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	if c, ok := f.dirs[dir]; ok {
+		return c
+	}
+	c := find(ctx, dir)
+	f.dirs[dir] = c
+	return c
+}
+
+func find(ctx context.Context, dir string) *Client {
+	base, err := socketDir(false)
+	if err != nil {
+		return nil
+	}
+	dir, err = canonicalDir(dir)
+	if err != nil {
+		return nil
+	}
+	for {
+		if c := dial(ctx, socketPathIn(base, dir)); c != nil && c.root == dir {
+			return c
+		}
+		parent := filepath.Dir(dir)
+		if parent == dir {
+			return nil
+		}
+		dir = parent
+	}
+}
+
+// dial greets the daemon on socket, returning nil unless it answers and is
+// compatible.
+func dial(ctx context.Context, socket string) *Client {
+	if _, err := os.Stat(socket); err != nil {
+		return nil
+	}
+	c := &Client{socket: socket, identity: identity()}
+	resp, err := c.call(ctx, Request{Method: MethodHello})
+	if err != nil {
+		return nil
+	}
+	c.root, c.includeDirs = resp.Root, resp.IncludeDirs
+	return c
+}
+
+// Root returns the workspace root the daemon serves.
+func (c *Client) Root() string {
+	return c.root
+}
+
+// Serves reports whether the daemon's index matches a workspace of roots and
+// includeDirs, so its workspace diagnostics equal an in-process run's.
+func (c *Client) Serves(roots, includeDirs []string) bool {
+	if len(roots) != 1 || len(includeDirs) != len(c.includeDirs) {
+		return false
+	}
+	if root, err := canonicalDir(roots[0]); err != nil || root != c.root {
+		return false
+	}
+	for i, dir := range includeDirs {
+		if dir, err := canonicalDir(dir); err != nil || dir != c.includeDirs[i] {
+			return false
+		}
+	}
+	return true
+}
+
+// Format formats src as a whole document. Failures are reported as by
+// format.Document, or as a *ParseError; ErrUnavailable means the daemon did
+// not answer.
+func (c *Client) Format(ctx context.Context, uri string, src []byte, lineWidth int) (format.Result, error) {
+	return c.format(ctx, Request{Method: MethodFormat, URI: uri, Source: src, LineWidth: lineWidth})
+}
+
+// Check reports whether formatting src would change it, like format.Check.
+func (c *Client) Check(ctx context.Context, uri string, src []byte, lineWidth int) (format.Result, error) {
+	return c.format(ctx, Request{Method: MethodFormat, URI: uri, Source: src, LineWidth: lineWidth, Check: true})
+}
+
+func (c *Client) format(ctx context.Context, req Request) (format.Result, error) {
+	resp, err := c.call(ctx, req)
+	if err != nil {
+		return format.Result{}, err
+	}
+	if err := resp.err(); err != nil {
+		return format.Result{Diagnostics: resp.Diagnostics}, err
+	}
+	return format.Result{Output: resp.Output, Changed: resp.Changed, Diagnostics: resp.Diagnostics}, nil
+}
+
+// Lint returns the sorted parser and local rule diagnostics of src, and with
+// workspace also those of the workspace rules against the daemon's index.
+func (c *Client) Lint(ctx context.Context, uri string, src []byte, workspace bool) ([]syntax.Diagnostic, error) {
+	resp, err := c.call(ctx, Request{Method: MethodLint, URI: absoluteURI(uri), Source: src, Workspace: workspace})
+	if err != nil {
+		return nil, err
+	}
+	if err := resp.err(); err != nil {
+		return nil, err
+	}
+	return resp.Diagnostics, nil
+}
+
+func (c *Client) call(ctx context.Context, req Request) (Response, error) {
+	req.Identity = c.identity
+	d := net.Dialer{Timeout: dialTimeout}
+	conn, err := d.DialContext(ctx, "unix", c.socket)
+	if err != nil {
+		return Response{}, fmt.Errorf("%w: %v", ErrUnavailable, err)
+	}
+	defer func() { _ = conn.Close() }()
+	_ = conn.SetDeadline(time.Now().Add(requestTimeout))
+
+	var resp Response
+	if err := json.NewEncoder(conn).Encode(req); err != nil {
+		return Response{}, fmt.Errorf("%w: %v", ErrUnavailable, err)
+	}
+	if err := json.NewDecoder(conn).Decode(&resp); err != nil {
+		return Response{}, fmt.Errorf("%w: %v", ErrUnavailable, err)
+	}
+	if resp.Mismatch {
+		return Response{}, fmt.Errorf("%w: daemon build differs", ErrUnavailable)
+	}
+	return resp, nil
+}
+
+func (r *Response) err() error {
+	switch {
+	case r.ParseFailed:
+		return &ParseError{Message: r.Error}
+	case r.UnsafeReason != "":
+		return &format.ErrUnsafeToFormat{Reason: format.UnsafeReason(r.UnsafeReason), Message: r.Error}
+	case r.Error != "":
+		return errors.New(r.Error)
+	default:
+		return nil
+	}
+}
+
+// absoluteURI resolves a relative path against the working directory, which
+// the daemon does not share.
+func absoluteURI(uri string) string {
+	if strings.Contains(uri, "://") || filepath.IsAbs(uri) {
+		return uri
+	}
+	if abs, err := filepath.Abs(uri); err == nil {
+		return abs
+	}
+	return uri
+}
@@ -0,0 +1,123 @@
+// Package daemon lets thriftfmt and thriftlint hand work to a long-lived
+// thriftls process over a Unix domain socket, so repeated runs reuse its warm
+// parsers and workspace index instead of starting cold.
+//
+// A daemon serves one workspace root. Its socket lives in a per-user
+// directory under a name derived from the root, so clients find it from a
+// file path alone. Each connection carries one JSON request and one JSON
+// response. Requests name the client build; a daemon from another build
+// answers with a mismatch, and the client works in-process instead.
+package daemon
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"errors"
+	"os"
+	"path/filepath"
+	"runtime/debug"
+	"strings"
+
+	thriftwasm "github.com/kpumuk/thrift-weaver/internal/grammars/thrift"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// protocolVersion changes whenever Request or Response change shape.
+const protocolVersion = "2"
+
+// Request methods.
+const (
+	// MethodHello reports the daemon root and build without doing any work.
+	MethodHello = "hello"
+	// MethodFormat formats a whole document, or with Check only reports
+	// whether formatting would change it.
+	MethodFormat = "format"
+	// MethodLint runs parser diagnostics and local lint rules, and with
+	// Workspace also the workspace rules against the daemon's index.
+	MethodLint = "lint"
+)
+
+// ErrUnavailable reports that no compatible daemon answered. Callers fall
+// back to in-process execution.
+var ErrUnavailable = errors.New("thriftls daemon unavailable")
+
+// Request is one call to the daemon.
+type Request struct {
+	Identity  string `json:"identity"`
+	Method    string `json:"method"`
+	URI       string `json:"uri,omitempty"`
+	Source    []byte `json:"source,omitempty"`
+	LineWidth int    `json:"lineWidth,omitempty"`
+	Check     bool   `json:"check,omitempty"`
+	Workspace bool   `json:"workspace,omitempty"`
+}
+
+// Response is the daemon's answer to one Request.
+type Response struct {
+	Identity    string              `json:"identity"`
+	Root        string              `json:"root"`
+	IncludeDirs []string            `json:"includeDirs,omitempty"`
+	Mismatch    bool                `json:"mismatch,omitempty"`
+	Output      []byte              `json:"output,omitempty"`
+	Changed     bool                `json:"changed,omitempty"`
+	Diagnostics []syntax.Diagnostic `json:"diagnostics,omitempty"`
+	// Error is the message of a failed request. ParseFailed and
+	// UnsafeReason tell parse failures and unsafe formatting apart.
+	Error        string `json:"error,omitempty"`
+	ParseFailed  bool   `json:"parseFailed,omitempty"`
+	UnsafeReason string `json:"unsafeReason,omitempty"`
+}
+
+// identity names the protocol, tool release and embedded grammar. Only
+// daemons with the same identity serve a client.
+func identity() string {
+	parts := []string{protocolVersion, thriftwasm.WASMChecksum()}
+	if info, ok := debug.ReadBuildInfo(); ok {
+		parts = append(parts, info.Main.Version)
+		for _, s := range info.Settings {
+			if s.Key == "vcs.revision" || s.Key == "vcs.modified" {
+				parts = append(parts, s.Value)
+			}
+		}
+	}
+	return strings.Join(parts, "|")
+}
+
+// SocketPath returns the socket a daemon for root listens on.
+func SocketPath(root string) (string, error) {
+	dir, err := socketDir(false)
+	if err != nil {
+		return "", err
+	}
+	root, err = canonicalDir(root)
+	if err != nil {
+		return "", err
+	}
+	return socketPathIn(dir, root), nil
+}
+
+func socketPathIn(dir, root string) string {
+	sum := sha256.Sum256([]byte(root))
+	return filepath.Join(dir, hex.EncodeToString(sum[:8])+".sock")
+}
+
+// canonicalDir makes dir absolute and resolves symlinks, so a root named
+// through different paths maps to one socket.
+func canonicalDir(dir string) (string, error) {
+	abs, err := filepath.Abs(dir)
+	if err != nil {
+		return "", err
+	}
+	if resolved, err := filepath.EvalSymlinks(abs); err == nil {
+		abs = resolved
+	}
+	return filepath.Clean(abs), nil
+}
+
+// runtimeBaseDir is the directory holding the per-user socket directory.
+func runtimeBaseDir() string {
+	if dir := os.Getenv("XDG_RUNTIME_DIR"); dir != "" {
+		return dir
+	}
+	return os.TempDir()
+}
@@ -0,0 +1,165 @@
+package daemon
+
+import (
+	"bytes"
+	"context"
+	"errors"
+	"os"
+	"path/filepath"
+	"slices"
+	"testing"
+	"time"
+
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/lint"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// startDaemon serves root on a socket in a fresh directory and returns a
+// client for it. The directory is kept short to fit socket path limits.
+func startDaemon(t *testing.T, root string) (*Client, string) {
+	t.Helper()
+
+	srv, err := NewServer(ServerOptions{Root: root, Workers: 2})
+	if err != nil {
+		t.Fatalf("NewServer: %v", err)
+	}
+	dir, err := os.MkdirTemp("", "tw")
+	if err != nil {
+		t.Fatalf("MkdirTemp: %v", err)
+	}
+	socket := filepath.Join(dir, "d.sock")
+	ln, err := listenSocket(socket)
+	if err != nil {
+		t.Fatalf("listenSocket: %v", err)
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan error, 1)
+	go func() { done <- srv.Serve(ctx, ln) }()
+	t.Cleanup(func() {
+		cancel()
+		if err := <-done; err != nil {
+			t.Errorf("Serve: %v", err)
+		}
+		srv.Close()
+		_ = os.RemoveAll(dir)
+	})
+
+	c := dial(context.Background(), socket)
+	if c == nil {
+		t.Fatal("dial: no daemon answered")
+	}
+	if c.Root() != srv.Root() {
+		t.Fatalf("Root()=%q, want %q", c.Root(), srv.Root())
+	}
+	return c, socket
+}
+
+func writeFile(t *testing.T, path, content string) {
+	t.Helper()
+	if err := os.WriteFile(path, []byte(content), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+}
+
+func TestClientFormatMatchesInProcess(t *testing.T) {
+	t.Parallel()
+
+	c, _ := startDaemon(t, t.TempDir())
+	src := []byte("struct  A{1:i32 id\n2: string name}\n")
+	got, err := c.Format(context.Background(), "a.thrift", src, 0)
+	if err != nil {
+		t.Fatalf("Format: %v", err)
+	}
+
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "a.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+	want, err := format.Document(context.Background(), tree, format.Options{})
+	if err != nil {
+		t.Fatalf("Document: %v", err)
+	}
+	if !bytes.Equal(got.Output, want.Output) || got.Changed != want.Changed {
+		t.Fatalf("daemon output=%q changed=%v, want %q changed=%v", got.Output, got.Changed, want.Output, want.Changed)
+	}
+	for _, tc := range []struct {
+		src     []byte
+		changed bool
+	}{{src, true}, {want.Output, false}} {
+		got, err := c.Check(context.Background(), "a.thrift", tc.src, 0)
+		if err != nil || got.Changed != tc.changed || got.Output != nil {
+			t.Fatalf("Check(%q) = {Changed: %v, Output: %q}, %v; want changed=%v", tc.src, got.Changed, got.Output, err, tc.changed)
+		}
+	}
+
+	_, err = c.Format(context.Background(), "b.thrift", []byte("const string X = 'unterminated\n"), 0)
+	var unsafe *format.ErrUnsafeToFormat
+	if !format.AsUnsafeToFormat(err, &unsafe) {
+		t.Fatalf("Format error=%v, want ErrUnsafeToFormat", err)
+	}
+}
+
+func TestClientLintWithWorkspaceSeesDiskChanges(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	writeFile(t, filepath.Join(root, "types.thrift"), "struct User {\n  1: i32 id,\n}\n")
+	main := filepath.Join(root, "main.thrift")
+	src := []byte("include \"types.thrift\"\n\nstruct A {\n  1: types.User user,\n  2: types.Account account,\n}\n")
+	writeFile(t, main, string(src))
+	c, _ := startDaemon(t, root)
+
+	local, err := c.Lint(context.Background(), main, src, false)
+	if err != nil {
+		t.Fatalf("Lint: %v", err)
+	}
+	if hasCode(local, lint.DiagnosticQualifiedReferenceUnknown) {
+		t.Fatalf("local lint reported workspace diagnostics: %+v", local)
+	}
+	diags, err := c.Lint(context.Background(), main, src, true)
+	if err != nil {
+		t.Fatalf("Lint: %v", err)
+	}
+	if !hasCode(diags, lint.DiagnosticQualifiedReferenceUnknown) {
+		t.Fatalf("missing %s in %+v", lint.DiagnosticQualifiedReferenceUnknown, diags)
+	}
+
+	// The watcher picks the edit up after its debounce window.
+	writeFile(t, filepath.Join(root, "types.thrift"), "struct User {\n  1: i32 id,\n}\n\nstruct Account {\n  1: i32 id,\n}\n")
+	deadline := time.Now().Add(5 * time.Second)
+	for {
+		diags, err = c.Lint(context.Background(), main, src, true)
+		if err != nil {
+			t.Fatalf("Lint: %v", err)
+		}
+		if !hasCode(diags, lint.DiagnosticQualifiedReferenceUnknown) {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("stale workspace diagnostics after edit: %+v", diags)
+		}
+		time.Sleep(20 * time.Millisecond)
+	}
+}
+
+func TestClientIdentityMismatchIsUnavailable(t *testing.T) {
+	t.Parallel()
+
+	c, socket := startDaemon(t, t.TempDir())
+	other := &Client{socket: socket, identity: "other build"}
+	if _, err := other.Format(context.Background(), "a.thrift", []byte("struct A {}\n"), 0); !errors.Is(err, ErrUnavailable) {
+		t.Fatalf("Format error=%v, want ErrUnavailable", err)
+	}
+	if _, err := listenSocket(socket); err == nil {
+		t.Fatal("listenSocket replaced a live daemon")
+	}
+	if !c.Serves([]string{c.Root()}, nil) || c.Serves([]string{c.Root()}, []string{c.Root()}) {
+		t.Fatal("Serves must match the daemon root and include dirs exactly")
+	}
+}
+
+func hasCode(diags []syntax.Diagnostic, code syntax.DiagnosticCode) bool {
+	return slices.ContainsFunc(diags, func(d syntax.Diagnostic) bool { return d.Code == code })
+}
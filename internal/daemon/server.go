@@ -0,0 +1,297 @@
+package daemon
+
+import (
+	"context"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"net"
+	"os"
+	"runtime"
+	"slices"
+	"sync"
+	"time"
+
+	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/index"
+	"github.com/kpumuk/thrift-weaver/internal/lint"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// requestTimeout bounds how long one connection may take to send its
+// request and receive the response.
+const requestTimeout = time.Minute
+
+// ServerOptions configure a daemon.
+type ServerOptions struct {
+	// Root is the workspace root the daemon indexes and serves.
+	Root        string
+	IncludeDirs []string
+	// Workers bounds concurrent parses and lint workers; 0 uses all CPUs.
+	Workers int
+}
+
+// Server answers format and lint requests for one workspace root with a
+// pool of warm parsers and a workspace index kept across requests.
+type Server struct {
+	root        string
+	includeDirs []string
+	identity    string
+	runner      *lint.Runner
+	manager     *index.Manager
+	parsers     chan *syntax.ReusableParser
+
+	// watched is set when a native watcher keeps the index current.
+	// Otherwise each workspace lint request rescans the disk first.
+	watched bool
+
+	// workspaceMu serializes workspace lint requests, which overlay their
+	// source on the shared index. lastRescan is when the latest rescan
+	// started; a request that arrived before it needs no rescan of its own.
+	workspaceMu sync.Mutex
+	lastRescan  time.Time
+}
+
+// NewServer builds a daemon for opts.Root. Call Serve to index the
+// workspace and answer requests.
+func NewServer(opts ServerOptions) (*Server, error) {
+	root, err := canonicalDir(opts.Root)
+	if err != nil {
+		return nil, err
+	}
+	workers := opts.Workers
+	if workers <= 0 {
+		workers = runtime.GOMAXPROCS(0)
+	}
+	includeDirs := make([]string, 0, len(opts.IncludeDirs))
+	for _, dir := range opts.IncludeDirs {
+		dir, err := canonicalDir(dir)
+		if err != nil {
+			return nil, err
+		}
+		includeDirs = append(includeDirs, dir)
+	}
+	s := &Server{
+		root:        root,
+		includeDirs: includeDirs,
+		identity:    identity(),
+		runner:      lint.NewDefaultRunner().WithPool(lint.NewPool(workers)),
+		manager: index.NewManager(index.Options{
+			WorkspaceRoots: []string{root},
+			IncludeDirs:    includeDirs,
+			ParseWorkers:   workers,
+		}),
+		parsers: make(chan *syntax.ReusableParser, workers),
+	}
+	for range workers {
+		s.parsers <- syntax.NewReusableParser()
+	}
+	return s, nil
+}
+
+// Root returns the canonical workspace root of s.
+func (s *Server) Root() string {
+	return s.root
+}
+
+// Listen opens the socket of the daemon for s.Root. A socket left behind by
+// a daemon that is no longer running is replaced; a live one is an error.
+func (s *Server) Listen() (net.Listener, error) {
+	dir, err := socketDir(true)
+	if err != nil {
+		return nil, err
+	}
+	return listenSocket(socketPathIn(dir, s.root))
+}
+
+func listenSocket(path string) (net.Listener, error) {
+	if conn, err := net.DialTimeout("unix", path, time.Second); err == nil {
+		_ = conn.Close()
+		return nil, fmt.Errorf("a daemon is already listening on %s", path)
+	}
+	if err := os.Remove(path); err != nil && !errors.Is(err, os.ErrNotExist) {
+		return nil, err
+	}
+	return net.Listen("unix", path)
+}
+
+// Serve indexes the workspace and starts watching it, then answers requests
+// on ln until ctx is done. It closes ln.
+func (s *Server) Serve(ctx context.Context, ln net.Listener) error {
+	defer func() { _ = ln.Close() }()
+	if err := s.rescan(ctx, time.Now()); err != nil {
+		return fmt.Errorf("index workspace: %w", err)
+	}
+	switch err := s.manager.StartWatcher(index.WatchOptions{}); {
+	case err == nil:
+		s.watched = true
+	case !errors.Is(err, index.ErrWatchUnsupported):
+		return fmt.Errorf("watch workspace: %w", err)
+	}
+	stop := context.AfterFunc(ctx, func() { _ = ln.Close() })
+	defer stop()
+
+	var wg sync.WaitGroup
+	defer wg.Wait()
+	for {
+		conn, err := ln.Accept()
+		if err != nil {
+			if ctx.Err() != nil {
+				return nil
+			}
+			return err
+		}
+		wg.Go(func() {
+			s.serveConn(ctx, conn)
+		})
+	}
+}
+
+// Close releases the parsers and the workspace index.
+func (s *Server) Close() {
+	s.manager.Close()
+	for {
+		select {
+		case p := <-s.parsers:
+			p.Close()
+		default:
+			return
+		}
+	}
+}
+
+func (s *Server) serveConn(ctx context.Context, conn net.Conn) {
+	defer func() { _ = conn.Close() }()
+	_ = conn.SetDeadline(time.Now().Add(requestTimeout))
+	ctx, cancel := context.WithTimeout(ctx, requestTimeout)
+	defer cancel()
+
+	var req Request
+	if err := json.NewDecoder(conn).Decode(&req); err != nil {
+		return
+	}
+	resp := s.handle(ctx, &req)
+	resp.Identity, resp.Root, resp.IncludeDirs = s.identity, s.root, s.includeDirs
+	_ = json.NewEncoder(conn).Encode(resp)
+}
+
+func (s *Server) handle(ctx context.Context, req *Request) Response {
+	if req.Identity != s.identity {
+		return Response{Mismatch: true}
+	}
+	switch req.Method {
+	case MethodHello:
+		return Response{}
+	case MethodFormat:
+		return s.format(ctx, req)
+	case MethodLint:
+		return s.lint(ctx, req)
+	default:
+		return Response{Error: fmt.Sprintf("unknown method %q", req.Method)}
+	}
+}
+
+func (s *Server) parse(ctx context.Context, req *Request) (*syntax.Tree, error) {
+	var p *syntax.ReusableParser
+	select {
+	case p = <-s.parsers:
+	case <-ctx.Done():
+		return nil, ctx.Err()
+	}
+	defer func() { s.parsers <- p }()
+	return p.Parse(ctx, req.Source, syntax.ParseOptions{URI: req.URI})
+}
+
+func (s *Server) format(ctx context.Context, req *Request) Response {
+	tree, err := s.parse(ctx, req)
+	if err != nil {
+		return Response{Error: err.Error(), ParseFailed: true}
+	}
+	defer tree.Close()
+
+	formatDocument := format.Document
+	if req.Check {
+		formatDocument = format.Check
+	}
+	res, err := formatDocument(ctx, tree, format.Options{LineWidth: req.LineWidth})
+	if err != nil {
+		resp := Response{Error: err.Error(), Diagnostics: res.Diagnostics}
+		var unsafe *format.ErrUnsafeToFormat
+		if format.AsUnsafeToFormat(err, &unsafe) {
+			resp.Error, resp.UnsafeReason = unsafe.Message, string(unsafe.Reason)
+		}
+		return resp
+	}
+	return Response{Output: res.Output, Changed: res.Changed, Diagnostics: res.Diagnostics}
+}
+
+func (s *Server) lint(ctx context.Context, req *Request) Response {
+	arrived := time.Now()
+	tree, err := s.parse(ctx, req)
+	if err != nil {
+		return Response{Error: err.Error(), ParseFailed: true}
+	}
+	diags := slices.Clone(tree.Diagnostics)
+	lintDiags, err := s.runner.Run(ctx, tree)
+	tree.Close()
+	if err != nil {
+		return Response{Error: err.Error()}
+	}
+	diags = append(diags, lintDiags...)
+	lint.SortDiagnostics(diags)
+	if req.Workspace {
+		workspaceDiags, err := s.lintWorkspace(ctx, req, arrived)
+		if err != nil {
+			return Response{Error: err.Error()}
+		}
+		diags = append(diags, workspaceDiags...)
+		lint.SortDiagnostics(diags)
+	}
+	return Response{Diagnostics: diags}
+}
+
+// lintWorkspace runs the workspace rules for req.Source as an open document
+// of the index. Without a watcher the index is first brought up to date
+// with the disk.
+func (s *Server) lintWorkspace(ctx context.Context, req *Request, arrived time.Time) ([]syntax.Diagnostic, error) {
+	s.workspaceMu.Lock()
+	defer s.workspaceMu.Unlock()
+	if !s.watched {
+		if err := s.rescan(ctx, arrived); err != nil {
+			return nil, err
+		}
+	}
+	if err := s.manager.UpsertOpenDocument(ctx, index.DocumentInput{
+		URI:     req.URI,
+		Version: -1,
+		Source:  req.Source,
+	}); err != nil {
+		return nil, err
+	}
+	defer func() { _ = s.manager.CloseOpenDocument(context.WithoutCancel(ctx), req.URI) }()
+
+	snapshot, ok := s.manager.Snapshot()
+	if !ok {
+		return nil, nil
+	}
+	view, ok, err := index.ViewForDocument(snapshot, req.URI)
+	if err != nil || !ok {
+		return nil, err
+	}
+	return s.runner.RunWithWorkspace(ctx, view)
+}
+
+// rescan refreshes the index from disk unless a rescan started after
+// arrived, which already saw every change made before it. Unchanged files
+// are not parsed again.
+func (s *Server) rescan(ctx context.Context, arrived time.Time) error {
+	if s.lastRescan.After(arrived) {
+		return nil
+	}
+	start := time.Now()
+	if err := s.manager.RescanWorkspace(ctx); err != nil {
+		return err
+	}
+	s.lastRescan = start
+	return nil
+}
@@ -0,0 +1,9 @@
+//go:build !unix
+
+package daemon
+
+import "errors"
+
+func socketDir(bool) (string, error) {
+	return "", errors.New("thriftls daemon sockets are not supported on this platform")
+}
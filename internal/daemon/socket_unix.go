@@ -0,0 +1,37 @@
+//go:build unix
+
+package daemon
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"syscall"
+)
+
+// socketDir returns the per-user socket directory, creating it if asked.
+// It must be owned by the current user and closed to everyone else, so no
+// other user can plant a socket that receives source code.
+func socketDir(create bool) (string, error) {
+	uid := os.Getuid()
+	dir := filepath.Join(runtimeBaseDir(), fmt.Sprintf("thrift-weaver-%d", uid))
+	if create {
+		if err := os.MkdirAll(dir, 0o700); err != nil {
+			return "", err
+		}
+	}
+	st, err := os.Lstat(dir)
+	if err != nil {
+		return "", err
+	}
+	sys, ok := st.Sys().(*syscall.Stat_t)
+	switch {
+	case !st.IsDir():
+		return "", fmt.Errorf("%s is not a directory", dir)
+	case !ok || int(sys.Uid) != uid:
+		return "", fmt.Errorf("%s is not owned by the current user", dir)
+	case st.Mode().Perm()&0o077 != 0:
+		return "", fmt.Errorf("%s is accessible by other users", dir)
+	}
+	return dir, nil
+}
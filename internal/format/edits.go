@@ -0,0 +1,129 @@
+package format
+
+import (
+	"bytes"
+	"context"
+	"unicode/utf8"
+
+	"github.com/kpumuk/thrift-weaver/internal/lexer"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// DocumentEdits formats a full syntax tree and returns the result as minimal
+// byte edits against the tree source instead of a full replacement.
+func DocumentEdits(ctx context.Context, tree *syntax.Tree, opts Options) (RangeResult, error) {
+	res, err := Document(ctx, tree, opts)
+	if err != nil {
+		return RangeResult{Diagnostics: res.Diagnostics}, err
+	}
+	return documentEdits(tree, res), nil
+}
+
+func documentEdits(tree *syntax.Tree, res Result) RangeResult {
+	if !res.Changed {
+		return RangeResult{Diagnostics: res.Diagnostics}
+	}
+	return RangeResult{
+		Edits:       tokenDiffEdits(tree.Source, tree.Tokens, res.Output),
+		Diagnostics: res.Diagnostics,
+	}
+}
+
+// tokenDiffEdits returns edits turning src into out. Formatting keeps the
+// significant tokens and their order, changing only the trivia between them
+// and a few separators, so the token streams are aligned on identical tokens
+// and each differing gap becomes one edit trimmed to its changed bytes. If
+// the streams stop aligning, the rest of the document is diffed as one gap.
+func tokenDiffEdits(src []byte, srcTokens []lexer.Token, out []byte) []text.ByteEdit {
+	outTokens := lexer.Lex(out).Tokens
+	var edits []text.ByteEdit
+	var srcEnd, outEnd text.ByteOffset
+	gap := func(srcStart, outStart text.ByteOffset) {
+		edits = appendGapEdit(edits, src, out, srcEnd, srcStart, outEnd, outStart)
+	}
+
+	i, j := 0, 0
+	for i < len(srcTokens) && j < len(outTokens) {
+		a, b := srcTokens[i], outTokens[j]
+		if a.Kind == lexer.TokenEOF || b.Kind == lexer.TokenEOF {
+			break
+		}
+		switch {
+		case a.Kind == b.Kind && bytes.Equal(a.Bytes(src), b.Bytes(out)):
+			gap(a.Span.Start, b.Span.Start)
+			srcEnd, outEnd = a.Span.End, b.Span.End
+			i++
+			j++
+		case isSeparatorToken(a.Kind) && isSeparatorToken(b.Kind):
+			// Replaced separator; it joins the surrounding gap.
+			i++
+			j++
+		case isSeparatorToken(a.Kind):
+			i++
+		case isSeparatorToken(b.Kind):
+			j++
+		default:
+			i, j = len(srcTokens), len(outTokens)
+		}
+	}
+	gap(text.ByteOffset(len(src)), text.ByteOffset(len(out)))
+	return edits
+}
+
+// appendGapEdit appends the edit replacing src[srcStart:srcEnd] with
+// out[outStart:outEnd], trimmed to the bytes that differ. Cuts never split a
+// UTF-8 sequence or a CRLF pair, so edits map cleanly to editor positions.
+func appendGapEdit(edits []text.ByteEdit, src, out []byte, srcStart, srcEnd, outStart, outEnd text.ByteOffset) []text.ByteEdit {
+	old, repl := src[srcStart:srcEnd], out[outStart:outEnd]
+	if bytes.Equal(old, repl) {
+		return edits
+	}
+	prefix := commonPrefixLen(old, repl)
+	for prefix > 0 && (!safeCut(old, prefix) || !safeCut(repl, prefix)) {
+		prefix--
+	}
+	old, repl = old[prefix:], repl[prefix:]
+	suffix := commonSuffixLen(old, repl)
+	for suffix > 0 && (!safeCut(old, len(old)-suffix) || !safeCut(repl, len(repl)-suffix)) {
+		suffix--
+	}
+	old, repl = old[:len(old)-suffix], repl[:len(repl)-suffix]
+	start := srcStart + text.ByteOffset(prefix)
+	return append(edits, text.ByteEdit{
+		Span:    text.Span{Start: start, End: start + text.ByteOffset(len(old))},
+		NewText: repl,
+	})
+}
+
+func isSeparatorToken(kind lexer.TokenKind) bool {
+	return kind == lexer.TokenComma || kind == lexer.TokenSemi
+}
+
+// safeCut reports whether b can be split at i.
+func safeCut(b []byte, i int) bool {
+	if i <= 0 || i >= len(b) {
+		return true
+	}
+	return utf8.RuneStart(b[i]) && (b[i-1] != '\r' || b[i] != '\n')
+}
+
+func commonPrefixLen(a, b []byte) int {
+	n := min(len(a), len(b))
+	for i := range n {
+		if a[i] != b[i] {
+			return i
+		}
+	}
+	return n
+}
+
+func commonSuffixLen(a, b []byte) int {
+	n := min(len(a), len(b))
+	for i := range n {
+		if a[len(a)-1-i] != b[len(b)-1-i] {
+			return i
+		}
+	}
+	return n
+}
@@ -17,7 +17,7 @@ func Document(ctx context.Context, tree *syntax.Tree, opts Options) (Result, err
 		return Result{Diagnostics: diags}, err
 	}
 
-	out, err := formatSyntaxTree(tree, normOpts, policy)
+	out, err := formatSyntaxTreeParallel(tree, normOpts, policy, formatWorkers(tree))
 	if err != nil {
 		return Result{}, err
 	}
@@ -34,12 +34,8 @@ func Range(ctx context.Context, tree *syntax.Tree, r text.Span, opts Options) (R
 	if err != nil {
 		return RangeResult{Diagnostics: diags}, err
 	}
-	if err := r.Validate(); err != nil {
-		return RangeResult{}, fmt.Errorf("invalid range: %w", err)
-	}
-	srcSpan := sourceSpan(tree.Source)
-	if !srcSpan.ContainsSpan(r) {
-		return RangeResult{}, fmt.Errorf("range %s out of bounds for source length %d", r, len(tree.Source))
+	if err := validateRange(tree, r); err != nil {
+		return RangeResult{}, err
 	}
 
 	ancestor, widenDiag, err := findRangeFormatAncestor(tree, r)
@@ -50,25 +46,53 @@ func Range(ctx context.Context, tree *syntax.Tree, r text.Span, opts Options) (R
 		return RangeResult{Diagnostics: diags}, err
 	}
 
-	out, err := formatNodeRange(tree, ancestor, normOpts, policy)
+	edits, err := formatNodeRanges(tree, []syntax.NodeID{ancestor}, normOpts, policy)
+	if err != nil {
+		return RangeResult{Diagnostics: diags}, err
+	}
+	return RangeResult{Edits: edits, Diagnostics: diags}, nil
+}
+
+// Ranges formats several source ranges of one document, such as the changed
+// lines of a diff, and returns edits in source order. Each range widens like
+// in Range. Ranges that widen to the same or nested ancestors are formatted
+// once, through the outermost ancestor, so edits never overlap. Unlike Range, a
+// range without a format-safe ancestor does not fail the call. It is left
+// unformatted and reported in the diagnostics.
+func Ranges(ctx context.Context, tree *syntax.Tree, ranges []text.Span, opts Options) (RangeResult, error) {
+	normOpts, policy, diags, err := prepareFormatting(ctx, tree, opts)
+	if err != nil {
+		return RangeResult{Diagnostics: diags}, err
+	}
+
+	ancestors := make([]syntax.NodeID, 0, len(ranges))
+	for _, r := range ranges {
+		if err := validateRange(tree, r); err != nil {
+			return RangeResult{}, err
+		}
+		ancestor, widenDiag, err := findRangeFormatAncestor(tree, r)
+		if err != nil {
+			diags = append(diags, widenDiag)
+			continue
+		}
+		ancestors = append(ancestors, ancestor)
+	}
+
+	edits, err := formatNodeRanges(tree, outermostNodes(tree, ancestors), normOpts, policy)
 	if err != nil {
 		return RangeResult{Diagnostics: diags}, err
 	}
-	n := tree.NodeByID(ancestor)
-	if n == nil {
-		return RangeResult{}, errors.New("range ancestor node not found")
+	return RangeResult{Edits: edits, Diagnostics: diags}, nil
+}
+
+func validateRange(tree *syntax.Tree, r text.Span) error {
+	if err := r.Validate(); err != nil {
+		return fmt.Errorf("invalid range: %w", err)
 	}
-	old := tree.Source[n.Span.Start:n.Span.End]
-	if bytes.Equal(out, old) {
-		return RangeResult{Diagnostics: diags}, nil
+	if !sourceSpan(tree.Source).ContainsSpan(r) {
+		return fmt.Errorf("range %s out of bounds for source length %d", r, len(tree.Source))
 	}
-	return RangeResult{
-		Edits: []text.ByteEdit{{
-			Span:    n.Span,
-			NewText: out,
-		}},
-		Diagnostics: diags,
-	}, nil
+	return nil
 }
 
 // Source parses and formats source bytes in one step.
@@ -3,9 +3,14 @@ package format
 import (
 	"bytes"
 	"context"
+	"fmt"
+	"path/filepath"
+	"strings"
 	"testing"
+	"unicode/utf8"
 
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/testutil"
 	"github.com/kpumuk/thrift-weaver/internal/text"
 )
 
@@ -152,3 +157,163 @@ func TestRangeReturnsNoEditsForSafeInputTrackA(t *testing.T) {
 		t.Fatalf("expected no edits for already-formatted declaration range, got %d", len(res.Edits))
 	}
 }
+
+func TestDocumentEditsTouchOnlyChangedTrivia(t *testing.T) {
+	t.Parallel()
+
+	src := []byte("struct S {\n  1: string a;\n  2: i32   b\n}\n// préface\n")
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "test.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+
+	res, err := DocumentEdits(context.Background(), tree, Options{})
+	if err != nil {
+		t.Fatalf("DocumentEdits: %v", err)
+	}
+	want := []text.ByteEdit{
+		{Span: text.Span{Start: 24, End: 25}, NewText: []byte(",")},
+		{Span: text.Span{Start: 35, End: 37}, NewText: []byte{}},
+		{Span: text.Span{Start: 38, End: 38}, NewText: []byte(",")},
+	}
+	if len(res.Edits) != len(want) {
+		t.Fatalf("edits = %+v, want %+v", res.Edits, want)
+	}
+	for i := range want {
+		if res.Edits[i].Span != want[i].Span || !bytes.Equal(res.Edits[i].NewText, want[i].NewText) {
+			t.Fatalf("edit %d = %+v, want %+v", i, res.Edits[i], want[i])
+		}
+	}
+}
+
+func TestDocumentEditsReproduceGoldenOutput(t *testing.T) {
+	t.Parallel()
+
+	cases, err := testutil.FormatGoldenCases()
+	if err != nil {
+		t.Fatalf("FormatGoldenCases: %v", err)
+	}
+	for _, tc := range cases {
+		t.Run(tc.Name, func(t *testing.T) {
+			t.Parallel()
+
+			input := testutil.ReadFile(t, tc.InputPath)
+			tree, err := syntax.Parse(context.Background(), input, syntax.ParseOptions{URI: filepath.Base(tc.InputPath)})
+			if err != nil {
+				t.Fatalf("Parse: %v", err)
+			}
+			defer tree.Close()
+
+			res, err := DocumentEdits(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("DocumentEdits: %v", err)
+			}
+			got, err := text.ApplyEdits(input, res.Edits)
+			if err != nil {
+				t.Fatalf("ApplyEdits: %v", err)
+			}
+			expected := testutil.ReadFile(t, tc.ExpectedPath)
+			if !bytes.Equal(got, expected) {
+				t.Fatalf("edited output mismatch\n--- got ---\n%s\n--- want ---\n%s", got, expected)
+			}
+			for _, e := range res.Edits {
+				if !utf8.Valid(e.NewText) || !utf8.Valid(input[e.Span.Start:e.Span.End]) {
+					t.Fatalf("edit %+v splits a UTF-8 sequence", e)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkFormatAfterSingleDeclarationEdit(b *testing.B) {
+	var base strings.Builder
+	for i := range 2000 {
+		fmt.Fprintf(&base, "struct S%d {\n  1: string name,\n  2: optional S%d next;\n  3:list<string> tags\n}\n\n", i, max(i-1, 0))
+	}
+	src := base.String()
+	parse := func(src string) *syntax.Tree {
+		tree, err := syntax.Parse(context.Background(), []byte(src), syntax.ParseOptions{URI: "file:///bench.thrift"})
+		if err != nil {
+			b.Fatalf("syntax.Parse: %v", err)
+		}
+		return tree
+	}
+	trees := [2]*syntax.Tree{parse(src), parse(strings.Replace(src, "struct S1000 {\n  1: string name", "struct S1000 {\n  1: string title", 1))}
+
+	b.Run("full", func(b *testing.B) {
+		b.ReportAllocs()
+		i := 0
+		for b.Loop() {
+			if _, err := Document(context.Background(), trees[i%2], Options{}); err != nil {
+				b.Fatalf("Document: %v", err)
+			}
+			i++
+		}
+	})
+	b.Run("incremental", func(b *testing.B) {
+		f := NewIncremental()
+		f.verifyEvery = 0
+		if _, err := f.Document(context.Background(), trees[0], Options{}); err != nil {
+			b.Fatalf("Document: %v", err)
+		}
+		b.ReportAllocs()
+		i := 1
+		for b.Loop() {
+			if _, err := f.Document(context.Background(), trees[i%2], Options{}); err != nil {
+				b.Fatalf("Document: %v", err)
+			}
+			i++
+		}
+	})
+}
+
+func BenchmarkFormatLargeDocument(b *testing.B) {
+	var src strings.Builder
+	for i := range 20000 {
+		fmt.Fprintf(&src, "struct S%d {\n  1: string name;\n  2:optional i32 id\n}\n", i)
+	}
+	tree, err := syntax.Parse(context.Background(), []byte(src.String()), syntax.ParseOptions{URI: "file:///large.thrift"})
+	if err != nil {
+		b.Fatalf("syntax.Parse: %v", err)
+	}
+	opts, policy, _, err := prepareFormatting(context.Background(), tree, Options{})
+	if err != nil {
+		b.Fatalf("prepareFormatting: %v", err)
+	}
+	for _, workers := range []int{1, 2, 4, 8} {
+		b.Run(fmt.Sprintf("workers=%d", workers), func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := formatSyntaxTreeParallel(tree, opts, policy, workers); err != nil {
+					b.Fatalf("formatSyntaxTreeParallel: %v", err)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkCheckFormattedDocument(b *testing.B) {
+	var src strings.Builder
+	for i := range 20000 {
+		fmt.Fprintf(&src, "struct S%d {\n  1: string name,\n  2: optional i32 id,\n}\n\n", i)
+	}
+	tree, err := syntax.Parse(context.Background(), []byte(strings.TrimSuffix(src.String(), "\n")), syntax.ParseOptions{URI: "file:///large.thrift"})
+	if err != nil {
+		b.Fatalf("syntax.Parse: %v", err)
+	}
+	for name, check := range map[string]func() (Result, error){
+		"document": func() (Result, error) { return Document(context.Background(), tree, Options{}) },
+		"check":    func() (Result, error) { return Check(context.Background(), tree, Options{}) },
+	} {
+		b.Run(name, func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				res, err := check()
+				if err != nil || res.Changed {
+					b.Fatalf("Changed = %v, err = %v; want formatted input", res.Changed, err)
+				}
+			}
+		})
+	}
+}
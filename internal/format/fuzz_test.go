@@ -80,3 +80,24 @@ func fuzzSpan(src []byte) text.Span {
 	}
 	return text.Span{Start: text.ByteOffset(start), End: text.ByteOffset(end)}
 }
+
+func FuzzIncrementalMatchesDocument(f *testing.F) {
+	addFormatSeeds(f)
+
+	f.Fuzz(func(t *testing.T, src []byte) {
+		if len(src) > 512*1024 {
+			t.Skip()
+		}
+
+		fmtr := NewIncremental()
+		fmtr.verifyEvery = 0
+		assertIncrementalMatchesDocument(t, fmtr, src)
+		if len(src) == 0 {
+			return
+		}
+		r := fuzzSpan(src)
+		edited := concatBytes(src[:r.Start], src[r.End:])
+		assertIncrementalMatchesDocument(t, fmtr, edited)
+		assertIncrementalMatchesDocument(t, fmtr, src)
+	})
+}
@@ -2,11 +2,13 @@ package format
 
 import (
 	"context"
+	"fmt"
 	"path/filepath"
 	"strings"
 	"testing"
 
 	"github.com/kpumuk/thrift-weaver/internal/lexer"
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
 	"github.com/kpumuk/thrift-weaver/internal/testutil"
 )
 
@@ -108,3 +110,297 @@ func extractCommentLexemes(src []byte) []string {
 	}
 	return out
 }
+
+func TestIncrementalMatchesDocumentOnGoldenCorpus(t *testing.T) {
+	t.Parallel()
+
+	cases, err := testutil.FormatGoldenCases()
+	if err != nil {
+		t.Fatalf("FormatGoldenCases: %v", err)
+	}
+	for _, tc := range cases {
+		t.Run(tc.Name, func(t *testing.T) {
+			t.Parallel()
+
+			input := testutil.ReadFile(t, tc.InputPath)
+			f := NewIncremental()
+			f.verifyEvery = 0
+			for i, src := range incrementalEditSequence(t, input) {
+				stats := assertIncrementalMatchesDocument(t, f, src)
+				if i == 1 && stats.segments > 2 && stats.reused == 0 {
+					t.Fatalf("version %d reused no segments out of %d", i, stats.segments)
+				}
+				if i == 3 && stats.reused == 0 {
+					t.Fatalf("version %d reused no segments out of %d", i, stats.segments)
+				}
+			}
+		})
+	}
+}
+
+// incrementalEditSequence returns successive versions of src: an inserted
+// declaration, a removed first declaration, a reindented one, and src again.
+func incrementalEditSequence(t *testing.T, src []byte) [][]byte {
+	t.Helper()
+
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "seq.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+
+	versions := [][]byte{src}
+	decls := tree.TopLevelDeclarationIDs()
+	if len(decls) < 2 {
+		return append(versions, src)
+	}
+	first := tree.NodeByID(decls[0]).Span
+	second := tree.NodeByID(decls[1]).Span
+	insert := []byte("struct Inserted {1:string a}\n\n")
+	versions = append(versions,
+		concatBytes(src[:second.Start], insert, src[second.Start:]),
+		concatBytes(src[:first.Start], src[first.End:]),
+		concatBytes(src[:second.Start], []byte("   "), src[second.Start:]),
+		src,
+	)
+	return versions
+}
+
+func assertIncrementalMatchesDocument(t *testing.T, f *Incremental, src []byte) incrementalFormatStats {
+	t.Helper()
+
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "seq.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+
+	want, wantErr := Document(context.Background(), tree, Options{})
+	got, stats, err := f.document(context.Background(), tree, Options{})
+	if (err != nil) != (wantErr != nil) {
+		t.Fatalf("incremental error = %v, full error = %v", err, wantErr)
+	}
+	if string(got.Output) != string(want.Output) || got.Changed != want.Changed {
+		t.Fatalf("incremental output mismatch\n--- got ---\n%s\n--- want ---\n%s", got.Output, want.Output)
+	}
+	return stats
+}
+
+func concatBytes(parts ...[]byte) []byte {
+	var out []byte
+	for _, p := range parts {
+		out = append(out, p...)
+	}
+	return out
+}
+
+func TestParallelFormatMatchesSequential(t *testing.T) {
+	t.Parallel()
+
+	cases, err := testutil.FormatGoldenCases()
+	if err != nil {
+		t.Fatalf("FormatGoldenCases: %v", err)
+	}
+	inputs := map[string][]byte{
+		"generated": generatedDeclarations(500, "\n"),
+		"crlf_bom":  append([]byte(utf8BOM), generatedDeclarations(200, "\r\n")...),
+	}
+	for _, tc := range cases {
+		inputs[tc.Name] = testutil.ReadFile(t, tc.InputPath)
+	}
+	for name, src := range inputs {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "parallel.thrift"})
+			if err != nil {
+				t.Fatalf("Parse: %v", err)
+			}
+			defer tree.Close()
+			opts, policy, _, err := prepareFormatting(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("prepareFormatting: %v", err)
+			}
+
+			want, err := formatSyntaxTree(tree, opts, policy)
+			if err != nil {
+				t.Fatalf("formatSyntaxTree: %v", err)
+			}
+			got, err := formatSyntaxTreeParallel(tree, opts, policy, 4)
+			if err != nil {
+				t.Fatalf("formatSyntaxTreeParallel: %v", err)
+			}
+			if string(got) != string(want) {
+				t.Fatalf("parallel output mismatch\n--- got ---\n%s\n--- want ---\n%s", got, want)
+			}
+		})
+	}
+}
+
+func TestDocumentToMatchesDocument(t *testing.T) {
+	t.Parallel()
+
+	cases, err := testutil.FormatGoldenCases()
+	if err != nil {
+		t.Fatalf("FormatGoldenCases: %v", err)
+	}
+	generated := generatedDeclarations(2000, "\n")
+	inputs := map[string][]byte{
+		"generated": generated,
+		"crlf_bom":  append([]byte(utf8BOM), generatedDeclarations(200, "\r\n")...),
+	}
+	for _, tc := range cases {
+		inputs[tc.Name] = testutil.ReadFile(t, tc.InputPath)
+		inputs[tc.Name+"/expected"] = testutil.ReadFile(t, tc.ExpectedPath)
+	}
+	for name, src := range inputs {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "stream.thrift"})
+			if err != nil {
+				t.Fatalf("Parse: %v", err)
+			}
+			defer tree.Close()
+
+			want, err := Document(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("Document: %v", err)
+			}
+			var got chunkRecorder
+			res, err := DocumentTo(context.Background(), tree, Options{}, &got)
+			if err != nil {
+				t.Fatalf("DocumentTo: %v", err)
+			}
+			if string(got.buf) != string(want.Output) {
+				t.Fatalf("streamed output mismatch\n--- got ---\n%s\n--- want ---\n%s", got.buf, want.Output)
+			}
+			if res.Changed != want.Changed || res.Output != nil {
+				t.Fatalf("DocumentTo result = {Changed: %v, Output: %d bytes}, want {Changed: %v, no output}", res.Changed, len(res.Output), want.Changed)
+			}
+			if len(want.Output) > 2*streamFlushBytes && got.writes < 2 {
+				t.Fatalf("%d bytes of output written in %d chunks", len(want.Output), got.writes)
+			}
+		})
+	}
+}
+
+func TestCheckMatchesDocument(t *testing.T) {
+	t.Parallel()
+
+	cases, err := testutil.FormatGoldenCases()
+	if err != nil {
+		t.Fatalf("FormatGoldenCases: %v", err)
+	}
+	formatted := testutil.ReadFile(t, cases[0].ExpectedPath)
+	generated, err := Source(context.Background(), generatedDeclarations(500, "\n"), "generated.thrift", Options{})
+	if err != nil {
+		t.Fatalf("Source: %v", err)
+	}
+	middle := len(generated.Output) / 2
+	inputs := map[string][]byte{
+		"crlf_bom":        append([]byte(utf8BOM), generatedDeclarations(200, "\r\n")...),
+		"trailing_blank":  concatBytes(formatted, []byte("\n\n")),
+		"missing_newline": formatted[:len(formatted)-1],
+		"generated":       generated.Output,
+		"generated_edit":  concatBytes(generated.Output[:middle], []byte(" "), generated.Output[middle:]),
+	}
+	for _, tc := range cases {
+		inputs[tc.Name] = testutil.ReadFile(t, tc.InputPath)
+		inputs[tc.Name+"/expected"] = testutil.ReadFile(t, tc.ExpectedPath)
+	}
+	for name, src := range inputs {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "check.thrift"})
+			if err != nil {
+				t.Fatalf("Parse: %v", err)
+			}
+			defer tree.Close()
+
+			want, err := Document(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("Document: %v", err)
+			}
+			got, err := Check(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("Check: %v", err)
+			}
+			if got.Changed != want.Changed || got.Output != nil {
+				t.Fatalf("Check result = {Changed: %v, Output: %d bytes}, want {Changed: %v, no output}", got.Changed, len(got.Output), want.Changed)
+			}
+			opts, policy, _, err := prepareFormatting(context.Background(), tree, Options{})
+			if err != nil {
+				t.Fatalf("prepareFormatting: %v", err)
+			}
+			if changed, err := verifySyntaxTreeParallel(tree, opts, policy, 4); err != nil || changed != want.Changed {
+				t.Fatalf("verifySyntaxTreeParallel = %v, %v; want %v", changed, err, want.Changed)
+			}
+		})
+	}
+}
+
+type chunkRecorder struct {
+	buf    []byte
+	writes int
+}
+
+func (r *chunkRecorder) Write(p []byte) (int, error) {
+	r.buf = append(r.buf, p...)
+	r.writes++
+	return len(p), nil
+}
+
+func TestBoundaryStatePredictsDeclarationBoundaries(t *testing.T) {
+	t.Parallel()
+
+	src := generatedDeclarations(50, "\n")
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "boundary.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+	opts, policy, _, err := prepareFormatting(context.Background(), tree, Options{})
+	if err != nil {
+		t.Fatalf("prepareFormatting: %v", err)
+	}
+
+	segs := formatSegments(tree)
+	if !segmentsSelfContained(tree, segs) {
+		t.Fatal("segments of a well-formed document are not self-contained")
+	}
+	hints := collectFormatHints(tree, opts)
+	defer hints.release()
+	p := newFormatPass(tree, hints, opts, policy)
+	for _, s := range segs {
+		if s.tokFrom > 0 && p.state() != boundaryState(tree, s.tokFrom-1) {
+			t.Fatalf("state before token %d = %+v, predicted %+v", s.tokFrom, p.state(), boundaryState(tree, s.tokFrom-1))
+		}
+		if err := p.run(s.tokFrom, s.tokTo); err != nil {
+			t.Fatalf("run: %v", err)
+		}
+	}
+}
+
+// generatedDeclarations builds a document mixing every top-level
+// declaration kind, comments between declarations and unformatted spacing.
+func generatedDeclarations(n int, newline string) []byte {
+	var b strings.Builder
+	b.WriteString("namespace go gen\ninclude \"shared.thrift\"\n")
+	for i := range n {
+		switch i % 5 {
+		case 0:
+			fmt.Fprintf(&b, "// struct %d\nstruct S%d {\n  1: string name;\n  2:optional i32 id\n}\n", i, i)
+		case 1:
+			fmt.Fprintf(&b, "enum E%d { A = 1, B = 2 }\n\n\n\n", i)
+		case 2:
+			fmt.Fprintf(&b, "const i32 C%d = %d\nconst i32 D%d = %d\n", i, i, i, i)
+		case 3:
+			fmt.Fprintf(&b, "service Svc%d {\n  void ping(1: i32 id, 2: string a_very_long_argument_name_that_forces_wrapping, 3: string another_long_argument_name)\n}\n", i)
+		default:
+			fmt.Fprintf(&b, "typedef list<S%d> L%d # trailing\n", i-4, i)
+		}
+	}
+	return []byte(strings.ReplaceAll(b.String(), "\n", newline))
+}
@@ -0,0 +1,274 @@
+package format
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"hash/maphash"
+	"sync"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// incrementalFormatVerificationEvery is how often Incremental also formats the
+// whole document from scratch and compares. That costs one cold format, so
+// every 64th run adds under 2% on average, while a stale cache entry still
+// surfaces within a short editing session.
+var incrementalFormatVerificationEvery uint64 = 64
+
+// Incremental formats successive versions of one document. The formatted
+// bytes of each top-level declaration, together with the trivia before it,
+// are cached under a structural hash of its nodes and tokens and the writer
+// state it starts from. After an edit only changed declarations, and
+// neighbours whose spacing context changed, collect hints and go through the
+// token writer again. Output is byte-identical to Document. Calls are
+// serialized.
+type Incremental struct {
+	mu          sync.Mutex
+	seed        maphash.Seed
+	opts        Options
+	newline     string
+	bom         bool
+	segments    map[uint64]formattedSegment
+	runs        uint64
+	verifyEvery uint64
+	scratch     []byte
+}
+
+// formattedSegment is the cached output of one declaration segment and the
+// pass state it leaves behind.
+type formattedSegment struct {
+	out  []byte
+	exit formatPassState
+}
+
+// incrementalFormatStats describes one incremental format run.
+type incrementalFormatStats struct {
+	segments           int
+	reused             int
+	verificationRun    bool
+	verificationFailed bool
+}
+
+// NewIncremental builds an empty incremental formatter.
+func NewIncremental() *Incremental {
+	return &Incremental{
+		seed:        maphash.MakeSeed(),
+		segments:    make(map[uint64]formattedSegment),
+		verifyEvery: incrementalFormatVerificationEvery,
+	}
+}
+
+// Document formats tree like Document, reusing declarations formatted by
+// earlier calls.
+func (f *Incremental) Document(ctx context.Context, tree *syntax.Tree, opts Options) (Result, error) {
+	res, _, err := f.document(ctx, tree, opts)
+	return res, err
+}
+
+// DocumentEdits formats tree like DocumentEdits, reusing declarations
+// formatted by earlier calls.
+func (f *Incremental) DocumentEdits(ctx context.Context, tree *syntax.Tree, opts Options) (RangeResult, error) {
+	res, _, err := f.document(ctx, tree, opts)
+	if err != nil {
+		return RangeResult{Diagnostics: res.Diagnostics}, err
+	}
+	return documentEdits(tree, res), nil
+}
+
+func (f *Incremental) document(ctx context.Context, tree *syntax.Tree, opts Options) (Result, incrementalFormatStats, error) {
+	var stats incrementalFormatStats
+	normOpts, policy, diags, err := prepareFormatting(ctx, tree, opts)
+	if err != nil {
+		return Result{Diagnostics: diags}, stats, err
+	}
+
+	f.mu.Lock()
+	defer f.mu.Unlock()
+
+	if normOpts != f.opts || policy.Newline != f.newline || policy.HasBOM != f.bom {
+		f.opts, f.newline, f.bom = normOpts, policy.Newline, policy.HasBOM
+		clear(f.segments)
+	}
+	out, err := f.format(tree, normOpts, policy, &stats)
+	if err != nil {
+		return Result{}, stats, err
+	}
+
+	f.runs++
+	if f.verifyEvery != 0 && f.runs%f.verifyEvery == 0 {
+		stats.verificationRun = true
+		full, err := formatSyntaxTree(tree, normOpts, policy)
+		if err != nil {
+			return Result{}, stats, err
+		}
+		if !bytes.Equal(out, full) {
+			// Some cached segment was wrong; forget them all and use the
+			// full output.
+			stats.verificationFailed = true
+			clear(f.segments)
+			out = full
+		}
+	}
+	return Result{
+		Output:      out,
+		Changed:     !bytes.Equal(out, tree.Source),
+		Diagnostics: diags,
+	}, stats, nil
+}
+
+// format runs the token writer segment by segment. Segment k covers the
+// tokens from the first token of top-level declaration k up to the next
+// declaration; the first segment also takes any tokens before it and the
+// last one the EOF token.
+func (f *Incremental) format(tree *syntax.Tree, opts Options, policy SourcePolicy, stats *incrementalFormatStats) ([]byte, error) {
+	if len(tree.Tokens) == 0 || tree.Root == syntax.NoNode {
+		return formatSyntaxTree(tree, opts, policy)
+	}
+	hints := acquireFormatHints(len(tree.Tokens))
+	defer hints.release()
+	addTopLevelBreakHints(tree, hints)
+	p := newFormatPass(tree, hints, opts, policy)
+
+	segs := formatSegments(tree)
+	next := make(map[uint64]formattedSegment, len(segs))
+	for _, s := range segs {
+		key := f.segmentHash(tree, hints, s, p.state())
+		stats.segments++
+		if seg, ok := f.segments[key]; ok {
+			stats.reused++
+			p.w.buf.Write(seg.out)
+			p.restore(seg.exit)
+			next[key] = seg
+			continue
+		}
+		addNodeHints(tree, opts, hints, s.nodeFrom, s.nodeTo)
+		start := p.w.buf.Len()
+		if err := p.run(s.tokFrom, s.tokTo); err != nil {
+			return nil, err
+		}
+		next[key] = formattedSegment{
+			out:  bytes.Clone(p.w.buf.Bytes()[start:]),
+			exit: p.state(),
+		}
+	}
+	f.segments = next
+	return bytes.Clone(p.w.finish()), nil
+}
+
+// formatSegment is the token and node range of one top-level declaration.
+type formatSegment struct {
+	tokFrom, tokTo   int
+	nodeFrom, nodeTo int
+}
+
+// formatSegments splits tree into one segment per top-level declaration.
+// The first segment also takes the tokens and nodes before its declaration,
+// and the last one the EOF token.
+func formatSegments(tree *syntax.Tree) []formatSegment {
+	segs := []formatSegment{{nodeFrom: 1}}
+	for _, id := range tree.TopLevelDeclarationIDs() {
+		n := tree.NodeByID(id)
+		last := &segs[len(segs)-1]
+		if n == nil || int(n.FirstToken) <= last.tokFrom || int(n.FirstToken) >= len(tree.Tokens) || int(id) <= last.nodeFrom {
+			continue
+		}
+		last.tokTo, last.nodeTo = int(n.FirstToken), int(id)
+		segs = append(segs, formatSegment{tokFrom: int(n.FirstToken), nodeFrom: int(id)})
+	}
+	last := &segs[len(segs)-1]
+	last.tokTo, last.nodeTo = len(tree.Tokens), len(tree.Nodes)
+	return segs
+}
+
+// segmentHash fingerprints everything hint collection and the token writer
+// read while formatting one segment: the entry state, the source bytes, the
+// token, trivia and node layout relative to the segment start, the
+// top-level break hint, and whether the token after the segment starts with
+// a comment.
+func (f *Incremental) segmentHash(tree *syntax.Tree, hints *formatHints, s formatSegment, entry formatPassState) uint64 {
+	buf := f.scratch[:0]
+	buf = appendPassState(buf, entry)
+	if s.tokTo < len(tree.Tokens) && triviaHasComment(tree.Tokens[s.tokTo].Leading) {
+		buf = append(buf, 1)
+	} else {
+		buf = append(buf, 0)
+	}
+
+	start := segmentStart(tree, s.tokFrom)
+	end := text.ByteOffset(len(tree.Source))
+	if s.tokTo < len(tree.Tokens) {
+		end = segmentStart(tree, s.tokTo)
+	}
+	for i := s.tokFrom; i < s.tokTo; i++ {
+		tok := &tree.Tokens[i]
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(tok.Kind))
+		buf = append(buf, byte(tok.Flags))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(hints.tokens[i]))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(tok.Span.Start-start))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(tok.Span.End-start))
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(len(tok.Leading)))
+		for _, tr := range tok.Leading {
+			buf = append(buf, byte(tr.Kind))
+			buf = binary.LittleEndian.AppendUint32(buf, uint32(tr.Span.Start-start))
+			buf = binary.LittleEndian.AppendUint32(buf, uint32(tr.Span.End-start))
+		}
+	}
+	for i := s.nodeFrom; i < s.nodeTo; i++ {
+		if syntax.NodeID(i) == tree.Root {
+			// The root spans the whole document and yields no hints.
+			continue
+		}
+		n := &tree.Nodes[i]
+		parent := uint32(0)
+		if int(n.Parent) >= s.nodeFrom {
+			parent = uint32(int(n.Parent) - s.nodeFrom + 1)
+		}
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(n.Kind))
+		buf = append(buf, byte(n.Flags))
+		buf = binary.LittleEndian.AppendUint32(buf, parent)
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(int(n.FirstToken)-s.tokFrom))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(int(n.LastToken)-s.tokFrom))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(n.Span.Start-start))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(n.Span.End-start))
+	}
+	f.scratch = buf
+
+	var h maphash.Hash
+	h.SetSeed(f.seed)
+	_, _ = h.Write(buf)
+	if start <= end && int(end) <= len(tree.Source) {
+		_, _ = h.Write(tree.Source[start:end])
+	}
+	return h.Sum64()
+}
+
+// segmentStart is the source offset where token i's leading trivia begins.
+func segmentStart(tree *syntax.Tree, i int) text.ByteOffset {
+	if i == 0 {
+		return 0
+	}
+	tok := &tree.Tokens[i]
+	if len(tok.Leading) > 0 {
+		return tok.Leading[0].Span.Start
+	}
+	return tok.Span.Start
+}
+
+func appendPassState(buf []byte, st formatPassState) []byte {
+	var flags byte
+	if st.atLineStart {
+		flags |= 1
+	}
+	if st.pendingSpace {
+		flags |= 2
+	}
+	if st.havePrev {
+		flags |= 4
+	}
+	buf = append(buf, flags)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(st.pendingBreaks))
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(st.indentLevel))
+	return binary.LittleEndian.AppendUint16(buf, uint16(st.prevKind))
+}
@@ -0,0 +1,164 @@
+package format
+
+import (
+	"bytes"
+	"runtime"
+	"sync"
+	"sync/atomic"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// parallelFormatMinTokens is the token count from which Document formats
+// top-level declarations concurrently.
+var parallelFormatMinTokens = 1 << 16
+
+// parallelChunksPerWorker splits the document finer than the worker count so
+// uneven declarations still balance.
+const parallelChunksPerWorker = 4
+
+// formattedChunk is the output of a run of segments formatted from a
+// predicted entry state.
+type formattedChunk struct {
+	out   []byte
+	entry formatPassState
+	exit  formatPassState
+	err   error
+}
+
+// formatSyntaxTreeParallel formats tree like formatSyntaxTree, splitting it
+// at top-level declarations into chunks formatted concurrently. Each chunk
+// starts from the state a declaration boundary normally leaves behind: indent
+// 0, no pending layout, after the previous declaration's last token. Chunks
+// are joined in order, and a chunk whose prediction does not match the real
+// state at its start is formatted again in sequence, so the output is
+// identical to the sequential formatter.
+func formatSyntaxTreeParallel(tree *syntax.Tree, opts Options, policy SourcePolicy, workers int) ([]byte, error) {
+	if workers <= 1 || tree == nil || len(tree.Tokens) == 0 || tree.Root == syntax.NoNode {
+		return formatSyntaxTree(tree, opts, policy)
+	}
+	segs := formatSegments(tree)
+	if len(segs) < 2 || !segmentsSelfContained(tree, segs) {
+		return formatSyntaxTree(tree, opts, policy)
+	}
+
+	hints := acquireFormatHints(len(tree.Tokens))
+	defer hints.release()
+	addTopLevelBreakHints(tree, hints)
+
+	chunks := chunkSegments(segs, workers*parallelChunksPerWorker)
+	results := make([]formattedChunk, len(chunks))
+	forEachChunk(workers, len(chunks), func(i int) {
+		results[i] = formatChunk(tree, hints, opts, policy, chunks[i])
+	})
+
+	p := newFormatPass(tree, hints, opts, policy)
+	for i, c := range chunks {
+		r := &results[i]
+		if r.err == nil && r.entry == p.state() {
+			p.w.buf.Write(r.out)
+			p.restore(r.exit)
+			continue
+		}
+		if err := p.run(c.tokFrom, c.tokTo); err != nil {
+			return nil, err
+		}
+	}
+	return bytes.Clone(p.w.finish()), nil
+}
+
+// forEachChunk calls fn for chunks [0, n) on up to workers goroutines.
+func forEachChunk(workers, n int, fn func(i int)) {
+	var (
+		next atomic.Int64
+		wg   sync.WaitGroup
+	)
+	for range min(workers, n) {
+		wg.Go(func() {
+			for {
+				i := int(next.Add(1) - 1)
+				if i >= n {
+					return
+				}
+				fn(i)
+			}
+		})
+	}
+	wg.Wait()
+}
+
+// formatChunk formats one chunk from the predicted state at its start.
+func formatChunk(tree *syntax.Tree, hints *formatHints, opts Options, policy SourcePolicy, c formatSegment) formattedChunk {
+	p := newChunkPass(tree, hints, opts, policy, c)
+	entry := p.state()
+	if err := p.run(c.tokFrom, c.tokTo); err != nil {
+		return formattedChunk{err: err}
+	}
+	return formattedChunk{out: p.w.buf.Bytes(), entry: entry, exit: p.state()}
+}
+
+// newChunkPass collects the hints of one chunk and returns a pass in the
+// predicted state at its start.
+func newChunkPass(tree *syntax.Tree, hints *formatHints, opts Options, policy SourcePolicy, c formatSegment) *formatPass {
+	addNodeHints(tree, opts, hints, c.nodeFrom, c.nodeTo)
+	p := newFormatPass(tree, hints, opts, SourcePolicy{Newline: policy.Newline})
+	switch {
+	case c.tokFrom > 0:
+		p.restore(boundaryState(tree, c.tokFrom-1))
+	case policy.HasBOM:
+		// The joining pass writes the BOM itself.
+		p.w.atLineStart = false
+	}
+	return p
+}
+
+// boundaryState predicts the pass state after the last token of a
+// well-formed top-level declaration. It must not read hints, which other
+// workers may still be writing.
+func boundaryState(tree *syntax.Tree, last int) formatPassState {
+	return formatPassState{prevKind: tree.Tokens[last].Kind, havePrev: true}
+}
+
+// chunkSegments groups consecutive segments into at most n chunks of
+// roughly equal token counts.
+func chunkSegments(segs []formatSegment, n int) []formatSegment {
+	total := segs[len(segs)-1].tokTo
+	size := max(total/max(n, 1), 1)
+	out := make([]formatSegment, 0, n)
+	cur := segs[0]
+	for _, s := range segs[1:] {
+		if cur.tokTo-cur.tokFrom >= size {
+			out = append(out, cur)
+			cur = s
+			continue
+		}
+		cur.tokTo, cur.nodeTo = s.tokTo, s.nodeTo
+	}
+	return append(out, cur)
+}
+
+// segmentsSelfContained reports whether every node lies within the tokens of
+// its segment, so segments can collect hints concurrently without touching
+// each other's tokens.
+func segmentsSelfContained(tree *syntax.Tree, segs []formatSegment) bool {
+	for _, s := range segs {
+		for i := s.nodeFrom; i < s.nodeTo; i++ {
+			if syntax.NodeID(i) == tree.Root {
+				continue
+			}
+			n := &tree.Nodes[i]
+			if int(n.FirstToken) < s.tokFrom || int(n.LastToken) >= s.tokTo || n.LastToken < n.FirstToken {
+				return false
+			}
+		}
+	}
+	return true
+}
+
+// formatWorkers is the number of workers Document uses for tree.
+func formatWorkers(tree *syntax.Tree) int {
+	if tree == nil || len(tree.Tokens) < parallelFormatMinTokens {
+		return 1
+	}
+	return runtime.GOMAXPROCS(0)
+}
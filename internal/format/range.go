@@ -1,8 +1,11 @@
 package format
 
 import (
+	"bytes"
+	"cmp"
 	"errors"
 	"fmt"
+	"slices"
 
 	"github.com/kpumuk/thrift-weaver/internal/lexer"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
@@ -21,23 +24,7 @@ func findRangeFormatAncestor(tree *syntax.Tree, r text.Span) (syntax.NodeID, syn
 		return syntax.NoNode, syntax.Diagnostic{}, errors.New("nil syntax tree")
 	}
 
-	best := syntax.NoNode
-	bestLen := text.ByteOffset(-1)
-	for i := 1; i < len(tree.Nodes); i++ {
-		id := syntax.NodeID(i)
-		n := tree.NodeByID(id)
-		if n == nil || !isFormatSafeAncestorKind(syntax.KindName(n.Kind)) {
-			continue
-		}
-		if !nodeContainsRange(n, r) {
-			continue
-		}
-		if best == syntax.NoNode || n.Span.Len() < bestLen {
-			best = id
-			bestLen = n.Span.Len()
-		}
-	}
-
+	best := smallestFormatSafeAncestor(tree, r)
 	if best == syntax.NoNode {
 		return rangeBlockingFailure(
 			DiagnosticFormatterRangeNoSafeAncestor,
@@ -64,20 +51,42 @@ func findRangeFormatAncestor(tree *syntax.Tree, r text.Span) (syntax.NodeID, syn
 	return best, syntax.Diagnostic{}, nil
 }
 
-func formatNodeRange(tree *syntax.Tree, id syntax.NodeID, opts Options, policy SourcePolicy) ([]byte, error) {
-	n := tree.NodeByID(id)
-	if n == nil {
-		return nil, fmt.Errorf("range ancestor node %d not found", id)
+// formatNodeRanges formats non-overlapping nodes in source order with one
+// hint collection and returns an edit for each node whose output differs.
+func formatNodeRanges(tree *syntax.Tree, ids []syntax.NodeID, opts Options, policy SourcePolicy) ([]text.ByteEdit, error) {
+	if len(ids) == 0 {
+		return nil, nil
+	}
+	hints := collectFormatHints(tree, opts)
+	defer hints.release()
+	indent := indentTracker{hints: hints}
+
+	var edits []text.ByteEdit
+	for _, id := range ids {
+		n := tree.NodeByID(id)
+		if n == nil {
+			return nil, fmt.Errorf("range ancestor node %d not found", id)
+		}
+		out, err := formatNodeRange(tree, n, hints, indent.before(n.FirstToken), opts, policy)
+		if err != nil {
+			return nil, err
+		}
+		if bytes.Equal(out, tree.Source[n.Span.Start:n.Span.End]) {
+			continue
+		}
+		edits = append(edits, text.ByteEdit{Span: n.Span, NewText: out})
 	}
+	return edits, nil
+}
+
+func formatNodeRange(tree *syntax.Tree, n *syntax.Node, hints *formatHints, indentLevel int, opts Options, policy SourcePolicy) ([]byte, error) {
 	if !hasBoundedTokenCoverage(tree, n) {
-		return nil, fmt.Errorf("node %d does not have bounded token coverage", id)
+		return nil, fmt.Errorf("node %d does not have bounded token coverage", n.ID)
 	}
 	if int(n.FirstToken) >= len(tree.Tokens) || int(n.LastToken) >= len(tree.Tokens) || n.LastToken < n.FirstToken {
-		return nil, fmt.Errorf("node %d token range out of bounds", id)
+		return nil, fmt.Errorf("node %d token range out of bounds", n.ID)
 	}
 
-	hints := collectFormatHints(tree, opts)
-	indentLevel := indentLevelBeforeToken(hints, n.FirstToken)
 	writerAtLineStart := isLineStartOffset(tree.Source, n.Span.Start)
 	w := newTokenWriter(policy.Newline, opts.Indent, opts.MaxBlankLines)
 	w.atLineStart = writerAtLineStart
@@ -94,7 +103,7 @@ func formatNodeRange(tree *syntax.Tree, id syntax.NodeID, opts Options, policy S
 			break
 		}
 
-		if spec, ok := hints.declBlockClose[ti]; ok && spec.HasMembers {
+		if hints.has(ti, hintDeclBlockClose) {
 			if indentLevel > 0 {
 				indentLevel--
 			}
@@ -103,7 +112,7 @@ func formatNodeRange(tree *syntax.Tree, id syntax.NodeID, opts Options, policy S
 			}
 		}
 		if ti != n.FirstToken {
-			if _, ok := hints.memberStart[ti]; ok {
+			if hints.has(ti, hintMemberStart) {
 				w.requestBreaks(1)
 			}
 			// For subtree formatting, top-level blank line spacing is intentionally omitted;
@@ -125,7 +134,7 @@ func formatNodeRange(tree *syntax.Tree, id syntax.NodeID, opts Options, policy S
 		}
 		w.writeRaw(indentLevel, raw)
 
-		if spec, ok := hints.declBlockOpen[ti]; ok && spec.HasMembers {
+		if hints.has(ti, hintDeclBlockOpen) {
 			indentLevel++
 			w.requestBreaks(1)
 		}
@@ -137,20 +146,48 @@ func formatNodeRange(tree *syntax.Tree, id syntax.NodeID, opts Options, policy S
 	return w.finish(), nil
 }
 
-func indentLevelBeforeToken(hints formatHints, startTok uint32) int {
-	level := 0
-	for tok := uint32(0); tok < startTok; {
-		if spec, ok := hints.declBlockClose[tok]; ok && spec.HasMembers {
-			if level > 0 {
-				level--
-			}
+// indentTracker replays block hints to find the indent level before tokens
+// visited in increasing order.
+type indentTracker struct {
+	hints *formatHints
+	next  int
+	level int
+}
+
+func (t *indentTracker) before(tok uint32) int {
+	for end := min(int(tok), len(t.hints.tokens)); t.next < end; t.next++ {
+		hint := t.hints.tokens[t.next]
+		if hint&hintDeclBlockClose != 0 && t.level > 0 {
+			t.level--
 		}
-		if spec, ok := hints.declBlockOpen[tok]; ok && spec.HasMembers {
-			level++
+		if hint&hintDeclBlockOpen != 0 {
+			t.level++
 		}
-		tok++
 	}
-	return level
+	return t.level
+}
+
+// outermostNodes sorts ids by position and drops nodes nested in, or equal
+// to, an earlier one. Node spans never partially overlap.
+func outermostNodes(tree *syntax.Tree, ids []syntax.NodeID) []syntax.NodeID {
+	slices.SortFunc(ids, func(a, b syntax.NodeID) int {
+		sa, sb := tree.NodeByID(a).Span, tree.NodeByID(b).Span
+		if c := cmp.Compare(sa.Start, sb.Start); c != 0 {
+			return c
+		}
+		return cmp.Compare(sb.End, sa.End)
+	})
+	out := ids[:0]
+	var end text.ByteOffset
+	for _, id := range ids {
+		sp := tree.NodeByID(id).Span
+		if len(out) > 0 && sp.Start < end {
+			continue
+		}
+		out = append(out, id)
+		end = sp.End
+	}
+	return out
 }
 
 func hasBoundedTokenCoverage(tree *syntax.Tree, n *syntax.Node) bool {
@@ -181,14 +218,22 @@ func hasBoundedTokenCoverage(tree *syntax.Tree, n *syntax.Node) bool {
 	return true
 }
 
-func nodeContainsRange(n *syntax.Node, r text.Span) bool {
-	if n == nil || !n.Span.IsValid() || !r.IsValid() {
-		return false
+// smallestFormatSafeAncestor returns the smallest format-safe node covering r.
+// An empty r also counts as covered by a node ending at it, so a caret just
+// past a declaration still widens to that declaration.
+func smallestFormatSafeAncestor(tree *syntax.Tree, r text.Span) syntax.NodeID {
+	accept := func(n *syntax.Node) bool {
+		return isFormatSafeAncestorKind(kindName(n.Kind))
+	}
+	best := tree.SmallestNodeCovering(r, accept)
+	if !r.IsEmpty() || r.Start == 0 {
+		return best
 	}
-	if r.IsEmpty() {
-		return n.Span.Start <= r.Start && r.Start <= n.Span.End
+	before := tree.SmallestNodeCovering(text.Span{Start: r.Start - 1, End: r.Start}, accept)
+	if best == syntax.NoNode || (before != syntax.NoNode && tree.NodeByID(before).Span.Len() < tree.NodeByID(best).Span.Len()) {
+		return before
 	}
-	return n.Span.ContainsSpan(r)
+	return best
 }
 
 func isFormatSafeAncestorKind(kind string) bool {
@@ -110,6 +110,49 @@ func TestRangeRefusesWhenNoSafeAncestorExists(t *testing.T) {
 	}
 }
 
+func TestRangesMergesNestedAncestorsAndSkipsUnsafeRanges(t *testing.T) {
+	t.Parallel()
+
+	src := []byte("struct A{1:i32 a;2:i32 b}\n\nstruct B{1:i32 c(x='y')}\n")
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "x.thrift"})
+	if err != nil {
+		t.Fatalf("Parse: %v", err)
+	}
+	at := func(needle string, n int) text.Span {
+		t.Helper()
+		i := bytes.Index(src, []byte(needle))
+		if i < 0 {
+			t.Fatalf("failed to find %q", needle)
+		}
+		return text.Span{Start: text.ByteOffset(i), End: text.ByteOffset(i + n)}
+	}
+	blank := bytes.Index(src, []byte("\n\n")) + 1
+
+	got, err := Ranges(context.Background(), tree, []text.Span{
+		at("x=", 1),
+		at("{1:i32 a", 1),
+		at("2:i32", 5),
+		{Start: text.ByteOffset(blank), End: text.ByteOffset(blank + 1)},
+	}, Options{})
+	if err != nil {
+		t.Fatalf("Ranges: %v", err)
+	}
+	if len(got.Edits) != 2 {
+		t.Fatalf("expected 2 edits, got %+v", got.Edits)
+	}
+	out, err := text.ApplyEdits(src, got.Edits)
+	if err != nil {
+		t.Fatalf("ApplyEdits: %v", err)
+	}
+	want := []byte("struct A{\n  1: i32 a;\n  2: i32 b\n}\n\nstruct B{1:i32 c(x = 'y')}\n")
+	if !bytes.Equal(out, want) {
+		t.Fatalf("ranges formatted output mismatch\n--- got ---\n%s\n--- want ---\n%s", out, want)
+	}
+	if len(got.Diagnostics) != 1 || got.Diagnostics[0].Code != DiagnosticFormatterRangeNoSafeAncestor {
+		t.Fatalf("expected one %q diagnostic, got %+v", DiagnosticFormatterRangeNoSafeAncestor, got.Diagnostics)
+	}
+}
+
 func TestRangeRefusesUnboundedAncestorCoverage(t *testing.T) {
 	t.Parallel()
 
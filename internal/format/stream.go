@@ -0,0 +1,85 @@
+package format
+
+import (
+	"bytes"
+	"context"
+	"io"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// streamFlushBytes is how much formatted output DocumentTo buffers before
+// handing it to the destination writer.
+const streamFlushBytes = 64 << 10
+
+// DocumentTo formats a full syntax tree like Document, writing the output to
+// dst in chunks as it is produced instead of returning it. Result.Output is
+// left empty; Result.Changed is computed by comparing each chunk against the
+// source on the fly. Output memory stays bounded by the flush size, although
+// the tree and its per-token hints are still held in memory. On error dst may
+// have received partial output.
+func DocumentTo(ctx context.Context, tree *syntax.Tree, opts Options, dst io.Writer) (Result, error) {
+	normOpts, policy, diags, err := prepareFormatting(ctx, tree, opts)
+	if err != nil {
+		return Result{Diagnostics: diags}, err
+	}
+
+	sink := &streamSink{dst: dst, src: tree.Source}
+	if err := streamSyntaxTree(tree, normOpts, policy, sink); err != nil {
+		return Result{}, err
+	}
+	return Result{Changed: sink.changed(), Diagnostics: diags}, nil
+}
+
+// streamSyntaxTree runs formatSyntaxTree, flushing the writer buffer to sink
+// whenever it grows past streamFlushBytes.
+func streamSyntaxTree(tree *syntax.Tree, opts Options, policy SourcePolicy, sink *streamSink) error {
+	if len(tree.Tokens) == 0 || tree.Root == syntax.NoNode {
+		return sink.write(tree.Source)
+	}
+
+	hints := collectFormatHints(tree, opts)
+	defer hints.release()
+	p := newFormatPass(tree, hints, opts, policy)
+	p.sink = sink
+	if err := p.run(0, len(tree.Tokens)); err != nil {
+		return err
+	}
+	return sink.write(p.w.finish())
+}
+
+// streamSink forwards formatted chunks to a writer and tracks whether the
+// concatenated output still matches the source.
+type streamSink struct {
+	dst     io.Writer
+	src     []byte
+	off     int
+	differs bool
+}
+
+func (s *streamSink) write(chunk []byte) error {
+	if len(chunk) == 0 {
+		return nil
+	}
+	if !s.differs {
+		end := s.off + len(chunk)
+		s.differs = end > len(s.src) || !bytes.Equal(chunk, s.src[s.off:end])
+	}
+	s.off += len(chunk)
+	_, err := s.dst.Write(chunk)
+	return err
+}
+
+func (s *streamSink) changed() bool {
+	return s.differs || s.off != len(s.src)
+}
+
+// flush hands the buffered output of p to its sink once it is large enough.
+func (p *formatPass) flush() error {
+	if p.sink == nil || p.w.buf.Len() < streamFlushBytes {
+		return nil
+	}
+	err := p.sink.write(p.w.buf.Bytes())
+	p.w.buf.Reset()
+	return err
+}
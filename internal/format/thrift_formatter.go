@@ -5,30 +5,76 @@ import (
 	"errors"
 	"fmt"
 	"strings"
+	"sync"
+	"sync/atomic"
 
 	"github.com/kpumuk/thrift-weaver/internal/lexer"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
 )
 
+// tokenHint packs the formatting hints of one token. The low bits are flags;
+// the bits from hintBreaksShift up hold the blank-line break count requested
+// before a top-level declaration other than the first.
+type tokenHint uint32
+
+const (
+	hintTopLevelBreak tokenHint = 1 << iota
+	hintMemberStart
+	hintWrapListStart
+	hintWrapListOpen
+	hintWrapListClose
+	hintDeclBlockOpen // opens a block with members
+	hintDeclBlockClose
+	hintOmitSeparator
+	hintForceComma
+	hintInsertCommaAfter
+
+	hintBreaksShift = 16
+	hintMaxBreaks   = 1<<(32-hintBreaksShift) - 1
+)
+
+// formatHints holds one tokenHint per token of the tree being formatted.
 type formatHints struct {
-	topLevelStart    map[uint32]int
-	topLevelBreaks   map[uint32]int
-	memberStart      map[uint32]struct{}
-	wrapListStart    map[uint32]struct{}
-	wrapListOpen     map[uint32]struct{}
-	wrapListClose    map[uint32]struct{}
-	declBlockOpen    map[uint32]declBlockSpec
-	declBlockClose   map[uint32]declBlockSpec
-	omitSeparatorTok map[uint32]struct{}
-	forceCommaTok    map[uint32]struct{}
-	insertCommaAfter map[uint32]struct{}
-}
-
-func (h formatHints) topLevelBreakCount(tok uint32) int {
-	if breaks, ok := h.topLevelBreaks[tok]; ok {
-		return breaks
+	tokens []tokenHint
+}
+
+var formatHintsPool = sync.Pool{New: func() any { return new(formatHints) }}
+
+func acquireFormatHints(n int) *formatHints {
+	h := formatHintsPool.Get().(*formatHints)
+	if cap(h.tokens) < n {
+		h.tokens = make([]tokenHint, n)
+	} else {
+		h.tokens = h.tokens[:n]
+		clear(h.tokens)
+	}
+	return h
+}
+
+// release returns h to the pool; h must not be used afterwards.
+func (h *formatHints) release() {
+	formatHintsPool.Put(h)
+}
+
+func (h *formatHints) has(tok uint32, flag tokenHint) bool {
+	return int(tok) < len(h.tokens) && h.tokens[tok]&flag != 0
+}
+
+func (h *formatHints) set(tok uint32, flag tokenHint) {
+	if int(tok) < len(h.tokens) {
+		h.tokens[tok] |= flag
+	}
+}
+
+func (h *formatHints) setTopLevelBreaks(tok uint32, breaks int) {
+	if int(tok) < len(h.tokens) {
+		hint := h.tokens[tok] &^ (hintMaxBreaks << hintBreaksShift)
+		h.tokens[tok] = hint | hintTopLevelBreak | tokenHint(min(max(breaks, 0), hintMaxBreaks))<<hintBreaksShift
 	}
-	return 2
+}
+
+func (h *formatHints) topLevelBreakCount(tok uint32) int {
+	return int(h.tokens[tok] >> hintBreaksShift)
 }
 
 type declBlockSpec struct {
@@ -36,11 +82,31 @@ type declBlockSpec struct {
 	HasMembers bool
 }
 
+func (h *formatHints) addDeclBlock(openTok uint32, spec declBlockSpec) {
+	if !spec.HasMembers {
+		return
+	}
+	h.set(openTok, hintDeclBlockOpen)
+	h.set(spec.CloseToken, hintDeclBlockClose)
+}
+
 type tokenWriter struct {
-	buf           bytes.Buffer
+	buf bytes.Buffer
+	// verify, when verifying is set, is the source the output is compared
+	// against instead of being written to buf. off is how much of it the
+	// output has matched, and differs is set at the first mismatch.
+	verify        []byte
+	off           int
+	verifying     bool
+	differs       bool
 	newline       string
 	indent        string
 	maxBlankLines int
+	writerState
+}
+
+// writerState is the pending layout of a tokenWriter.
+type writerState struct {
 	atLineStart   bool
 	pendingSpace  bool
 	pendingBreaks int
@@ -51,8 +117,63 @@ func newTokenWriter(newline, indent string, maxBlankLines int) *tokenWriter {
 		newline:       newline,
 		indent:        indent,
 		maxBlankLines: maxBlankLines,
-		atLineStart:   true,
+		writerState:   writerState{atLineStart: true},
+	}
+}
+
+// startVerify switches w to comparing its output against src from off on.
+// Output already in buf is compared first.
+func (w *tokenWriter) startVerify(src []byte, off int) {
+	w.verify, w.off, w.verifying = src, off, true
+	pending := w.buf.Bytes()
+	w.buf.Reset()
+	w.write(pending)
+}
+
+func (w *tokenWriter) write(b []byte) {
+	if !w.verifying {
+		w.buf.Write(b)
+		return
+	}
+	end := w.off + len(b)
+	if w.differs || end > len(w.verify) || !bytes.Equal(w.verify[w.off:end], b) {
+		w.differs = true
+		return
+	}
+	w.off = end
+}
+
+func (w *tokenWriter) writeString(s string) {
+	if !w.verifying {
+		w.buf.WriteString(s)
+		return
 	}
+	end := w.off + len(s)
+	if w.differs || end > len(w.verify) || string(w.verify[w.off:end]) != s {
+		w.differs = true
+		return
+	}
+	w.off = end
+}
+
+func (w *tokenWriter) writeRepeat(s string, count int) {
+	for range count {
+		w.writeString(s)
+	}
+}
+
+// changed reports whether verified output differs from the source; it is
+// valid after finish.
+func (w *tokenWriter) changed() bool {
+	return w.differs || w.off != len(w.verify)
+}
+
+func (w *tokenWriter) state() writerState {
+	return w.writerState
+}
+
+func (w *tokenWriter) restore(st writerState) {
+	w.writerState = st
 }
 
 func (w *tokenWriter) requestSpace() {
@@ -79,20 +200,18 @@ func (w *tokenWriter) addBreak() {
 
 func (w *tokenWriter) flushBeforeContent(indentLevel int) {
 	if w.pendingBreaks > 0 {
-		w.buf.WriteString(repeatString(w.newline, w.cappedBreaks()))
+		w.writeRepeat(w.newline, w.cappedBreaks())
 		w.atLineStart = true
 		w.pendingBreaks = 0
 	}
 	if w.atLineStart {
-		if indentLevel > 0 {
-			w.buf.WriteString(repeatString(w.indent, indentLevel))
-		}
+		w.writeRepeat(w.indent, indentLevel)
 		w.atLineStart = false
 		w.pendingSpace = false
 		return
 	}
 	if w.pendingSpace {
-		w.buf.WriteByte(' ')
+		w.writeString(" ")
 		w.pendingSpace = false
 	}
 }
@@ -102,7 +221,7 @@ func (w *tokenWriter) writeRaw(indentLevel int, raw []byte) {
 		return
 	}
 	w.flushBeforeContent(indentLevel)
-	w.buf.Write(raw)
+	w.write(raw)
 	w.pendingSpace = false
 	w.atLineStart = endsWithLineBreak(raw)
 }
@@ -134,7 +253,7 @@ func (w *tokenWriter) emitLeadingTrivia(src []byte, trivia []lexer.Trivia, inden
 
 func (w *tokenWriter) finish() []byte {
 	if w.pendingBreaks > 0 {
-		w.buf.WriteString(repeatString(w.newline, w.cappedBreaks()))
+		w.writeRepeat(w.newline, w.cappedBreaks())
 		w.pendingBreaks = 0
 		w.pendingSpace = false
 		w.atLineStart = true
@@ -155,109 +274,148 @@ func formatSyntaxTree(tree *syntax.Tree, opts Options, policy SourcePolicy) ([]b
 	}
 
 	hints := collectFormatHints(tree, opts)
+	defer hints.release()
+	p := newFormatPass(tree, hints, opts, policy)
+	if err := p.run(0, len(tree.Tokens)); err != nil {
+		return nil, err
+	}
+	return bytes.Clone(p.w.finish()), nil
+}
+
+// formatPass writes the formatted tokens of a tree, in order.
+type formatPass struct {
+	tree  *syntax.Tree
+	hints *formatHints
+	w     *tokenWriter
+	sink  *streamSink
+	formatPassState
+}
+
+// formatPassState is everything carried from one token to the next; a token
+// range formats the same way whenever it starts from the same state.
+type formatPassState struct {
+	writerState
+	indentLevel int
+	prevKind    lexer.TokenKind
+	havePrev    bool
+}
+
+func newFormatPass(tree *syntax.Tree, hints *formatHints, opts Options, policy SourcePolicy) *formatPass {
 	w := newTokenWriter(policy.Newline, opts.Indent, opts.MaxBlankLines)
 	if policy.HasBOM {
-		w.buf.WriteString(utf8BOM)
+		w.writeString(utf8BOM)
 		w.atLineStart = false
 	}
+	return &formatPass{tree: tree, hints: hints, w: w}
+}
+
+func (p *formatPass) state() formatPassState {
+	st := p.formatPassState
+	st.writerState = p.w.state()
+	return st
+}
 
-	indentLevel := 0
-	var prevKind lexer.TokenKind
-	var havePrev bool
+func (p *formatPass) restore(st formatPassState) {
+	p.formatPassState = st
+	p.w.restore(st.writerState)
+}
 
-	for i := range tree.Tokens {
+// run formats tokens [from, to). The EOF token flushes the trailing trivia.
+func (p *formatPass) run(from, to int) error {
+	tree, hints, w := p.tree, p.hints, p.w
+	for i := from; i < to; i++ {
 		idx := uint32(i)
 		tok := tree.Tokens[i]
 		if tok.Kind == lexer.TokenEOF {
-			if err := w.emitLeadingTrivia(tree.Source, tok.Leading, indentLevel, true); err != nil {
-				return nil, err
-			}
-			break
+			return w.emitLeadingTrivia(tree.Source, tok.Leading, p.indentLevel, true)
 		}
 		leadingHasComment := triviaHasComment(tok.Leading)
+		hint := hints.tokens[idx]
 
-		if spec, ok := hints.declBlockClose[idx]; ok && spec.HasMembers {
-			if indentLevel > 0 {
-				indentLevel--
+		if hint&hintDeclBlockClose != 0 {
+			if p.indentLevel > 0 {
+				p.indentLevel--
 			}
 			if !leadingHasComment {
 				w.requestBreaks(1)
 			}
 		}
-		if _, ok := hints.wrapListClose[idx]; ok {
-			if indentLevel > 0 {
-				indentLevel--
+		if hint&hintWrapListClose != 0 {
+			if p.indentLevel > 0 {
+				p.indentLevel--
 			}
 			if !leadingHasComment {
 				w.requestBreaks(1)
 			}
 		}
-		if order, ok := hints.topLevelStart[idx]; ok && order > 0 {
+		if hint&hintTopLevelBreak != 0 {
 			breaks := hints.topLevelBreakCount(idx)
 			if leadingHasComment {
 				breaks = max(breaks-leadingNewlinesBeforeFirstComment(tok.Leading), 0)
 			}
 			w.requestBreaks(breaks)
-		} else if !leadingHasComment {
-			if _, ok := hints.memberStart[idx]; ok {
-				w.requestBreaks(1)
-			} else if _, ok := hints.wrapListStart[idx]; ok {
-				w.requestBreaks(1)
-			}
+		} else if !leadingHasComment && hint&(hintMemberStart|hintWrapListStart) != 0 {
+			w.requestBreaks(1)
 		}
 
-		if err := w.emitLeadingTrivia(tree.Source, tok.Leading, indentLevel, false); err != nil {
-			return nil, err
+		if err := w.emitLeadingTrivia(tree.Source, tok.Leading, p.indentLevel, false); err != nil {
+			return err
 		}
-		if havePrev && shouldInsertSpace(prevKind, tok.Kind) {
+		if p.havePrev && shouldInsertSpace(p.prevKind, tok.Kind) {
 			w.requestSpace()
 		}
 
-		if _, omit := hints.omitSeparatorTok[idx]; !omit || !isCommaOrSemiToken(tok.Kind) {
+		if hint&hintOmitSeparator == 0 || !isCommaOrSemiToken(tok.Kind) {
 			raw := tok.Bytes(tree.Source)
 			if raw == nil {
-				return nil, fmt.Errorf("invalid token span %s at index %d", tok.Span, i)
+				return fmt.Errorf("invalid token span %s at index %d", tok.Span, i)
 			}
-			if _, ok := hints.forceCommaTok[idx]; ok && isCommaOrSemiToken(tok.Kind) {
+			if hint&hintForceComma != 0 && isCommaOrSemiToken(tok.Kind) {
 				raw = []byte(",")
 			}
-			w.writeRaw(indentLevel, raw)
+			w.writeRaw(p.indentLevel, raw)
 		}
 		insertedComma := false
-		if _, ok := hints.insertCommaAfter[idx]; ok {
-			w.writeRaw(indentLevel, []byte(","))
+		if hint&hintInsertCommaAfter != 0 {
+			w.writeRaw(p.indentLevel, []byte(","))
 			insertedComma = true
 		}
 
-		if spec, ok := hints.declBlockOpen[idx]; ok && spec.HasMembers {
-			indentLevel++
+		if hint&hintDeclBlockOpen != 0 {
+			p.indentLevel++
 			if !nextTokenHasLeadingComment(tree.Tokens, i+1) {
 				w.requestBreaks(1)
 			}
 		}
-		if _, ok := hints.wrapListOpen[idx]; ok {
-			indentLevel++
+		if hint&hintWrapListOpen != 0 {
+			p.indentLevel++
 			if !nextTokenHasLeadingComment(tree.Tokens, i+1) {
 				w.requestBreaks(1)
 			}
 		}
 
 		if insertedComma {
-			prevKind = lexer.TokenComma
+			p.prevKind = lexer.TokenComma
 		} else {
-			prevKind = tok.Kind
+			p.prevKind = tok.Kind
+		}
+		p.havePrev = true
+		if w.differs {
+			// Verifying, and the output already differs.
+			return nil
+		}
+		if err := p.flush(); err != nil {
+			return err
 		}
-		havePrev = true
 	}
-
-	return bytes.Clone(w.finish()), nil
+	return nil
 }
 
 func addCommaTerminatorHint(tree *syntax.Tree, hints *formatHints, parentKind string, member *syntax.Node) {
 	if tree == nil || hints == nil || member == nil {
 		return
 	}
-	if !requiresCommaTerminator(parentKind, syntax.KindName(member.Kind)) {
+	if !requiresCommaTerminator(parentKind, kindName(member.Kind)) {
 		return
 	}
 	if int(member.LastToken) >= len(tree.Tokens) {
@@ -268,17 +426,17 @@ func addCommaTerminatorHint(tree *syntax.Tree, hints *formatHints, parentKind st
 		parent := tree.NodeByID(member.Parent)
 		if parameterListTrailingFieldShouldOmitComma(tree, hints, parent, member) {
 			if isCommaOrSemiToken(lastKind) {
-				hints.omitSeparatorTok[member.LastToken] = struct{}{}
+				hints.set(member.LastToken, hintOmitSeparator)
 			}
 			return
 		}
 	}
 
 	if isCommaOrSemiToken(lastKind) {
-		hints.forceCommaTok[member.LastToken] = struct{}{}
+		hints.set(member.LastToken, hintForceComma)
 		return
 	}
-	hints.insertCommaAfter[member.LastToken] = struct{}{}
+	hints.set(member.LastToken, hintInsertCommaAfter)
 }
 
 func requiresCommaTerminator(parentKind, memberKind string) bool {
@@ -302,7 +460,7 @@ func parameterListTrailingFieldShouldOmitComma(tree *syntax.Tree, hints *formatH
 	if tree == nil || hints == nil || list == nil || member == nil {
 		return false
 	}
-	if syntax.KindName(list.Kind) != "parameter_list" {
+	if kindName(list.Kind) != "parameter_list" {
 		return false
 	}
 	next := member.LastToken + 1
@@ -313,84 +471,94 @@ func parameterListTrailingFieldShouldOmitComma(tree *syntax.Tree, hints *formatH
 	if !ok {
 		return false
 	}
-	_, wrapped := hints.wrapListOpen[openTok]
-	return !wrapped
+	return !hints.has(openTok, hintWrapListOpen)
 }
 
-func collectFormatHints(tree *syntax.Tree, opts Options) formatHints {
-	hints := formatHints{
-		topLevelStart:    make(map[uint32]int),
-		topLevelBreaks:   make(map[uint32]int),
-		memberStart:      make(map[uint32]struct{}),
-		wrapListStart:    make(map[uint32]struct{}),
-		wrapListOpen:     make(map[uint32]struct{}),
-		wrapListClose:    make(map[uint32]struct{}),
-		declBlockOpen:    make(map[uint32]declBlockSpec),
-		declBlockClose:   make(map[uint32]declBlockSpec),
-		omitSeparatorTok: make(map[uint32]struct{}),
-		forceCommaTok:    make(map[uint32]struct{}),
-		insertCommaAfter: make(map[uint32]struct{}),
-	}
+// collectFormatHints computes the per-token hints of tree. The caller
+// releases the result when done.
+func collectFormatHints(tree *syntax.Tree, opts Options) *formatHints {
+	hints := acquireFormatHints(len(tree.Tokens))
+	addTopLevelBreakHints(tree, hints)
+	addNodeHints(tree, opts, hints, 1, len(tree.Nodes))
+	return hints
+}
 
+// addTopLevelBreakHints records the blank lines requested between top-level
+// declarations, which depend on the kinds of neighbouring declarations.
+func addTopLevelBreakHints(tree *syntax.Tree, hints *formatHints) {
 	prevTopKind := ""
 	for order, id := range tree.TopLevelDeclarationIDs() {
 		n := tree.NodeByID(id)
 		if n == nil {
 			continue
 		}
-		kind := syntax.KindName(n.Kind)
-		hints.topLevelStart[n.FirstToken] = order
+		kind := kindName(n.Kind)
 		if order > 0 {
 			breaks := topLevelBreakCount(prevTopKind, kind)
 			if prevTopKind == "const_declaration" && kind == "const_declaration" && int(n.FirstToken) < len(tree.Tokens) {
 				breaks = max(leadingNewlinesBeforeFirstComment(tree.Tokens[n.FirstToken].Leading), 1)
 			}
-			hints.topLevelBreaks[n.FirstToken] = breaks
+			hints.setTopLevelBreaks(n.FirstToken, breaks)
 		}
 		prevTopKind = kind
 	}
+}
 
-	for i := 1; i < len(tree.Nodes); i++ {
+// addNodeHints records the hints derived from nodes [from, to). Nodes are
+// stored in pre-order, so a declaration and its subtree form one range, and
+// every hint lands on a token of the node that produced it.
+func addNodeHints(tree *syntax.Tree, opts Options, hints *formatHints, from, to int) {
+	for i := from; i < to; i++ {
+		if !hasMemberNodes(kindName(tree.Nodes[i].Kind)) {
+			continue
+		}
 		id := syntax.NodeID(i)
 		for _, memberID := range tree.MemberNodeIDs(id) {
 			member := tree.NodeByID(memberID)
 			if member == nil {
 				continue
 			}
-			hints.memberStart[member.FirstToken] = struct{}{}
-			if syntax.KindName(member.Kind) == "function_definition" {
-				addWrappedFunctionSignatureHints(tree, opts, &hints, member)
+			hints.set(member.FirstToken, hintMemberStart)
+			if kindName(member.Kind) == "function_definition" {
+				addWrappedFunctionSignatureHints(tree, opts, hints, member)
 			}
 		}
 	}
 
-	for i := 1; i < len(tree.Nodes); i++ {
+	for i := from; i < to; i++ {
 		node := &tree.Nodes[i]
 		parentKind := ""
 		if parent := tree.NodeByID(node.Parent); parent != nil {
-			parentKind = syntax.KindName(parent.Kind)
+			parentKind = kindName(parent.Kind)
 		}
-		addCommaTerminatorHint(tree, &hints, parentKind, node)
+		addCommaTerminatorHint(tree, hints, parentKind, node)
 	}
 
-	for i := 1; i < len(tree.Nodes); i++ {
+	for i := from; i < to; i++ {
 		n := &tree.Nodes[i]
-		switch syntax.KindName(n.Kind) {
+		switch kindName(n.Kind) {
 		case "field_block", "function_block", "enum_block":
 			if spec, ok := declBlockSpecFromBraces(tree, n.FirstToken, n.LastToken, countNamedChildNodes(tree, n.ID)); ok {
-				hints.declBlockOpen[n.FirstToken] = spec
-				hints.declBlockClose[spec.CloseToken] = spec
+				hints.addDeclBlock(n.FirstToken, spec)
 			}
 		case "senum_definition":
 			memberCount := len(tree.MemberNodeIDs(n.ID))
 			if openTok, spec, ok := declBlockSpecFromNodeTokenScan(tree, n.FirstToken, n.LastToken, memberCount); ok {
-				hints.declBlockOpen[openTok] = spec
-				hints.declBlockClose[spec.CloseToken] = spec
+				hints.addDeclBlock(openTok, spec)
 			}
 		}
 	}
+}
 
-	return hints
+// hasMemberNodes reports whether syntax.Tree.MemberNodeIDs can return members
+// for a node of the given kind, which saves its kind lookup on other nodes.
+func hasMemberNodes(kind string) bool {
+	switch kind {
+	case "struct_definition", "union_definition", "exception_definition", "service_definition", "enum_definition", "senum_definition":
+		return true
+	default:
+		return false
+	}
 }
 
 func addWrappedFunctionSignatureHints(tree *syntax.Tree, opts Options, hints *formatHints, fn *syntax.Node) {
@@ -409,13 +577,13 @@ func addWrappedFunctionSignatureHints(tree *syntax.Tree, opts Options, hints *fo
 		if child == nil {
 			continue
 		}
-		switch syntax.KindName(child.Kind) {
+		switch kindName(child.Kind) {
 		case "parameter_list":
 			addWrappedParameterListHints(tree, hints, child)
 		case "throws_clause":
 			for _, throwsChildID := range tree.ChildNodeIDs(child.ID) {
 				throwsChild := tree.NodeByID(throwsChildID)
-				if throwsChild == nil || syntax.KindName(throwsChild.Kind) != "parameter_list" {
+				if throwsChild == nil || kindName(throwsChild.Kind) != "parameter_list" {
 					continue
 				}
 				addWrappedParameterListHints(tree, hints, throwsChild)
@@ -434,14 +602,14 @@ func addWrappedParameterListHints(tree *syntax.Tree, hints *formatHints, list *s
 		return
 	}
 
-	hints.wrapListOpen[openTok] = struct{}{}
-	hints.wrapListClose[closeTok] = struct{}{}
+	hints.set(openTok, hintWrapListOpen)
+	hints.set(closeTok, hintWrapListClose)
 	for _, childID := range tree.ChildNodeIDs(list.ID) {
 		child := tree.NodeByID(childID)
-		if child == nil || syntax.KindName(child.Kind) != "field" {
+		if child == nil || kindName(child.Kind) != "field" {
 			continue
 		}
-		hints.wrapListStart[child.FirstToken] = struct{}{}
+		hints.set(child.FirstToken, hintWrapListStart)
 	}
 }
 
@@ -683,9 +851,22 @@ func nextTokenHasLeadingComment(tokens []lexer.Token, next int) bool {
 	return triviaHasComment(tokens[next].Leading)
 }
 
-func repeatString(s string, count int) string {
-	if count <= 0 || s == "" {
-		return ""
+// maxMemoKinds bounds the kindNames table; grammar kind ids stay far below it.
+const maxMemoKinds = 1024
+
+// kindNames memoizes syntax.KindName, which takes a lock per call.
+var kindNames [maxMemoKinds]atomic.Pointer[string]
+
+func kindName(kind syntax.NodeKind) string {
+	if int(kind) >= maxMemoKinds {
+		return syntax.KindName(kind)
+	}
+	if name := kindNames[kind].Load(); name != nil {
+		return *name
+	}
+	name := syntax.KindName(kind)
+	if name != "" {
+		kindNames[kind].Store(&name)
 	}
-	return strings.Repeat(s, count)
+	return name
 }
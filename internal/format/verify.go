@@ -0,0 +1,117 @@
+package format
+
+import (
+	"context"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// Check reports whether Document would change tree, without rendering the
+// output. It makes the same layout decisions as Document but compares each
+// against the source bytes, stopping at the first difference. Result.Output
+// is left empty.
+func Check(ctx context.Context, tree *syntax.Tree, opts Options) (Result, error) {
+	normOpts, policy, diags, err := prepareFormatting(ctx, tree, opts)
+	if err != nil {
+		return Result{Diagnostics: diags}, err
+	}
+
+	changed, err := verifySyntaxTreeParallel(tree, normOpts, policy, formatWorkers(tree))
+	if err != nil {
+		return Result{}, err
+	}
+	return Result{Changed: changed, Diagnostics: diags}, nil
+}
+
+// verifySyntaxTree runs formatSyntaxTree with the token writer comparing
+// against tree.Source instead of writing, and reports whether they differ.
+func verifySyntaxTree(tree *syntax.Tree, opts Options, policy SourcePolicy) (bool, error) {
+	if len(tree.Tokens) == 0 || tree.Root == syntax.NoNode {
+		return false, nil
+	}
+
+	hints := collectFormatHints(tree, opts)
+	defer hints.release()
+	p := newFormatPass(tree, hints, opts, policy)
+	p.w.startVerify(tree.Source, 0)
+	if err := p.run(0, len(tree.Tokens)); err != nil {
+		return false, err
+	}
+	p.w.finish()
+	return p.w.changed(), nil
+}
+
+// verifiedChunk is the verdict on a run of segments checked from a predicted
+// entry state and source offset.
+type verifiedChunk struct {
+	entry      formatPassState
+	exit       formatPassState
+	start, end int
+	differs    bool
+	err        error
+}
+
+// verifySyntaxTreeParallel is verifySyntaxTree split into chunks like
+// formatSyntaxTreeParallel. Output that matches the source so far ends where
+// the previous token ends in the source, so each chunk is compared from
+// there. A chunk whose predicted state or offset turns out wrong is checked
+// again in sequence.
+func verifySyntaxTreeParallel(tree *syntax.Tree, opts Options, policy SourcePolicy, workers int) (bool, error) {
+	if workers <= 1 || tree == nil || len(tree.Tokens) == 0 || tree.Root == syntax.NoNode {
+		return verifySyntaxTree(tree, opts, policy)
+	}
+	segs := formatSegments(tree)
+	if len(segs) < 2 || !segmentsSelfContained(tree, segs) {
+		return verifySyntaxTree(tree, opts, policy)
+	}
+
+	hints := acquireFormatHints(len(tree.Tokens))
+	defer hints.release()
+	addTopLevelBreakHints(tree, hints)
+
+	chunks := chunkSegments(segs, workers*parallelChunksPerWorker)
+	results := make([]verifiedChunk, len(chunks))
+	forEachChunk(workers, len(chunks), func(i int) {
+		results[i] = verifyChunk(tree, hints, opts, policy, chunks[i])
+	})
+
+	p := newFormatPass(tree, hints, opts, policy)
+	p.w.startVerify(tree.Source, 0)
+	for i, c := range chunks {
+		r := &results[i]
+		if r.err == nil && r.entry == p.state() && r.start == p.w.off {
+			if r.differs {
+				return true, nil
+			}
+			p.restore(r.exit)
+			p.w.off = r.end
+			continue
+		}
+		if err := p.run(c.tokFrom, c.tokTo); err != nil {
+			return false, err
+		}
+		if p.w.differs {
+			return true, nil
+		}
+	}
+	p.w.finish()
+	return p.w.changed(), nil
+}
+
+// verifyChunk checks one chunk from the predicted state at its start.
+func verifyChunk(tree *syntax.Tree, hints *formatHints, opts Options, policy SourcePolicy, c formatSegment) verifiedChunk {
+	p := newChunkPass(tree, hints, opts, policy, c)
+	start := 0
+	switch {
+	case c.tokFrom > 0:
+		start = int(tree.Tokens[c.tokFrom-1].Span.End)
+	case policy.HasBOM:
+		start = len(utf8BOM)
+	}
+	p.w.startVerify(tree.Source, start)
+	entry := p.state()
+	if err := p.run(c.tokFrom, c.tokTo); err != nil {
+		return verifiedChunk{err: err}
+	}
+	return verifiedChunk{entry: entry, exit: p.state(), start: start, end: p.w.off, differs: p.w.differs}
+}
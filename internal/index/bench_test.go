@@ -5,8 +5,10 @@ import (
 	"fmt"
 	"os"
 	"path/filepath"
+	"runtime"
 	"strings"
 	"testing"
+	"time"
 
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
 	"github.com/kpumuk/thrift-weaver/internal/testutil"
@@ -119,6 +121,57 @@ func BenchmarkFirstOpenClosurePublication(b *testing.B) {
 	}
 }
 
+func BenchmarkCloseWithManyOpenDocuments(b *testing.B) {
+	root := b.TempDir()
+	const tabs, depth = 30, 10
+	for i := range tabs {
+		for d := range depth {
+			src := fmt.Sprintf("struct T%02d_%02d {\n  1: string name,\n}\n", i, d)
+			if d+1 < depth {
+				src = fmt.Sprintf("include \"chain-%02d-%02d.thrift\"\n\n", i, d+1) + src
+			}
+			path := filepath.Join(root, fmt.Sprintf("chain-%02d-%02d.thrift", i, d))
+			if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+				b.Fatalf("WriteFile(%s): %v", path, err)
+			}
+		}
+	}
+	manager := NewManager(Options{WorkspaceRoots: []string{root}})
+	b.Cleanup(manager.Close)
+	open := func(i int) string {
+		path := filepath.Join(root, fmt.Sprintf("tab-%02d.thrift", i))
+		if err := manager.UpsertOpenDocumentWithReason(context.Background(), DocumentInput{
+			URI:        path,
+			Version:    1,
+			Generation: 1,
+			Source:     fmt.Appendf(nil, "include \"chain-%02d-00.thrift\"\n", i),
+		}, RebuildReasonOpen); err != nil {
+			b.Fatalf("UpsertOpenDocumentWithReason: %v", err)
+		}
+		if err := manager.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonOpen); err != nil {
+			b.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+		}
+		return path
+	}
+	for i := 1; i < tabs; i++ {
+		open(i)
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for range b.N {
+		b.StopTimer()
+		path := open(0)
+		b.StartTimer()
+		if err := manager.CloseOpenDocumentWithReason(context.Background(), path, RebuildReasonClose); err != nil {
+			b.Fatalf("CloseOpenDocumentWithReason: %v", err)
+		}
+		if err := manager.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonClose); err != nil {
+			b.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+		}
+	}
+}
+
 func BenchmarkBackgroundDiscoveryWidening(b *testing.B) {
 	root, mainPath, mainSource := benchmarkLazyDiscoveryWorkspace(b)
 
@@ -143,6 +196,153 @@ func BenchmarkBackgroundDiscoveryWidening(b *testing.B) {
 	}
 }
 
+func BenchmarkDiscoveryTimeToFirstUsefulAnswer(b *testing.B) {
+	root, mainPath, _ := benchmarkLazyDiscoveryWorkspace(b)
+	_, mainKey, err := CanonicalizeDocumentURI(mainPath)
+	if err != nil {
+		b.Fatalf("CanonicalizeDocumentURI: %v", err)
+	}
+
+	var firstAnswer, discovery time.Duration
+	b.ReportAllocs()
+	b.ResetTimer()
+	for range b.N {
+		var (
+			manager  *Manager
+			answered time.Duration
+		)
+		start := time.Now()
+		manager = NewManager(Options{
+			WorkspaceRoots: []string{root},
+			Hooks: Hooks{OnEvent: func(event Event) {
+				if answered != 0 || event.Kind != EventKindRebuild {
+					return
+				}
+				snap, ok := manager.Snapshot()
+				if !ok {
+					return
+				}
+				doc := snap.Documents[mainKey]
+				if doc != nil && doc.ClosureComplete && doc.References[0].Binding.Status == BindingStatusBound {
+					answered = time.Since(start)
+				}
+			}},
+		})
+		if err := manager.RescanWorkspaceWithReason(context.Background(), RebuildReasonManualRescan); err != nil {
+			manager.Close()
+			b.Fatalf("RescanWorkspaceWithReason: %v", err)
+		}
+		discovery += time.Since(start)
+		firstAnswer += answered
+		manager.Close()
+	}
+	b.ReportMetric(float64(firstAnswer.Microseconds())/float64(b.N), "first-answer-us/op")
+	b.ReportMetric(float64(discovery.Microseconds())/float64(b.N), "discovery-us/op")
+}
+
+func BenchmarkScanDuration(b *testing.B) {
+	root := benchmarkScanTree(b)
+	rules := benchmarkGitIgnoreRules(400)
+
+	for _, gitignore := range []struct {
+		name  string
+		rules string
+	}{
+		{name: "no-gitignore"},
+		{name: "gitignore-400-rules", rules: rules},
+	} {
+		for _, workers := range []int{1, defaultScanWorkers()} {
+			b.Run(fmt.Sprintf("%s/workers=%d", gitignore.name, workers), func(b *testing.B) {
+				path := filepath.Join(root, ".gitignore")
+				if err := os.WriteFile(path, []byte(gitignore.rules), 0o600); err != nil {
+					b.Fatalf("WriteFile(%s): %v", path, err)
+				}
+
+				b.ReportAllocs()
+				b.ResetTimer()
+				for range b.N {
+					result, err := scanWorkspaceWithWorkers(context.Background(), []string{root}, nil, 10_000, 1<<20, workers)
+					if err != nil {
+						b.Fatalf("scanWorkspace: %v", err)
+					}
+					if len(result.files) != benchmarkScanThriftFiles {
+						b.Fatalf("scanned %d files, want %d", len(result.files), benchmarkScanThriftFiles)
+					}
+				}
+			})
+		}
+	}
+}
+
+func BenchmarkGitIgnoreStackMatch(b *testing.B) {
+	root := b.TempDir()
+	if err := os.WriteFile(filepath.Join(root, ".gitignore"), []byte(benchmarkGitIgnoreRules(400)), 0o600); err != nil {
+		b.Fatalf("WriteFile .gitignore: %v", err)
+	}
+	stack, err := gitIgnoreStack(nil).withDir(root, "")
+	if err != nil {
+		b.Fatalf("withDir: %v", err)
+	}
+	paths := []string{"pkg-001/mod-07/file-031.go", "pkg-042/mod-13", "pkg-099/mod-19/service.thrift"}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := range b.N {
+		if stack.ignored(paths[i%len(paths)], i%len(paths) == 1) {
+			b.Fatal("benchmark path unexpectedly ignored")
+		}
+	}
+}
+
+const benchmarkScanThriftFiles = 100 * 20
+
+// benchmarkScanTree builds a synthetic tree of roughly 200k entries: 100
+// packages with 20 modules of 100 files each, one of which is a thrift file.
+func benchmarkScanTree(b *testing.B) string {
+	b.Helper()
+	root := b.TempDir()
+	for pkg := range 100 {
+		for mod := range 20 {
+			dir := filepath.Join(root, fmt.Sprintf("pkg-%03d", pkg), fmt.Sprintf("mod-%02d", mod))
+			if err := os.MkdirAll(dir, 0o750); err != nil {
+				b.Fatalf("MkdirAll(%s): %v", dir, err)
+			}
+			for file := range 99 {
+				path := filepath.Join(dir, fmt.Sprintf("file-%03d.go", file))
+				if err := os.WriteFile(path, nil, 0o600); err != nil {
+					b.Fatalf("WriteFile(%s): %v", path, err)
+				}
+			}
+			path := filepath.Join(dir, "service.thrift")
+			if err := os.WriteFile(path, []byte("struct Service {}\n"), 0o600); err != nil {
+				b.Fatalf("WriteFile(%s): %v", path, err)
+			}
+		}
+	}
+	return root
+}
+
+// benchmarkGitIgnoreRules returns n rules mixing literal, anchored, suffix and
+// glob patterns, none of which match benchmarkScanTree entries.
+func benchmarkGitIgnoreRules(n int) string {
+	var sb strings.Builder
+	for i := range n {
+		switch i % 5 {
+		case 0:
+			fmt.Fprintf(&sb, "node_modules_%d\n", i)
+		case 1:
+			fmt.Fprintf(&sb, "/dist-%d/\n", i)
+		case 2:
+			fmt.Fprintf(&sb, "*.gen%d\n", i)
+		case 3:
+			fmt.Fprintf(&sb, "build-%d/**/out\n", i)
+		default:
+			fmt.Fprintf(&sb, "tmp-%d-*.log\n", i)
+		}
+	}
+	return sb.String()
+}
+
 func benchmarkLazyDiscoveryWorkspace(b testing.TB) (root string, mainPath string, mainSource []byte) {
 	b.Helper()
 	root = b.TempDir()
@@ -238,3 +438,117 @@ func benchmarkUTF16PositionForSubstring(tb testing.TB, src []byte, needle string
 	}
 	return pos
 }
+
+func BenchmarkWorkspaceSnapshotHeap(b *testing.B) {
+	root := benchmarkSymbolWorkspace(b, 10_000)
+
+	var heap uint64
+	b.ReportAllocs()
+	b.ResetTimer()
+	for range b.N {
+		var before runtime.MemStats
+		runtime.GC()
+		runtime.ReadMemStats(&before)
+
+		manager := NewManager(Options{WorkspaceRoots: []string{root}, MaxFiles: 20_000})
+		if err := manager.RescanWorkspace(context.Background()); err != nil {
+			manager.Close()
+			b.Fatalf("RescanWorkspace: %v", err)
+		}
+
+		var after runtime.MemStats
+		runtime.GC()
+		runtime.ReadMemStats(&after)
+		if after.HeapInuse > before.HeapInuse {
+			heap += after.HeapInuse - before.HeapInuse
+		}
+		if snap := mustSnapshotForBenchmark(b, manager); len(snap.Documents) != 10_000 {
+			manager.Close()
+			b.Fatalf("indexed %d documents, want 10000", len(snap.Documents))
+		}
+		manager.Close()
+	}
+	b.ReportMetric(float64(heap)/float64(b.N)/(1<<20), "heap-inuse-MiB")
+}
+
+func BenchmarkBindWorkspaceReferences(b *testing.B) {
+	root := benchmarkSymbolWorkspace(b, 10_000)
+	manager := NewManager(Options{WorkspaceRoots: []string{root}, MaxFiles: 20_000})
+	b.Cleanup(manager.Close)
+	if err := manager.RescanWorkspace(context.Background()); err != nil {
+		b.Fatalf("RescanWorkspace: %v", err)
+	}
+	docs := mustSnapshotForBenchmark(b, manager).Documents
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for range b.N {
+		if snap := buildSnapshot(nil, docs, nil, true, resolverConfig{roots: []string{root}}, nil, true); len(snap.Documents) != len(docs) {
+			b.Fatalf("bound %d documents, want %d", len(snap.Documents), len(docs))
+		}
+	}
+}
+
+// benchmarkSymbolWorkspace writes n thrift files in 100 directories; each file
+// declares four types and references the previous file's types through an
+// include.
+func benchmarkSymbolWorkspace(b *testing.B, n int) string {
+	b.Helper()
+	root := b.TempDir()
+	for i := range n {
+		dir := filepath.Join(root, fmt.Sprintf("pkg-%02d", i%100))
+		if err := os.MkdirAll(dir, 0o750); err != nil {
+			b.Fatalf("MkdirAll(%s): %v", dir, err)
+		}
+		var sb strings.Builder
+		prev := i - 100
+		if prev >= 0 {
+			fmt.Fprintf(&sb, "include \"module_%05d.thrift\"\n\n", prev)
+		}
+		for decl := range 4 {
+			fmt.Fprintf(&sb, "struct Type%05d_%d {\n", i, decl)
+			if prev >= 0 {
+				fmt.Fprintf(&sb, "  1: module_%05d.Type%05d_%d previous,\n", prev, prev, decl)
+			}
+			fmt.Fprintf(&sb, "  2: list<Type%05d_%d> siblings,\n}\n\n", i, (decl+1)%4)
+		}
+		fmt.Fprintf(&sb, "exception Failure%05d {}\n\nservice Service%05d {\n  Type%05d_0 get(1: Type%05d_1 key) throws (1: Failure%05d failure),\n}\n", i, i, i, i, i)
+		path := filepath.Join(dir, fmt.Sprintf("module_%05d.thrift", i))
+		if err := os.WriteFile(path, []byte(sb.String()), 0o600); err != nil {
+			b.Fatalf("WriteFile(%s): %v", path, err)
+		}
+	}
+	return root
+}
+
+func BenchmarkDefinitionQueryLargeDocument(b *testing.B) {
+	root := b.TempDir()
+	var sb strings.Builder
+	sb.WriteString("struct Target {}\n\nstruct Holder {\n")
+	for i := range 20_000 {
+		fmt.Fprintf(&sb, "  %d: Target field%05d,\n", i+1, i)
+	}
+	sb.WriteString("}\n")
+	src := []byte(sb.String())
+	path := filepath.Join(root, "large.thrift")
+	if err := os.WriteFile(path, src, 0o600); err != nil {
+		b.Fatalf("WriteFile(%s): %v", path, err)
+	}
+
+	manager := NewManager(Options{WorkspaceRoots: []string{root}})
+	b.Cleanup(manager.Close)
+	if err := manager.RescanWorkspace(context.Background()); err != nil {
+		b.Fatalf("RescanWorkspace: %v", err)
+	}
+	doc := mustDocumentForBenchmark(b, mustSnapshotForBenchmark(b, manager), path)
+	query := QueryDocument{URI: doc.URI, Version: doc.Version, Generation: doc.Generation}
+	pos := benchmarkUTF16PositionForSubstring(b, src, "Target field19999")
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for range b.N {
+		if _, _, err := manager.Definition(context.Background(), query, pos); err != nil {
+			b.Fatalf("Definition: %v", err)
+		}
+	}
+}
@@ -70,6 +70,9 @@ func ViewForDocument(snapshot *WorkspaceSnapshot, uri string) (*DocumentView, bo
 	if snapshot == nil {
 		return nil, false, nil
 	}
+	if doc, ok := snapshot.documentByURI(uri); ok {
+		return &DocumentView{Document: doc, Snapshot: snapshot}, true, nil
+	}
 	_, key, err := CanonicalizeDocumentURI(uri)
 	if err != nil {
 		return nil, false, err
@@ -0,0 +1,93 @@
+package index
+
+import (
+	"sync"
+	"time"
+)
+
+const (
+	defaultDiscoveryPublishInterval = 500 * time.Millisecond
+	defaultDiscoveryPublishFiles    = 32
+)
+
+// discoveryProgress publishes intermediate snapshots while the first
+// workspace discovery pass is still parsing files. Intermediate snapshots keep
+// DiscoveryComplete=false; per-document ClosureComplete flags tell queries
+// which documents already answer exactly.
+type discoveryProgress struct {
+	m      *Manager
+	reason RebuildReason
+	start  time.Time
+	stats  rebuildStats
+
+	mu          sync.Mutex
+	batch       map[DocumentKey]loadedDiskState
+	lastPublish time.Time
+	published   int
+	milestone   int
+}
+
+func (m *Manager) newDiscoveryProgress(reason RebuildReason, start time.Time, result scanWorkspaceResult) *discoveryProgress {
+	if m == nil || m.discoveryPublishFiles <= 0 {
+		return nil
+	}
+	m.mu.Lock()
+	complete := m.discoveryCompleteLocked()
+	m.mu.Unlock()
+	if complete {
+		// A rescan of a complete workspace must not regress readers to an
+		// incomplete view; it publishes once at the end instead.
+		return nil
+	}
+	return &discoveryProgress{
+		m:      m,
+		reason: reason,
+		start:  start,
+		stats: rebuildStats{
+			discoveredFiles:       len(result.files),
+			gitIgnoreSkippedPaths: result.gitIgnoreSkippedPaths,
+		},
+		batch:       make(map[DocumentKey]loadedDiskState),
+		lastPublish: start,
+		milestone:   m.discoveryPublishFiles,
+	}
+}
+
+// record collects one parsed file and publishes once a file-count milestone or
+// the publish interval is reached. Milestones grow with the published document
+// count so intermediate rebuilds stay linear in workspace size. record runs on
+// parse worker goroutines.
+func (p *discoveryProgress) record(state loadedDiskState) {
+	if p == nil || state.summary == nil {
+		return
+	}
+
+	p.mu.Lock()
+	p.batch[state.file.Key] = state
+	now := time.Now()
+	if len(p.batch) < p.milestone && now.Sub(p.lastPublish) < p.m.discoveryPublishInterval {
+		p.mu.Unlock()
+		return
+	}
+	batch := p.batch
+	p.batch = make(map[DocumentKey]loadedDiskState, len(batch))
+	p.lastPublish = now
+	p.published += len(batch)
+	p.milestone = max(p.m.discoveryPublishFiles, p.published)
+	p.mu.Unlock()
+
+	p.m.publishDiscoveryProgress(batch, p.reason, time.Since(p.start), p.stats)
+}
+
+func (m *Manager) publishDiscoveryProgress(batch map[DocumentKey]loadedDiskState, reason RebuildReason, duration time.Duration, stats rebuildStats) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	if m.discoveryCompleteLocked() {
+		return
+	}
+	changed, fullRebuild := m.mergeDiskStatesLocked(batch, diskSourceOpportunistic)
+	if len(changed) == 0 {
+		return
+	}
+	m.publishLocked(changed, fullRebuild || m.snapshot.Load() == nil, reason, duration, stats, false)
+}
@@ -0,0 +1,359 @@
+package index
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"regexp"
+	"slices"
+	"strings"
+)
+
+// gitIgnoreMatcher holds the compiled rules of one .gitignore file.
+//
+// Literal rules are indexed by the segment or path they match exactly, so a
+// candidate costs a few map lookups regardless of rule count. Glob rules are
+// indexed in byte tries by their literal prefix, or by their literal suffix
+// when the pattern starts with a wildcard; only the rules a trie walk selects,
+// plus the few patterns with neither, are matched one by one.
+type gitIgnoreMatcher struct {
+	rules        []gitIgnoreRule
+	segments     map[string][]int
+	anchored     map[string][]int
+	paths        map[string][]int
+	pathPrefix   gitIgnoreTrie
+	segPrefix    gitIgnoreTrie
+	segSuffix    gitIgnoreTrie
+	globFallback []int
+}
+
+// gitIgnoreTrie maps literal keys to the rules that require them; collect
+// returns every rule whose key is a prefix of the input (or a suffix, for a
+// reversed trie).
+type gitIgnoreTrie struct {
+	next  map[byte]*gitIgnoreTrie
+	rules []int
+}
+
+func (t *gitIgnoreTrie) insert(key string, reversed bool, rule int) {
+	node := t
+	for i := range len(key) {
+		ch := key[i]
+		if reversed {
+			ch = key[len(key)-1-i]
+		}
+		child := node.next[ch]
+		if child == nil {
+			if node.next == nil {
+				node.next = make(map[byte]*gitIgnoreTrie)
+			}
+			child = &gitIgnoreTrie{}
+			node.next[ch] = child
+		}
+		node = child
+	}
+	node.rules = append(node.rules, rule)
+}
+
+func (t *gitIgnoreTrie) collect(s string, reversed bool, out []int) []int {
+	node := t
+	for i := 0; i < len(s) && node.next != nil; i++ {
+		ch := s[i]
+		if reversed {
+			ch = s[len(s)-1-i]
+		}
+		if node = node.next[ch]; node == nil {
+			return out
+		}
+		out = append(out, node.rules...)
+	}
+	return out
+}
+
+type gitIgnorePatternKind uint8
+
+const (
+	gitIgnorePatternLiteral gitIgnorePatternKind = iota
+	gitIgnorePatternPrefix
+	gitIgnorePatternSuffix
+	gitIgnorePatternRegex
+)
+
+type gitIgnoreRule struct {
+	anchored bool
+	dirOnly  bool
+	negated  bool
+	hasSlash bool
+	kind     gitIgnorePatternKind
+	literal  string
+	prefix   string
+	suffix   string
+	regex    *regexp.Regexp
+}
+
+// gitIgnoreLayer places a matcher within a walk: offset is where the
+// matcher's base-relative path starts inside a root-relative candidate path.
+type gitIgnoreLayer struct {
+	matcher *gitIgnoreMatcher
+	offset  int
+}
+
+// gitIgnoreStack is the ordered set of .gitignore matchers in effect for one
+// directory. Stacks share their parent's layers and are never mutated.
+type gitIgnoreStack []gitIgnoreLayer
+
+// withDir returns the stack for dir, whose root-relative slash path is rel.
+func (s gitIgnoreStack) withDir(dir string, rel string) (gitIgnoreStack, error) {
+	matcher, err := readGitIgnoreMatcher(dir)
+	if err != nil || matcher == nil {
+		return s, err
+	}
+	offset := 0
+	if rel != "" {
+		offset = len(rel) + 1
+	}
+	out := make(gitIgnoreStack, len(s), len(s)+1)
+	copy(out, s)
+	return append(out, gitIgnoreLayer{matcher: matcher, offset: offset}), nil
+}
+
+// ignored reports whether the root-relative slash path rel is ignored. The
+// last matching rule across all layers decides, as in git.
+func (s gitIgnoreStack) ignored(rel string, isDir bool) bool {
+	for i := len(s) - 1; i >= 0; i-- {
+		layer := s[i]
+		if layer.offset >= len(rel) {
+			continue
+		}
+		if index, ok := layer.matcher.lastMatch(rel[layer.offset:], isDir); ok {
+			return !layer.matcher.rules[index].negated
+		}
+	}
+	return false
+}
+
+func readGitIgnoreMatcher(dir string) (*gitIgnoreMatcher, error) {
+	path := filepath.Join(dir, ".gitignore")
+	src, err := os.ReadFile(path)
+	if err != nil {
+		if os.IsNotExist(err) {
+			return nil, nil
+		}
+		return nil, err
+	}
+
+	lines := strings.Split(string(src), "\n")
+	rules := make([]gitIgnoreRule, 0, len(lines))
+	for _, raw := range lines {
+		rule, ok, err := parseGitIgnoreRule(raw)
+		if err != nil {
+			return nil, fmt.Errorf("parse %s: %w", path, err)
+		}
+		if ok {
+			rules = append(rules, rule)
+		}
+	}
+	if len(rules) == 0 {
+		return nil, nil
+	}
+	return compileGitIgnoreMatcher(rules), nil
+}
+
+func compileGitIgnoreMatcher(rules []gitIgnoreRule) *gitIgnoreMatcher {
+	m := &gitIgnoreMatcher{rules: rules}
+	index := func(byKey *map[string][]int, key string, i int) {
+		if *byKey == nil {
+			*byKey = make(map[string][]int)
+		}
+		(*byKey)[key] = append((*byKey)[key], i)
+	}
+	for i, rule := range rules {
+		switch {
+		case rule.kind != gitIgnorePatternLiteral && rule.hasSlash && rule.prefix != "":
+			m.pathPrefix.insert(rule.prefix, false, i)
+		case rule.kind != gitIgnorePatternLiteral && !rule.hasSlash && rule.prefix != "":
+			m.segPrefix.insert(rule.prefix, false, i)
+		case rule.kind != gitIgnorePatternLiteral && !rule.hasSlash && rule.suffix != "":
+			m.segSuffix.insert(rule.suffix, true, i)
+		case rule.kind != gitIgnorePatternLiteral:
+			m.globFallback = append(m.globFallback, i)
+		case rule.hasSlash:
+			index(&m.paths, rule.literal, i)
+		case rule.anchored:
+			index(&m.anchored, rule.literal, i)
+		default:
+			index(&m.segments, rule.literal, i)
+		}
+	}
+	return m
+}
+
+func parseGitIgnoreRule(raw string) (gitIgnoreRule, bool, error) {
+	line := strings.TrimSpace(raw)
+	if line == "" || strings.HasPrefix(line, "#") {
+		return gitIgnoreRule{}, false, nil
+	}
+
+	negated := strings.HasPrefix(line, "!")
+	if negated {
+		line = strings.TrimSpace(strings.TrimPrefix(line, "!"))
+	}
+	if line == "" {
+		return gitIgnoreRule{}, false, nil
+	}
+
+	anchored := strings.HasPrefix(line, "/")
+	line = strings.TrimPrefix(line, "/")
+	dirOnly := strings.HasSuffix(line, "/")
+	line = strings.TrimSuffix(line, "/")
+	if line == "" {
+		return gitIgnoreRule{}, false, nil
+	}
+
+	rule := gitIgnoreRule{
+		anchored: anchored,
+		dirOnly:  dirOnly,
+		negated:  negated,
+		hasSlash: strings.Contains(line, "/"),
+	}
+	const meta = "*?["
+	if first := strings.IndexAny(line, meta); first >= 0 {
+		rule.prefix = line[:first]
+		// A bracket expression ends at "]", so the literal suffix starts
+		// after the last "]" as well as after the last wildcard.
+		suffixMeta := meta
+		if strings.Contains(line, "[") {
+			suffixMeta = "*?[]"
+		}
+		rule.suffix = line[strings.LastIndexAny(line, suffixMeta)+1:]
+	}
+	switch {
+	case !strings.ContainsAny(line, meta):
+		rule.kind, rule.literal = gitIgnorePatternLiteral, line
+	case !rule.hasSlash && len(line) > 1 && line[0] == '*' && !strings.ContainsAny(line[1:], meta):
+		rule.kind, rule.literal = gitIgnorePatternSuffix, line[1:]
+	case !rule.hasSlash && len(line) > 1 && line[len(line)-1] == '*' && !strings.ContainsAny(line[:len(line)-1], meta):
+		rule.kind, rule.literal = gitIgnorePatternPrefix, line[:len(line)-1]
+	default:
+		regex, err := regexp.Compile(globPatternToRegex(line))
+		if err != nil {
+			return gitIgnoreRule{}, false, err
+		}
+		rule.kind, rule.regex = gitIgnorePatternRegex, regex
+	}
+	return rule, true, nil
+}
+
+// lastMatch returns the index of the last rule matching the base-relative
+// slash path rel.
+func (m *gitIgnoreMatcher) lastMatch(rel string, isDir bool) (int, bool) {
+	best := -1
+	if m.paths != nil {
+		best = m.bestOf(m.paths[rel], best, isDir)
+	}
+	if m.anchored != nil {
+		segment, _, _ := strings.Cut(rel, "/")
+		best = m.bestOf(m.anchored[segment], best, isDir)
+	}
+	if m.segments != nil {
+		for rest, more := rel, true; more; {
+			var segment string
+			segment, rest, more = strings.Cut(rest, "/")
+			best = m.bestOf(m.segments[segment], best, isDir)
+		}
+	}
+
+	var buf [32]int
+	candidates := m.pathPrefix.collect(rel, false, buf[:0])
+	if m.segPrefix.next != nil || m.segSuffix.next != nil {
+		for rest, more := rel, true; more; {
+			var segment string
+			segment, rest, more = strings.Cut(rest, "/")
+			candidates = m.segPrefix.collect(segment, false, candidates)
+			candidates = m.segSuffix.collect(segment, true, candidates)
+		}
+	}
+	candidates = append(candidates, m.globFallback...)
+	slices.Sort(candidates)
+	for i := len(candidates) - 1; i >= 0 && candidates[i] > best; i-- {
+		if m.rules[candidates[i]].matches(rel, isDir) {
+			best = candidates[i]
+			break
+		}
+	}
+	return best, best >= 0
+}
+
+func (m *gitIgnoreMatcher) bestOf(indices []int, best int, isDir bool) int {
+	for _, i := range indices {
+		if i > best && (isDir || !m.rules[i].dirOnly) {
+			best = i
+		}
+	}
+	return best
+}
+
+func (r gitIgnoreRule) matches(rel string, isDir bool) bool {
+	if rel == "" || (r.dirOnly && !isDir) {
+		return false
+	}
+	if r.hasSlash {
+		if r.kind == gitIgnorePatternLiteral {
+			return rel == r.literal
+		}
+		return r.regex.MatchString(rel)
+	}
+
+	if r.anchored {
+		segment, _, _ := strings.Cut(rel, "/")
+		return r.matchesSegment(segment)
+	}
+	for rest, more := rel, true; more; {
+		var segment string
+		segment, rest, more = strings.Cut(rest, "/")
+		if r.matchesSegment(segment) {
+			return true
+		}
+	}
+	return false
+}
+
+func (r gitIgnoreRule) matchesSegment(segment string) bool {
+	switch r.kind {
+	case gitIgnorePatternLiteral:
+		return segment == r.literal
+	case gitIgnorePatternPrefix:
+		return strings.HasPrefix(segment, r.literal)
+	case gitIgnorePatternSuffix:
+		return strings.HasSuffix(segment, r.literal)
+	default:
+		return r.regex.MatchString(segment)
+	}
+}
+
+func globPatternToRegex(pattern string) string {
+	var b strings.Builder
+	b.WriteString("^")
+	for i := 0; i < len(pattern); i++ {
+		switch ch := pattern[i]; ch {
+		case '*':
+			if i+1 < len(pattern) && pattern[i+1] == '*' {
+				b.WriteString(".*")
+				i++
+				continue
+			}
+			b.WriteString("[^/]*")
+		case '?':
+			b.WriteString("[^/]")
+		case '.', '+', '(', ')', '|', '^', '$', '{', '}', '\\':
+			b.WriteByte('\\')
+			b.WriteByte(ch)
+		case '/':
+			b.WriteByte('/')
+		default:
+			b.WriteByte(ch)
+		}
+	}
+	b.WriteString("$")
+	return b.String()
+}
@@ -38,6 +38,45 @@ func buildIncludeGraph(docs map[DocumentKey]*DocumentSummary) IncludeGraph {
 	}
 }
 
+// markClosureCompleteness flags documents whose transitive include closure is
+// fully loaded. An unresolved include only counts as settled when its document
+// was loaded directly, because direct loads resolve includes against disk.
+func markClosureCompleteness(docs map[DocumentKey]*DocumentSummary, graph IncludeGraph, settled map[DocumentKey]struct{}, discoveryComplete bool) {
+	queue := make([]DocumentKey, 0)
+	for _, key := range sortedDocumentKeys(docs) {
+		doc := docs[key]
+		if doc == nil {
+			continue
+		}
+		doc.ClosureComplete = true
+		if discoveryComplete {
+			continue
+		}
+		if _, ok := settled[key]; ok {
+			continue
+		}
+		if slices.ContainsFunc(doc.Includes, func(edge IncludeEdge) bool {
+			return edge.Status != IncludeStatusResolved
+		}) {
+			queue = append(queue, key)
+		}
+	}
+
+	incomplete := make(map[DocumentKey]struct{}, len(queue))
+	for len(queue) > 0 {
+		key := queue[0]
+		queue = queue[1:]
+		if _, ok := incomplete[key]; ok {
+			continue
+		}
+		incomplete[key] = struct{}{}
+		if doc := docs[key]; doc != nil {
+			doc.ClosureComplete = false
+		}
+		queue = append(queue, graph.Reverse[key]...)
+	}
+}
+
 func stronglyConnectedComponents(keys []DocumentKey, forward map[DocumentKey][]DocumentKey) [][]DocumentKey {
 	var (
 		index      int
@@ -47,9 +47,21 @@ type Event struct {
 	WorkspaceGeneration    uint64
 	DiscoveryComplete      bool
 	BackgroundQueueDepth   int
+	ParseQueueDepths       ParseQueueDepths
 	RenameBlockers         map[string]int
 }
 
+// ParseQueueDepths counts pending workspace parse jobs per priority band.
+//
+// Open-document include closures parse first, then documents some indexed
+// document includes directly, then opportunistic discovery. Within a band the
+// largest files are scheduled first.
+type ParseQueueDepths struct {
+	OpenClosure    int
+	DirectIncludes int
+	Discovery      int
+}
+
 // Hooks configures structured observability callbacks for workspace indexing.
 type Hooks struct {
 	OnEvent    func(Event)
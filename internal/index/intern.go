@@ -0,0 +1,236 @@
+package index
+
+import (
+	"cmp"
+	"slices"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// symbolHandle is a dense, snapshot-scoped handle for one declaration.
+type symbolHandle uint32
+
+const noSymbol = ^symbolHandle(0)
+
+// siteHandle locates a declaration or reference site by document handle and
+// index within that document's summary.
+type siteHandle struct {
+	doc   uint32
+	index uint32
+}
+
+type symbolNameKey struct {
+	doc  uint32
+	name string
+}
+
+// symbolTable interns one snapshot's documents, declarations and declaration
+// names into dense uint32 handles. Records live in the document summaries and
+// handle lookups index slices; a SymbolID resolves through its document handle
+// and a binary search over that document's declarations. Bound references are
+// stored per target in one flat slice.
+type symbolTable struct {
+	docs     []*DocumentSummary
+	docByKey map[DocumentKey]uint32
+	docByURI map[string]uint32
+	// docSymbols[d] is the handle of document d's first declaration.
+	docSymbols []symbolHandle
+	symbols    []siteHandle
+	byName     map[symbolNameKey]symbolHandle
+	// sameName chains declarations sharing a document and name.
+	sameName []symbolHandle
+	// refStart[h]:refStart[h+1] bounds the reference sites bound to h in refSites.
+	refStart []uint32
+	refSites []siteHandle
+}
+
+func newSymbolTable(docs map[DocumentKey]*DocumentSummary) *symbolTable {
+	keys := sortedDocumentKeys(docs)
+	count := 0
+	for _, key := range keys {
+		if doc := docs[key]; doc != nil {
+			count += len(doc.Declarations)
+		}
+	}
+
+	t := &symbolTable{
+		docs:       make([]*DocumentSummary, 0, len(keys)),
+		docByKey:   make(map[DocumentKey]uint32, len(keys)),
+		docByURI:   make(map[string]uint32, len(keys)),
+		docSymbols: make([]symbolHandle, 0, len(keys)),
+		symbols:    make([]siteHandle, 0, count),
+		byName:     make(map[symbolNameKey]symbolHandle, count),
+		sameName:   make([]symbolHandle, 0, count),
+	}
+	for _, key := range keys {
+		doc := docs[key]
+		if doc == nil {
+			continue
+		}
+		docHandle := uint32(len(t.docs))
+		t.docs = append(t.docs, doc)
+		t.docByKey[key] = docHandle
+		t.docByURI[doc.URI] = docHandle
+		t.docSymbols = append(t.docSymbols, symbolHandle(len(t.symbols)))
+		for i, sym := range doc.Declarations {
+			handle := symbolHandle(len(t.symbols))
+			t.symbols = append(t.symbols, siteHandle{doc: docHandle, index: uint32(i)})
+
+			name := symbolNameKey{doc: docHandle, name: sym.Name}
+			next, ok := t.byName[name]
+			if !ok {
+				next = noSymbol
+			}
+			t.sameName = append(t.sameName, next)
+			t.byName[name] = handle
+		}
+	}
+	return t
+}
+
+// lookup returns the handle of the declaration identified by id. Declarations
+// are summarized in source order, so their name spans are sorted.
+func (t *symbolTable) lookup(id SymbolID) (symbolHandle, bool) {
+	doc, ok := t.docByKey[id.Key]
+	if !ok {
+		return noSymbol, false
+	}
+	decls := t.docs[doc].Declarations
+	i, found := slices.BinarySearchFunc(decls, id.Span.Start, func(sym Symbol, start text.ByteOffset) int {
+		return cmp.Compare(sym.NameSpan.Start, start)
+	})
+	if !found || decls[i].ID != id {
+		return noSymbol, false
+	}
+	return t.docSymbols[doc] + symbolHandle(i), true
+}
+
+func (t *symbolTable) symbol(handle symbolHandle) *Symbol {
+	site := t.symbols[handle]
+	return &t.docs[site.doc].Declarations[site.index]
+}
+
+func (t *symbolTable) reference(site siteHandle) *ReferenceSite {
+	return &t.docs[site.doc].References[site.index]
+}
+
+// bind resolves name against the declarations of the document key, with the
+// same outcomes as bindAgainstSymbols.
+func (t *symbolTable) bind(key DocumentKey, name string, expected []SymbolKind) BindingResult {
+	handle := noSymbol
+	if doc, ok := t.docByKey[key]; ok {
+		if first, ok := t.byName[symbolNameKey{doc: doc, name: name}]; ok {
+			handle = first
+		}
+	}
+	if handle == noSymbol {
+		return BindingResult{Status: BindingStatusUnresolved, Reason: "no matching declaration"}
+	}
+
+	match, matches := noSymbol, 0
+	for ; handle != noSymbol; handle = t.sameName[handle] {
+		if kindAllowed(t.symbol(handle).Kind, expected) {
+			match = handle
+			matches++
+		}
+	}
+	switch matches {
+	case 0:
+		return BindingResult{Status: BindingStatusUnresolved, Reason: "declaration kind does not match expected context"}
+	case 1:
+		return BindingResult{Status: BindingStatusBound, Target: t.symbol(match).ID}
+	default:
+		return BindingResult{Status: BindingStatusAmbiguous, Reason: "multiple declarations match the same name"}
+	}
+}
+
+// indexReferences groups every bound reference site by target, in document
+// key order and source order within a document.
+func (t *symbolTable) indexReferences() {
+	type boundSite struct {
+		target symbolHandle
+		site   siteHandle
+	}
+	var bound []boundSite
+	t.refStart = make([]uint32, len(t.symbols)+1)
+	for docHandle, doc := range t.docs {
+		for i, ref := range doc.References {
+			if ref.Binding.Status != BindingStatusBound {
+				continue
+			}
+			target, ok := t.lookup(ref.Binding.Target)
+			if !ok {
+				continue
+			}
+			bound = append(bound, boundSite{target: target, site: siteHandle{doc: uint32(docHandle), index: uint32(i)}})
+			t.refStart[target+1]++
+		}
+	}
+	for i := 1; i < len(t.refStart); i++ {
+		t.refStart[i] += t.refStart[i-1]
+	}
+	t.refSites = make([]siteHandle, len(bound))
+	next := make([]uint32, len(t.symbols))
+	copy(next, t.refStart)
+	for _, b := range bound {
+		t.refSites[next[b.target]] = b.site
+		next[b.target]++
+	}
+}
+
+// documentByURI returns the document whose canonical display URI is uri,
+// which lets queries skip path canonicalization for URIs the index produced.
+func (s *WorkspaceSnapshot) documentByURI(uri string) (*DocumentSummary, bool) {
+	if s == nil || s.symbols == nil {
+		return nil, false
+	}
+	doc, ok := s.symbols.docByURI[uri]
+	if !ok {
+		return nil, false
+	}
+	return s.symbols.docs[doc], true
+}
+
+// Dependents returns keys together with every document that includes one of
+// them, directly or transitively.
+func (s *WorkspaceSnapshot) Dependents(keys []DocumentKey) map[DocumentKey]struct{} {
+	return expandInvalidation(s, keys)
+}
+
+// Symbol returns the declaration identified by id.
+func (s *WorkspaceSnapshot) Symbol(id SymbolID) (Symbol, bool) {
+	if s == nil || s.symbols == nil {
+		return Symbol{}, false
+	}
+	handle, ok := s.symbols.lookup(id)
+	if !ok {
+		return Symbol{}, false
+	}
+	return *s.symbols.symbol(handle), true
+}
+
+// ReferencesTo returns the reference sites bound to the declaration identified by id.
+func (s *WorkspaceSnapshot) ReferencesTo(id SymbolID) []ReferenceSite {
+	if s == nil || s.symbols == nil {
+		return nil
+	}
+	handle, ok := s.symbols.lookup(id)
+	if !ok {
+		return nil
+	}
+	t := s.symbols
+	sites := t.refSites[t.refStart[handle]:t.refStart[handle+1]]
+	out := make([]ReferenceSite, 0, len(sites))
+	for _, site := range sites {
+		out = append(out, *t.reference(site))
+	}
+	return out
+}
+
+// SymbolCount returns the number of indexed declarations.
+func (s *WorkspaceSnapshot) SymbolCount() int {
+	if s == nil || s.symbols == nil {
+		return 0
+	}
+	return len(s.symbols.symbols)
+}
@@ -0,0 +1,100 @@
+package index
+
+import (
+	"context"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+func TestSymbolTableLooksUpHandlesAndReferenceSites(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	sharedPath := filepath.Join(root, "shared.thrift")
+	mainPath := filepath.Join(root, "main.thrift")
+	if err := os.WriteFile(sharedPath, []byte("struct A {}\nstruct B {}\nenum C {\n  X = 1,\n}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile shared: %v", err)
+	}
+	mainSrc := "include \"shared.thrift\"\n\nstruct Main {\n  1: shared.A a,\n  2: shared.B b,\n  3: shared.B c,\n}\n"
+	if err := os.WriteFile(mainPath, []byte(mainSrc), 0o600); err != nil {
+		t.Fatalf("WriteFile main: %v", err)
+	}
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+	if err := m.RescanWorkspace(context.Background()); err != nil {
+		t.Fatalf("RescanWorkspace: %v", err)
+	}
+
+	snap1 := mustSnapshot(t, m)
+	shared := mustDocument(t, snap1, sharedPath)
+	if got := len(shared.Declarations); got != 3 {
+		t.Fatalf("len(Declarations)=%d, want 3", got)
+	}
+	table := snap1.symbols
+	first, ok := table.lookup(shared.Declarations[0].ID)
+	if !ok {
+		t.Fatalf("lookup(%v) failed", shared.Declarations[0].ID)
+	}
+	for i, decl := range shared.Declarations {
+		handle, ok := table.lookup(decl.ID)
+		if !ok || handle != first+symbolHandle(i) {
+			t.Fatalf("lookup(%s)=%d,%t, want %d", decl.Name, handle, ok, first+symbolHandle(i))
+		}
+		if got := table.symbol(handle); got.ID != decl.ID || got.Name != decl.Name {
+			t.Fatalf("symbol(%d)=%s %v, want %s %v", handle, got.Name, got.ID, decl.Name, decl.ID)
+		}
+	}
+
+	a, b := shared.Declarations[0].ID, shared.Declarations[1].ID
+	missingSpan := b
+	missingSpan.Span = text.Span{Start: b.Span.Start + 1, End: b.Span.End}
+	if _, ok := table.lookup(missingSpan); ok {
+		t.Fatalf("lookup(%v) found a declaration, want none", missingSpan)
+	}
+	missingDoc := SymbolID{Key: DocumentKey("missing.thrift"), Span: a.Span}
+	if _, ok := table.lookup(missingDoc); ok {
+		t.Fatalf("lookup(%v) found a declaration, want none", missingDoc)
+	}
+	if refs := snap1.ReferencesTo(missingDoc); refs != nil {
+		t.Fatalf("ReferencesTo(missing document)=%v, want nil", refs)
+	}
+
+	if got := referenceNames(snap1.ReferencesTo(a)); len(got) != 1 {
+		t.Fatalf("ReferencesTo(A)=%v, want one site", got)
+	}
+	if got := referenceNames(snap1.ReferencesTo(b)); len(got) != 2 {
+		t.Fatalf("ReferencesTo(B)=%v, want two sites", got)
+	}
+
+	// Rebinding main in a new snapshot moves its reference sites and leaves
+	// the published snapshot untouched.
+	if err := m.UpsertOpenDocument(context.Background(), DocumentInput{
+		URI:        mainPath,
+		Version:    1,
+		Generation: 1,
+		Source:     []byte("include \"shared.thrift\"\n\nstruct Main {\n  1: shared.A a,\n  2: shared.A b,\n}\n"),
+	}); err != nil {
+		t.Fatalf("UpsertOpenDocument: %v", err)
+	}
+	snap2 := mustSnapshot(t, m)
+	if got := referenceNames(snap2.ReferencesTo(a)); len(got) != 2 {
+		t.Fatalf("rebuilt ReferencesTo(A)=%v, want two sites", got)
+	}
+	if got := snap2.ReferencesTo(b); len(got) != 0 {
+		t.Fatalf("rebuilt ReferencesTo(B)=%v, want none", got)
+	}
+	if got := referenceNames(snap1.ReferencesTo(b)); len(got) != 2 {
+		t.Fatalf("old snapshot ReferencesTo(B)=%v, want two sites", got)
+	}
+}
+
+func referenceNames(refs []ReferenceSite) []string {
+	names := make([]string, 0, len(refs))
+	for _, ref := range refs {
+		names = append(names, ref.Qualifier+"."+ref.Name)
+	}
+	return names
+}
@@ -136,9 +136,28 @@ type Manager struct {
 	parseWorkers int
 	onEvent      func(Event)
 	queueDepth   func() int
+	onParsedTree func(DocumentKey, string, *syntax.Tree)
+
+	discoveryPublishInterval time.Duration
+	discoveryPublishFiles    int
 
 	slots map[DocumentKey]*documentSlot
 
+	// closures holds the documents reachable through the includes of each
+	// open document and closureRefs how many open documents reach each of
+	// them; a disk document keeps its direct source while its count is
+	// positive. dirtyClosures are the open documents whose closure the next
+	// RefreshOpenDocumentClosureWithReason walks again.
+	closures      map[DocumentKey]map[DocumentKey]struct{}
+	closureRefs   map[DocumentKey]int
+	dirtyClosures map[DocumentKey]struct{}
+
+	watcherMu sync.Mutex
+	watcher   *workspaceWatcher
+
+	parseGate  parseGate
+	parseQueue parseQueueCounters
+
 	snapshot atomic.Pointer[WorkspaceSnapshot]
 }
 
@@ -164,7 +183,15 @@ func NewManager(opts Options) *Manager {
 		parseWorkers: parseWorkers,
 		onEvent:      opts.Hooks.OnEvent,
 		queueDepth:   opts.Hooks.QueueDepth,
+		onParsedTree: opts.OnParsedTree,
 		slots:        make(map[DocumentKey]*documentSlot),
+
+		closures:      make(map[DocumentKey]map[DocumentKey]struct{}),
+		closureRefs:   make(map[DocumentKey]int),
+		dirtyClosures: make(map[DocumentKey]struct{}),
+
+		discoveryPublishInterval: defaultDiscoveryPublishInterval,
+		discoveryPublishFiles:    defaultDiscoveryPublishFiles,
 	}
 }
 
@@ -175,8 +202,13 @@ func normalizeParseWorkers(workers int) int {
 	return min(max(runtime.GOMAXPROCS(0), 1), 4)
 }
 
-// Close releases manager resources.
-func (m *Manager) Close() {}
+// Close releases manager resources and stops the file watcher, if any.
+func (m *Manager) Close() {
+	if m == nil {
+		return
+	}
+	m.stopWatcher()
+}
 
 // UpsertOpenDocument reparses and stores the active open-document shadow.
 func (m *Manager) UpsertOpenDocument(ctx context.Context, in DocumentInput) error {
@@ -195,7 +227,9 @@ func (m *Manager) UpsertOpenDocumentWithReason(ctx context.Context, in DocumentI
 	}
 	in.URI = displayURI
 
+	release := m.parseGate.enterForeground()
 	summary, err := ParseAndSummarize(ctx, key, in)
+	release()
 	if err != nil {
 		return err
 	}
@@ -204,8 +238,13 @@ func (m *Manager) UpsertOpenDocumentWithReason(ctx context.Context, in DocumentI
 	defer m.mu.Unlock()
 
 	slot := m.ensureSlotLocked(key, displayURI)
-	hadActive := slot.active() != nil
+	prev := slot.active()
+	hadActive := prev != nil
 	slot.open = &documentState{input: in, summary: summary}
+	m.dirtyClosures[key] = struct{}{}
+	if prev == nil || !sameIncludePaths(prev.summary, summary) {
+		m.markClosureDependentsDirtyLocked(key)
+	}
 	m.publishLocked([]DocumentKey{key}, !hadActive, reason, time.Since(start), rebuildStats{}, m.discoveryCompleteLocked())
 	return nil
 }
@@ -215,7 +254,10 @@ func (m *Manager) CloseOpenDocument(ctx context.Context, uri string) error {
 	return m.CloseOpenDocumentWithReason(ctx, uri, RebuildReasonClose)
 }
 
-// CloseOpenDocumentWithReason removes the active open-document shadow for uri.
+// CloseOpenDocumentWithReason removes the active open-document shadow for uri
+// and drops the disk documents no remaining open document reaches. When other
+// open documents still include uri and its disk content may include different
+// files, their closures are left for RefreshOpenDocumentClosureWithReason.
 func (m *Manager) CloseOpenDocumentWithReason(ctx context.Context, uri string, reason RebuildReason) error {
 	_ = ctx
 	if m == nil {
@@ -235,13 +277,21 @@ func (m *Manager) CloseOpenDocumentWithReason(ctx context.Context, uri string, r
 		return nil
 	}
 	hadActive := slot.active() != nil
+	wasOpen := slot.open
 	slot.displayURI = displayURI
 	slot.open = nil
+	released := m.dropOpenClosureLocked(key)
+	if wasOpen != nil && (slot.disk == nil || !sameIncludePaths(wasOpen.summary, slot.disk.summary)) {
+		m.markClosureDependentsDirtyLocked(key)
+	}
 	hasActive := slot.active() != nil
 	if !hasActive {
 		delete(m.slots, key)
 	}
-	m.publishLocked([]DocumentKey{key}, hadActive != hasActive, reason, time.Since(start), rebuildStats{}, m.discoveryCompleteLocked())
+	changed, fullRebuild := m.releaseDirectLocked(released)
+	changed = append(changed, key)
+	slices.Sort(changed)
+	m.publishLocked(changed, fullRebuild || hadActive != hasActive, reason, time.Since(start), rebuildStats{}, m.discoveryCompleteLocked())
 	return nil
 }
 
@@ -262,8 +312,9 @@ func (m *Manager) RescanWorkspaceWithReason(ctx context.Context, reason RebuildR
 	}
 	scanDuration := time.Since(start)
 
-	cached := m.cachedDiskStates()
-	next, err := m.summarizeScannedFiles(ctx, result.files, cached)
+	cached, bandOf := m.cachedDiskStates()
+	progress := m.newDiscoveryProgress(reason, start, result)
+	next, err := m.summarizeScannedFiles(ctx, result.files, cached, bandOf, progress.record)
 	if err != nil {
 		return err
 	}
@@ -282,7 +333,9 @@ func (m *Manager) RescanWorkspaceWithReason(ctx context.Context, reason RebuildR
 	return nil
 }
 
-// RefreshOpenDocumentClosureWithReason rebuilds the on-disk closure reachable from open documents.
+// RefreshOpenDocumentClosureWithReason loads the on-disk closure reachable from
+// open documents. Only closures of documents opened or edited since the last
+// refresh, or reaching a document whose includes changed, are walked again.
 func (m *Manager) RefreshOpenDocumentClosureWithReason(ctx context.Context, reason RebuildReason) error {
 	if m == nil {
 		return errors.New("nil Manager")
@@ -295,114 +348,170 @@ func (m *Manager) RefreshOpenDocumentClosureWithReason(ctx context.Context, reas
 	}
 
 	m.mu.Lock()
-	openDocs, wasDiscoveryComplete := m.openDocumentSeedsLocked()
+	wasDiscoveryComplete := m.discoveryCompleteLocked()
+	var openDocs map[DocumentKey]*DocumentSummary
+	dirty := make(map[DocumentKey]activeDocumentIdentity, len(m.dirtyClosures))
+	if len(m.dirtyClosures) > 0 {
+		openDocs, _ = m.openDocumentSeedsLocked()
+		for key := range m.dirtyClosures {
+			if slot := m.slots[key]; slot != nil && slot.open != nil {
+				dirty[key] = identityForState(slot.open)
+			}
+		}
+		clear(m.dirtyClosures)
+	}
 	m.mu.Unlock()
 
-	loaded, err := m.loadOpenDocumentClosure(ctx, cfg, openDocs)
-	if err != nil {
-		return err
+	var closures map[DocumentKey]openClosure
+	if len(dirty) > 0 {
+		release := m.parseGate.enterForeground()
+		var err error
+		closures, err = m.loadOpenDocumentClosures(ctx, cfg, dirty, openDocs)
+		release()
+		if err != nil {
+			m.mu.Lock()
+			for key := range dirty {
+				m.dirtyClosures[key] = struct{}{}
+			}
+			m.mu.Unlock()
+			return err
+		}
 	}
 
 	m.mu.Lock()
 	defer m.mu.Unlock()
-	changed, fullRebuild := m.replaceDiskStatesLocked(loaded, diskSourceDirect)
+	changed, fullRebuild, directLoads := m.applyOpenClosuresLocked(closures)
 	if len(changed) == 0 && m.snapshot.Load() != nil && wasDiscoveryComplete == m.discoveryCompleteLocked() {
 		return nil
 	}
 	m.publishLocked(changed, fullRebuild || m.snapshot.Load() == nil, reason, time.Since(start), rebuildStats{
-		directLoads: len(loaded),
+		directLoads: directLoads,
 	}, m.discoveryCompleteLocked())
 	return nil
 }
 
 // RefreshDocumentWithReason refreshes one on-disk document after a watcher event.
 func (m *Manager) RefreshDocumentWithReason(ctx context.Context, uri string, deleted bool, reason RebuildReason) error {
+	return m.RefreshDocumentsWithReason(ctx, []DocumentChange{{URI: uri, Deleted: deleted}}, reason)
+}
+
+// RefreshDocumentsWithReason refreshes a batch of on-disk documents after
+// watcher events. Changes are deduplicated by document key, files whose size
+// and modification time are unchanged are not reparsed, and at most one
+// snapshot is published for the whole batch.
+func (m *Manager) RefreshDocumentsWithReason(ctx context.Context, changes []DocumentChange, reason RebuildReason) error {
 	if m == nil {
 		return errors.New("nil Manager")
 	}
 	start := time.Now()
 
-	displayURI, key, err := CanonicalizeDocumentURI(uri)
-	if err != nil {
-		return err
-	}
-	path, err := filePathFromDocumentURI(displayURI)
-	if err != nil {
-		return err
-	}
-	if !m.pathAllowed(path) {
-		return nil
-	}
-
-	m.mu.Lock()
-	defer m.mu.Unlock()
-
-	slot := m.ensureSlotLocked(key, displayURI)
-	if deleted {
-		if !m.clearDiskStateLocked(key, slot) {
-			return nil
+	targets := make(map[DocumentKey]scannedFile, len(changes))
+	deleted := make(map[DocumentKey]bool, len(changes))
+	order := make([]DocumentKey, 0, len(changes))
+	for _, change := range changes {
+		displayURI, key, err := CanonicalizeDocumentURI(change.URI)
+		if err != nil {
+			return err
+		}
+		path, err := filePathFromDocumentURI(displayURI)
+		if err != nil {
+			return err
 		}
-		if slot.open != nil {
-			return nil
+		if !m.pathAllowed(path) {
+			continue
 		}
-		m.publishLocked([]DocumentKey{key}, false, reason, time.Since(start), rebuildStats{
-			discoveredFiles: 1,
-		}, m.discoveryCompleteLocked())
-		return nil
-	}
 
-	info, statErr := os.Stat(path)
-	if statErr != nil {
-		if !os.IsNotExist(statErr) {
-			return statErr
-		}
-		if !m.clearDiskStateLocked(key, slot) {
-			return nil
+		file := scannedFile{Path: path, DisplayURI: displayURI, Key: key}
+		gone := change.Deleted
+		if !gone {
+			info, statErr := os.Stat(path)
+			switch {
+			case statErr != nil && !os.IsNotExist(statErr):
+				return statErr
+			case statErr != nil:
+				gone = true
+			case info.IsDir():
+				continue
+			default:
+				file.Size = info.Size()
+				file.ModTime = info.ModTime()
+			}
 		}
-		if slot.open != nil {
-			return nil
+		if _, ok := targets[key]; !ok {
+			order = append(order, key)
 		}
-		m.publishLocked([]DocumentKey{key}, false, reason, time.Since(start), rebuildStats{
-			discoveredFiles: 1,
-		}, m.discoveryCompleteLocked())
-		return nil
+		targets[key] = file
+		deleted[key] = gone
 	}
-	if info.IsDir() {
+	if len(order) == 0 {
 		return nil
 	}
 
-	if slot.disk != nil && slot.disk.size == info.Size() && slot.disk.modTime.Equal(info.ModTime()) {
-		return nil
+	m.mu.Lock()
+	pending := make([]scannedFile, 0, len(order))
+	for _, key := range order {
+		file := targets[key]
+		if deleted[key] {
+			continue
+		}
+		if slot := m.slots[key]; slot != nil && slot.disk != nil && slot.disk.size == file.Size && slot.disk.modTime.Equal(file.ModTime) {
+			continue
+		}
+		pending = append(pending, file)
 	}
+	bandOf := m.scanParseBandsLocked()
+	m.mu.Unlock()
 
-	src, err := os.ReadFile(path)
+	states, err := m.parseScannedFiles(ctx, pending, bandOf, nil)
 	if err != nil {
 		return err
 	}
-	in := DocumentInput{URI: displayURI, Version: -1, Generation: 0, Source: src}
-	summary, err := ParseAndSummarize(ctx, key, in)
-	if err != nil {
-		return err
+
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	changedSet := make(map[DocumentKey]struct{}, len(order))
+	for _, key := range order {
+		if !deleted[key] {
+			continue
+		}
+		slot := m.slots[key]
+		if !m.clearDiskStateLocked(key, slot) || slot.open != nil {
+			continue
+		}
+		changedSet[key] = struct{}{}
+	}
+	parsed := make(map[DocumentKey]loadedDiskState, len(states))
+	for _, state := range states {
+		parsed[state.file.Key] = state
 	}
-	before := identityForState(slot.active())
-	slot.disk = &documentState{
-		input:   DocumentInput{URI: displayURI, Version: -1, Generation: 0},
-		summary: summary,
-		size:    info.Size(),
-		modTime: info.ModTime(),
+	merged, fullRebuild := m.mergeDiskStatesLocked(parsed, diskSourceOpportunistic)
+	for _, key := range merged {
+		changedSet[key] = struct{}{}
 	}
-	slot.sources.opportunistic = true
-	after := identityForState(slot.active())
-	if slot.open != nil || sameActiveIdentity(before, after) {
+	if len(changedSet) == 0 {
 		return nil
 	}
-	fullRebuild := !before.present || !after.present
-	m.publishLocked([]DocumentKey{key}, fullRebuild || m.snapshot.Load() == nil, reason, time.Since(start), rebuildStats{
-		discoveredFiles: 1,
+
+	changed := make([]DocumentKey, 0, len(changedSet))
+	for key := range changedSet {
+		changed = append(changed, key)
+	}
+	slices.Sort(changed)
+	m.publishLocked(changed, fullRebuild || m.snapshot.Load() == nil, reason, time.Since(start), rebuildStats{
+		discoveredFiles: len(order),
 	}, m.discoveryCompleteLocked())
 	return nil
 }
 
+// ParseQueueDepths reports pending workspace parse jobs per priority band.
+func (m *Manager) ParseQueueDepths() ParseQueueDepths {
+	if m == nil {
+		return ParseQueueDepths{}
+	}
+	return m.parseQueue.depths()
+}
+
 // Snapshot returns the latest published workspace snapshot.
 func (m *Manager) Snapshot() (*WorkspaceSnapshot, bool) {
 	if m == nil {
@@ -429,6 +538,9 @@ func (m *Manager) clearDiskStateLocked(key DocumentKey, slot *documentSlot) bool
 	if slot == nil || slot.disk == nil {
 		return false
 	}
+	if !sameIncludePaths(slot.disk.summary, nil) {
+		m.markClosureDependentsDirtyLocked(key)
+	}
 	slot.disk = nil
 	slot.sources = diskSources{}
 	if slot.active() == nil {
@@ -453,24 +565,48 @@ func (m *Manager) discoveryCompleteLocked() bool {
 	return snapshot != nil && snapshot.DiscoveryComplete
 }
 
-func (m *Manager) loadOpenDocumentClosure(ctx context.Context, cfg resolverConfig, openDocs map[DocumentKey]*DocumentSummary) (map[DocumentKey]loadedDiskState, error) {
-	ctx = contextOrBackground(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
+// openClosure is the include closure walked from one open document.
+type openClosure struct {
+	identity activeDocumentIdentity
+	members  map[DocumentKey]struct{}
+	loaded   map[DocumentKey]loadedDiskState
+}
 
+// loadOpenDocumentClosures walks the closures of the dirty open documents.
+func (m *Manager) loadOpenDocumentClosures(ctx context.Context, cfg resolverConfig, dirty map[DocumentKey]activeDocumentIdentity, openDocs map[DocumentKey]*DocumentSummary) (map[DocumentKey]openClosure, error) {
+	ctx = contextOrBackground(ctx)
 	parser := syntax.NewReusableParser()
 	defer parser.Close()
 
-	loaded := make(map[DocumentKey]loadedDiskState)
-	queue := make([]*DocumentSummary, 0, len(openDocs))
+	closures := make(map[DocumentKey]openClosure, len(dirty))
 	for _, key := range sortedDocumentKeys(openDocs) {
-		queue = append(queue, openDocs[key])
+		identity, ok := dirty[key]
+		if !ok {
+			continue
+		}
+		closure, err := m.loadOpenDocumentClosure(ctx, parser, cfg, openDocs[key], openDocs)
+		if err != nil {
+			return nil, err
+		}
+		closure.identity = identity
+		closures[key] = closure
 	}
+	return closures, nil
+}
 
+// loadOpenDocumentClosure walks the includes reachable from root. Open
+// documents are followed through their shadows; other documents are loaded
+// from disk, reusing the summary of a file whose size and modification time
+// are unchanged.
+func (m *Manager) loadOpenDocumentClosure(ctx context.Context, parser *syntax.ReusableParser, cfg resolverConfig, root *DocumentSummary, openDocs map[DocumentKey]*DocumentSummary) (openClosure, error) {
+	closure := openClosure{
+		members: make(map[DocumentKey]struct{}),
+		loaded:  make(map[DocumentKey]loadedDiskState),
+	}
+	queue := []*DocumentSummary{root}
 	for len(queue) > 0 {
 		if err := ctx.Err(); err != nil {
-			return nil, err
+			return openClosure{}, err
 		}
 
 		doc := queue[0]
@@ -481,27 +617,168 @@ func (m *Manager) loadOpenDocumentClosure(ctx context.Context, cfg resolverConfi
 		for _, include := range doc.Includes {
 			file, ok, err := m.resolveIncludeFile(doc.URI, include.RawPath, cfg)
 			if err != nil {
-				return nil, err
+				return openClosure{}, err
 			}
-			if !ok {
+			if !ok || file.Key == root.Key {
 				continue
 			}
-			if _, ok := openDocs[file.Key]; ok {
+			if _, ok := closure.members[file.Key]; ok {
 				continue
 			}
-			if _, ok := loaded[file.Key]; ok {
+			closure.members[file.Key] = struct{}{}
+			if open, ok := openDocs[file.Key]; ok {
+				queue = append(queue, open)
 				continue
 			}
 
-			state, err := summarizeScannedFile(ctx, parser, file)
-			if err != nil {
-				return nil, err
+			state, ok := m.cachedDiskState(file)
+			if !ok {
+				state, err = summarizeScannedFile(ctx, parser, file, m.onParsedTree)
+				if err != nil {
+					return openClosure{}, err
+				}
 			}
-			loaded[file.Key] = state
+			closure.loaded[file.Key] = state
 			queue = append(queue, state.summary)
 		}
 	}
-	return loaded, nil
+	return closure, nil
+}
+
+// cachedDiskState returns the loaded state of file if its size and
+// modification time match the stored disk state.
+func (m *Manager) cachedDiskState(file scannedFile) (loadedDiskState, bool) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	slot := m.slots[file.Key]
+	if slot == nil || slot.disk == nil || slot.disk.summary == nil {
+		return loadedDiskState{}, false
+	}
+	cached := scannedFile{
+		Path:       file.Path,
+		DisplayURI: slot.disk.input.URI,
+		Key:        file.Key,
+		Size:       slot.disk.size,
+		ModTime:    slot.disk.modTime,
+	}
+	if !sameScannedFileMetadata(cached, file) {
+		return loadedDiskState{}, false
+	}
+	return loadedDiskState{file: file, summary: slot.disk.summary}, true
+}
+
+// applyOpenClosuresLocked replaces the stored closures of the walked open
+// documents, adjusting reference counts. Documents reached for the first time
+// gain their direct source and those no open document reaches any more lose
+// it. Closures of documents closed or edited since the walk are skipped;
+// closing or a later refresh accounts for them.
+func (m *Manager) applyOpenClosuresLocked(closures map[DocumentKey]openClosure) ([]DocumentKey, bool, int) {
+	var released []DocumentKey
+	loaded := make(map[DocumentKey]loadedDiskState)
+	for key, closure := range closures {
+		slot := m.slots[key]
+		if slot == nil || !sameActiveIdentity(identityForState(slot.open), closure.identity) {
+			continue
+		}
+		prev := m.closures[key]
+		for member := range closure.members {
+			if _, ok := prev[member]; !ok {
+				m.closureRefs[member]++
+			}
+		}
+		released = append(released, m.releaseMembersLocked(prev, closure.members)...)
+		m.closures[key] = closure.members
+		maps.Copy(loaded, closure.loaded)
+	}
+	maps.DeleteFunc(loaded, func(key DocumentKey, _ loadedDiskState) bool {
+		return m.closureRefs[key] == 0
+	})
+
+	changed, fullRebuild := m.mergeDiskStatesLocked(loaded, diskSourceDirect)
+	releasedChanged, releasedRebuild := m.releaseDirectLocked(released)
+	changed = append(changed, releasedChanged...)
+	slices.Sort(changed)
+	return slices.Compact(changed), fullRebuild || releasedRebuild, len(loaded)
+}
+
+// dropOpenClosureLocked forgets the closure of a closed document and returns
+// the documents it was the last to reach.
+func (m *Manager) dropOpenClosureLocked(key DocumentKey) []DocumentKey {
+	members := m.closures[key]
+	delete(m.closures, key)
+	delete(m.dirtyClosures, key)
+	return m.releaseMembersLocked(members, nil)
+}
+
+// releaseMembersLocked decrements the reference counts of the members of prev
+// missing from next and returns those that dropped to zero.
+func (m *Manager) releaseMembersLocked(prev, next map[DocumentKey]struct{}) []DocumentKey {
+	var released []DocumentKey
+	for member := range prev {
+		if _, ok := next[member]; ok {
+			continue
+		}
+		m.closureRefs[member]--
+		if m.closureRefs[member] <= 0 {
+			delete(m.closureRefs, member)
+			released = append(released, member)
+		}
+	}
+	return released
+}
+
+// releaseDirectLocked removes the direct source from unreferenced documents.
+func (m *Manager) releaseDirectLocked(keys []DocumentKey) ([]DocumentKey, bool) {
+	var changed []DocumentKey
+	fullRebuild := false
+	for _, key := range keys {
+		slot := m.slots[key]
+		if m.closureRefs[key] > 0 || slot == nil || !slot.hasSource(diskSourceDirect) {
+			continue
+		}
+		before := identityForState(slot.active())
+		slot.setSource(diskSourceDirect, false)
+		slot.clearDiskIfUnused()
+		after := identityForState(slot.active())
+		if slot.active() == nil {
+			delete(m.slots, key)
+		}
+		if sameActiveIdentity(before, after) {
+			continue
+		}
+		changed = append(changed, key)
+		if before.present != after.present {
+			fullRebuild = true
+		}
+	}
+	return changed, fullRebuild
+}
+
+// markClosureDependentsDirtyLocked schedules the open documents reaching key
+// for a closure walk, after the include edges of key changed.
+func (m *Manager) markClosureDependentsDirtyLocked(key DocumentKey) {
+	if m.closureRefs[key] == 0 {
+		return
+	}
+	for open, members := range m.closures {
+		if _, ok := members[key]; ok {
+			m.dirtyClosures[open] = struct{}{}
+		}
+	}
+}
+
+// sameIncludePaths reports whether two summaries include the same paths.
+func sameIncludePaths(a, b *DocumentSummary) bool {
+	var aIncludes, bIncludes []IncludeEdge
+	if a != nil {
+		aIncludes = a.Includes
+	}
+	if b != nil {
+		bIncludes = b.Includes
+	}
+	return slices.EqualFunc(aIncludes, bIncludes, func(x, y IncludeEdge) bool {
+		return x.RawPath == y.RawPath
+	})
 }
 
 func (m *Manager) resolveIncludeFile(uri, rawPath string, cfg resolverConfig) (scannedFile, bool, error) {
@@ -550,11 +827,21 @@ func (m *Manager) resolveIncludeFile(uri, rawPath string, cfg resolverConfig) (s
 }
 
 func (m *Manager) replaceDiskStatesLocked(next map[DocumentKey]loadedDiskState, kind diskSourceKind) ([]DocumentKey, bool) {
+	return m.applyDiskStatesLocked(next, kind, true)
+}
+
+// mergeDiskStatesLocked adds or updates disk states without dropping documents
+// missing from next; progressive discovery publishes partial batches this way.
+func (m *Manager) mergeDiskStatesLocked(next map[DocumentKey]loadedDiskState, kind diskSourceKind) ([]DocumentKey, bool) {
+	return m.applyDiskStatesLocked(next, kind, false)
+}
+
+func (m *Manager) applyDiskStatesLocked(next map[DocumentKey]loadedDiskState, kind diskSourceKind, prune bool) ([]DocumentKey, bool) {
 	changed := make(map[DocumentKey]struct{}, len(next)+len(m.slots))
 	fullRebuild := false
 	affected := make(map[DocumentKey]struct{}, len(next)+len(m.slots))
 	for key, slot := range m.slots {
-		if slot == nil || !slot.hasSource(kind) {
+		if !prune || slot == nil || !slot.hasSource(kind) {
 			continue
 		}
 		affected[key] = struct{}{}
@@ -591,6 +878,9 @@ func (m *Manager) replaceDiskStatesLocked(next map[DocumentKey]loadedDiskState,
 		if sameLoadedDiskState(slot.disk, state) {
 			continue
 		}
+		if slot.disk != nil && !sameIncludePaths(slot.disk.summary, state.summary) {
+			m.markClosureDependentsDirtyLocked(key)
+		}
 		slot.disk = &documentState{
 			input:   DocumentInput{URI: state.file.DisplayURI, Version: -1, Generation: 0},
 			summary: state.summary,
@@ -636,7 +926,7 @@ func sameScannedFileMetadata(a, b scannedFile) bool {
 	return a.Key == b.Key && a.DisplayURI == b.DisplayURI && a.Size == b.Size && a.ModTime.Equal(b.ModTime)
 }
 
-func (m *Manager) cachedDiskStates() map[DocumentKey]loadedDiskState {
+func (m *Manager) cachedDiskStates() (map[DocumentKey]loadedDiskState, func(DocumentKey) parseBand) {
 	m.mu.Lock()
 	defer m.mu.Unlock()
 
@@ -656,7 +946,7 @@ func (m *Manager) cachedDiskStates() map[DocumentKey]loadedDiskState {
 			summary: slot.disk.summary,
 		}
 	}
-	return out
+	return out, m.scanParseBandsLocked()
 }
 
 func documentPathOrEmpty(uri string) string {
@@ -676,12 +966,16 @@ type rebuildStats struct {
 func (m *Manager) publishLocked(changed []DocumentKey, fullRebuild bool, reason RebuildReason, duration time.Duration, stats rebuildStats, discoveryComplete bool) {
 	prev := m.snapshot.Load()
 	baseDocs := make(map[DocumentKey]*DocumentSummary, len(m.slots))
+	settled := make(map[DocumentKey]struct{})
 	for key, slot := range m.slots {
 		active := slot.active()
 		if active == nil || active.summary == nil {
 			continue
 		}
 		baseDocs[key] = active.summary
+		if slot.open != nil || slot.hasSource(diskSourceDirect) {
+			settled[key] = struct{}{}
+		}
 	}
 
 	impactedCount := len(baseDocs)
@@ -691,7 +985,7 @@ func (m *Manager) publishLocked(changed []DocumentKey, fullRebuild bool, reason
 	next := buildSnapshot(prev, baseDocs, changed, fullRebuild, resolverConfig{
 		roots:       slices.Clone(m.roots),
 		includeDirs: slices.Clone(m.includeDirs),
-	}, discoveryComplete)
+	}, settled, discoveryComplete)
 	m.snapshot.Store(next)
 	scanDuration := time.Duration(0)
 	if stats.discoveredFiles > 0 {
@@ -730,7 +1024,7 @@ func (m *Manager) sourceCountsLocked() (direct int, opportunistic int) {
 	return direct, opportunistic
 }
 
-func buildSnapshot(prev *WorkspaceSnapshot, baseDocs map[DocumentKey]*DocumentSummary, changed []DocumentKey, fullRebuild bool, cfg resolverConfig, discoveryComplete bool) *WorkspaceSnapshot {
+func buildSnapshot(prev *WorkspaceSnapshot, baseDocs map[DocumentKey]*DocumentSummary, changed []DocumentKey, fullRebuild bool, cfg resolverConfig, settled map[DocumentKey]struct{}, discoveryComplete bool) *WorkspaceSnapshot {
 	if fullRebuild || prev == nil {
 		changed = sortedDocumentKeys(baseDocs)
 	}
@@ -759,38 +1053,26 @@ func buildSnapshot(prev *WorkspaceSnapshot, baseDocs map[DocumentKey]*DocumentSu
 		}
 	}
 
-	symbolsByID, symbolsByQName, byDocument := buildSymbolIndexes(docs)
+	symbols := newSymbolTable(docs)
 	if fullRebuild || prev == nil {
 		for _, key := range sortedDocumentKeys(docs) {
-			bindReferencesForSummary(docs[key], byDocument)
+			bindReferencesForSummary(docs[key], symbols)
 		}
 	} else {
 		for key := range impacted {
 			if doc := docs[key]; doc != nil {
-				bindReferencesForSummary(doc, byDocument)
+				bindReferencesForSummary(doc, symbols)
 			}
 		}
 	}
+	symbols.indexReferences()
 
 	graph := buildIncludeGraph(docs)
-	refsByTarget := make(map[SymbolID][]ReferenceSiteID)
+	markClosureCompleteness(docs, graph, settled, discoveryComplete)
 	issues := make([]IndexDiagnostic, 0, 8)
-	for _, key := range sortedDocumentKeys(docs) {
-		doc := docs[key]
-		if doc == nil {
-			continue
-		}
-		for _, ref := range doc.References {
-			if ref.Binding.Status != BindingStatusBound {
-				continue
-			}
-			refsByTarget[ref.Binding.Target] = append(refsByTarget[ref.Binding.Target], ref.ID)
-		}
+	for _, doc := range symbols.docs {
 		issues = append(issues, doc.Diagnostics...)
 	}
-	for _, ids := range refsByTarget {
-		slices.Sort(ids)
-	}
 	sortDiagnostics(issues)
 
 	nextGen := uint64(1)
@@ -801,12 +1083,10 @@ func buildSnapshot(prev *WorkspaceSnapshot, baseDocs map[DocumentKey]*DocumentSu
 		Generation:        nextGen,
 		DiscoveryComplete: discoveryComplete,
 		Documents:         docs,
-		SymbolsByID:       symbolsByID,
-		SymbolsByQName:    symbolsByQName,
-		RefsByTarget:      refsByTarget,
 		IncludeGraph:      graph,
 		ReverseDeps:       graph.Reverse,
 		SnapshotIssues:    issues,
+		symbols:           symbols,
 	}
 }
 
@@ -855,16 +1135,12 @@ func cloneSummary(in *DocumentSummary) *DocumentSummary {
 	if in == nil {
 		return nil
 	}
+	// Namespaces and declarations are never modified after summarization and
+	// are shared; resolution rewrites includes, bindings and diagnostics.
 	out := *in
 	out.Includes = slices.Clone(in.Includes)
-	out.Namespaces = slices.Clone(in.Namespaces)
-	out.Declarations = slices.Clone(in.Declarations)
 	out.Diagnostics = cloneDiagnostics(in.Diagnostics)
-	out.References = make([]ReferenceSite, len(in.References))
-	for i := range in.References {
-		out.References[i] = in.References[i]
-		out.References[i].ExpectedKinds = cloneKinds(in.References[i].ExpectedKinds)
-	}
+	out.References = slices.Clone(in.References)
 	return &out
 }
 
@@ -979,6 +1255,7 @@ func (m *Manager) emit(event Event) {
 	if m.queueDepth != nil {
 		event.BackgroundQueueDepth = m.queueDepth()
 	}
+	event.ParseQueueDepths = m.parseQueue.depths()
 	if len(event.RenameBlockers) != 0 {
 		event.RenameBlockers = maps.Clone(event.RenameBlockers)
 	}
@@ -4,8 +4,10 @@ import (
 	"context"
 	"os"
 	"path/filepath"
+	"strconv"
 	"strings"
 	"testing"
+	"time"
 
 	"github.com/kpumuk/thrift-weaver/internal/testutil"
 )
@@ -33,7 +35,7 @@ func TestManagerResolvesIncludesAndBindings(t *testing.T) {
 		t.Fatalf("binding status=%q, want %q", got, BindingStatusBound)
 	}
 
-	target := snap.SymbolsByID[mainDoc.References[0].Binding.Target]
+	target, _ := snap.Symbol(mainDoc.References[0].Binding.Target)
 	if target.Name != "User" || target.Kind != SymbolKindStruct {
 		t.Fatalf("target=%+v, want User struct", target)
 	}
@@ -247,6 +249,282 @@ func TestManagerRefreshOpenDocumentClosureBypassesGitIgnore(t *testing.T) {
 	}
 }
 
+func TestManagerCloseDropsOnlyUnreachedClosureDocuments(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	files := map[string]string{
+		"a.thrift":      "include \"shared.thrift\"\n",
+		"b.thrift":      "include \"shared.thrift\"\ninclude \"c.thrift\"\n",
+		"c.thrift":      "include \"leaf.thrift\"\n",
+		"shared.thrift": "include \"leaf.thrift\"\n",
+		"leaf.thrift":   "struct Leaf {\n  1: i32 id,\n}\n",
+	}
+	for name, src := range files {
+		if err := os.WriteFile(filepath.Join(root, name), []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile %s: %v", name, err)
+		}
+	}
+	path := func(name string) string { return filepath.Join(root, name) }
+
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+	for _, name := range []string{"a.thrift", "b.thrift", "c.thrift"} {
+		if err := m.UpsertOpenDocumentWithReason(context.Background(), DocumentInput{
+			URI:        path(name),
+			Version:    1,
+			Generation: 1,
+			Source:     []byte(files[name]),
+		}, RebuildReasonOpen); err != nil {
+			t.Fatalf("UpsertOpenDocumentWithReason(%s): %v", name, err)
+		}
+	}
+	if err := m.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonOpen); err != nil {
+		t.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+	}
+	snap := mustSnapshot(t, m)
+	mustDocument(t, snap, path("shared.thrift"))
+	mustDocument(t, snap, path("leaf.thrift"))
+
+	closeDocument := func(name string) *WorkspaceSnapshot {
+		t.Helper()
+		before := mustSnapshot(t, m).Generation
+		if err := m.CloseOpenDocumentWithReason(context.Background(), path(name), RebuildReasonClose); err != nil {
+			t.Fatalf("CloseOpenDocumentWithReason(%s): %v", name, err)
+		}
+		if err := m.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonClose); err != nil {
+			t.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+		}
+		snap := mustSnapshot(t, m)
+		if snap.Generation != before+1 {
+			t.Fatalf("closing %s published %d snapshots, want 1", name, snap.Generation-before)
+		}
+		return snap
+	}
+
+	// b.thrift still reaches shared.thrift.
+	snap = closeDocument("a.thrift")
+	mustDocument(t, snap, path("shared.thrift"))
+
+	// c.thrift is still included by b.thrift and is loaded from disk.
+	if err := m.CloseOpenDocumentWithReason(context.Background(), path("c.thrift"), RebuildReasonClose); err != nil {
+		t.Fatalf("CloseOpenDocumentWithReason: %v", err)
+	}
+	if err := m.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonClose); err != nil {
+		t.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+	}
+	if doc := mustDocument(t, mustSnapshot(t, m), path("c.thrift")); doc.Version != -1 {
+		t.Fatalf("c.thrift version=%d, want disk version -1", doc.Version)
+	}
+
+	snap = closeDocument("b.thrift")
+	for _, name := range []string{"a.thrift", "b.thrift", "c.thrift", "shared.thrift", "leaf.thrift"} {
+		_, key, err := CanonicalizeDocumentURI(path(name))
+		if err != nil {
+			t.Fatalf("CanonicalizeDocumentURI: %v", err)
+		}
+		if _, ok := snap.Documents[key]; ok {
+			t.Fatalf("%s still indexed after every document closed", name)
+		}
+	}
+}
+
+func TestManagerRefreshOpenDocumentClosureFollowsIncludeEdits(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	mainPath := filepath.Join(root, "main.thrift")
+	sharedPath := filepath.Join(root, "shared.thrift")
+	if err := os.WriteFile(sharedPath, []byte("struct User {\n  1: string name,\n}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+	upsert := func(version int32, src string) *WorkspaceSnapshot {
+		t.Helper()
+		if err := m.UpsertOpenDocumentWithReason(context.Background(), DocumentInput{
+			URI:        mainPath,
+			Version:    version,
+			Generation: uint64(version),
+			Source:     []byte(src),
+		}, RebuildReasonChange); err != nil {
+			t.Fatalf("UpsertOpenDocumentWithReason: %v", err)
+		}
+		if err := m.RefreshOpenDocumentClosureWithReason(context.Background(), RebuildReasonChange); err != nil {
+			t.Fatalf("RefreshOpenDocumentClosureWithReason: %v", err)
+		}
+		return mustSnapshot(t, m)
+	}
+
+	mustDocument(t, upsert(1, "include \"shared.thrift\"\n"), sharedPath)
+	snap := upsert(2, "struct Holder {}\n")
+	_, key, err := CanonicalizeDocumentURI(sharedPath)
+	if err != nil {
+		t.Fatalf("CanonicalizeDocumentURI: %v", err)
+	}
+	if _, ok := snap.Documents[key]; ok {
+		t.Fatal("shared.thrift still indexed after its include was removed")
+	}
+	mustDocument(t, upsert(3, "include \"shared.thrift\"\n"), sharedPath)
+}
+
+func TestManagerPublishesProgressiveDiscoverySnapshots(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	mainPath := filepath.Join(root, "main.thrift")
+	sharedPath := filepath.Join(root, "shared.thrift")
+	mainSource := "include \"shared.thrift\"\n\nstruct Holder {\n  1: shared.User user,\n}\n" + strings.Repeat("// padding\n", 64)
+	files := map[string]string{
+		mainPath:   mainSource,
+		sharedPath: "struct User {\n  1: string name,\n}\n",
+	}
+	for i := range 4 {
+		files[filepath.Join(root, "extra"+strconv.Itoa(i)+".thrift")] = "struct Extra {\n  1: string name,\n}\n" + strings.Repeat("// filler\n", 16)
+	}
+	for path, src := range files {
+		if err := os.WriteFile(path, []byte(src), 0o600); err != nil {
+			t.Fatalf("WriteFile %s: %v", path, err)
+		}
+	}
+
+	var (
+		m         *Manager
+		snapshots []*WorkspaceSnapshot
+	)
+	m = NewManager(Options{
+		WorkspaceRoots: []string{root},
+		ParseWorkers:   1,
+		Hooks: Hooks{OnEvent: func(event Event) {
+			if event.Kind != EventKindRebuild {
+				return
+			}
+			if snap, ok := m.Snapshot(); ok {
+				snapshots = append(snapshots, snap)
+			}
+		}},
+	})
+	defer m.Close()
+	m.discoveryPublishFiles = 1
+	m.discoveryPublishInterval = time.Hour
+
+	if err := m.RescanWorkspace(context.Background()); err != nil {
+		t.Fatalf("RescanWorkspace: %v", err)
+	}
+	if len(snapshots) < 3 {
+		t.Fatalf("published %d snapshots, want intermediate discovery snapshots", len(snapshots))
+	}
+
+	first := snapshots[0]
+	if first.DiscoveryComplete {
+		t.Fatal("first intermediate snapshot should not be discovery complete")
+	}
+	if got := len(first.Documents); got != 1 {
+		t.Fatalf("first snapshot documents=%d, want largest file only", got)
+	}
+	if mustDocument(t, first, mainPath).ClosureComplete {
+		t.Fatal("main closure should be incomplete before shared.thrift is parsed")
+	}
+
+	second := snapshots[1]
+	if second.DiscoveryComplete {
+		t.Fatal("second intermediate snapshot should not be discovery complete")
+	}
+	mainDoc := mustDocument(t, second, mainPath)
+	if mustDocument(t, second, sharedPath) == nil || !mainDoc.ClosureComplete {
+		t.Fatal("shared.thrift should be promoted ahead of unrelated files and complete main's closure")
+	}
+	if got := mainDoc.References[0].Binding.Status; got != BindingStatusBound {
+		t.Fatalf("binding status=%q, want %q", got, BindingStatusBound)
+	}
+
+	final := snapshots[len(snapshots)-1]
+	if !final.DiscoveryComplete || len(final.Documents) != len(files) {
+		t.Fatalf("final snapshot complete=%t documents=%d, want complete with %d", final.DiscoveryComplete, len(final.Documents), len(files))
+	}
+	for i := 1; i < len(snapshots); i++ {
+		if snapshots[i].Generation <= snapshots[i-1].Generation {
+			t.Fatalf("snapshot generations not increasing: %d then %d", snapshots[i-1].Generation, snapshots[i].Generation)
+		}
+	}
+}
+
+func TestManagerRefreshDocumentsPublishesOneSnapshotPerBatch(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	paths := make([]string, 4)
+	for i := range paths {
+		paths[i] = filepath.Join(root, "file"+strconv.Itoa(i)+".thrift")
+		if err := os.WriteFile(paths[i], []byte("struct Type"+strconv.Itoa(i)+" {}\n"), 0o600); err != nil {
+			t.Fatalf("WriteFile %s: %v", paths[i], err)
+		}
+	}
+
+	var rebuilds []Event
+	m := NewManager(Options{
+		WorkspaceRoots: []string{root},
+		Hooks: Hooks{OnEvent: func(event Event) {
+			if event.Kind == EventKindRebuild {
+				rebuilds = append(rebuilds, event)
+			}
+		}},
+	})
+	defer m.Close()
+	if err := m.RescanWorkspace(context.Background()); err != nil {
+		t.Fatalf("RescanWorkspace: %v", err)
+	}
+	rebuilds = nil
+
+	if err := os.WriteFile(paths[0], []byte("struct Changed {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+	if err := os.Remove(paths[1]); err != nil {
+		t.Fatalf("Remove: %v", err)
+	}
+	added := filepath.Join(root, "added.thrift")
+	if err := os.WriteFile(added, []byte("struct Added {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile: %v", err)
+	}
+
+	changes := []DocumentChange{
+		{URI: paths[0]},
+		{URI: paths[0]},
+		{URI: paths[1], Deleted: true},
+		{URI: paths[2]},
+		{URI: added},
+	}
+	if err := m.RefreshDocumentsWithReason(context.Background(), changes, RebuildReasonWatch); err != nil {
+		t.Fatalf("RefreshDocumentsWithReason: %v", err)
+	}
+	if len(rebuilds) != 1 {
+		t.Fatalf("rebuild events=%d, want one for the batch", len(rebuilds))
+	}
+	if got := rebuilds[0].ImpactedDocuments; got > 4 {
+		t.Fatalf("ImpactedDocuments=%d, want only touched documents and dependents", got)
+	}
+
+	snap := mustSnapshot(t, m)
+	if got := mustDocument(t, snap, paths[0]).Declarations[0].Name; got != "Changed" {
+		t.Fatalf("changed declaration=%q, want Changed", got)
+	}
+	if mustDocument(t, snap, added) == nil {
+		t.Fatal("expected added document")
+	}
+	if _, key, _ := CanonicalizeDocumentURI(paths[1]); snap.Documents[key] != nil {
+		t.Fatal("deleted document should leave the snapshot")
+	}
+
+	rebuilds = nil
+	if err := m.RefreshDocumentsWithReason(context.Background(), []DocumentChange{{URI: paths[2]}, {URI: paths[3]}}, RebuildReasonWatch); err != nil {
+		t.Fatalf("RefreshDocumentsWithReason unchanged: %v", err)
+	}
+	if len(rebuilds) != 0 {
+		t.Fatalf("unchanged files published %d snapshots, want none", len(rebuilds))
+	}
+}
+
 func mustSnapshot(t *testing.T, m *Manager) *WorkspaceSnapshot {
 	t.Helper()
 	snap, ok := m.Snapshot()
@@ -0,0 +1,367 @@
+package index
+
+import (
+	"cmp"
+	"context"
+	"slices"
+	"sync"
+	"sync/atomic"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// parseBand orders workspace parse work by how soon an editor session needs it.
+type parseBand uint8
+
+const (
+	// parseBandOpenClosure covers documents reachable from an open document's include closure.
+	parseBandOpenClosure parseBand = iota
+	// parseBandDirectInclude covers documents that another indexed document includes directly.
+	parseBandDirectInclude
+	// parseBandDiscovery covers the remaining opportunistic discovery work.
+	parseBandDiscovery
+
+	parseBandCount
+)
+
+type parseJob struct {
+	index int
+	band  parseBand
+	cost  int64
+}
+
+func compareParseJobs(a, b parseJob) int {
+	if c := cmp.Compare(a.band, b.band); c != 0 {
+		return c
+	}
+	if c := cmp.Compare(b.cost, a.cost); c != 0 {
+		return c
+	}
+	return cmp.Compare(a.index, b.index)
+}
+
+// parseGate lets foreground open-document work preempt background scan bands.
+type parseGate struct {
+	mu         sync.Mutex
+	foreground int
+	released   chan struct{}
+}
+
+func (g *parseGate) enterForeground() func() {
+	if g == nil {
+		return func() {}
+	}
+	g.mu.Lock()
+	if g.foreground == 0 {
+		g.released = make(chan struct{})
+	}
+	g.foreground++
+	g.mu.Unlock()
+
+	var once sync.Once
+	return func() {
+		once.Do(func() {
+			g.mu.Lock()
+			defer g.mu.Unlock()
+			g.foreground--
+			if g.foreground == 0 {
+				close(g.released)
+				g.released = nil
+			}
+		})
+	}
+}
+
+func (g *parseGate) preempted() (<-chan struct{}, bool) {
+	if g == nil {
+		return nil, false
+	}
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	if g.foreground == 0 {
+		return nil, false
+	}
+	return g.released, true
+}
+
+// parseQueueCounters tracks pending parse jobs per band across active schedulers.
+type parseQueueCounters [parseBandCount]atomic.Int64
+
+func (c *parseQueueCounters) add(band parseBand, delta int64) {
+	if c == nil {
+		return
+	}
+	c[band].Add(delta)
+}
+
+func (c *parseQueueCounters) depths() ParseQueueDepths {
+	if c == nil {
+		return ParseQueueDepths{}
+	}
+	return ParseQueueDepths{
+		OpenClosure:    int(c[parseBandOpenClosure].Load()),
+		DirectIncludes: int(c[parseBandDirectInclude].Load()),
+		Discovery:      int(c[parseBandDiscovery].Load()),
+	}
+}
+
+// parseScheduler hands out parse jobs by band, longest job first within a band,
+// and lets idle workers steal from the most loaded worker in the same band.
+// Promoted jobs are re-queued in their new band; the old queue entry goes
+// stale and is skipped when reached.
+type parseScheduler struct {
+	mu       sync.Mutex
+	queues   [][parseBandCount][]parseJob
+	bands    []parseBand
+	taken    []bool
+	gate     *parseGate
+	counters *parseQueueCounters
+}
+
+func newParseScheduler(jobs []parseJob, workers int, gate *parseGate, counters *parseQueueCounters) *parseScheduler {
+	workers = max(workers, 1)
+	sorted := slices.Clone(jobs)
+	slices.SortFunc(sorted, compareParseJobs)
+
+	size := 0
+	for _, job := range jobs {
+		size = max(size, job.index+1)
+	}
+	s := &parseScheduler{
+		queues:   make([][parseBandCount][]parseJob, workers),
+		bands:    make([]parseBand, size),
+		taken:    make([]bool, size),
+		gate:     gate,
+		counters: counters,
+	}
+	var dealt [parseBandCount]int
+	for _, job := range sorted {
+		s.bands[job.index] = job.band
+		worker := dealt[job.band] % workers
+		dealt[job.band]++
+		s.queues[worker][job.band] = append(s.queues[worker][job.band], job)
+		counters.add(job.band, 1)
+	}
+	return s
+}
+
+// next returns the next job for worker. Bands below parseBandOpenClosure wait
+// while foreground open-document work holds the gate.
+func (s *parseScheduler) next(ctx context.Context, worker int) (parseJob, bool, error) {
+	for {
+		if err := ctx.Err(); err != nil {
+			return parseJob{}, false, err
+		}
+		wait, preempted := s.gate.preempted()
+
+		s.mu.Lock()
+		job, ok, blocked := s.takeLocked(worker, preempted)
+		s.mu.Unlock()
+		if ok {
+			s.counters.add(job.band, -1)
+			return job, true, nil
+		}
+		if !blocked {
+			return parseJob{}, false, nil
+		}
+
+		select {
+		case <-wait:
+		case <-ctx.Done():
+			return parseJob{}, false, ctx.Err()
+		}
+	}
+}
+
+func (s *parseScheduler) takeLocked(worker int, preempted bool) (job parseJob, ok bool, blocked bool) {
+	for band := range parseBandCount {
+		if preempted && band > parseBandOpenClosure {
+			if s.pendingLocked(band) {
+				blocked = true
+			}
+			continue
+		}
+		if job, ok := s.popLocked(worker, band); ok {
+			return job, true, false
+		}
+		for {
+			victim := -1
+			for i := range s.queues {
+				if len(s.queues[i][band]) == 0 {
+					continue
+				}
+				if victim < 0 || len(s.queues[i][band]) > len(s.queues[victim][band]) {
+					victim = i
+				}
+			}
+			if victim < 0 {
+				break
+			}
+			if job, ok := s.popLocked(victim, band); ok {
+				return job, true, false
+			}
+		}
+	}
+	return parseJob{}, false, blocked
+}
+
+func (s *parseScheduler) popLocked(worker int, band parseBand) (parseJob, bool) {
+	for len(s.queues[worker][band]) > 0 {
+		job := s.queues[worker][band][0]
+		s.queues[worker][band] = s.queues[worker][band][1:]
+		if s.staleLocked(job) {
+			continue
+		}
+		s.taken[job.index] = true
+		return job, true
+	}
+	return parseJob{}, false
+}
+
+func (s *parseScheduler) staleLocked(job parseJob) bool {
+	return s.taken[job.index] || s.bands[job.index] != job.band
+}
+
+func (s *parseScheduler) pendingLocked(band parseBand) bool {
+	for i := range s.queues {
+		for _, job := range s.queues[i][band] {
+			if !s.staleLocked(job) {
+				return true
+			}
+		}
+	}
+	return false
+}
+
+// promote moves a queued job into a higher-priority band, for example once a
+// parsed file shows that it includes the job's document.
+func (s *parseScheduler) promote(index int, band parseBand) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if index < 0 || index >= len(s.bands) || s.taken[index] || s.bands[index] <= band {
+		return
+	}
+
+	var job parseJob
+	found := false
+	for i := range s.queues {
+		for _, queued := range s.queues[i][s.bands[index]] {
+			if queued.index == index {
+				job, found = queued, true
+				break
+			}
+		}
+		if found {
+			break
+		}
+	}
+	if !found {
+		return
+	}
+
+	s.counters.add(job.band, -1)
+	s.counters.add(band, 1)
+	s.bands[index] = band
+	job.band = band
+
+	target := 0
+	for i := range s.queues {
+		if len(s.queues[i][band]) < len(s.queues[target][band]) {
+			target = i
+		}
+	}
+	queue := s.queues[target][band]
+	at, _ := slices.BinarySearchFunc(queue, job, compareParseJobs)
+	s.queues[target][band] = slices.Insert(queue, at, job)
+}
+
+// drain drops jobs left behind by cancellation so queue depth stays accurate.
+func (s *parseScheduler) drain() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	for i := range s.queues {
+		for band := range parseBandCount {
+			for _, job := range s.queues[i][band] {
+				if !s.staleLocked(job) {
+					s.counters.add(band, -1)
+					s.taken[job.index] = true
+				}
+			}
+			s.queues[i][band] = nil
+		}
+	}
+}
+
+// run parses all scheduled jobs. Each worker owns one reusable parser; a
+// single worker runs inline on the calling goroutine.
+func (s *parseScheduler) run(ctx context.Context, parse func(context.Context, *syntax.ReusableParser, parseJob) error) error {
+	ctx = contextOrBackground(ctx)
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+	defer s.drain()
+
+	work := func(worker int) {
+		parser := syntax.NewReusableParser()
+		defer parser.Close()
+
+		for {
+			job, ok, err := s.next(ctx, worker)
+			if err != nil || !ok {
+				return
+			}
+			if err := parse(ctx, parser, job); err != nil {
+				cancel()
+				return
+			}
+		}
+	}
+
+	if len(s.queues) == 1 {
+		work(0)
+		return ctx.Err()
+	}
+
+	var wg sync.WaitGroup
+	for worker := range s.queues {
+		wg.Go(func() {
+			work(worker)
+		})
+	}
+	wg.Wait()
+	return ctx.Err()
+}
+
+func (m *Manager) scanParseBandsLocked() func(DocumentKey) parseBand {
+	snapshot := m.snapshot.Load()
+	if snapshot == nil {
+		return nil
+	}
+
+	closure := make(map[DocumentKey]struct{})
+	queue := make([]DocumentKey, 0, len(m.slots))
+	for key, slot := range m.slots {
+		if slot != nil && slot.open != nil {
+			queue = append(queue, key)
+		}
+	}
+	for len(queue) > 0 {
+		key := queue[0]
+		queue = queue[1:]
+		if _, ok := closure[key]; ok {
+			continue
+		}
+		closure[key] = struct{}{}
+		queue = append(queue, snapshot.IncludeGraph.Forward[key]...)
+	}
+
+	reverse := snapshot.IncludeGraph.Reverse
+	return func(key DocumentKey) parseBand {
+		if _, ok := closure[key]; ok {
+			return parseBandOpenClosure
+		}
+		if len(reverse[key]) > 0 {
+			return parseBandDirectInclude
+		}
+		return parseBandDiscovery
+	}
+}
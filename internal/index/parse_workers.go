@@ -4,12 +4,14 @@ import (
 	"context"
 	"fmt"
 	"os"
-	"sync"
+	"path/filepath"
+	"strings"
 
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	"github.com/kpumuk/thrift-weaver/internal/text"
 )
 
-func (m *Manager) summarizeScannedFiles(ctx context.Context, files []scannedFile, cached map[DocumentKey]loadedDiskState) (map[DocumentKey]loadedDiskState, error) {
+func (m *Manager) summarizeScannedFiles(ctx context.Context, files []scannedFile, cached map[DocumentKey]loadedDiskState, bandOf func(DocumentKey) parseBand, onParsed func(loadedDiskState)) (map[DocumentKey]loadedDiskState, error) {
 	next := make(map[DocumentKey]loadedDiskState, len(files))
 	pending := make([]scannedFile, 0, len(files))
 	for _, file := range files {
@@ -20,7 +22,7 @@ func (m *Manager) summarizeScannedFiles(ctx context.Context, files []scannedFile
 		pending = append(pending, file)
 	}
 
-	states, err := m.parseScannedFiles(ctx, pending)
+	states, err := m.parseScannedFiles(ctx, pending, bandOf, onParsed)
 	if err != nil {
 		return nil, err
 	}
@@ -30,83 +32,97 @@ func (m *Manager) summarizeScannedFiles(ctx context.Context, files []scannedFile
 	return next, nil
 }
 
-func (m *Manager) parseScannedFiles(ctx context.Context, files []scannedFile) ([]loadedDiskState, error) {
+func (m *Manager) parseScannedFiles(ctx context.Context, files []scannedFile, bandOf func(DocumentKey) parseBand, onParsed func(loadedDiskState)) ([]loadedDiskState, error) {
 	if len(files) == 0 {
 		return nil, nil
 	}
 	workers := 1
+	var (
+		gate     *parseGate
+		counters *parseQueueCounters
+		onTree   func(DocumentKey, string, *syntax.Tree)
+	)
 	if m != nil {
 		workers = min(m.parseWorkers, len(files))
+		gate = &m.parseGate
+		counters = &m.parseQueue
+		onTree = m.onParsedTree
 	}
-	if workers <= 1 {
-		return parseScannedFilesSequential(ctx, files)
-	}
-	return parseScannedFilesParallel(ctx, files, workers)
-}
-
-func parseScannedFilesSequential(ctx context.Context, files []scannedFile) ([]loadedDiskState, error) {
-	parser := syntax.NewReusableParser()
-	defer parser.Close()
 
-	out := make([]loadedDiskState, len(files))
+	jobs := make([]parseJob, len(files))
 	for i, file := range files {
-		state, err := summarizeScannedFile(ctx, parser, file)
-		if err != nil {
-			return nil, err
+		band := parseBandDiscovery
+		if bandOf != nil {
+			band = bandOf(file.Key)
 		}
-		out[i] = state
+		jobs[i] = parseJob{index: i, band: band, cost: file.Size}
 	}
-	return out, nil
-}
-
-func parseScannedFilesParallel(ctx context.Context, files []scannedFile, workers int) ([]loadedDiskState, error) {
-	ctx = contextOrBackground(ctx)
-	ctx, cancel := context.WithCancel(ctx)
-	defer cancel()
 
 	results := make([]loadedDiskState, len(files))
 	errs := make([]error, len(files))
-	jobs := make(chan int)
-
-	var wg sync.WaitGroup
-	for range workers {
-		wg.Go(func() {
-			parser := syntax.NewReusableParser()
-			defer parser.Close()
-
-			for idx := range jobs {
-				state, err := summarizeScannedFile(ctx, parser, files[idx])
-				if err != nil {
-					errs[idx] = err
-					cancel()
-					continue
-				}
-				results[idx] = state
-			}
-		})
-	}
-
-	for i := range files {
-		if err := ctx.Err(); err != nil {
-			break
+	scheduler := newParseScheduler(jobs, workers, gate, counters)
+	promoteIncludes := m.includePromoter(files, scheduler)
+	runErr := scheduler.run(ctx, func(ctx context.Context, parser *syntax.ReusableParser, job parseJob) error {
+		state, err := summarizeScannedFile(ctx, parser, files[job.index], onTree)
+		if err != nil {
+			errs[job.index] = err
+			return err
 		}
-		jobs <- i
-	}
-	close(jobs)
-	wg.Wait()
+		results[job.index] = state
+		promoteIncludes(job, state)
+		if onParsed != nil {
+			onParsed(state)
+		}
+		return nil
+	})
 
 	for _, err := range errs {
 		if err != nil {
 			return nil, err
 		}
 	}
-	if err := ctx.Err(); err != nil {
-		return nil, err
+	if runErr != nil {
+		return nil, runErr
 	}
 	return results, nil
 }
 
-func summarizeScannedFile(ctx context.Context, parser *syntax.ReusableParser, file scannedFile) (loadedDiskState, error) {
+// includePromoter returns a callback that moves pending includes of a parsed
+// file into the direct-include band, or into the open-closure band when the
+// includer belongs to it, so that closures complete before unrelated files.
+func (m *Manager) includePromoter(files []scannedFile, scheduler *parseScheduler) func(parseJob, loadedDiskState) {
+	if m == nil || len(files) < 2 {
+		return func(parseJob, loadedDiskState) {}
+	}
+	indexByPath := make(map[string]int, len(files))
+	for i, file := range files {
+		indexByPath[filepath.Clean(file.Path)] = i
+	}
+	return func(job parseJob, state loadedDiskState) {
+		if state.summary == nil || len(state.summary.Includes) == 0 {
+			return
+		}
+		band := parseBandDirectInclude
+		if job.band == parseBandOpenClosure {
+			band = parseBandOpenClosure
+		}
+		candidates := includeSearchCandidates(filepath.Dir(state.file.Path), m.roots, m.includeDirs)
+		for _, include := range state.summary.Includes {
+			includePath := unquoteMaybe(include.RawPath)
+			if strings.TrimSpace(includePath) == "" {
+				continue
+			}
+			for _, base := range candidates {
+				if index, ok := indexByPath[filepath.Join(base, filepath.FromSlash(includePath))]; ok {
+					scheduler.promote(index, band)
+					break
+				}
+			}
+		}
+	}
+}
+
+func summarizeScannedFile(ctx context.Context, parser *syntax.ReusableParser, file scannedFile, onTree func(DocumentKey, string, *syntax.Tree)) (loadedDiskState, error) {
 	if err := ctx.Err(); err != nil {
 		return loadedDiskState{}, err
 	}
@@ -116,12 +132,22 @@ func summarizeScannedFile(ctx context.Context, parser *syntax.ReusableParser, fi
 		return loadedDiskState{}, fmt.Errorf("read %s: %w", file.Path, err)
 	}
 
-	summary, err := ParseAndSummarizeWithParser(ctx, parser, file.Key, DocumentInput{
+	in := DocumentInput{
 		URI:        file.DisplayURI,
 		Version:    -1,
 		Generation: 0,
 		Source:     src,
-	})
+		Content:    text.NewContent(src),
+	}
+	tree, err := parser.Parse(ctx, in.Source, syntax.ParseOptions{URI: in.URI, Version: in.Version, Content: in.Content})
+	if err != nil {
+		return loadedDiskState{}, err
+	}
+	defer tree.Close()
+	if onTree != nil {
+		onTree(file.Key, file.DisplayURI, tree)
+	}
+	summary, err := SummarizeTree(file.Key, in, tree)
 	if err != nil {
 		return loadedDiskState{}, err
 	}
@@ -2,11 +2,14 @@ package index
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"os"
 	"path/filepath"
+	"slices"
 	"sync"
 	"testing"
+	"time"
 
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
 	parserbackend "github.com/kpumuk/thrift-weaver/internal/syntax/backend"
@@ -70,3 +73,162 @@ func TestManagerRescanWorkspaceReusesParsersWithinWorkerLimit(t *testing.T) {
 		t.Fatalf("NewParser() calls = %d, want between 1 and 2", got)
 	}
 }
+
+func TestParseSchedulerOrdersBandsThenLongestJobFirst(t *testing.T) {
+	t.Parallel()
+
+	jobs := []parseJob{
+		{index: 0, band: parseBandDiscovery, cost: 900},
+		{index: 1, band: parseBandOpenClosure, cost: 10},
+		{index: 2, band: parseBandDirectInclude, cost: 50},
+		{index: 3, band: parseBandOpenClosure, cost: 40},
+		{index: 4, band: parseBandDiscovery, cost: 5},
+	}
+	var counters parseQueueCounters
+	scheduler := newParseScheduler(jobs, 1, nil, &counters)
+	if got, want := counters.depths(), (ParseQueueDepths{OpenClosure: 2, DirectIncludes: 1, Discovery: 2}); got != want {
+		t.Fatalf("depths=%+v, want %+v", got, want)
+	}
+
+	var order []int
+	for {
+		job, ok, err := scheduler.next(context.Background(), 0)
+		if err != nil {
+			t.Fatalf("next: %v", err)
+		}
+		if !ok {
+			break
+		}
+		order = append(order, job.index)
+	}
+	if want := []int{3, 1, 2, 0, 4}; !slices.Equal(order, want) {
+		t.Fatalf("order=%v, want %v", order, want)
+	}
+	if got := counters.depths(); got != (ParseQueueDepths{}) {
+		t.Fatalf("depths after drain=%+v, want zero", got)
+	}
+}
+
+func TestParseSchedulerPromotesQueuedJob(t *testing.T) {
+	t.Parallel()
+
+	jobs := []parseJob{
+		{index: 0, band: parseBandDiscovery, cost: 900},
+		{index: 1, band: parseBandDiscovery, cost: 500},
+		{index: 2, band: parseBandDiscovery, cost: 5},
+	}
+	var counters parseQueueCounters
+	scheduler := newParseScheduler(jobs, 2, nil, &counters)
+
+	first, ok, err := scheduler.next(context.Background(), 0)
+	if err != nil || !ok || first.index != 0 {
+		t.Fatalf("first=%+v ok=%t err=%v, want index 0", first, ok, err)
+	}
+	scheduler.promote(2, parseBandDirectInclude)
+	scheduler.promote(first.index, parseBandOpenClosure)
+	if got, want := counters.depths(), (ParseQueueDepths{DirectIncludes: 1, Discovery: 1}); got != want {
+		t.Fatalf("depths after promote=%+v, want %+v", got, want)
+	}
+
+	var order []int
+	for {
+		job, ok, err := scheduler.next(context.Background(), 0)
+		if err != nil {
+			t.Fatalf("next: %v", err)
+		}
+		if !ok {
+			break
+		}
+		order = append(order, job.index)
+	}
+	if want := []int{2, 1}; !slices.Equal(order, want) {
+		t.Fatalf("order=%v, want %v", order, want)
+	}
+	if got := counters.depths(); got != (ParseQueueDepths{}) {
+		t.Fatalf("depths after drain=%+v, want zero", got)
+	}
+}
+
+func TestParseSchedulerStealsFromLoadedWorker(t *testing.T) {
+	t.Parallel()
+
+	jobs := []parseJob{
+		{index: 0, band: parseBandDiscovery, cost: 30},
+		{index: 1, band: parseBandDiscovery, cost: 20},
+		{index: 2, band: parseBandDiscovery, cost: 10},
+	}
+	scheduler := newParseScheduler(jobs, 2, nil, nil)
+
+	var got []int
+	for {
+		job, ok, err := scheduler.next(context.Background(), 1)
+		if err != nil {
+			t.Fatalf("next: %v", err)
+		}
+		if !ok {
+			break
+		}
+		got = append(got, job.index)
+	}
+	if want := []int{1, 0, 2}; !slices.Equal(got, want) {
+		t.Fatalf("worker 1 order=%v, want %v", got, want)
+	}
+}
+
+func TestParseSchedulerPreemptsBackgroundBandsForForegroundWork(t *testing.T) {
+	t.Parallel()
+
+	var gate parseGate
+	jobs := []parseJob{
+		{index: 0, band: parseBandOpenClosure, cost: 1},
+		{index: 1, band: parseBandDiscovery, cost: 1},
+	}
+	scheduler := newParseScheduler(jobs, 1, &gate, nil)
+
+	release := gate.enterForeground()
+	job, ok, err := scheduler.next(context.Background(), 0)
+	if err != nil || !ok || job.index != 0 {
+		t.Fatalf("next=(%+v, %v, %v), want open-closure job", job, ok, err)
+	}
+
+	done := make(chan parseJob, 1)
+	go func() {
+		job, _, _ := scheduler.next(context.Background(), 0)
+		done <- job
+	}()
+	select {
+	case job := <-done:
+		t.Fatalf("discovery job %+v ran while foreground work was active", job)
+	case <-time.After(20 * time.Millisecond):
+	}
+
+	release()
+	select {
+	case job := <-done:
+		if job.index != 1 {
+			t.Fatalf("job=%+v, want discovery job", job)
+		}
+	case <-time.After(time.Second):
+		t.Fatal("discovery job did not resume after foreground release")
+	}
+}
+
+func TestParseSchedulerPreemptedWaitHonorsCancellation(t *testing.T) {
+	t.Parallel()
+
+	var gate parseGate
+	var counters parseQueueCounters
+	scheduler := newParseScheduler([]parseJob{{index: 0, band: parseBandDiscovery}}, 1, &gate, &counters)
+	release := gate.enterForeground()
+	defer release()
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	if _, ok, err := scheduler.next(ctx, 0); ok || !errors.Is(err, context.Canceled) {
+		t.Fatalf("next=(%v, %v), want context.Canceled", ok, err)
+	}
+	scheduler.drain()
+	if got := counters.depths(); got != (ParseQueueDepths{}) {
+		t.Fatalf("depths after drain=%+v, want zero", got)
+	}
+}
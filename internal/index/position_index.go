@@ -0,0 +1,187 @@
+package index
+
+import (
+	"cmp"
+	"fmt"
+	"slices"
+	"sync"
+	"sync/atomic"
+	"unicode/utf8"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// positionCache holds the lazily built position index of one summarized
+// document content. Snapshot clones of a summary share the cache, so the
+// index is built at most once per document generation.
+type positionCache struct {
+	mu    sync.Mutex
+	index atomic.Pointer[positionIndex]
+}
+
+func (c *positionCache) get(build func() (*positionIndex, error)) (*positionIndex, error) {
+	if c == nil {
+		return build()
+	}
+	if index := c.index.Load(); index != nil {
+		return index, nil
+	}
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if index := c.index.Load(); index != nil {
+		return index, nil
+	}
+	index, err := build()
+	if err != nil {
+		return nil, err
+	}
+	c.index.Store(index)
+	return index, nil
+}
+
+// positionSpan is one indexed span and the summary slice index it came from.
+type positionSpan struct {
+	start uint32
+	end   uint32
+	index uint32
+}
+
+// positionIndex maps LSP positions to byte offsets and byte offsets to the
+// summary entries under them without keeping the document source. Line
+// content is retained only for lines with non-ASCII bytes, which need UTF-16
+// decoding.
+type positionIndex struct {
+	sourceLen    text.ByteOffset
+	lineStarts   []uint32
+	lineEnds     []uint32
+	wideLines    map[int][]byte
+	declarations []positionSpan
+	references   []positionSpan
+	includes     []positionSpan
+}
+
+func newPositionIndex(src []byte, doc *DocumentSummary) *positionIndex {
+	p := &positionIndex{
+		sourceLen:  text.ByteOffset(len(src)),
+		lineStarts: []uint32{0},
+	}
+	wide := false
+	for i, b := range src {
+		switch {
+		case b == '\n':
+			p.endLine(src, uint32(i), wide)
+			p.lineStarts = append(p.lineStarts, uint32(i+1))
+			wide = false
+		case b >= utf8.RuneSelf:
+			wide = true
+		}
+	}
+	p.endLine(src, uint32(len(src)), wide)
+
+	for i, sym := range doc.Declarations {
+		p.declarations = appendPositionSpan(p.declarations, sym.NameSpan, i)
+	}
+	for i, ref := range doc.References {
+		p.references = appendPositionSpan(p.references, ref.Span, i)
+	}
+	for i, include := range doc.Includes {
+		p.includes = appendPositionSpan(p.includes, include.Span, i)
+	}
+	for _, spans := range [][]positionSpan{p.declarations, p.references, p.includes} {
+		slices.SortStableFunc(spans, func(a, b positionSpan) int {
+			return cmp.Compare(a.start, b.start)
+		})
+	}
+	return p
+}
+
+// endLine records the content end of the last started line, which stops
+// before a trailing "\n" or "\r\n".
+func (p *positionIndex) endLine(src []byte, end uint32, wide bool) {
+	line := len(p.lineStarts) - 1
+	start := p.lineStarts[line]
+	if end > start && src[end-1] == '\r' && int(end) < len(src) {
+		end--
+	}
+	p.lineEnds = append(p.lineEnds, end)
+	if wide {
+		if p.wideLines == nil {
+			p.wideLines = make(map[int][]byte)
+		}
+		p.wideLines[line] = slices.Clone(src[start:end])
+	}
+}
+
+func appendPositionSpan(spans []positionSpan, span text.Span, index int) []positionSpan {
+	if !span.IsValid() || span.Start == span.End {
+		return spans
+	}
+	return append(spans, positionSpan{start: uint32(span.Start), end: uint32(span.End), index: uint32(index)})
+}
+
+// offset converts an LSP UTF-16 position to a byte offset with the same
+// validation as text.LineIndex.
+func (p *positionIndex) offset(pos text.UTF16Position) (text.ByteOffset, error) {
+	if pos.Line < 0 || pos.Line >= len(p.lineStarts) {
+		return 0, fmt.Errorf("line out of range: %d", pos.Line)
+	}
+	if pos.Character < 0 {
+		return 0, fmt.Errorf("character out of range: %d", pos.Character)
+	}
+	start := text.ByteOffset(p.lineStarts[pos.Line])
+	if line, ok := p.wideLines[pos.Line]; ok {
+		rel, err := text.UTF16ColumnToByteOffset(line, pos.Character)
+		if err != nil {
+			return 0, err
+		}
+		return start + rel, nil
+	}
+	width := int(p.lineEnds[pos.Line]) - int(start)
+	if pos.Character > width {
+		return 0, fmt.Errorf("character out of range: %d > %d", pos.Character, width)
+	}
+	return start + text.ByteOffset(pos.Character), nil
+}
+
+// findPositionSpan returns the summary index of the span containing offset.
+// Spans in one table never overlap, so only the last span starting at or
+// before offset can contain it.
+func findPositionSpan(spans []positionSpan, offset text.ByteOffset) (int, bool) {
+	if !offset.IsValid() {
+		return 0, false
+	}
+	i, found := slices.BinarySearchFunc(spans, uint32(offset), func(span positionSpan, off uint32) int {
+		return cmp.Compare(span.start, off)
+	})
+	if !found {
+		i--
+	}
+	if i < 0 || uint32(offset) >= spans[i].end {
+		return 0, false
+	}
+	return int(spans[i].index), true
+}
+
+func (p *positionIndex) declarationAt(doc *DocumentSummary, offset text.ByteOffset) (Symbol, bool) {
+	i, ok := findPositionSpan(p.declarations, offset)
+	if !ok || i >= len(doc.Declarations) {
+		return Symbol{}, false
+	}
+	return doc.Declarations[i], true
+}
+
+func (p *positionIndex) referenceAt(doc *DocumentSummary, offset text.ByteOffset) (ReferenceSite, bool) {
+	i, ok := findPositionSpan(p.references, offset)
+	if !ok || i >= len(doc.References) {
+		return ReferenceSite{}, false
+	}
+	return doc.References[i], true
+}
+
+func (p *positionIndex) includeLocationAt(doc *DocumentSummary, offset text.ByteOffset) (Location, bool) {
+	i, ok := findPositionSpan(p.includes, offset)
+	if !ok || i >= len(doc.Includes) || doc.Includes[i].ResolvedURI == "" {
+		return Location{}, false
+	}
+	return Location{URI: doc.Includes[i].ResolvedURI, Span: text.Span{}}, true
+}
@@ -0,0 +1,58 @@
+package index
+
+import (
+	"testing"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+func TestPositionIndexOffsetMatchesLineIndex(t *testing.T) {
+	t.Parallel()
+
+	src := []byte("struct A {}\r\n// héllo 😀 x\n\nconst i32 B = 1\r")
+	positions := newPositionIndex(src, &DocumentSummary{})
+	lines := text.NewLineIndex(src)
+	for line := -1; line <= lines.LineCount(); line++ {
+		for character := -1; character <= 20; character++ {
+			pos := text.UTF16Position{Line: line, Character: character}
+			want, wantErr := lines.UTF16PositionToOffset(pos)
+			got, err := positions.offset(pos)
+			if (err != nil) != (wantErr != nil) || got != want {
+				t.Fatalf("offset(%+v)=(%d, %v), want (%d, %v)", pos, got, err, want, wantErr)
+			}
+		}
+	}
+}
+
+func TestPositionIndexFindsContainingSpans(t *testing.T) {
+	t.Parallel()
+
+	doc := &DocumentSummary{
+		Declarations: []Symbol{
+			{Name: "A", NameSpan: text.Span{Start: 7, End: 8}},
+			{Name: "B", NameSpan: text.Span{Start: 30, End: 31}},
+		},
+		References: []ReferenceSite{
+			{Name: "late", Span: text.Span{Start: 40, End: 44}},
+			{Name: "early", Span: text.Span{Start: 12, End: 17}},
+		},
+	}
+	positions := newPositionIndex(make([]byte, 64), doc)
+
+	if sym, ok := positions.declarationAt(doc, 7); !ok || sym.Name != "A" {
+		t.Fatalf("declarationAt(7)=(%+v, %v), want A", sym, ok)
+	}
+	if _, ok := positions.declarationAt(doc, 8); ok {
+		t.Fatal("declarationAt(8) matched an exclusive span end")
+	}
+	for offset, want := range map[text.ByteOffset]string{12: "early", 16: "early", 43: "late"} {
+		if ref, ok := positions.referenceAt(doc, offset); !ok || ref.Name != want {
+			t.Fatalf("referenceAt(%d)=(%+v, %v), want %s", offset, ref, ok, want)
+		}
+	}
+	for _, offset := range []text.ByteOffset{-1, 0, 20, 44, 63} {
+		if ref, ok := positions.referenceAt(doc, offset); ok {
+			t.Fatalf("referenceAt(%d)=%+v, want no match", offset, ref)
+		}
+	}
+}
@@ -15,10 +15,11 @@ import (
 )
 
 type queryContext struct {
-	snapshot *WorkspaceSnapshot
-	view     *DocumentView
-	meta     QueryMeta
-	offset   text.ByteOffset
+	snapshot  *WorkspaceSnapshot
+	view      *DocumentView
+	positions *positionIndex
+	meta      QueryMeta
+	offset    text.ByteOffset
 }
 
 type renameTarget struct {
@@ -35,11 +36,14 @@ func (m *Manager) Definition(ctx context.Context, doc QueryDocument, pos text.UT
 	if err != nil {
 		return nil, qctx.meta, err
 	}
-	if location, ok := includeLocationAtOffset(qctx.view.Document, qctx.offset); ok {
+	if location, ok := qctx.positions.includeLocationAt(qctx.view.Document, qctx.offset); ok {
 		return []Location{location}, qctx.meta, nil
 	}
 	symbol := targetSymbolAtOffset(qctx)
 	if symbol == nil {
+		if !qctx.meta.DocumentClosureComplete {
+			return nil, qctx.meta, ErrWorkspaceIncomplete
+		}
 		return []Location{}, qctx.meta, nil
 	}
 	return []Location{{URI: symbol.URI, Span: symbol.NameSpan}}, qctx.meta, nil
@@ -61,16 +65,12 @@ func (m *Manager) References(ctx context.Context, doc QueryDocument, pos text.UT
 		return nil, qctx.meta, ErrWorkspaceIncomplete
 	}
 
-	refs := qctx.snapshot.RefsByTarget[symbol.ID]
+	refs := qctx.snapshot.ReferencesTo(symbol.ID)
 	out := make([]Location, 0, len(refs)+1)
 	if includeDecl {
 		out = append(out, Location{URI: symbol.URI, Span: symbol.NameSpan})
 	}
-	for _, refID := range refs {
-		ref, ok := referenceByID(qctx.snapshot, refID)
-		if !ok {
-			continue
-		}
+	for _, ref := range refs {
 		out = append(out, Location{URI: ref.URI, Span: ref.Span})
 	}
 	sortLocations(out)
@@ -96,7 +96,7 @@ func (m *Manager) WorkspaceSymbols(ctx context.Context, query string) (symbols [
 	}
 	query = strings.TrimSpace(strings.ToLower(query))
 
-	out := make([]WorkspaceSymbol, 0, len(snapshot.SymbolsByID))
+	out := make([]WorkspaceSymbol, 0, snapshot.SymbolCount())
 	for _, key := range sortedDocumentKeys(snapshot.Documents) {
 		doc := snapshot.Documents[key]
 		if doc == nil {
@@ -198,14 +198,14 @@ func (m *Manager) queryTargetSymbol(ctx context.Context, doc QueryDocument, pos
 }
 
 func targetSymbolAtOffset(qctx queryContext) *Symbol {
-	if symbol, ok := declarationAtOffset(qctx.view.Document, qctx.offset); ok {
+	if symbol, ok := qctx.positions.declarationAt(qctx.view.Document, qctx.offset); ok {
 		return &symbol
 	}
-	ref, ok := referenceAtOffset(qctx.view.Document, qctx.offset)
+	ref, ok := qctx.positions.referenceAt(qctx.view.Document, qctx.offset)
 	if !ok || ref.Binding.Status != BindingStatusBound {
 		return nil
 	}
-	symbol, ok := qctx.snapshot.SymbolsByID[ref.Binding.Target]
+	symbol, ok := qctx.snapshot.Symbol(ref.Binding.Target)
 	if !ok {
 		return nil
 	}
@@ -218,11 +218,11 @@ func (m *Manager) queryRenameTarget(ctx context.Context, doc QueryDocument, pos
 		return qctx, nil, nil, err
 	}
 
-	if symbol, ok := declarationAtOffset(qctx.view.Document, qctx.offset); ok {
+	if symbol, ok := qctx.positions.declarationAt(qctx.view.Document, qctx.offset); ok {
 		return qctx, &renameTarget{symbol: symbol, span: symbol.NameSpan}, nil, nil
 	}
 
-	ref, ok := referenceAtOffset(qctx.view.Document, qctx.offset)
+	ref, ok := qctx.positions.referenceAt(qctx.view.Document, qctx.offset)
 	if !ok {
 		return qctx, nil, renameBlockers(
 			qctx.view.Document.URI,
@@ -234,7 +234,7 @@ func (m *Manager) queryRenameTarget(ctx context.Context, doc QueryDocument, pos
 
 	switch ref.Binding.Status {
 	case BindingStatusBound:
-		symbol, ok := qctx.snapshot.SymbolsByID[ref.Binding.Target]
+		symbol, ok := qctx.snapshot.Symbol(ref.Binding.Target)
 		if !ok {
 			return qctx, nil, renameBlockers(
 				ref.URI,
@@ -293,54 +293,78 @@ func (m *Manager) queryDocumentContext(ctx context.Context, doc QueryDocument, p
 		return queryContext{}, ErrContentModified
 	}
 
-	src, err := m.queryDocumentSource(view.Document)
+	positions, err := m.documentPositions(view.Document)
 	if err != nil {
 		return queryContext{}, err
 	}
-	lineIndex := text.NewLineIndex(src)
-	offset, err := lineIndex.UTF16PositionToOffset(pos)
+	offset, err := positions.offset(pos)
 	if err != nil {
 		return queryContext{}, err
 	}
 
 	meta := QueryMeta{
-		WorkspaceGeneration: snapshot.Generation,
-		DocumentURI:         view.Document.URI,
-		DocumentVersion:     view.Document.Version,
-		DocumentGeneration:  view.Document.Generation,
-		DiscoveryComplete:   snapshot.DiscoveryComplete,
+		WorkspaceGeneration:     snapshot.Generation,
+		DocumentURI:             view.Document.URI,
+		DocumentVersion:         view.Document.Version,
+		DocumentGeneration:      view.Document.Generation,
+		DiscoveryComplete:       snapshot.DiscoveryComplete,
+		DocumentClosureComplete: snapshot.DiscoveryComplete || view.Document.ClosureComplete,
 	}
 	return queryContext{
-		snapshot: snapshot,
-		view:     view,
-		meta:     meta,
-		offset:   offset,
+		snapshot:  snapshot,
+		view:      view,
+		positions: positions,
+		meta:      meta,
+		offset:    offset,
 	}, nil
 }
 
-func (m *Manager) queryDocumentSource(doc *DocumentSummary) ([]byte, error) {
+// documentPositions returns the position index of doc, reading its source
+// only the first time a generation is queried. Disk sources must still match
+// the summarized content hash.
+func (m *Manager) documentPositions(doc *DocumentSummary) (*positionIndex, error) {
+	return doc.positions.get(func() (*positionIndex, error) {
+		content, err := m.queryDocumentSource(doc)
+		if err != nil {
+			return nil, err
+		}
+		if content.Hash() != doc.ContentHash {
+			return nil, ErrContentModified
+		}
+		return newPositionIndex(content.Bytes(), doc), nil
+	})
+}
+
+func (m *Manager) queryDocumentSource(doc *DocumentSummary) (*text.Content, error) {
 	if m == nil || doc == nil {
 		return nil, errors.New("query document source unavailable")
 	}
 
 	m.mu.Lock()
 	slot := m.slots[doc.Key]
-	var src []byte
+	var in DocumentInput
 	if slot != nil && slot.open != nil && slot.open.summary != nil {
 		if slot.open.summary.Version == doc.Version && slot.open.summary.Generation == doc.Generation {
-			src = slices.Clone(slot.open.input.Source)
+			in = slot.open.input
 		}
 	}
 	m.mu.Unlock()
-	if src != nil {
-		return src, nil
+	if in.Source != nil {
+		if in.Content.Holds(in.Source) {
+			return in.Content, nil
+		}
+		return text.NewContent(in.Source), nil
 	}
 
 	path, err := filePathFromDocumentURI(doc.URI)
 	if err != nil {
 		return nil, err
 	}
-	return os.ReadFile(path)
+	src, err := os.ReadFile(path)
+	if err != nil {
+		return nil, err
+	}
+	return text.NewContent(src), nil
 }
 
 func (m *Manager) planRename(qctx queryContext, target Symbol, newName string) (*RenameResult, []IndexDiagnostic, error) {
@@ -349,7 +373,7 @@ func (m *Manager) planRename(qctx queryContext, target Symbol, newName string) (
 		return nil, nil, ErrContentModified
 	}
 
-	references := referencesForTarget(qctx.snapshot, target.ID)
+	references := qctx.snapshot.ReferencesTo(target.ID)
 	blockers := renameCollisionBlockers(target, targetDoc, references, newName)
 	if len(blockers) > 0 {
 		return nil, blockers, nil
@@ -392,11 +416,11 @@ func (m *Manager) planRename(qctx queryContext, target Symbol, newName string) (
 		if doc == nil {
 			return nil, nil, ErrContentModified
 		}
-		src, err := m.queryDocumentSource(doc)
+		positions, err := m.documentPositions(doc)
 		if err != nil {
 			return nil, nil, err
 		}
-		if err := text.ValidateEdits(text.ByteOffset(len(src)), docEdits.Edits); err != nil {
+		if err := text.ValidateEdits(positions.sourceLen, docEdits.Edits); err != nil {
 			return nil, nil, err
 		}
 		sortByteEditsDescending(docEdits.Edits)
@@ -475,23 +499,6 @@ func renameCollisionBlockers(target Symbol, targetDoc *DocumentSummary, referenc
 	return blockers
 }
 
-func referencesForTarget(snapshot *WorkspaceSnapshot, id SymbolID) []ReferenceSite {
-	if snapshot == nil {
-		return nil
-	}
-
-	refIDs := snapshot.RefsByTarget[id]
-	out := make([]ReferenceSite, 0, len(refIDs))
-	for _, refID := range refIDs {
-		ref, ok := referenceByID(snapshot, refID)
-		if !ok {
-			continue
-		}
-		out = append(out, ref)
-	}
-	return out
-}
-
 func queryDocumentSummary(snapshot *WorkspaceSnapshot, uri string) (*DocumentSummary, bool) {
 	if snapshot == nil {
 		return nil, false
@@ -541,63 +548,6 @@ func (m *Manager) validateRenameDocument(doc *DocumentSummary) error {
 	return nil
 }
 
-func declarationAtOffset(doc *DocumentSummary, offset text.ByteOffset) (Symbol, bool) {
-	if doc == nil {
-		return Symbol{}, false
-	}
-	for _, symbol := range doc.Declarations {
-		if symbol.NameSpan.Contains(offset) {
-			return symbol, true
-		}
-	}
-	return Symbol{}, false
-}
-
-func referenceAtOffset(doc *DocumentSummary, offset text.ByteOffset) (ReferenceSite, bool) {
-	if doc == nil {
-		return ReferenceSite{}, false
-	}
-	for _, ref := range doc.References {
-		if ref.Span.Contains(offset) {
-			return ref, true
-		}
-	}
-	return ReferenceSite{}, false
-}
-
-func includeLocationAtOffset(doc *DocumentSummary, offset text.ByteOffset) (Location, bool) {
-	if doc == nil {
-		return Location{}, false
-	}
-	for _, include := range doc.Includes {
-		if include.ResolvedURI == "" {
-			continue
-		}
-		if include.Span.Contains(offset) {
-			return Location{URI: include.ResolvedURI, Span: text.Span{}}, true
-		}
-	}
-	return Location{}, false
-}
-
-func referenceByID(snapshot *WorkspaceSnapshot, id ReferenceSiteID) (ReferenceSite, bool) {
-	if snapshot == nil {
-		return ReferenceSite{}, false
-	}
-	for _, key := range sortedDocumentKeys(snapshot.Documents) {
-		doc := snapshot.Documents[key]
-		if doc == nil {
-			continue
-		}
-		for _, ref := range doc.References {
-			if ref.ID == id {
-				return ref, true
-			}
-		}
-	}
-	return ReferenceSite{}, false
-}
-
 func renameReferenceSpan(ref ReferenceSite) text.Span {
 	if ref.Qualifier == "" || ref.Name == "" || !ref.Span.IsValid() {
 		return ref.Span
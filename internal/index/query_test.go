@@ -3,10 +3,12 @@ package index
 import (
 	"context"
 	"errors"
+	"os"
 	"path/filepath"
 	"strings"
 	"testing"
 
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
 	"github.com/kpumuk/thrift-weaver/internal/testutil"
 	"github.com/kpumuk/thrift-weaver/internal/text"
 )
@@ -311,6 +313,100 @@ func TestManagerDefinitionRejectsContentModified(t *testing.T) {
 	}
 }
 
+func TestManagerDefinitionReusesDocumentPositionIndex(t *testing.T) {
+	t.Parallel()
+
+	root := testutil.CopyWorkspaceFixture(t, "navigation")
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+
+	if err := m.RescanWorkspace(context.Background()); err != nil {
+		t.Fatalf("RescanWorkspace: %v", err)
+	}
+
+	mainPath := filepath.Join(root, "main.thrift")
+	mainDoc := mustDocument(t, mustSnapshot(t, m), mainPath)
+	query := QueryDocument{URI: mainDoc.URI, Version: mainDoc.Version, Generation: mainDoc.Generation}
+	pos := mustUTF16PositionForSubstring(t, testutil.ReadFile(t, mainPath), "types.User input")
+	if _, _, err := m.Definition(context.Background(), query, pos); err != nil {
+		t.Fatalf("Definition: %v", err)
+	}
+
+	// The indexed generation answers from its cached position index.
+	if err := os.Remove(mainPath); err != nil {
+		t.Fatalf("Remove(%s): %v", mainPath, err)
+	}
+	definitions, _, err := m.Definition(context.Background(), query, pos)
+	if err != nil {
+		t.Fatalf("Definition after remove: %v", err)
+	}
+	if len(definitions) != 1 || !strings.HasSuffix(definitions[0].URI, "types.thrift") {
+		t.Fatalf("Definition after remove=%+v, want types.thrift location", definitions)
+	}
+}
+
+func TestManagerDefinitionReportsIncompleteClosureDuringDiscovery(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	mainPath := filepath.Join(root, "main.thrift")
+	sharedPath := filepath.Join(root, "shared.thrift")
+	mainSource := []byte("include \"shared.thrift\"\n\nstruct Holder {\n  1: shared.User user,\n}\n")
+	if err := os.WriteFile(mainPath, mainSource, 0o600); err != nil {
+		t.Fatalf("WriteFile main: %v", err)
+	}
+	if err := os.WriteFile(sharedPath, []byte("struct User {\n  1: string name,\n}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile shared: %v", err)
+	}
+
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+
+	result, err := scanWorkspace(context.Background(), m.roots, m.includeDirs, m.maxFiles, m.maxFileSize)
+	if err != nil {
+		t.Fatalf("scanWorkspace: %v", err)
+	}
+	states := make(map[string]loadedDiskState, len(result.files))
+	parser := syntax.NewReusableParser()
+	defer parser.Close()
+	for _, file := range result.files {
+		state, err := summarizeScannedFile(context.Background(), parser, file, nil)
+		if err != nil {
+			t.Fatalf("summarizeScannedFile(%s): %v", file.Path, err)
+		}
+		states[filepath.Base(file.Path)] = state
+	}
+
+	publish := func(name string) {
+		state := states[name]
+		m.publishDiscoveryProgress(map[DocumentKey]loadedDiskState{state.file.Key: state}, RebuildReasonManualRescan, 0, rebuildStats{})
+	}
+	userPos := mustUTF16PositionForSubstring(t, mainSource, "User user")
+
+	publish("main.thrift")
+	doc := mustDocument(t, mustSnapshot(t, m), mainPath)
+	query := QueryDocument{URI: doc.URI, Version: doc.Version, Generation: doc.Generation}
+	_, meta, err := m.Definition(context.Background(), query, userPos)
+	if !errors.Is(err, ErrWorkspaceIncomplete) {
+		t.Fatalf("Definition error=%v, want %v", err, ErrWorkspaceIncomplete)
+	}
+	if meta.DocumentClosureComplete {
+		t.Fatal("definition meta should report an incomplete include closure")
+	}
+
+	publish("shared.thrift")
+	definitions, meta, err := m.Definition(context.Background(), query, userPos)
+	if err != nil {
+		t.Fatalf("Definition after shared.thrift: %v", err)
+	}
+	if meta.DiscoveryComplete || !meta.DocumentClosureComplete {
+		t.Fatalf("meta=%+v, want complete closure during incomplete discovery", meta)
+	}
+	if len(definitions) != 1 || locationText(t, definitions[0]) != "User" {
+		t.Fatalf("definition results=%+v", definitions)
+	}
+}
+
 func TestManagerPrepareRenameAndRename(t *testing.T) {
 	t.Parallel()
 
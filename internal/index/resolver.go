@@ -212,32 +212,7 @@ func includeSearchCandidates(docDir string, roots []string, includeDirs []string
 	return out
 }
 
-func buildSymbolIndexes(docs map[DocumentKey]*DocumentSummary) (map[SymbolID]Symbol, map[QualifiedName][]SymbolID, map[DocumentKey]map[string][]Symbol) {
-	symbolsByID := make(map[SymbolID]Symbol)
-	symbolsByQName := make(map[QualifiedName][]SymbolID)
-	byDocument := make(map[DocumentKey]map[string][]Symbol)
-
-	for _, key := range sortedDocumentKeys(docs) {
-		doc := docs[key]
-		if doc == nil {
-			continue
-		}
-		names := make(map[string][]Symbol)
-		for _, sym := range doc.Declarations {
-			symbolsByID[sym.ID] = sym
-			symbolsByQName[sym.QName] = append(symbolsByQName[sym.QName], sym.ID)
-			names[sym.Name] = append(names[sym.Name], sym)
-		}
-		byDocument[key] = names
-	}
-
-	for _, ids := range symbolsByQName {
-		slices.Sort(ids)
-	}
-	return symbolsByID, symbolsByQName, byDocument
-}
-
-func bindReferencesForSummary(summary *DocumentSummary, byDocument map[DocumentKey]map[string][]Symbol) {
+func bindReferencesForSummary(summary *DocumentSummary, symbols *symbolTable) {
 	if summary == nil {
 		return
 	}
@@ -258,7 +233,7 @@ func bindReferencesForSummary(summary *DocumentSummary, byDocument map[DocumentK
 		}
 
 		if ref.Qualifier == "" {
-			ref.Binding = bindAgainstSymbols(byDocument[summary.Key][ref.Name], ref.ExpectedKinds)
+			ref.Binding = symbols.bind(summary.Key, ref.Name, ref.ExpectedKinds)
 			continue
 		}
 
@@ -267,7 +242,7 @@ func bindReferencesForSummary(summary *DocumentSummary, byDocument map[DocumentK
 		case 0:
 			ref.Binding = BindingResult{Status: BindingStatusUnresolved, Reason: "include alias is unresolved"}
 		case 1:
-			ref.Binding = bindAgainstSymbols(byDocument[targets[0]][ref.Name], ref.ExpectedKinds)
+			ref.Binding = symbols.bind(targets[0], ref.Name, ref.ExpectedKinds)
 		default:
 			ref.Binding = BindingResult{Status: BindingStatusAmbiguous, Reason: "include alias resolves to multiple targets"}
 		}
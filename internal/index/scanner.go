@@ -5,10 +5,11 @@ import (
 	"fmt"
 	"os"
 	"path/filepath"
-	"regexp"
 	"runtime"
 	"slices"
 	"strings"
+	"sync"
+	"sync/atomic"
 	"time"
 )
 
@@ -30,6 +31,14 @@ type scanWorkspaceStats struct {
 }
 
 func scanWorkspace(ctx context.Context, roots []string, includeDirs []string, maxFiles int, maxFileBytes int64) (scanWorkspaceResult, error) {
+	return scanWorkspaceWithWorkers(ctx, roots, includeDirs, maxFiles, maxFileBytes, defaultScanWorkers())
+}
+
+func defaultScanWorkers() int {
+	return min(max(runtime.GOMAXPROCS(0), 1)*2, maxScanWorkers)
+}
+
+func scanWorkspaceWithWorkers(ctx context.Context, roots []string, includeDirs []string, maxFiles int, maxFileBytes int64, workers int) (scanWorkspaceResult, error) {
 	dirs, err := scanDirectories(roots, includeDirs)
 	if err != nil {
 		return scanWorkspaceResult{}, err
@@ -58,26 +67,19 @@ func scanWorkspace(ctx context.Context, roots []string, includeDirs []string, ma
 			continue
 		}
 
-		matchersByDir := make(map[string][]*gitIgnoreMatcher)
-		rootMatchers, err := gitIgnoreMatchersForDir(dir, nil)
-		if err != nil {
+		walker := &workspaceWalker{
+			ctx:          ctx,
+			allowedRoots: allowedRoots,
+			maxFileBytes: maxFileBytes,
+			seen:         seen,
+			budget:       int64(maxFiles - len(out)),
+			sem:          make(chan struct{}, max(workers-1, 0)),
+		}
+		tree := walker.walk(dir)
+		if err := ctx.Err(); err != nil {
 			return scanWorkspaceResult{}, err
 		}
-		matchersByDir[dir] = rootMatchers
-
-		err = filepath.WalkDir(dir, func(path string, d os.DirEntry, walkErr error) error {
-			if walkErr != nil {
-				return walkErr
-			}
-			if err := ctx.Err(); err != nil {
-				return err
-			}
-			if d.IsDir() {
-				return walkWorkspaceDir(path, dir, d.Name(), matchersByDir, &stats)
-			}
-			return walkWorkspaceFile(path, d, matchersByDir, allowedRoots, seen, &out, maxFiles, maxFileBytes, &stats)
-		})
-		if err != nil {
+		if err := tree.collect(seen, &out, maxFiles, &stats); err != nil {
 			return scanWorkspaceResult{}, err
 		}
 	}
@@ -183,75 +185,179 @@ func pathWithinRoot(path string, root string) bool {
 	return rel == "." || (rel != ".." && !strings.HasPrefix(rel, ".."+string(filepath.Separator)))
 }
 
-func walkWorkspaceDir(path string, root string, name string, matchersByDir map[string][]*gitIgnoreMatcher, stats *scanWorkspaceStats) error {
-	if path != root && isIgnoredWorkspaceDir(name) {
-		return filepath.SkipDir
+// maxScanWorkers bounds directory-reading goroutines for one scan root.
+const maxScanWorkers = 16
+
+// workspaceWalker reads one scan root concurrently. Subdirectories are handed
+// to idle workers and otherwise walked inline, so goroutines stay bounded by
+// the semaphore. Each directory records its entries in lexical order and
+// collect replays them depth-first, which keeps results, deduplication and
+// the first reported error identical to a sequential filepath.WalkDir.
+type workspaceWalker struct {
+	ctx          context.Context
+	allowedRoots []string
+	maxFileBytes int64
+	// seen holds keys from earlier scan roots; it is only read during a walk.
+	seen map[DocumentKey]struct{}
+	// budget counts new regular files so an oversized tree stops early; the
+	// exact maxFiles check happens in collect.
+	budget int64
+	sem    chan struct{}
+	wg     sync.WaitGroup
+	failed atomic.Bool
+}
+
+type walkedDir struct {
+	err     error
+	entries []walkedEntry
+	skipped int
+}
+
+type walkedEntry struct {
+	dir  *walkedDir
+	file *scannedFile
+	err  error
+}
+
+func (w *workspaceWalker) walk(root string) *walkedDir {
+	out := &walkedDir{}
+	w.walkDir(root, "", nil, out)
+	w.wg.Wait()
+	return out
+}
+
+func (w *workspaceWalker) walkDir(path string, rel string, inherited gitIgnoreStack, out *walkedDir) {
+	if w.failed.Load() || w.ctx.Err() != nil {
+		return
 	}
-	if path == root {
-		return nil
+	ignores, err := inherited.withDir(path, rel)
+	if err != nil {
+		out.err = err
+		w.failed.Store(true)
+		return
 	}
-
-	matchers := matchersByDir[filepath.Dir(path)]
-	ignored, err := matchesGitIgnore(matchers, path, true)
+	entries, err := os.ReadDir(path)
 	if err != nil {
-		return err
+		out.err = err
+		w.failed.Store(true)
+		return
 	}
-	if ignored {
-		if stats != nil {
-			stats.gitIgnoreSkippedPaths++
+
+	for _, d := range entries {
+		if w.failed.Load() || w.ctx.Err() != nil {
+			return
+		}
+		name := d.Name()
+		if d.IsDir() && isIgnoredWorkspaceDir(name) {
+			continue
+		}
+		// Root-relative paths are only needed for gitignore matching and
+		// nested walks; building them for every file dominates allocations.
+		childRel := ""
+		if d.IsDir() || len(ignores) > 0 {
+			childRel = joinWalkRel(rel, name)
 		}
-		return filepath.SkipDir
-	}
 
-	matchersByDir[path], err = gitIgnoreMatchersForDir(path, matchers)
-	return err
-}
+		if d.IsDir() {
+			if ignores.ignored(childRel, true) {
+				out.skipped++
+				continue
+			}
+			childPath := filepath.Join(path, name)
+			child := &walkedDir{}
+			out.entries = append(out.entries, walkedEntry{dir: child})
+			select {
+			case w.sem <- struct{}{}:
+				w.wg.Go(func() {
+					defer func() { <-w.sem }()
+					w.walkDir(childPath, childRel, ignores, child)
+				})
+			default:
+				w.walkDir(childPath, childRel, ignores, child)
+			}
+			continue
+		}
 
-func walkWorkspaceFile(path string, d os.DirEntry, matchersByDir map[string][]*gitIgnoreMatcher, allowedRoots []string, seen map[DocumentKey]struct{}, out *[]scannedFile, maxFiles int, maxFileBytes int64, stats *scanWorkspaceStats) error {
-	ignored, err := matchesGitIgnore(matchersByDir[filepath.Dir(path)], path, false)
-	if err != nil {
-		return err
-	}
-	if ignored {
-		if stats != nil {
-			stats.gitIgnoreSkippedPaths++
+		if len(ignores) > 0 && ignores.ignored(childRel, false) {
+			out.skipped++
+			continue
+		}
+		if filepath.Ext(name) != ".thrift" {
+			continue
+		}
+		entry := w.walkFile(filepath.Join(path, name), d)
+		out.entries = append(out.entries, entry)
+		if entry.err != nil {
+			w.failed.Store(true)
+			return
 		}
-		return nil
-	}
-	if filepath.Ext(d.Name()) != ".thrift" {
-		return nil
 	}
-	if len(*out) >= maxFiles {
-		return fmt.Errorf("workspace file limit exceeded: maxFiles=%d", maxFiles)
+}
+
+func joinWalkRel(rel string, name string) string {
+	if rel == "" {
+		return name
 	}
+	return rel + "/" + name
+}
 
+func (w *workspaceWalker) walkFile(path string, d os.DirEntry) walkedEntry {
 	info, err := d.Info()
 	if err != nil {
-		return err
+		return walkedEntry{err: err}
 	}
-	if maxFileBytes > 0 && info.Size() > maxFileBytes {
-		return fmt.Errorf("workspace file exceeds size limit: %s (%d > %d)", path, info.Size(), maxFileBytes)
+	if w.maxFileBytes > 0 && info.Size() > w.maxFileBytes {
+		return walkedEntry{err: fmt.Errorf("workspace file exceeds size limit: %s (%d > %d)", path, info.Size(), w.maxFileBytes)}
 	}
 
 	resolvedPath, displayURI, key, err := canonicalizeScannedWorkspacePath(path, d)
 	if err != nil {
-		return err
+		return walkedEntry{err: err}
 	}
-	if !pathWithinAnyRoot(resolvedPath, allowedRoots) {
-		return fmt.Errorf("workspace file resolves outside allowed roots: %s", path)
+	if !pathWithinAnyRoot(resolvedPath, w.allowedRoots) {
+		return walkedEntry{err: fmt.Errorf("workspace file resolves outside allowed roots: %s", path)}
 	}
-	if _, ok := seen[key]; ok {
-		return nil
+	if _, ok := w.seen[key]; !ok && d.Type()&os.ModeSymlink == 0 {
+		if atomic.AddInt64(&w.budget, -1) < 0 {
+			// collect reports the limit error at the exact file.
+			w.failed.Store(true)
+		}
 	}
-
-	seen[key] = struct{}{}
-	*out = append(*out, scannedFile{
+	return walkedEntry{file: &scannedFile{
 		Path:       resolvedPath,
 		DisplayURI: displayURI,
 		Key:        key,
 		Size:       info.Size(),
 		ModTime:    info.ModTime(),
-	})
+	}}
+}
+
+// collect appends walked files in depth-first order, applying the file limit
+// and cross-root deduplication exactly as a sequential walk would.
+func (d *walkedDir) collect(seen map[DocumentKey]struct{}, out *[]scannedFile, maxFiles int, stats *scanWorkspaceStats) error {
+	if d.err != nil {
+		return d.err
+	}
+	stats.gitIgnoreSkippedPaths += d.skipped
+	for _, entry := range d.entries {
+		if entry.dir != nil {
+			if err := entry.dir.collect(seen, out, maxFiles, stats); err != nil {
+				return err
+			}
+			continue
+		}
+		if len(*out) >= maxFiles {
+			return fmt.Errorf("workspace file limit exceeded: maxFiles=%d", maxFiles)
+		}
+		if entry.err != nil {
+			return entry.err
+		}
+		if _, ok := seen[entry.file.Key]; ok {
+			continue
+		}
+		seen[entry.file.Key] = struct{}{}
+		*out = append(*out, *entry.file)
+	}
 	return nil
 }
 
@@ -273,165 +379,3 @@ func canonicalizeScannedWorkspacePath(path string, d os.DirEntry) (resolvedPath
 	key = documentKeyForDisplayURIWithCase(displayURI, runtimeCaseInsensitive)
 	return resolvedPath, displayURI, key, nil
 }
-
-type gitIgnoreMatcher struct {
-	baseDir string
-	rules   []gitIgnoreRule
-}
-
-type gitIgnoreRule struct {
-	anchored bool
-	dirOnly  bool
-	negated  bool
-	hasSlash bool
-	regex    *regexp.Regexp
-}
-
-func gitIgnoreMatchersForDir(dir string, inherited []*gitIgnoreMatcher) ([]*gitIgnoreMatcher, error) {
-	out := slices.Clone(inherited)
-	matcher, err := readGitIgnoreMatcher(dir)
-	if err != nil {
-		return nil, err
-	}
-	if matcher == nil {
-		return out, nil
-	}
-	return append(out, matcher), nil
-}
-
-func readGitIgnoreMatcher(dir string) (*gitIgnoreMatcher, error) {
-	path := filepath.Join(dir, ".gitignore")
-	src, err := os.ReadFile(path)
-	if err != nil {
-		if os.IsNotExist(err) {
-			return nil, nil
-		}
-		return nil, err
-	}
-
-	lines := strings.Split(string(src), "\n")
-	rules := make([]gitIgnoreRule, 0, len(lines))
-	for _, raw := range lines {
-		rule, ok, err := parseGitIgnoreRule(raw)
-		if err != nil {
-			return nil, fmt.Errorf("parse %s: %w", path, err)
-		}
-		if ok {
-			rules = append(rules, rule)
-		}
-	}
-	if len(rules) == 0 {
-		return nil, nil
-	}
-	return &gitIgnoreMatcher{baseDir: dir, rules: rules}, nil
-}
-
-func parseGitIgnoreRule(raw string) (gitIgnoreRule, bool, error) {
-	line := strings.TrimSpace(raw)
-	if line == "" || strings.HasPrefix(line, "#") {
-		return gitIgnoreRule{}, false, nil
-	}
-
-	negated := strings.HasPrefix(line, "!")
-	if negated {
-		line = strings.TrimSpace(strings.TrimPrefix(line, "!"))
-	}
-	if line == "" {
-		return gitIgnoreRule{}, false, nil
-	}
-
-	anchored := strings.HasPrefix(line, "/")
-	line = strings.TrimPrefix(line, "/")
-	dirOnly := strings.HasSuffix(line, "/")
-	line = strings.TrimSuffix(line, "/")
-	if line == "" {
-		return gitIgnoreRule{}, false, nil
-	}
-
-	regex, err := regexp.Compile(globPatternToRegex(line))
-	if err != nil {
-		return gitIgnoreRule{}, false, err
-	}
-	return gitIgnoreRule{
-		anchored: anchored,
-		dirOnly:  dirOnly,
-		negated:  negated,
-		hasSlash: strings.Contains(line, "/"),
-		regex:    regex,
-	}, true, nil
-}
-
-func matchesGitIgnore(matchers []*gitIgnoreMatcher, candidate string, isDir bool) (bool, error) {
-	ignored := false
-	matched := false
-	for _, matcher := range matchers {
-		rel, err := filepath.Rel(matcher.baseDir, candidate)
-		if err != nil {
-			return false, err
-		}
-		if rel == "." || rel == ".." || strings.HasPrefix(rel, ".."+string(filepath.Separator)) {
-			continue
-		}
-
-		rel = filepath.ToSlash(rel)
-		for _, rule := range matcher.rules {
-			if !rule.matches(rel, isDir) {
-				continue
-			}
-			matched = true
-			ignored = !rule.negated
-		}
-	}
-	if !matched {
-		return false, nil
-	}
-	return ignored, nil
-}
-
-func (r gitIgnoreRule) matches(rel string, isDir bool) bool {
-	if rel == "" || (r.dirOnly && !isDir) || r.regex == nil {
-		return false
-	}
-	if r.hasSlash {
-		return r.regex.MatchString(rel)
-	}
-
-	if r.anchored {
-		segment, _, found := strings.Cut(rel, "/")
-		if !found {
-			segment = rel
-		}
-		return r.regex.MatchString(segment)
-	}
-
-	return slices.ContainsFunc(strings.Split(rel, "/"), func(segment string) bool {
-		return r.regex.MatchString(segment)
-	})
-}
-
-func globPatternToRegex(pattern string) string {
-	var b strings.Builder
-	b.WriteString("^")
-	for i := 0; i < len(pattern); i++ {
-		switch ch := pattern[i]; ch {
-		case '*':
-			if i+1 < len(pattern) && pattern[i+1] == '*' {
-				b.WriteString(".*")
-				i++
-				continue
-			}
-			b.WriteString("[^/]*")
-		case '?':
-			b.WriteString("[^/]")
-		case '.', '+', '(', ')', '|', '^', '$', '{', '}', '\\':
-			b.WriteByte('\\')
-			b.WriteByte(ch)
-		case '/':
-			b.WriteByte('/')
-		default:
-			b.WriteByte(ch)
-		}
-	}
-	b.WriteString("$")
-	return b.String()
-}
@@ -5,6 +5,7 @@ import (
 	"os"
 	"path/filepath"
 	"slices"
+	"strconv"
 	"strings"
 	"testing"
 )
@@ -125,3 +126,149 @@ func TestScanWorkspaceRespectsRecursiveGitIgnore(t *testing.T) {
 		t.Fatalf("gitIgnoreSkippedPaths=%d, want 2", result.gitIgnoreSkippedPaths)
 	}
 }
+
+func TestGitIgnoreStackMatchesLastRuleAcrossLayers(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	nested := filepath.Join(root, "pkg")
+	if err := os.MkdirAll(nested, 0o750); err != nil {
+		t.Fatalf("MkdirAll pkg: %v", err)
+	}
+	rootRules := strings.Join([]string{
+		"node_modules",
+		"/build",
+		"gen/*.thrift",
+		"docs/api/index.thrift",
+		"*.tmp",
+		"cache*",
+		"b?n/",
+		"**/deep/*.thrift",
+		"!cache-keep",
+	}, "\n")
+	if err := os.WriteFile(filepath.Join(root, ".gitignore"), []byte(rootRules), 0o600); err != nil {
+		t.Fatalf("WriteFile root .gitignore: %v", err)
+	}
+	if err := os.WriteFile(filepath.Join(nested, ".gitignore"), []byte("*.thrift\n!keep.thrift\nout/\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile nested .gitignore: %v", err)
+	}
+
+	stack, err := gitIgnoreStack(nil).withDir(root, "")
+	if err != nil {
+		t.Fatalf("withDir root: %v", err)
+	}
+	nestedStack, err := stack.withDir(nested, "pkg")
+	if err != nil {
+		t.Fatalf("withDir pkg: %v", err)
+	}
+
+	tests := []struct {
+		stack gitIgnoreStack
+		rel   string
+		isDir bool
+		want  bool
+	}{
+		{stack, "node_modules", true, true},
+		{stack, "a/node_modules", true, true},
+		{stack, "build", true, true},
+		{stack, "a/build", true, false},
+		{stack, "gen/api.thrift", false, true},
+		{stack, "gen/sub/api.thrift", false, false},
+		{stack, "docs/api/index.thrift", false, true},
+		{stack, "docs/api/other.thrift", false, false},
+		{stack, "a/b.tmp", false, true},
+		{stack, "cache-dir", true, true},
+		{stack, "cache-keep", true, false},
+		{stack, "bin", true, true},
+		{stack, "bin", false, false},
+		{stack, "x/deep/y.thrift", false, true},
+		{stack, "main.thrift", false, false},
+		{nestedStack, "pkg/skip.thrift", false, true},
+		{nestedStack, "pkg/keep.thrift", false, false},
+		{nestedStack, "pkg/out", true, true},
+		{nestedStack, "pkg/cache.tmp", false, true},
+	}
+	for _, tt := range tests {
+		if got := tt.stack.ignored(tt.rel, tt.isDir); got != tt.want {
+			t.Errorf("ignored(%q, dir=%t)=%t, want %t", tt.rel, tt.isDir, got, tt.want)
+		}
+	}
+}
+
+func TestGitIgnoreMatcherIndexesBracketExpressions(t *testing.T) {
+	t.Parallel()
+
+	tests := []struct {
+		pattern string
+		rel     string
+		isDir   bool
+		want    bool
+	}{
+		{"*.py[cod]", "a.pyc", false, true},
+		{"*.py[cod]", "pkg/a.pyo", false, true},
+		{"*.py[cod]", "a.pyx", false, false},
+		{"[Bb]uild/", "build", true, true},
+		{"[Bb]uild/", "src/Build", true, true},
+		{"[Bb]uild/", "rebuild", true, false},
+		{"*.[ch]", "x.c", false, true},
+		{"*.[ch]", "x.h", false, true},
+		{"*.[ch]", "x.cc", false, false},
+	}
+	for _, tt := range tests {
+		rule, ok, err := parseGitIgnoreRule(tt.pattern)
+		if err != nil || !ok {
+			t.Fatalf("parseGitIgnoreRule(%q) = %v, %v", tt.pattern, ok, err)
+		}
+		if got := rule.matches(tt.rel, tt.isDir); got != tt.want {
+			t.Errorf("rule %q matches(%q)=%t, want %t", tt.pattern, tt.rel, got, tt.want)
+		}
+		_, got := compileGitIgnoreMatcher([]gitIgnoreRule{rule}).lastMatch(tt.rel, tt.isDir)
+		if got != tt.want {
+			t.Errorf("matcher %q lastMatch(%q)=%t, want %t", tt.pattern, tt.rel, got, tt.want)
+		}
+	}
+}
+
+func TestScanWorkspaceParallelWalkMatchesSequential(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	if err := os.WriteFile(filepath.Join(root, ".gitignore"), []byte("skip-*\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile .gitignore: %v", err)
+	}
+	for i := range 8 {
+		for _, dir := range []string{"pkg-" + strconv.Itoa(i), "skip-" + strconv.Itoa(i)} {
+			sub := filepath.Join(root, dir, "nested")
+			if err := os.MkdirAll(sub, 0o750); err != nil {
+				t.Fatalf("MkdirAll %s: %v", sub, err)
+			}
+			for _, path := range []string{filepath.Join(root, dir, "a.thrift"), filepath.Join(sub, "b.thrift"), filepath.Join(sub, "c.txt")} {
+				if err := os.WriteFile(path, []byte("struct A {}\n"), 0o600); err != nil {
+					t.Fatalf("WriteFile %s: %v", path, err)
+				}
+			}
+		}
+	}
+
+	sequential, err := scanWorkspaceWithWorkers(context.Background(), []string{root}, []string{"pkg-3"}, 100, 1<<20, 1)
+	if err != nil {
+		t.Fatalf("sequential scan: %v", err)
+	}
+	parallel, err := scanWorkspaceWithWorkers(context.Background(), []string{root}, []string{"pkg-3"}, 100, 1<<20, 8)
+	if err != nil {
+		t.Fatalf("parallel scan: %v", err)
+	}
+	if len(sequential.files) != 16 {
+		t.Fatalf("len(files)=%d, want 16", len(sequential.files))
+	}
+	if !slices.Equal(sequential.files, parallel.files) {
+		t.Fatalf("parallel files differ from sequential walk:\n%v\n%v", parallel.files, sequential.files)
+	}
+	if sequential.gitIgnoreSkippedPaths != 8 || parallel.gitIgnoreSkippedPaths != 8 {
+		t.Fatalf("gitIgnoreSkippedPaths=%d/%d, want 8", sequential.gitIgnoreSkippedPaths, parallel.gitIgnoreSkippedPaths)
+	}
+
+	if _, err := scanWorkspaceWithWorkers(context.Background(), []string{root}, nil, 15, 1<<20, 8); err == nil || !strings.Contains(err.Error(), "maxFiles=15") {
+		t.Fatalf("maxFiles error=%v, want limit failure", err)
+	}
+}
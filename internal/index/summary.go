@@ -4,8 +4,8 @@ import (
 	"context"
 	"crypto/sha256"
 	"errors"
-	"fmt"
 	"path"
+	"slices"
 	"strconv"
 	"strings"
 
@@ -13,6 +13,7 @@ import (
 	"github.com/kpumuk/thrift-weaver/internal/text"
 )
 
+// Expected-kind sets are shared by every reference site that uses them.
 var dataTypeKinds = []SymbolKind{
 	SymbolKindTypedef,
 	SymbolKindEnum,
@@ -22,9 +23,14 @@ var dataTypeKinds = []SymbolKind{
 	SymbolKindException,
 }
 
+var (
+	serviceKinds   = []SymbolKind{SymbolKindService}
+	exceptionKinds = []SymbolKind{SymbolKindException}
+)
+
 // ParseAndSummarize parses a document and extracts its summary.
 func ParseAndSummarize(ctx context.Context, key DocumentKey, in DocumentInput) (*DocumentSummary, error) {
-	tree, err := syntax.Parse(ctx, in.Source, syntax.ParseOptions{URI: in.URI, Version: in.Version})
+	tree, err := syntax.Parse(ctx, in.Source, syntax.ParseOptions{URI: in.URI, Version: in.Version, Content: in.Content})
 	if err != nil {
 		return nil, err
 	}
@@ -39,7 +45,7 @@ func ParseAndSummarizeWithParser(ctx context.Context, parser *syntax.ReusablePar
 		return ParseAndSummarize(ctx, key, in)
 	}
 
-	tree, err := parser.Parse(ctx, in.Source, syntax.ParseOptions{URI: in.URI, Version: in.Version})
+	tree, err := parser.Parse(ctx, in.Source, syntax.ParseOptions{URI: in.URI, Version: in.Version, Content: in.Content})
 	if err != nil {
 		return nil, err
 	}
@@ -61,8 +67,9 @@ func SummarizeTree(key DocumentKey, in DocumentInput, tree *syntax.Tree) (*Docum
 		URI:          in.URI,
 		Version:      in.Version,
 		Generation:   in.Generation,
-		ContentHash:  sha256.Sum256(tree.Source),
+		ContentHash:  treeContentHash(tree),
 		ParseTainted: len(tree.Diagnostics) > 0,
+		positions:    &positionCache{},
 	}
 
 	for _, id := range tree.TopLevelDeclarationIDs() {
@@ -106,10 +113,27 @@ func SummarizeTree(key DocumentKey, in DocumentInput, tree *syntax.Tree) (*Docum
 		}
 	})
 
+	// Summaries outlive the parse, so drop append growth slack.
+	sum.Declarations = clipSlice(sum.Declarations)
+	sum.References = clipSlice(sum.References)
 	sortDiagnostics(sum.Diagnostics)
 	return sum, nil
 }
 
+func treeContentHash(tree *syntax.Tree) [32]byte {
+	if tree.Content != nil {
+		return tree.Content.Hash()
+	}
+	return sha256.Sum256(tree.Source)
+}
+
+func clipSlice[S ~[]E, E any](s S) S {
+	if cap(s) == len(s) {
+		return s
+	}
+	return slices.Clone(s)
+}
+
 func summarizeInclude(tree *syntax.Tree, n *syntax.Node) (IncludeEdge, bool) {
 	if tree == nil || n == nil {
 		return IncludeEdge{}, false
@@ -162,7 +186,7 @@ func summarizeSymbol(sum *DocumentSummary, tree *syntax.Tree, n *syntax.Node) (S
 		return Symbol{}, false
 	}
 	return Symbol{
-		ID:       newSymbolID(sum.Key, kind, nameSpan),
+		ID:       SymbolID{Key: sum.Key, Span: nameSpan},
 		Key:      sum.Key,
 		URI:      sum.URI,
 		Kind:     kind,
@@ -207,7 +231,7 @@ func appendServiceExtendsReference(sum *DocumentSummary, tree *syntax.Tree, serv
 	if span := firstChildSpanByKind(tree, serviceID, "scoped_identifier"); span.IsValid() {
 		n := tree.NodeByID(firstChildNodeIDBySpan(tree, serviceID, span))
 		if n != nil {
-			sum.References = append(sum.References, newReferenceSite(sum, tree, n, ReferenceKindServiceExtends, []SymbolKind{SymbolKindService}))
+			sum.References = append(sum.References, newReferenceSite(sum, tree, n, ReferenceKindServiceExtends, serviceKinds))
 		}
 	}
 }
@@ -238,7 +262,7 @@ func appendThrowsReferences(sum *DocumentSummary, tree *syntax.Tree, functionID
 		if typeNode == nil || syntax.KindName(typeNode.Kind) != "scoped_identifier" {
 			continue
 		}
-		sum.References = append(sum.References, newReferenceSite(sum, tree, typeNode, ReferenceKindThrowsType, []SymbolKind{SymbolKindException}))
+		sum.References = append(sum.References, newReferenceSite(sum, tree, typeNode, ReferenceKindThrowsType, exceptionKinds))
 	}
 }
 
@@ -246,14 +270,14 @@ func newReferenceSite(sum *DocumentSummary, tree *syntax.Tree, node *syntax.Node
 	raw := strings.TrimSpace(textForSpan(tree.Source, node.Span))
 	qualifier, name := splitScopedIdentifier(raw)
 	return ReferenceSite{
-		ID:            newReferenceSiteID(sum.Key, context, node.Span),
+		ID:            ReferenceSiteID{Key: sum.Key, Span: node.Span},
 		URI:           sum.URI,
 		Context:       context,
 		RawText:       raw,
 		Qualifier:     qualifier,
 		Name:          name,
 		Span:          node.Span,
-		ExpectedKinds: cloneKinds(expected),
+		ExpectedKinds: expected,
 		Tainted:       nodeOrAncestorHasError(tree, node.ID),
 		Binding:       BindingResult{Status: BindingStatusUnknown},
 	}
@@ -282,12 +306,6 @@ func symbolKindForNodeKind(kind string) (SymbolKind, bool) {
 	}
 }
 
-func cloneKinds(in []SymbolKind) []SymbolKind {
-	out := make([]SymbolKind, len(in))
-	copy(out, in)
-	return out
-}
-
 func splitScopedIdentifier(raw string) (string, string) {
 	raw = strings.TrimSpace(raw)
 	if raw == "" {
@@ -300,12 +318,8 @@ func splitScopedIdentifier(raw string) (string, string) {
 	return parts[0], strings.Join(parts[1:], ".")
 }
 
-func newSymbolID(key DocumentKey, kind SymbolKind, span text.Span) SymbolID {
-	return SymbolID(fmt.Sprintf("%s:%s:%d:%d", key, kind, span.Start, span.End))
-}
-
-func newReferenceSiteID(key DocumentKey, kind ReferenceKind, span text.Span) ReferenceSiteID {
-	return ReferenceSiteID(fmt.Sprintf("%s:%s:%d:%d", key, kind, span.Start, span.End))
+func formatSiteID(key DocumentKey, span text.Span) string {
+	return string(key) + ":" + strconv.Itoa(int(span.Start)) + ":" + strconv.Itoa(int(span.End))
 }
 
 func forEachNamedNode(tree *syntax.Tree, fn func(n *syntax.Node, kind string)) {
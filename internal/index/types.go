@@ -11,11 +11,28 @@ import (
 // DocumentKey uniquely identifies a document within the workspace index.
 type DocumentKey string
 
-// SymbolID uniquely identifies a declaration symbol.
-type SymbolID string
+// SymbolID uniquely identifies a declaration symbol by its document and name
+// span. IDs share the document key string instead of owning a copy.
+type SymbolID struct {
+	Key  DocumentKey
+	Span text.Span
+}
+
+// ReferenceSiteID uniquely identifies a reference site by its document and span.
+type ReferenceSiteID struct {
+	Key  DocumentKey
+	Span text.Span
+}
+
+// String renders the ID as "key:start:end".
+func (id SymbolID) String() string {
+	return formatSiteID(id.Key, id.Span)
+}
 
-// ReferenceSiteID uniquely identifies a reference site.
-type ReferenceSiteID string
+// String renders the ID as "key:start:end".
+func (id ReferenceSiteID) String() string {
+	return formatSiteID(id.Key, id.Span)
+}
 
 // SymbolKind identifies a top-level declaration kind indexed by RFC 0003.
 type SymbolKind string
@@ -74,14 +91,29 @@ type Options struct {
 	MaxFileBytes   int64
 	ParseWorkers   int
 	Hooks          Hooks
+	// OnParsedTree, when set, receives the syntax tree of every disk document
+	// the manager parses, before the tree is released. It runs on the parse
+	// workers, concurrently, and must not retain the tree.
+	OnParsedTree func(key DocumentKey, uri string, tree *syntax.Tree)
 }
 
 // DocumentInput is a parsed-document input used by the workspace manager.
+//
+// The manager keeps Source without copying it, so callers must not modify it
+// afterwards. Content, when it holds Source, is shared with the parsed tree
+// and supplies the content hash.
 type DocumentInput struct {
 	URI        string
 	Version    int32
 	Generation uint64
 	Source     []byte
+	Content    *text.Content
+}
+
+// DocumentChange reports one on-disk document created, changed, or deleted.
+type DocumentChange struct {
+	URI     string
+	Deleted bool
 }
 
 // NamespaceDecl captures a namespace declaration.
@@ -135,7 +167,7 @@ type ReferenceSite struct {
 	Qualifier     string
 	Name          string
 	Span          text.Span
-	ExpectedKinds []SymbolKind
+	ExpectedKinds []SymbolKind // shared between sites; never modified
 	Tainted       bool
 	Binding       BindingResult
 }
@@ -164,6 +196,12 @@ type DocumentSummary struct {
 	Declarations []Symbol
 	References   []ReferenceSite
 	Diagnostics  []IndexDiagnostic
+
+	// ClosureComplete reports whether every document reachable through this
+	// document's includes was loaded when its snapshot was published.
+	ClosureComplete bool
+
+	positions *positionCache
 }
 
 // IncludeGraph records resolved include edges and components.
@@ -178,12 +216,11 @@ type WorkspaceSnapshot struct {
 	Generation        uint64
 	DiscoveryComplete bool
 	Documents         map[DocumentKey]*DocumentSummary
-	SymbolsByID       map[SymbolID]Symbol
-	SymbolsByQName    map[QualifiedName][]SymbolID
-	RefsByTarget      map[SymbolID][]ReferenceSiteID
 	IncludeGraph      IncludeGraph
 	ReverseDeps       map[DocumentKey][]DocumentKey
 	SnapshotIssues    []IndexDiagnostic
+
+	symbols *symbolTable
 }
 
 // DocumentView binds one document summary to its containing snapshot.
@@ -221,6 +258,10 @@ type QueryMeta struct {
 	DocumentVersion     int32
 	DocumentGeneration  uint64
 	DiscoveryComplete   bool
+	// DocumentClosureComplete reports whether the caller document's include
+	// closure was fully loaded, so definition answers are exact even while
+	// discovery is still running.
+	DocumentClosureComplete bool
 }
 
 // PrepareRenameResult describes a prepare-rename result or blockers.
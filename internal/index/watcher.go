@@ -0,0 +1,223 @@
+package index
+
+import (
+	"context"
+	"errors"
+	"path/filepath"
+	"slices"
+	"time"
+)
+
+const defaultWatchDebounce = 150 * time.Millisecond
+
+// ErrWatchUnsupported reports that native file watching is unavailable on this platform.
+var ErrWatchUnsupported = errors.New("workspace file watching is not supported on this platform")
+
+// WatchOptions configures the native workspace file watcher.
+type WatchOptions struct {
+	// Debounce is the quiet period collected into one refresh batch; zero uses the default.
+	Debounce time.Duration
+	// OnRefresh runs after a batch published a new workspace snapshot.
+	OnRefresh func()
+}
+
+// watchEvent is one raw notification from a watchSource. Paths name .thrift
+// files or, with dir set, removed directories; rescan asks for a full rescan
+// after a dropped event queue or a .gitignore change.
+type watchEvent struct {
+	path   string
+	dir    bool
+	rescan bool
+}
+
+// watchSource delivers filesystem notifications for the watched workspace directories.
+type watchSource interface {
+	Events() <-chan []watchEvent
+	Close() error
+}
+
+// watchBatch accumulates events for one debounce window.
+type watchBatch struct {
+	files  map[string]struct{}
+	dirs   map[string]struct{}
+	rescan bool
+}
+
+func (b *watchBatch) add(events []watchEvent) {
+	for _, event := range events {
+		switch {
+		case event.rescan:
+			b.rescan = true
+		case event.dir:
+			if b.dirs == nil {
+				b.dirs = make(map[string]struct{})
+			}
+			b.dirs[event.path] = struct{}{}
+		default:
+			if b.files == nil {
+				b.files = make(map[string]struct{})
+			}
+			b.files[event.path] = struct{}{}
+		}
+	}
+}
+
+func (b *watchBatch) empty() bool {
+	return !b.rescan && len(b.files) == 0 && len(b.dirs) == 0
+}
+
+type workspaceWatcher struct {
+	m         *Manager
+	source    watchSource
+	debounce  time.Duration
+	onRefresh func()
+	cancel    context.CancelFunc
+	done      chan struct{}
+}
+
+// StartWatcher starts a native watcher over the workspace roots and include
+// directories. Events are batched over a debounce window and refresh exactly
+// the touched documents; a dropped event queue falls back to a workspace
+// rescan. The watcher stops when the manager is closed.
+func (m *Manager) StartWatcher(opts WatchOptions) error {
+	if m == nil {
+		return errors.New("nil Manager")
+	}
+	dirs, err := scanDirectories(m.roots, m.includeDirs)
+	if err != nil {
+		return err
+	}
+
+	m.watcherMu.Lock()
+	defer m.watcherMu.Unlock()
+	if m.watcher != nil {
+		return nil
+	}
+	source, err := newWatchSource(dirs)
+	if err != nil {
+		return err
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	w := &workspaceWatcher{
+		m:         m,
+		source:    source,
+		debounce:  opts.Debounce,
+		onRefresh: opts.OnRefresh,
+		cancel:    cancel,
+		done:      make(chan struct{}),
+	}
+	if w.debounce <= 0 {
+		w.debounce = defaultWatchDebounce
+	}
+	m.watcher = w
+	go w.run(ctx)
+	return nil
+}
+
+func (m *Manager) stopWatcher() {
+	m.watcherMu.Lock()
+	w := m.watcher
+	m.watcher = nil
+	m.watcherMu.Unlock()
+	if w == nil {
+		return
+	}
+	w.cancel()
+	_ = w.source.Close()
+	<-w.done
+}
+
+// run batches events until the stream has been quiet for the debounce
+// window, or for at most four windows under a continuous stream.
+func (w *workspaceWatcher) run(ctx context.Context) {
+	defer close(w.done)
+
+	var (
+		batch    watchBatch
+		quiet    *time.Timer
+		deadline time.Time
+	)
+	flush := make(<-chan time.Time)
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case events, ok := <-w.source.Events():
+			if !ok {
+				return
+			}
+			batch.add(events)
+			if batch.empty() {
+				continue
+			}
+			now := time.Now()
+			if quiet == nil {
+				deadline = now.Add(4 * w.debounce)
+				quiet = time.NewTimer(w.debounce)
+				flush = quiet.C
+				continue
+			}
+			quiet.Reset(min(w.debounce, max(deadline.Sub(now), 0)))
+		case <-flush:
+			w.refresh(ctx, batch)
+			batch = watchBatch{}
+			quiet = nil
+			flush = make(<-chan time.Time)
+		}
+	}
+}
+
+func (w *workspaceWatcher) refresh(ctx context.Context, batch watchBatch) {
+	before := w.generation()
+	if batch.rescan || w.m.RefreshDocumentsWithReason(ctx, w.changes(batch), RebuildReasonWatch) != nil {
+		_ = w.m.RescanWorkspaceWithReason(ctx, RebuildReasonWatch)
+	}
+	if w.onRefresh != nil && w.generation() != before {
+		w.onRefresh()
+	}
+}
+
+// changes expands a batch into document changes. Removed directories refresh
+// every indexed document below them; stat decides whether each file is gone.
+func (w *workspaceWatcher) changes(batch watchBatch) []DocumentChange {
+	out := make([]DocumentChange, 0, len(batch.files))
+	for path := range batch.files {
+		out = append(out, DocumentChange{URI: path})
+	}
+	if len(batch.dirs) != 0 {
+		if snapshot, ok := w.m.Snapshot(); ok {
+			for _, doc := range snapshot.Documents {
+				path, err := filePathFromDocumentURI(doc.URI)
+				if err != nil {
+					continue
+				}
+				for dir := range batch.dirs {
+					if pathWithin(filepath.Clean(path), dir) {
+						out = append(out, DocumentChange{URI: path})
+						break
+					}
+				}
+			}
+		}
+	}
+	slices.SortFunc(out, func(a, b DocumentChange) int {
+		switch {
+		case a.URI < b.URI:
+			return -1
+		case a.URI > b.URI:
+			return 1
+		default:
+			return 0
+		}
+	})
+	return out
+}
+
+func (w *workspaceWatcher) generation() uint64 {
+	snapshot, ok := w.m.Snapshot()
+	if !ok {
+		return 0
+	}
+	return snapshot.Generation
+}
@@ -0,0 +1,200 @@
+//go:build linux
+
+package index
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"syscall"
+	"unsafe"
+)
+
+const inotifyWatchMask = syscall.IN_CREATE | syscall.IN_CLOSE_WRITE | syscall.IN_DELETE |
+	syscall.IN_MOVED_FROM | syscall.IN_MOVED_TO | syscall.IN_ONLYDIR
+
+// inotifySource watches workspace directories with one inotify instance. The
+// descriptor is non-blocking and wrapped in an os.File, so reads park on the
+// runtime poller and Close unblocks them. Directory bookkeeping is owned by
+// the reader goroutine after construction.
+type inotifySource struct {
+	file   *os.File
+	fd     int
+	dirs   map[int32]inotifyDir
+	events chan []watchEvent
+	done   chan struct{}
+}
+
+type inotifyDir struct {
+	path    string
+	rel     string
+	ignores gitIgnoreStack
+}
+
+func newWatchSource(dirs []string) (watchSource, error) {
+	fd, err := syscall.InotifyInit1(syscall.IN_CLOEXEC | syscall.IN_NONBLOCK)
+	if err != nil {
+		return nil, os.NewSyscallError("inotify_init1", err)
+	}
+	s := &inotifySource{
+		file:   os.NewFile(uintptr(fd), "inotify"),
+		fd:     fd,
+		dirs:   make(map[int32]inotifyDir),
+		events: make(chan []watchEvent, 16),
+		done:   make(chan struct{}),
+	}
+	for _, dir := range dirs {
+		if err := s.addTree(dir, "", nil, nil); err != nil {
+			_ = s.file.Close()
+			return nil, err
+		}
+	}
+	go s.read()
+	return s, nil
+}
+
+func (s *inotifySource) Events() <-chan []watchEvent {
+	return s.events
+}
+
+func (s *inotifySource) Close() error {
+	select {
+	case <-s.done:
+		return nil
+	default:
+	}
+	close(s.done)
+	return s.file.Close()
+}
+
+// addTree watches path and its non-ignored subdirectories. When found is
+// non-nil, .thrift files already present are reported, because they may have
+// been written before the watch existed.
+func (s *inotifySource) addTree(path string, rel string, inherited gitIgnoreStack, found *[]watchEvent) error {
+	ignores, err := inherited.withDir(path, rel)
+	if err != nil {
+		return err
+	}
+	wd, err := syscall.InotifyAddWatch(s.fd, path, inotifyWatchMask)
+	if err != nil {
+		if errors.Is(err, syscall.ENOENT) || errors.Is(err, syscall.ENOTDIR) {
+			return nil
+		}
+		if errors.Is(err, syscall.ENOSPC) {
+			return fmt.Errorf("watch %s: inotify watch limit reached: %w", path, err)
+		}
+		return fmt.Errorf("watch %s: %w", path, os.NewSyscallError("inotify_add_watch", err))
+	}
+	s.dirs[int32(wd)] = inotifyDir{path: path, rel: rel, ignores: ignores}
+
+	entries, err := os.ReadDir(path)
+	if err != nil {
+		return nil
+	}
+	for _, d := range entries {
+		name := d.Name()
+		childRel := joinWalkRel(rel, name)
+		if d.IsDir() {
+			if isIgnoredWorkspaceDir(name) || ignores.ignored(childRel, true) {
+				continue
+			}
+			if err := s.addTree(filepath.Join(path, name), childRel, ignores, found); err != nil {
+				return err
+			}
+			continue
+		}
+		if found != nil && filepath.Ext(name) == ".thrift" && !ignores.ignored(childRel, false) {
+			*found = append(*found, watchEvent{path: filepath.Join(path, name)})
+		}
+	}
+	return nil
+}
+
+func (s *inotifySource) read() {
+	defer close(s.events)
+
+	buf := make([]byte, 64*1024)
+	for {
+		n, err := s.file.Read(buf)
+		if err != nil {
+			return
+		}
+		events := s.decode(buf[:n])
+		if len(events) == 0 {
+			continue
+		}
+		select {
+		case s.events <- events:
+		case <-s.done:
+			return
+		}
+	}
+}
+
+func (s *inotifySource) decode(buf []byte) []watchEvent {
+	var out []watchEvent
+	for offset := 0; offset+syscall.SizeofInotifyEvent <= len(buf); {
+		raw := (*syscall.InotifyEvent)(unsafe.Pointer(&buf[offset]))
+		nameStart := offset + syscall.SizeofInotifyEvent
+		nameEnd := nameStart + int(raw.Len)
+		if nameEnd > len(buf) {
+			break
+		}
+		name := strings.TrimRight(string(buf[nameStart:nameEnd]), "\x00")
+		offset = nameEnd
+
+		mask := raw.Mask
+		if mask&syscall.IN_Q_OVERFLOW != 0 {
+			out = append(out, watchEvent{rescan: true})
+			continue
+		}
+		if mask&syscall.IN_IGNORED != 0 {
+			delete(s.dirs, raw.Wd)
+			continue
+		}
+		dir, ok := s.dirs[raw.Wd]
+		if !ok || name == "" {
+			continue
+		}
+		path := filepath.Join(dir.path, name)
+		rel := joinWalkRel(dir.rel, name)
+
+		if mask&syscall.IN_ISDIR != 0 {
+			switch {
+			case mask&(syscall.IN_CREATE|syscall.IN_MOVED_TO) != 0:
+				if isIgnoredWorkspaceDir(name) || dir.ignores.ignored(rel, true) {
+					continue
+				}
+				if err := s.addTree(path, rel, dir.ignores, &out); err != nil {
+					out = append(out, watchEvent{rescan: true})
+				}
+			case mask&(syscall.IN_DELETE|syscall.IN_MOVED_FROM) != 0:
+				s.removeTree(path)
+				out = append(out, watchEvent{path: path, dir: true})
+			}
+			continue
+		}
+		if name == ".gitignore" {
+			out = append(out, watchEvent{rescan: true})
+			continue
+		}
+		if filepath.Ext(name) != ".thrift" || dir.ignores.ignored(rel, false) {
+			continue
+		}
+		out = append(out, watchEvent{path: path})
+	}
+	return out
+}
+
+// removeTree drops watches below a directory that was moved away, so later
+// events are not reported under its stale path.
+func (s *inotifySource) removeTree(path string) {
+	for wd, dir := range s.dirs {
+		if pathWithin(dir.path, path) {
+			_, _ = syscall.InotifyRmWatch(s.fd, uint32(wd))
+			delete(s.dirs, wd)
+		}
+	}
+}
@@ -0,0 +1,90 @@
+//go:build linux
+
+package index
+
+import (
+	"context"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+)
+
+func TestManagerWatcherRefreshesTouchedDocuments(t *testing.T) {
+	t.Parallel()
+
+	root := t.TempDir()
+	mainPath := filepath.Join(root, "main.thrift")
+	if err := os.WriteFile(mainPath, []byte("struct Main {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile main: %v", err)
+	}
+	if err := os.WriteFile(filepath.Join(root, ".gitignore"), []byte("build/\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile .gitignore: %v", err)
+	}
+
+	m := NewManager(Options{WorkspaceRoots: []string{root}})
+	defer m.Close()
+	if err := m.RescanWorkspace(context.Background()); err != nil {
+		t.Fatalf("RescanWorkspace: %v", err)
+	}
+
+	refreshed := make(chan struct{}, 16)
+	if err := m.StartWatcher(WatchOptions{
+		Debounce:  20 * time.Millisecond,
+		OnRefresh: func() { refreshed <- struct{}{} },
+	}); err != nil {
+		t.Fatalf("StartWatcher: %v", err)
+	}
+
+	nested := filepath.Join(root, "nested", "deeper")
+	if err := os.MkdirAll(nested, 0o750); err != nil {
+		t.Fatalf("MkdirAll: %v", err)
+	}
+	nestedPath := filepath.Join(nested, "nested.thrift")
+	if err := os.WriteFile(nestedPath, []byte("struct Nested {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile nested: %v", err)
+	}
+	if err := os.MkdirAll(filepath.Join(root, "build"), 0o750); err != nil {
+		t.Fatalf("MkdirAll build: %v", err)
+	}
+	ignoredPath := filepath.Join(root, "build", "ignored.thrift")
+	if err := os.WriteFile(ignoredPath, []byte("struct Ignored {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile ignored: %v", err)
+	}
+	if err := os.WriteFile(mainPath, []byte("struct Renamed {}\n"), 0o600); err != nil {
+		t.Fatalf("WriteFile main: %v", err)
+	}
+
+	waitForSnapshot(t, m, refreshed, func(snap *WorkspaceSnapshot) bool {
+		_, nestedKey, _ := CanonicalizeDocumentURI(nestedPath)
+		_, mainKey, _ := CanonicalizeDocumentURI(mainPath)
+		main := snap.Documents[mainKey]
+		return snap.Documents[nestedKey] != nil && main != nil && main.Declarations[0].Name == "Renamed"
+	})
+	if _, key, _ := CanonicalizeDocumentURI(ignoredPath); mustSnapshot(t, m).Documents[key] != nil {
+		t.Fatal("gitignored directory should not be watched")
+	}
+
+	if err := os.RemoveAll(filepath.Join(root, "nested")); err != nil {
+		t.Fatalf("RemoveAll: %v", err)
+	}
+	waitForSnapshot(t, m, refreshed, func(snap *WorkspaceSnapshot) bool {
+		_, key, _ := CanonicalizeDocumentURI(nestedPath)
+		return snap.Documents[key] == nil
+	})
+}
+
+func waitForSnapshot(t *testing.T, m *Manager, refreshed <-chan struct{}, done func(*WorkspaceSnapshot) bool) {
+	t.Helper()
+	timeout := time.After(5 * time.Second)
+	for {
+		if done(mustSnapshot(t, m)) {
+			return
+		}
+		select {
+		case <-refreshed:
+		case <-timeout:
+			t.Fatal("timed out waiting for watcher refresh")
+		}
+	}
+}
@@ -0,0 +1,7 @@
+//go:build !linux
+
+package index
+
+func newWatchSource([]string) (watchSource, error) {
+	return nil, ErrWatchUnsupported
+}
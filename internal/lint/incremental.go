@@ -0,0 +1,312 @@
+package lint
+
+import (
+	"context"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/maphash"
+	"slices"
+	"sync"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+	itext "github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+// Verification is periodic, like full-parse verification of incremental reparses.
+var incrementalLintVerificationEvery uint64 = 64
+
+// Incremental lints successive versions of one document. Diagnostics of
+// scoped rules are cached per top-level declaration under a structural hash
+// of the declaration, so after an edit only changed declarations run again.
+// Declarations touched by the tree's ChangedRanges are never served from the
+// cache, and whole-file rules run every time. Calls are serialized.
+type Incremental struct {
+	mu          sync.Mutex
+	runner      *Runner
+	seed        maphash.Seed
+	fileRules   []Rule
+	scoped      []ScopedRule // cached rules; NodeRules first, matching pass.rules
+	symbolScope []bool       // scoped[i] has ScopeContainer
+	pass        *rulePass
+	outs        []*[]syntax.Diagnostic
+	decls       map[uint64]declarationLint
+	runs        uint64
+	verifyEvery uint64
+	scratch     []byte
+}
+
+// declarationLint is the cached lint result of one declaration. Spans are
+// relative to the declaration start.
+type declarationLint struct {
+	local   []syntax.Diagnostic
+	symbol  []syntax.Diagnostic
+	symbols uint64 // symbol table fingerprint the symbol diagnostics were computed with
+}
+
+// incrementalStats describes one incremental lint run.
+type incrementalStats struct {
+	declarations       int
+	reused             int
+	verificationRun    bool
+	verificationFailed bool
+}
+
+// NewIncremental builds an incremental linter over the local rules of r.
+func NewIncremental(r *Runner) *Incremental {
+	l := &Incremental{
+		runner:      r,
+		seed:        maphash.MakeSeed(),
+		decls:       make(map[uint64]declarationLint),
+		verifyEvery: incrementalLintVerificationEvery,
+	}
+	if r == nil {
+		return l
+	}
+	var nodeRules []NodeRule
+	var others []ScopedRule
+	for _, rule := range r.rules {
+		scoped, ok := rule.(ScopedRule)
+		if !ok || (scoped.Scope() != ScopeDeclaration && scoped.Scope() != ScopeContainer) {
+			l.fileRules = append(l.fileRules, rule)
+			continue
+		}
+		if nr, ok := scoped.(NodeRule); ok {
+			nodeRules = append(nodeRules, nr)
+			continue
+		}
+		others = append(others, scoped)
+	}
+	for _, rule := range nodeRules {
+		l.scoped = append(l.scoped, rule)
+	}
+	l.scoped = append(l.scoped, others...)
+	for _, rule := range l.scoped {
+		l.symbolScope = append(l.symbolScope, rule.Scope() == ScopeContainer)
+	}
+	l.pass = newRulePass(nodeRules)
+	l.outs = make([]*[]syntax.Diagnostic, len(l.scoped))
+	return l
+}
+
+// Run lints tree and returns a sorted diagnostic list equal to Runner.Run.
+func (l *Incremental) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	diags, _, err := l.run(ctx, tree)
+	return diags, err
+}
+
+func (l *Incremental) run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, incrementalStats, error) {
+	var stats incrementalStats
+	if tree == nil {
+		return nil, stats, errors.New("nil syntax tree")
+	}
+	ctx = normalizeContext(ctx)
+	if err := ctx.Err(); err != nil {
+		return nil, stats, err
+	}
+
+	l.mu.Lock()
+	defer l.mu.Unlock()
+
+	facts := &documentFacts{tree: tree}
+	var symbols uint64
+	if slices.Contains(l.symbolScope, true) {
+		symbols = l.symbolsFingerprint(facts.localSymbols())
+	}
+
+	decls := tree.TopLevelDeclarationIDs()
+	next := make(map[uint64]declarationLint, len(decls))
+	out := make([]syntax.Diagnostic, 0, 8)
+	for _, id := range decls {
+		if err := ctx.Err(); err != nil {
+			return nil, stats, err
+		}
+		n := tree.NodeByID(id)
+		if n == nil {
+			continue
+		}
+		key := l.declarationHash(tree, id)
+		cached, hit := l.decls[key]
+		hit = hit && !spanIntersectsAny(n.Span, tree.ChangedRanges)
+
+		result := cached
+		if !hit || cached.symbols != symbols {
+			local, symbol, err := l.lintDeclaration(ctx, &Declaration{Tree: tree, ID: id, facts: facts}, !hit)
+			if err != nil {
+				return nil, stats, err
+			}
+			if !hit {
+				result.local = local
+			}
+			result.symbol = symbol
+			result.symbols = symbols
+		}
+		if hit {
+			stats.reused++
+		}
+		stats.declarations++
+		next[key] = result
+
+		start := len(out)
+		out = append(out, result.local...)
+		out = append(out, result.symbol...)
+		relocateDiagnostics(out[start:], n.Span.Start)
+	}
+
+	for _, rule := range l.fileRules {
+		if err := ctx.Err(); err != nil {
+			return nil, stats, err
+		}
+		diags, err := rule.Run(ctx, tree)
+		if err != nil {
+			return nil, stats, fmt.Errorf("rule %s: %w", rule.ID(), err)
+		}
+		out = append(out, diags...)
+	}
+	for i := range out {
+		if out[i].Source == "" {
+			out[i].Source = DiagnosticSource
+		}
+	}
+	SortDiagnostics(out)
+	l.decls = next
+
+	l.runs++
+	if l.verifyEvery == 0 || l.runs%l.verifyEvery != 0 {
+		return out, stats, nil
+	}
+	stats.verificationRun = true
+	full, err := l.runner.Run(ctx, tree)
+	if err != nil {
+		return nil, stats, err
+	}
+	if !slices.EqualFunc(out, full, equalDiagnostic) {
+		// Drop the cache so the next run starts from scratch.
+		stats.verificationFailed = true
+		clear(l.decls)
+		return full, stats, nil
+	}
+	return out, stats, nil
+}
+
+// lintDeclaration runs the symbol-table rules, and the declaration rules
+// when withLocal is set, over one declaration. Spans in the result are
+// relative to the declaration start.
+func (l *Incremental) lintDeclaration(ctx context.Context, decl *Declaration, withLocal bool) (local, symbol []syntax.Diagnostic, err error) {
+	for i := range l.scoped {
+		switch {
+		case l.symbolScope[i]:
+			l.outs[i] = &symbol
+		case withLocal:
+			l.outs[i] = &local
+		default:
+			l.outs[i] = nil
+		}
+	}
+	l.pass.run(decl, l.outs[:len(l.pass.rules)], nil)
+	for i := len(l.pass.rules); i < len(l.scoped); i++ {
+		if l.outs[i] == nil {
+			continue
+		}
+		diags, err := l.scoped[i].RunDeclaration(ctx, decl)
+		if err != nil {
+			return nil, nil, fmt.Errorf("rule %s: %w", l.scoped[i].ID(), err)
+		}
+		*l.outs[i] = append(*l.outs[i], diags...)
+	}
+	clear(l.outs)
+
+	start := decl.Tree.Nodes[decl.ID].Span.Start
+	relocateDiagnostics(local, -start)
+	relocateDiagnostics(symbol, -start)
+	return local, symbol, nil
+}
+
+// declarationHash fingerprints a declaration by its source bytes and the
+// shape of its subtree: node kinds, flags, parents and spans relative to the
+// declaration. Equal hashes mean scoped rules produce the same relative
+// diagnostics.
+func (l *Incremental) declarationHash(tree *syntax.Tree, id syntax.NodeID) uint64 {
+	decl := &tree.Nodes[id]
+	start := decl.Span.Start
+	buf := l.scratch[:0]
+	end := subtreeEnd(tree, id)
+	for i := int(id); i < end; i++ {
+		n := &tree.Nodes[i]
+		parent := uint32(0)
+		if i > int(id) {
+			parent = uint32(n.Parent - id)
+		}
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(n.Kind))
+		buf = append(buf, byte(n.Flags))
+		buf = binary.LittleEndian.AppendUint32(buf, parent)
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(n.Span.Start-start))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(n.Span.End-start))
+	}
+	l.scratch = buf
+
+	var h maphash.Hash
+	h.SetSeed(l.seed)
+	_, _ = h.Write(buf)
+	_, _ = h.Write(textForSpanBytes(tree.Source, decl.Span))
+	return h.Sum64()
+}
+
+func (l *Incremental) symbolsFingerprint(symbols localSymbols) uint64 {
+	var h maphash.Hash
+	h.SetSeed(l.seed)
+	for _, name := range symbols.names {
+		_, _ = h.WriteString(name)
+		_ = h.WriteByte(byte(symbols.decls[name]))
+	}
+	return h.Sum64()
+}
+
+func textForSpanBytes(src []byte, sp itext.Span) []byte {
+	if !sp.IsValid() || int(sp.End) > len(src) {
+		return nil
+	}
+	return src[sp.Start:sp.End]
+}
+
+// relocateDiagnostics shifts diagnostic spans by delta in place. Related
+// slices are copied so cached diagnostics stay untouched.
+func relocateDiagnostics(diags []syntax.Diagnostic, delta itext.ByteOffset) {
+	for i := range diags {
+		diags[i].Span = shiftSpan(diags[i].Span, delta)
+		if len(diags[i].Related) == 0 {
+			continue
+		}
+		related := slices.Clone(diags[i].Related)
+		for j := range related {
+			related[j].Span = shiftSpan(related[j].Span, delta)
+		}
+		diags[i].Related = related
+	}
+}
+
+func shiftSpan(sp itext.Span, delta itext.ByteOffset) itext.Span {
+	if !sp.IsValid() {
+		return sp
+	}
+	return itext.Span{Start: sp.Start + delta, End: sp.End + delta}
+}
+
+func spanIntersectsAny(sp itext.Span, ranges []itext.Span) bool {
+	for _, r := range ranges {
+		if sp.Intersects(r) {
+			return true
+		}
+	}
+	return false
+}
+
+func equalDiagnostic(a, b syntax.Diagnostic) bool {
+	return a.Code == b.Code &&
+		a.Message == b.Message &&
+		a.Severity == b.Severity &&
+		a.Span == b.Span &&
+		a.Source == b.Source &&
+		a.Recoverable == b.Recoverable &&
+		slices.Equal(a.Related, b.Related)
+}
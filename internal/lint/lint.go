@@ -7,6 +7,8 @@ import (
 	"fmt"
 	"slices"
 	"sort"
+	"sync"
+	"time"
 
 	"github.com/kpumuk/thrift-weaver/internal/index"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
@@ -24,6 +26,95 @@ type Rule interface {
 	Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error)
 }
 
+// RuleScope declares which part of a document a rule's diagnostics depend on.
+type RuleScope uint8
+
+const (
+	// ScopeFile rules read the whole document. Rules that do not implement
+	// ScopedRule have this scope.
+	ScopeFile RuleScope = iota
+	// ScopeDeclaration rules read one top-level declaration subtree.
+	ScopeDeclaration
+	// ScopeContainer rules read one top-level declaration and the names and
+	// kinds of the declarations in the document that contains it.
+	ScopeContainer
+)
+
+// ScopedRule is a Rule that can run one top-level declaration at a time. Run
+// must return the diagnostics of RunDeclaration over all top-level declarations.
+type ScopedRule interface {
+	Rule
+	Scope() RuleScope
+	RunDeclaration(ctx context.Context, decl *Declaration) ([]syntax.Diagnostic, error)
+}
+
+// Declaration is a top-level declaration handed to a ScopedRule.
+type Declaration struct {
+	Tree *syntax.Tree
+	ID   syntax.NodeID
+
+	facts  *documentFacts
+	fields map[syntax.NodeID][]syntax.NodeID
+}
+
+// documentFacts holds document-wide data shared by the declarations of one
+// run, which may lint declarations concurrently.
+type documentFacts struct {
+	tree        *syntax.Tree
+	symbolsOnce sync.Once
+	symbols     localSymbols
+}
+
+func (d *Declaration) localSymbols() localSymbols {
+	if d.facts == nil {
+		d.facts = &documentFacts{tree: d.Tree}
+	}
+	return d.facts.localSymbols()
+}
+
+// fieldLists returns the error-free fields of the declaration grouped by the
+// node that contains them.
+func (d *Declaration) fieldLists() map[syntax.NodeID][]syntax.NodeID {
+	if d.fields == nil {
+		d.fields = make(map[syntax.NodeID][]syntax.NodeID)
+		forEachNamedNodeIn(d.Tree, d.ID, func(n *syntax.Node, kind string) {
+			if kind == "field" && !hasErrorFlags(n.Flags) {
+				d.fields[n.Parent] = append(d.fields[n.Parent], n.ID)
+			}
+		})
+	}
+	return d.fields
+}
+
+func (f *documentFacts) localSymbols() localSymbols {
+	f.symbolsOnce.Do(func() {
+		f.symbols = collectLocalSymbols(f.tree)
+	})
+	return f.symbols
+}
+
+// runDeclarations implements Run of a ScopedRule.
+func runDeclarations(ctx context.Context, tree *syntax.Tree, rule ScopedRule) ([]syntax.Diagnostic, error) {
+	ctx = normalizeContext(ctx)
+	if err := ctx.Err(); err != nil {
+		return nil, err
+	}
+
+	out := make([]syntax.Diagnostic, 0, 8)
+	facts := &documentFacts{tree: tree}
+	for _, id := range tree.TopLevelDeclarationIDs() {
+		if err := ctx.Err(); err != nil {
+			return nil, err
+		}
+		diags, err := rule.RunDeclaration(ctx, &Declaration{Tree: tree, ID: id, facts: facts})
+		if err != nil {
+			return nil, err
+		}
+		out = append(out, diags...)
+	}
+	return out, nil
+}
+
 // WorkspaceRule is a lint check that emits diagnostics from an indexed workspace document view.
 type WorkspaceRule interface {
 	ID() string
@@ -31,22 +122,30 @@ type WorkspaceRule interface {
 	RunWorkspace(ctx context.Context, view *index.DocumentView) ([]syntax.Diagnostic, error)
 }
 
-// Runner executes lint rules and returns aggregated diagnostics.
+// Runner executes lint rules and returns aggregated diagnostics. NodeRules
+// share one pass over the tree; other rules run on their own.
 type Runner struct {
 	rules          []Rule
 	workspaceRules []WorkspaceRule
+	pass           *rulePass
+	treeRules      []Rule
+	pool           *Pool
+	timings        *RuleTimings
 }
 
 // NewRunner builds a lint runner from a rule set.
 func NewRunner(rules ...Rule) *Runner {
-	return &Runner{rules: slices.Clone(rules)}
+	return NewRunnerWithWorkspace(rules, nil)
 }
 
 // NewRunnerWithWorkspace builds a lint runner from local and workspace-aware rule sets.
 func NewRunnerWithWorkspace(rules []Rule, workspaceRules []WorkspaceRule) *Runner {
+	nodeRules, treeRules := splitNodeRules(rules)
 	return &Runner{
 		rules:          slices.Clone(rules),
 		workspaceRules: slices.Clone(workspaceRules),
+		pass:           newRulePass(nodeRules),
+		treeRules:      treeRules,
 	}
 }
 
@@ -73,6 +172,44 @@ func NewDefaultRunner() *Runner {
 	)
 }
 
+// Rules returns the configured local rules.
+func (r *Runner) Rules() []Rule {
+	if r == nil {
+		return nil
+	}
+	return slices.Clone(r.rules)
+}
+
+// WithPool returns a copy of r that spreads its work over pool: chunks of
+// top-level declarations and whole-file rules of one document run
+// concurrently, as do workspace rules. Results are unchanged.
+func (r *Runner) WithPool(pool *Pool) *Runner {
+	if r == nil {
+		return nil
+	}
+	c := *r
+	c.pool = pool
+	return &c
+}
+
+// WithTimings returns a copy of r that adds the time spent in each rule to t.
+func (r *Runner) WithTimings(t *RuleTimings) *Runner {
+	if r == nil {
+		return nil
+	}
+	c := *r
+	c.timings = t
+	return &c
+}
+
+// Pool returns the worker pool of r, or nil when r runs serially.
+func (r *Runner) Pool() *Pool {
+	if r == nil {
+		return nil
+	}
+	return r.pool
+}
+
 // Run executes all configured rules and returns a sorted diagnostic list.
 func (r *Runner) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
 	if tree == nil {
@@ -86,21 +223,57 @@ func (r *Runner) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnosti
 		return []syntax.Diagnostic{}, nil
 	}
 
-	out := make([]syntax.Diagnostic, 0, 8)
-	for _, rule := range r.rules {
-		if err := ctx.Err(); err != nil {
-			return nil, err
+	// Task i < len(chunks) lints one chunk of declarations in the shared pass;
+	// the rest run one whole-file rule each. Results merge in task order.
+	chunks := r.pass.chunks(tree.TopLevelDeclarationIDs(), r.pool.Workers())
+	results := make([][]syntax.Diagnostic, len(chunks)+len(r.treeRules))
+	var spent [][]time.Duration
+	if r.timings != nil {
+		spent = make([][]time.Duration, len(chunks))
+		for i := range spent {
+			spent[i] = make([]time.Duration, len(r.pass.rules))
 		}
+	}
+	facts := &documentFacts{tree: tree}
+	err := r.pool.Run(ctx, len(results), func(ctx context.Context, i int) error {
+		if i < len(chunks) {
+			var chunkSpent []time.Duration
+			if spent != nil {
+				chunkSpent = spent[i]
+			}
+			diags, err := r.pass.runDeclarations(ctx, facts, chunks[i], chunkSpent)
+			results[i] = diags
+			return err
+		}
+		rule := r.treeRules[i-len(chunks)]
+		start := time.Now()
 		diags, err := rule.Run(ctx, tree)
 		if err != nil {
-			return nil, fmt.Errorf("rule %s: %w", rule.ID(), err)
+			return fmt.Errorf("rule %s: %w", rule.ID(), err)
 		}
-		for i := range diags {
-			if diags[i].Source == "" {
-				diags[i].Source = DiagnosticSource
+		if r.timings != nil {
+			r.timings.add(rule.ID(), time.Since(start))
+		}
+		results[i] = diags
+		return nil
+	})
+	if err != nil {
+		return nil, err
+	}
+	if spent != nil {
+		for rule, nodeRule := range r.pass.rules {
+			var total time.Duration
+			for _, chunk := range spent {
+				total += chunk[rule]
 			}
+			r.timings.add(nodeRule.ID(), total)
+		}
+	}
+	out := concatDiagnostics(results)
+	for i := range out {
+		if out[i].Source == "" {
+			out[i].Source = DiagnosticSource
 		}
-		out = append(out, diags...)
 	}
 
 	SortDiagnostics(out)
@@ -121,27 +294,46 @@ func (r *Runner) RunWithWorkspace(ctx context.Context, view *index.DocumentView)
 		return []syntax.Diagnostic{}, nil
 	}
 
-	out := make([]syntax.Diagnostic, 0, 8)
-	for _, rule := range r.workspaceRules {
-		if err := ctx.Err(); err != nil {
-			return nil, err
-		}
+	results := make([][]syntax.Diagnostic, len(r.workspaceRules))
+	err := r.pool.Run(ctx, len(results), func(ctx context.Context, i int) error {
+		rule := r.workspaceRules[i]
+		start := time.Now()
 		diags, err := rule.RunWorkspace(ctx, view)
 		if err != nil {
-			return nil, fmt.Errorf("workspace rule %s: %w", rule.ID(), err)
+			return fmt.Errorf("workspace rule %s: %w", rule.ID(), err)
 		}
-		for i := range diags {
-			if diags[i].Source == "" {
-				diags[i].Source = DiagnosticSourceWorkspace
-			}
+		if r.timings != nil {
+			r.timings.add(rule.ID(), time.Since(start))
+		}
+		results[i] = diags
+		return nil
+	})
+	if err != nil {
+		return nil, err
+	}
+	out := concatDiagnostics(results)
+	for i := range out {
+		if out[i].Source == "" {
+			out[i].Source = DiagnosticSourceWorkspace
 		}
-		out = append(out, diags...)
 	}
 
 	SortDiagnostics(out)
 	return out, nil
 }
 
+func concatDiagnostics(parts [][]syntax.Diagnostic) []syntax.Diagnostic {
+	n := 0
+	for _, part := range parts {
+		n += len(part)
+	}
+	out := make([]syntax.Diagnostic, 0, n)
+	for _, part := range parts {
+		out = append(out, part...)
+	}
+	return out
+}
+
 // SortDiagnostics orders diagnostics deterministically for stable output.
 func SortDiagnostics(diags []syntax.Diagnostic) {
 	if len(diags) < 2 {
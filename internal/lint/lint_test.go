@@ -2,8 +2,13 @@ package lint
 
 import (
 	"context"
+	"errors"
+	"fmt"
 	"os"
 	"path/filepath"
+	"slices"
+	"strings"
+	"sync/atomic"
 	"testing"
 
 	"github.com/kpumuk/thrift-weaver/internal/index"
@@ -490,6 +495,332 @@ func TestRunnerRunWithWorkspaceResolvedNavigationHasNoWorkspaceDiagnostics(t *te
 	}
 }
 
+func TestIncrementalMatchesFullLintAcrossEdits(t *testing.T) {
+	t.Parallel()
+
+	versions := []string{
+		`
+struct User {
+  1: string name,
+  1: string title,
+}
+
+struct Account {
+  1: User owner,
+  2: Missing other,
+}
+
+service API {
+  void ping(1: User user) throws (1: Account err),
+}
+`,
+		// Edit inside User only.
+		`
+struct User {
+  1: string name,
+  2: string title,
+  xsd_optional string nick,
+}
+
+struct Account {
+  1: User owner,
+  2: Missing other,
+}
+
+service API {
+  void ping(1: User user) throws (1: Account err),
+}
+`,
+		// Rename Account: unchanged declarations that reference it must be re-linted.
+		`
+struct User {
+  1: string name,
+  2: string title,
+  xsd_optional string nick,
+}
+
+exception Account {
+  1: User owner,
+  2: Missing other,
+}
+
+service API {
+  void ping(1: User user) throws (1: Account err),
+}
+`,
+		// Shift everything down without changing declarations.
+		`
+namespace go demo
+
+struct User {
+  1: string name,
+  2: string title,
+  xsd_optional string nick,
+}
+
+exception Account {
+  1: User owner,
+  2: Missing other,
+}
+
+service API {
+  void ping(1: User user) throws (1: Account err),
+}
+`,
+	}
+
+	runner := NewDefaultRunner()
+	linter := NewIncremental(runner)
+	linter.verifyEvery = 0
+	for i, src := range versions {
+		tree := mustParseTree(t, src)
+		want, err := runner.Run(context.Background(), tree)
+		if err != nil {
+			t.Fatalf("version %d: Run: %v", i, err)
+		}
+		got, stats, err := linter.run(context.Background(), tree)
+		if err != nil {
+			t.Fatalf("version %d: Incremental.Run: %v", i, err)
+		}
+		if !slices.EqualFunc(got, want, equalDiagnostic) {
+			t.Fatalf("version %d: incremental diagnostics\n%+v\nwant\n%+v", i, got, want)
+		}
+		if i > 0 && stats.reused == 0 {
+			t.Fatalf("version %d: no declarations reused (%+v)", i, stats)
+		}
+		if i == 3 && stats.reused != stats.declarations-1 {
+			t.Fatalf("version %d: reused %d of %d declarations, want all but the new namespace", i, stats.reused, stats.declarations)
+		}
+	}
+}
+
+func TestIncrementalVerificationFallsBackToFullLint(t *testing.T) {
+	t.Parallel()
+
+	tree := mustParseTree(t, `
+struct S {
+  1: string name,
+  string title,
+}
+`)
+	runner := NewDefaultRunner()
+	linter := NewIncremental(runner)
+	linter.verifyEvery = 2
+	if _, err := linter.Run(context.Background(), tree); err != nil {
+		t.Fatalf("Incremental.Run: %v", err)
+	}
+	for key, cached := range linter.decls {
+		cached.local = nil
+		linter.decls[key] = cached
+	}
+
+	got, stats, err := linter.run(context.Background(), tree)
+	if err != nil {
+		t.Fatalf("Incremental.Run: %v", err)
+	}
+	if !stats.verificationRun || !stats.verificationFailed {
+		t.Fatalf("stats=%+v, want failed verification", stats)
+	}
+	if !hasCode(got, DiagnosticFieldIDRequired) {
+		t.Fatalf("verification did not return full lint diagnostics: %+v", got)
+	}
+	if len(linter.decls) != 0 {
+		t.Fatalf("cache kept %d declarations after mismatch", len(linter.decls))
+	}
+}
+
+func TestSharedPassMatchesRulesRunAlone(t *testing.T) {
+	t.Parallel()
+
+	runner := NewDefaultRunner()
+	for _, set := range []string{"valid", "invalid", "editor"} {
+		files, err := testutil.CorpusFiles(set)
+		if err != nil {
+			t.Fatalf("CorpusFiles(%q): %v", set, err)
+		}
+		for _, path := range files {
+			tree, err := syntax.Parse(context.Background(), testutil.ReadFile(t, path), syntax.ParseOptions{URI: path})
+			if err != nil {
+				t.Fatalf("syntax.Parse(%s): %v", path, err)
+			}
+			got, err := runner.Run(context.Background(), tree)
+			if err != nil {
+				t.Fatalf("Run(%s): %v", path, err)
+			}
+			var want []syntax.Diagnostic
+			for _, rule := range runner.Rules() {
+				diags, err := rule.Run(context.Background(), tree)
+				if err != nil {
+					t.Fatalf("%s.Run(%s): %v", rule.ID(), path, err)
+				}
+				want = append(want, diags...)
+			}
+			for i := range want {
+				want[i].Source = DiagnosticSource
+			}
+			SortDiagnostics(want)
+			if !slices.EqualFunc(got, want, equalDiagnostic) {
+				t.Fatalf("%s: shared pass diagnostics differ\n got: %+v\nwant: %+v", path, got, want)
+			}
+		}
+	}
+}
+
+func TestRunnerWithPoolMatchesSerialRun(t *testing.T) {
+	t.Parallel()
+
+	var src strings.Builder
+	for i := range 600 {
+		fmt.Fprintf(&src, "struct S%d {\n  1: string name,\n  name: Missing%d,\n  1: i32 id,\n}\n\n", i, i%7)
+	}
+	tree := mustParseTree(t, src.String())
+	want, err := NewDefaultRunner().Run(context.Background(), tree)
+	if err != nil {
+		t.Fatalf("Run: %v", err)
+	}
+
+	timings := &RuleTimings{}
+	runner := NewDefaultRunner().WithPool(NewPool(4)).WithTimings(timings)
+	if chunks := runner.pass.chunks(tree.TopLevelDeclarationIDs(), runner.pool.Workers()); len(chunks) != 4 {
+		t.Fatalf("chunks = %d, want 4", len(chunks))
+	}
+	got, err := runner.Run(context.Background(), tree)
+	if err != nil {
+		t.Fatalf("parallel Run: %v", err)
+	}
+	if !slices.EqualFunc(got, want, equalDiagnostic) {
+		t.Fatalf("parallel run differs from serial run: got %d diagnostics, want %d", len(got), len(want))
+	}
+
+	recorded := timings.Timings()
+	if len(recorded) != len(runner.Rules()) {
+		t.Fatalf("timed %d rules, want %d", len(recorded), len(runner.Rules()))
+	}
+	for _, rt := range recorded {
+		if rt.Runs != 1 {
+			t.Fatalf("rule %s timed %d runs, want 1", rt.Rule, rt.Runs)
+		}
+	}
+}
+
+func TestPoolRunStopsOnFirstError(t *testing.T) {
+	t.Parallel()
+
+	pool := NewPool(1)
+	boom := errors.New("boom")
+	var ran atomic.Int32
+	err := pool.Run(context.Background(), 100, func(_ context.Context, i int) error {
+		ran.Add(1)
+		if i == 3 {
+			return boom
+		}
+		return nil
+	})
+	if !errors.Is(err, boom) {
+		t.Fatalf("Run error = %v, want %v", err, boom)
+	}
+	if ran.Load() != 4 {
+		t.Fatalf("ran %d tasks, want 4 up to the first error", ran.Load())
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	if err := pool.Run(ctx, 1, func(context.Context, int) error { return nil }); !errors.Is(err, context.Canceled) {
+		t.Fatalf("Run on canceled context = %v, want context.Canceled", err)
+	}
+}
+
+func BenchmarkDefaultRunner(b *testing.B) {
+	root := testutil.MustRepoRoot(b)
+	src := testutil.ReadFile(b, filepath.Join(root, "testdata", "format", "input", "006_apache_cassandra.thrift"))
+	tree, err := syntax.Parse(context.Background(), src, syntax.ParseOptions{URI: "file:///cassandra.thrift"})
+	if err != nil {
+		b.Fatalf("syntax.Parse: %v", err)
+	}
+	bench := func(runner *Runner) func(*testing.B) {
+		return func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := runner.Run(context.Background(), tree); err != nil {
+					b.Fatalf("Run: %v", err)
+				}
+			}
+		}
+	}
+	runner := NewDefaultRunner()
+	b.Run("all", bench(runner))
+	for _, rule := range runner.Rules() {
+		b.Run(rule.ID(), bench(NewRunner(rule)))
+	}
+}
+
+func BenchmarkDefaultRunnerWithPool(b *testing.B) {
+	var src strings.Builder
+	for i := range 4000 {
+		fmt.Fprintf(&src, "struct S%d {\n  1: string name,\n  2: optional S%d next,\n  3: list<string> tags,\n}\n\n", i, max(i-1, 0))
+	}
+	tree, err := syntax.Parse(context.Background(), []byte(src.String()), syntax.ParseOptions{URI: "file:///bench.thrift"})
+	if err != nil {
+		b.Fatalf("syntax.Parse: %v", err)
+	}
+	bench := func(runner *Runner) func(*testing.B) {
+		return func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := runner.Run(context.Background(), tree); err != nil {
+					b.Fatalf("Run: %v", err)
+				}
+			}
+		}
+	}
+	b.Run("serial", bench(NewDefaultRunner()))
+	b.Run("pool", bench(NewDefaultRunner().WithPool(NewPool(0))))
+}
+
+func BenchmarkLintAfterSingleDeclarationEdit(b *testing.B) {
+	var base strings.Builder
+	for i := range 2000 {
+		fmt.Fprintf(&base, "struct S%d {\n  1: string name,\n  2: optional S%d next,\n  3: list<string> tags,\n}\n\n", i, max(i-1, 0))
+	}
+	base.WriteString("service API {\n  S1 get(1: S0 req),\n}\n")
+	src := base.String()
+	parse := func(src string) *syntax.Tree {
+		tree, err := syntax.Parse(context.Background(), []byte(src), syntax.ParseOptions{URI: "file:///bench.thrift", Version: 1})
+		if err != nil {
+			b.Fatalf("syntax.Parse: %v", err)
+		}
+		return tree
+	}
+	trees := [2]*syntax.Tree{parse(src), parse(strings.Replace(src, "struct S1000 {\n  1: string name", "struct S1000 {\n  1: string title", 1))}
+
+	b.Run("full", func(b *testing.B) {
+		runner := NewDefaultRunner()
+		b.ReportAllocs()
+		i := 0
+		for b.Loop() {
+			if _, err := runner.Run(context.Background(), trees[i%2]); err != nil {
+				b.Fatalf("Run: %v", err)
+			}
+			i++
+		}
+	})
+	b.Run("incremental", func(b *testing.B) {
+		linter := NewIncremental(NewDefaultRunner())
+		linter.verifyEvery = 0
+		if _, err := linter.Run(context.Background(), trees[0]); err != nil {
+			b.Fatalf("Run: %v", err)
+		}
+		b.ReportAllocs()
+		i := 1
+		for b.Loop() {
+			if _, err := linter.Run(context.Background(), trees[i%2]); err != nil {
+				b.Fatalf("Run: %v", err)
+			}
+			i++
+		}
+	})
+}
+
 func mustParseTree(t *testing.T, src string) *syntax.Tree {
 	t.Helper()
 
@@ -0,0 +1,130 @@
+package lint
+
+import (
+	"context"
+	"runtime"
+	"sort"
+	"sync"
+	"time"
+)
+
+// Pool bounds the lint work running at once across every runner sharing it.
+// A task that finds no free worker runs on the calling goroutine, so nested
+// fan-out (files, then declarations of one file) never waits on itself.
+type Pool struct {
+	slots chan struct{}
+}
+
+// NewPool builds a pool with the given number of workers, counting the
+// calling goroutine. Zero or less selects GOMAXPROCS.
+func NewPool(workers int) *Pool {
+	if workers <= 0 {
+		workers = runtime.GOMAXPROCS(0)
+	}
+	return &Pool{slots: make(chan struct{}, workers-1)}
+}
+
+// Workers reports the pool size, counting the calling goroutine.
+func (p *Pool) Workers() int {
+	if p == nil {
+		return 1
+	}
+	return cap(p.slots) + 1
+}
+
+// Run calls task for every index in [0, n) and waits for all of them. The
+// first error cancels the context handed to the remaining tasks and is
+// returned; tasks that have not started by then are skipped.
+func (p *Pool) Run(ctx context.Context, n int, task func(ctx context.Context, i int) error) error {
+	parent := normalizeContext(ctx)
+	ctx, cancel := context.WithCancel(parent)
+	defer cancel()
+
+	var (
+		wg    sync.WaitGroup
+		once  sync.Once
+		first error
+	)
+	fail := func(err error) {
+		once.Do(func() {
+			first = err
+			cancel()
+		})
+	}
+	for i := range n {
+		if ctx.Err() != nil {
+			break
+		}
+		if p != nil {
+			select {
+			case p.slots <- struct{}{}:
+				wg.Add(1)
+				go func(i int) {
+					defer func() {
+						<-p.slots
+						wg.Done()
+					}()
+					if err := task(ctx, i); err != nil {
+						fail(err)
+					}
+				}(i)
+				continue
+			default:
+			}
+		}
+		if err := task(ctx, i); err != nil {
+			fail(err)
+		}
+	}
+	wg.Wait()
+	if first != nil {
+		return first
+	}
+	return parent.Err()
+}
+
+// RuleTiming is the time spent in one rule.
+type RuleTiming struct {
+	Rule     string
+	Duration time.Duration
+	Runs     int
+}
+
+// RuleTimings collects the time spent in each rule across runs. It is safe
+// for concurrent use.
+type RuleTimings struct {
+	mu     sync.Mutex
+	byRule map[string]*RuleTiming
+}
+
+func (t *RuleTimings) add(rule string, d time.Duration) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	if t.byRule == nil {
+		t.byRule = make(map[string]*RuleTiming)
+	}
+	rt := t.byRule[rule]
+	if rt == nil {
+		rt = &RuleTiming{Rule: rule}
+		t.byRule[rule] = rt
+	}
+	rt.Duration += d
+	rt.Runs++
+}
+
+// Timings returns the collected timings, slowest rule first.
+func (t *RuleTimings) Timings() []RuleTiming {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	out := make([]RuleTiming, 0, len(t.byRule))
+	for _, rt := range t.byRule {
+		out = append(out, *rt)
+	}
+	sort.Slice(out, func(i, j int) bool {
+		if out[i].Duration != out[j].Duration {
+			return out[i].Duration > out[j].Duration
+		}
+		return out[i].Rule < out[j].Rule
+	})
+	return out
+}
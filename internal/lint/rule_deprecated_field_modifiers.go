@@ -54,33 +54,42 @@ func (DeprecatedFieldModifiersRule) Description() string {
 	return "deprecated xsd field modifiers should not be used"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (DeprecatedFieldModifiersRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (DeprecatedFieldModifiersRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
+func (r DeprecatedFieldModifiersRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r DeprecatedFieldModifiersRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (DeprecatedFieldModifiersRule) Kinds() []string {
+	return []string{"field"}
+}
+
+// VisitNode checks the modifiers of one field.
+func (DeprecatedFieldModifiersRule) VisitNode(v *Visit, n *syntax.Node) {
+	tree := v.Tree
+	if hasErrorFlags(n.Flags) {
+		return
 	}
 
-	out := make([]syntax.Diagnostic, 0, 8)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "field" {
-			return
+	for _, childID := range tree.ChildNodeIDs(n.ID) {
+		child := tree.NodeByID(childID)
+		if child == nil {
+			continue
 		}
-		if hasErrorFlags(n.Flags) {
-			return
+		code, message, ok := deprecatedFieldModifierDiagnostic(kindName(child.Kind))
+		if !ok {
+			continue
 		}
-
-		for _, childID := range tree.ChildNodeIDs(n.ID) {
-			child := tree.NodeByID(childID)
-			if child == nil {
-				continue
-			}
-			code, message, ok := deprecatedFieldModifierDiagnostic(syntax.KindName(child.Kind))
-			if !ok {
-				continue
-			}
-			out = append(out, newRecoverableWarning(code, message, child.Span))
-		}
-	})
-	return out, nil
+		v.Report(newRecoverableWarning(code, message, child.Span))
+	}
 }
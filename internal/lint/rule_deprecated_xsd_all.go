@@ -24,33 +24,41 @@ func (DeprecatedXSDAllRule) Description() string {
 	return "deprecated definition modifier xsd_all should not be used"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (DeprecatedXSDAllRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (DeprecatedXSDAllRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
+func (r DeprecatedXSDAllRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r DeprecatedXSDAllRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (DeprecatedXSDAllRule) Kinds() []string {
+	return []string{"struct_definition", "union_definition"}
+}
+
+// VisitNode checks one struct or union definition.
+func (DeprecatedXSDAllRule) VisitNode(v *Visit, n *syntax.Node) {
+	tree := v.Tree
+	if hasErrorFlags(n.Flags) {
+		return
+	}
+
+	xsdAllSpan := firstChildSpanByKind(tree, n.ID, "xsd_all")
+	if !xsdAllSpan.IsValid() {
+		return
 	}
 
-	out := make([]syntax.Diagnostic, 0, 4)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "struct_definition" && kind != "union_definition" {
-			return
-		}
-		if hasErrorFlags(n.Flags) {
-			return
-		}
-
-		xsdAllSpan := firstChildSpanByKind(tree, n.ID, "xsd_all")
-		if !xsdAllSpan.IsValid() {
-			return
-		}
-
-		out = append(out, newRecoverableWarning(
-			DiagnosticDeprecatedXSDAll,
-			"deprecated definition modifier `xsd_all` should not be used",
-			xsdAllSpan,
-		))
-	})
-
-	return out, nil
+	v.Report(newRecoverableWarning(
+		DiagnosticDeprecatedXSDAll,
+		"deprecated definition modifier `xsd_all` should not be used",
+		xsdAllSpan,
+	))
 }
@@ -24,34 +24,39 @@ func (FieldIDRequiredRule) Description() string {
 	return "all field declarations must define an explicit numeric field id"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (FieldIDRequiredRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (FieldIDRequiredRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
+func (r FieldIDRequiredRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r FieldIDRequiredRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (FieldIDRequiredRule) Kinds() []string {
+	return []string{"field"}
+}
+
+// VisitNode checks one field.
+func (FieldIDRequiredRule) VisitNode(v *Visit, n *syntax.Node) {
+	if hasErrorFlags(n.Flags) || hasChildByKind(v.Tree, n.ID, "field_id") {
+		return
 	}
 
-	out := make([]syntax.Diagnostic, 0, 8)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "field" {
-			return
-		}
-		if hasErrorFlags(n.Flags) {
-			return
-		}
-		if hasChildByKind(tree, n.ID, "field_id") {
-			return
-		}
-
-		span := firstChildSpanByKind(tree, n.ID, "field_name")
-		if !span.IsValid() {
-			span = n.Span
-		}
-		out = append(out, newRecoverableWarning(
-			DiagnosticFieldIDRequired,
-			"field is missing an explicit field id (for example: `1:`)",
-			span,
-		))
-	})
-	return out, nil
+	span := firstChildSpanByKind(v.Tree, n.ID, "field_name")
+	if !span.IsValid() {
+		span = n.Span
+	}
+	v.Report(newRecoverableWarning(
+		DiagnosticFieldIDRequired,
+		"field is missing an explicit field id (for example: `1:`)",
+		span,
+	))
 }
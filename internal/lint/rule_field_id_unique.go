@@ -26,20 +26,36 @@ func (FieldIDUniqueRule) Description() string {
 	return "explicit field ids must be unique within the same containing field list"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (FieldIDUniqueRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (FieldIDUniqueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
+func (r FieldIDUniqueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r FieldIDUniqueRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (FieldIDUniqueRule) Kinds() []string {
+	return []string{"field"}
+}
 
-	return duplicateFieldChildDiagnostics(
-		tree,
+// VisitNode checks the field list that starts with one field.
+func (FieldIDUniqueRule) VisitNode(v *Visit, n *syntax.Node) {
+	reportDuplicateFieldChildren(
+		v,
+		n,
 		"field_id",
 		normalizedIntegerLiteral,
 		DiagnosticFieldIDDuplicate,
 		"explicit field id is duplicated within the same containing field list",
-	), nil
+	)
 }
 
 func normalizedIntegerLiteral(raw string) string {
@@ -25,18 +25,34 @@ func (FieldNameUniqueRule) Description() string {
 	return "field names must be unique within the same containing field list"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (FieldNameUniqueRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (FieldNameUniqueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
-
-	return duplicateFieldChildDiagnostics(
-		tree,
+func (r FieldNameUniqueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r FieldNameUniqueRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (FieldNameUniqueRule) Kinds() []string {
+	return []string{"field"}
+}
+
+// VisitNode checks the field list that starts with one field.
+func (FieldNameUniqueRule) VisitNode(v *Visit, n *syntax.Node) {
+	reportDuplicateFieldChildren(
+		v,
+		n,
 		"field_name",
 		strings.TrimSpace,
 		DiagnosticFieldNameDuplicate,
 		"field name is duplicated within the same containing field list",
-	), nil
+	)
 }
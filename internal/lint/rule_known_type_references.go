@@ -29,32 +29,35 @@ func (UnknownTypeRule) Description() string {
 	return "unqualified local type references must resolve within the current document"
 }
 
+// Scope reports that the rule reads one top-level declaration and the local symbol table.
+func (UnknownTypeRule) Scope() RuleScope {
+	return ScopeContainer
+}
+
 // Run evaluates the rule against a syntax tree.
-func (UnknownTypeRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
+func (r UnknownTypeRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
 
-	symbols := collectLocalSymbols(tree)
-	out := make([]syntax.Diagnostic, 0, 4)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if hasErrorFlags(n.Flags) {
-			return
-		}
-
-		switch kind {
-		case "field":
-			if hasAncestorKind(tree, n.ID, "throws_clause") {
-				return
-			}
-			appendDirectTypeDiagnostics(tree, symbols, n.ID, DiagnosticTypeUnknown, "referenced type is unknown in the current document", &out)
-		case "const_declaration", "function_definition":
-			appendDirectTypeDiagnostics(tree, symbols, n.ID, DiagnosticTypeUnknown, "referenced type is unknown in the current document", &out)
-		}
-	})
-
-	return out, nil
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r UnknownTypeRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (UnknownTypeRule) Kinds() []string {
+	return []string{"field", "const_declaration", "function_definition"}
+}
+
+// VisitNode checks the types referenced directly by one node.
+func (UnknownTypeRule) VisitNode(v *Visit, n *syntax.Node) {
+	if hasErrorFlags(n.Flags) {
+		return
+	}
+	if kindName(n.Kind) == "field" && hasAncestorKind(v.Tree, n.ID, "throws_clause") {
+		return
+	}
+	appendDirectTypeDiagnostics(v.Tree, v.localSymbols(), n.ID, DiagnosticTypeUnknown, "referenced type is unknown in the current document", v.out)
 }
 
 // ID returns the stable rule identifier.
@@ -67,21 +70,30 @@ func (TypedefUnknownBaseRule) Description() string {
 	return "typedef base types must resolve within the current document when locally referenceable"
 }
 
+// Scope reports that the rule reads one top-level declaration and the local symbol table.
+func (TypedefUnknownBaseRule) Scope() RuleScope {
+	return ScopeContainer
+}
+
 // Run evaluates the rule against a syntax tree.
-func (TypedefUnknownBaseRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
+func (r TypedefUnknownBaseRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
 
-	symbols := collectLocalSymbols(tree)
-	out := make([]syntax.Diagnostic, 0, 2)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "typedef_declaration" || hasErrorFlags(n.Flags) {
-			return
-		}
-		appendDirectTypeDiagnostics(tree, symbols, n.ID, DiagnosticTypedefUnknownBase, "typedef base type is unknown in the current document", &out)
-	})
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r TypedefUnknownBaseRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (TypedefUnknownBaseRule) Kinds() []string {
+	return []string{"typedef_declaration"}
+}
 
-	return out, nil
+// VisitNode checks the base type of one typedef.
+func (TypedefUnknownBaseRule) VisitNode(v *Visit, n *syntax.Node) {
+	if hasErrorFlags(n.Flags) {
+		return
+	}
+	appendDirectTypeDiagnostics(v.Tree, v.localSymbols(), n.ID, DiagnosticTypedefUnknownBase, "typedef base type is unknown in the current document", v.out)
 }
@@ -25,46 +25,54 @@ func (NegativeEnumValueRule) Description() string {
 	return "explicit enum values must not be negative"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (NegativeEnumValueRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (NegativeEnumValueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
+func (r NegativeEnumValueRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r NegativeEnumValueRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (NegativeEnumValueRule) Kinds() []string {
+	return []string{"enum_definition"}
+}
+
+// VisitNode checks the values of one enum.
+func (NegativeEnumValueRule) VisitNode(v *Visit, n *syntax.Node) {
+	tree := v.Tree
+	if hasErrorFlags(n.Flags) {
+		return
 	}
 
-	out := make([]syntax.Diagnostic, 0, 4)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "enum_definition" {
-			return
+	for _, memberID := range tree.MemberNodeIDs(n.ID) {
+		member := tree.NodeByID(memberID)
+		if member == nil || kindName(member.Kind) != "enum_value" {
+			continue
 		}
-		if hasErrorFlags(n.Flags) {
-			return
+		if hasErrorFlags(member.Flags) {
+			continue
 		}
 
-		for _, memberID := range tree.MemberNodeIDs(n.ID) {
-			member := tree.NodeByID(memberID)
-			if member == nil || syntax.KindName(member.Kind) != "enum_value" {
-				continue
-			}
-			if hasErrorFlags(member.Flags) {
-				continue
-			}
-
-			valueSpan := firstChildSpanByKind(tree, member.ID, "int_literal")
-			if !valueSpan.IsValid() {
-				continue
-			}
-			if !strings.HasPrefix(strings.TrimSpace(textForSpan(tree.Source, valueSpan)), "-") {
-				continue
-			}
-
-			out = append(out, newRecoverableWarning(
-				DiagnosticNegativeEnumValue,
-				"explicit enum values must not be negative",
-				valueSpan,
-			))
+		valueSpan := firstChildSpanByKind(tree, member.ID, "int_literal")
+		if !valueSpan.IsValid() {
+			continue
+		}
+		if !strings.HasPrefix(strings.TrimSpace(textForSpan(tree.Source, valueSpan)), "-") {
+			continue
 		}
-	})
 
-	return out, nil
+		v.Report(newRecoverableWarning(
+			DiagnosticNegativeEnumValue,
+			"explicit enum values must not be negative",
+			valueSpan,
+		))
+	}
 }
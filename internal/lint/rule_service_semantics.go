@@ -35,31 +35,42 @@ func (ServiceSemanticsRule) Description() string {
 	return "service declarations must satisfy local oneway, throws, and extends constraints"
 }
 
+// Scope reports that the rule reads one top-level declaration and the local symbol table.
+func (ServiceSemanticsRule) Scope() RuleScope {
+	return ScopeContainer
+}
+
 // Run evaluates the rule against a syntax tree.
-func (ServiceSemanticsRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
-	}
+func (r ServiceSemanticsRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
 
-	symbols := collectLocalSymbols(tree)
-	out := make([]syntax.Diagnostic, 0, 6)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "service_definition" || hasErrorFlags(n.Flags) {
-			return
-		}
-		appendServiceExtendsDiagnostics(tree, symbols, n.ID, &out)
-		for _, memberID := range tree.MemberNodeIDs(n.ID) {
-			member := tree.NodeByID(memberID)
-			if member == nil || syntax.KindName(member.Kind) != "function_definition" || hasErrorFlags(member.Flags) {
-				continue
-			}
-			appendOnewayDiagnostics(tree, member.ID, &out)
-			appendThrowsDiagnostics(tree, symbols, member.ID, &out)
-		}
-	})
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r ServiceSemanticsRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
 
-	return out, nil
+// Kinds lists the node kinds the rule visits.
+func (ServiceSemanticsRule) Kinds() []string {
+	return []string{"service_definition"}
+}
+
+// VisitNode checks one service and its functions.
+func (ServiceSemanticsRule) VisitNode(v *Visit, n *syntax.Node) {
+	if hasErrorFlags(n.Flags) {
+		return
+	}
+	tree := v.Tree
+	symbols := v.localSymbols()
+	appendServiceExtendsDiagnostics(tree, symbols, n.ID, v.out)
+	for _, memberID := range tree.MemberNodeIDs(n.ID) {
+		member := tree.NodeByID(memberID)
+		if member == nil || kindName(member.Kind) != "function_definition" || hasErrorFlags(member.Flags) {
+			continue
+		}
+		appendOnewayDiagnostics(tree, member.ID, v.out)
+		appendThrowsDiagnostics(tree, symbols, member.ID, v.out)
+	}
 }
 
 func appendServiceExtendsDiagnostics(tree *syntax.Tree, symbols localSymbols, serviceID syntax.NodeID, out *[]syntax.Diagnostic) {
@@ -124,7 +135,7 @@ func appendThrowsDiagnostics(tree *syntax.Tree, symbols localSymbols, functionID
 
 	for _, fieldID := range tree.ChildNodeIDs(paramsID) {
 		field := tree.NodeByID(fieldID)
-		if field == nil || syntax.KindName(field.Kind) != "field" || hasErrorFlags(field.Flags) {
+		if field == nil || kindName(field.Kind) != "field" || hasErrorFlags(field.Flags) {
 			continue
 		}
 
@@ -141,7 +152,7 @@ func appendThrowsDiagnostics(tree *syntax.Tree, symbols localSymbols, functionID
 		if typeNode == nil {
 			continue
 		}
-		if syntax.KindName(typeNode.Kind) != "scoped_identifier" {
+		if kindName(typeNode.Kind) != "scoped_identifier" {
 			*out = append(*out, newRecoverableError(
 				DiagnosticServiceThrowsNotException,
 				"`throws` parameters must use exception types",
@@ -25,46 +25,54 @@ func (UnionFieldRequirednessRule) Description() string {
 	return "union fields are implicitly optional and should not be marked required"
 }
 
+// Scope reports that the rule reads one top-level declaration.
+func (UnionFieldRequirednessRule) Scope() RuleScope {
+	return ScopeDeclaration
+}
+
 // Run evaluates the rule against a syntax tree.
-func (UnionFieldRequirednessRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
-	ctx = normalizeContext(ctx)
-	if err := ctx.Err(); err != nil {
-		return nil, err
+func (r UnionFieldRequirednessRule) Run(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+	return runDeclarations(ctx, tree, r)
+}
+
+// RunDeclaration evaluates the rule against one top-level declaration.
+func (r UnionFieldRequirednessRule) RunDeclaration(_ context.Context, decl *Declaration) ([]syntax.Diagnostic, error) {
+	return visitDeclaration(decl, r), nil
+}
+
+// Kinds lists the node kinds the rule visits.
+func (UnionFieldRequirednessRule) Kinds() []string {
+	return []string{"union_definition"}
+}
+
+// VisitNode checks the fields of one union.
+func (UnionFieldRequirednessRule) VisitNode(v *Visit, n *syntax.Node) {
+	tree := v.Tree
+	if hasErrorFlags(n.Flags) {
+		return
 	}
 
-	out := make([]syntax.Diagnostic, 0, 4)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "union_definition" {
-			return
+	for _, memberID := range tree.MemberNodeIDs(n.ID) {
+		member := tree.NodeByID(memberID)
+		if member == nil || kindName(member.Kind) != "field" {
+			continue
 		}
-		if hasErrorFlags(n.Flags) {
-			return
+		if hasErrorFlags(member.Flags) {
+			continue
 		}
 
-		for _, memberID := range tree.MemberNodeIDs(n.ID) {
-			member := tree.NodeByID(memberID)
-			if member == nil || syntax.KindName(member.Kind) != "field" {
-				continue
-			}
-			if hasErrorFlags(member.Flags) {
-				continue
-			}
-
-			requirednessSpan := firstChildSpanByKind(tree, member.ID, "requiredness")
-			if !requirednessSpan.IsValid() {
-				continue
-			}
-			if strings.TrimSpace(textForSpan(tree.Source, requirednessSpan)) != "required" {
-				continue
-			}
-
-			out = append(out, newRecoverableWarning(
-				DiagnosticUnionFieldRequired,
-				"union fields are implicitly optional; explicit `required` should not be used",
-				requirednessSpan,
-			))
+		requirednessSpan := firstChildSpanByKind(tree, member.ID, "requiredness")
+		if !requirednessSpan.IsValid() {
+			continue
+		}
+		if strings.TrimSpace(textForSpan(tree.Source, requirednessSpan)) != "required" {
+			continue
 		}
-	})
 
-	return out, nil
+		v.Report(newRecoverableWarning(
+			DiagnosticUnionFieldRequired,
+			"union fields are implicitly optional; explicit `required` should not be used",
+			requirednessSpan,
+		))
+	}
 }
@@ -35,80 +35,71 @@ func newRecoverableDiagnostic(code syntax.DiagnosticCode, message string, severi
 	}
 }
 
-func duplicateFieldChildSpans(
-	tree *syntax.Tree,
+// reportDuplicateFieldChildren reports the fields of one field list whose
+// normalized childKind values collide. Each list is checked once, when its
+// first error-free field is visited.
+func reportDuplicateFieldChildren(
+	v *Visit,
+	n *syntax.Node,
 	childKind string,
 	normalize func(string) string,
-) [][]itext.Span {
-	if tree == nil || childKind == "" {
-		return nil
-	}
-	if normalize == nil {
-		normalize = func(raw string) string { return raw }
+	code syntax.DiagnosticCode,
+	message string,
+) {
+	siblings := v.fieldLists()[n.Parent]
+	if len(siblings) < 2 || siblings[0] != n.ID {
+		return
 	}
 
-	byParent := make(map[syntax.NodeID]map[string][]itext.Span)
-	forEachNamedNode(tree, func(n *syntax.Node, kind string) {
-		if kind != "field" || hasErrorFlags(n.Flags) {
-			return
-		}
-
-		childSpan := firstChildSpanByKind(tree, n.ID, childKind)
+	byValue := make(map[string][]itext.Span, len(siblings))
+	for _, id := range siblings {
+		childSpan := firstChildSpanByKind(v.Tree, id, childKind)
 		if !childSpan.IsValid() {
-			return
+			continue
 		}
-
-		key := normalize(textForSpan(tree.Source, childSpan))
+		key := normalize(textForSpan(v.Tree.Source, childSpan))
 		if key == "" {
-			return
-		}
-
-		if byParent[n.Parent] == nil {
-			byParent[n.Parent] = make(map[string][]itext.Span)
-		}
-		byParent[n.Parent][key] = append(byParent[n.Parent][key], childSpan)
-	})
-
-	out := make([][]itext.Span, 0, len(byParent))
-	for _, byValue := range byParent {
-		for _, spans := range byValue {
-			if len(spans) < 2 {
-				continue
-			}
-			out = append(out, spans)
+			continue
 		}
+		byValue[key] = append(byValue[key], childSpan)
 	}
-	return out
-}
-
-func duplicateFieldChildDiagnostics(
-	tree *syntax.Tree,
-	childKind string,
-	normalize func(string) string,
-	code syntax.DiagnosticCode,
-	message string,
-) []syntax.Diagnostic {
-	duplicates := duplicateFieldChildSpans(tree, childKind, normalize)
-	out := make([]syntax.Diagnostic, 0, 4)
-	for _, spans := range duplicates {
+	for _, spans := range byValue {
+		if len(spans) < 2 {
+			continue
+		}
 		for _, span := range spans {
-			out = append(out, newRecoverableError(code, message, span))
+			v.Report(newRecoverableError(code, message, span))
 		}
 	}
-	return out
 }
 
-func forEachNamedNode(tree *syntax.Tree, fn func(n *syntax.Node, kind string)) {
+// forEachNamedNodeIn visits the named nodes of the subtree rooted at root.
+func forEachNamedNodeIn(tree *syntax.Tree, root syntax.NodeID, fn func(n *syntax.Node, kind string)) {
 	if tree == nil || fn == nil {
 		return
 	}
-	for i := 1; i < len(tree.Nodes); i++ {
+	end := subtreeEnd(tree, root)
+	for i := int(root); i < end; i++ {
 		n := &tree.Nodes[i]
 		if !n.Flags.Has(syntax.NodeFlagNamed) {
 			continue
 		}
-		fn(n, syntax.KindName(n.Kind))
+		fn(n, kindName(n.Kind))
+	}
+}
+
+// subtreeEnd returns the node index just past the subtree rooted at root.
+// Nodes are stored in pre-order, so the subtree is the run of nodes after
+// root whose parents lie inside it.
+func subtreeEnd(tree *syntax.Tree, root syntax.NodeID) int {
+	if tree == nil || root == syntax.NoNode || int(root) >= len(tree.Nodes) {
+		return int(root)
+	}
+	end := int(root) + 1
+	for end < len(tree.Nodes) && tree.Nodes[end].Parent >= root {
+		end++
 	}
+	return end
 }
 
 func hasErrorFlags(flags syntax.NodeFlags) bool {
@@ -120,7 +111,7 @@ func hasChildByKind(tree *syntax.Tree, parent syntax.NodeID, want string) bool {
 	ids := tree.ChildNodeIDs(parent)
 	for _, id := range ids {
 		child := tree.NodeByID(id)
-		if child == nil || syntax.KindName(child.Kind) != want {
+		if child == nil || kindName(child.Kind) != want {
 			continue
 		}
 		return true
@@ -132,7 +123,7 @@ func firstChildSpanByKind(tree *syntax.Tree, parent syntax.NodeID, want string)
 	ids := tree.ChildNodeIDs(parent)
 	for _, id := range ids {
 		child := tree.NodeByID(id)
-		if child == nil || syntax.KindName(child.Kind) != want {
+		if child == nil || kindName(child.Kind) != want {
 			continue
 		}
 		return child.Span
@@ -143,7 +134,7 @@ func firstChildSpanByKind(tree *syntax.Tree, parent syntax.NodeID, want string)
 func firstChildNodeIDByKind(tree *syntax.Tree, parent syntax.NodeID, want string) (syntax.NodeID, bool) {
 	for _, id := range tree.ChildNodeIDs(parent) {
 		child := tree.NodeByID(id)
-		if child == nil || syntax.KindName(child.Kind) != want {
+		if child == nil || kindName(child.Kind) != want {
 			continue
 		}
 		return id, true
@@ -172,7 +163,7 @@ func unwrapTypeNodeID(tree *syntax.Tree, nodeID syntax.NodeID) (syntax.NodeID, b
 		if n == nil {
 			return syntax.NoNode, false
 		}
-		kind := syntax.KindName(n.Kind)
+		kind := kindName(n.Kind)
 		if kind != "type" && kind != "return_type" {
 			return current, true
 		}
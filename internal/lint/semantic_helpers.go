@@ -22,6 +22,7 @@ const (
 
 type localSymbols struct {
 	decls map[string]localDeclKind
+	names []string // keys of decls in declaration order
 }
 
 func collectLocalSymbols(tree *syntax.Tree) localSymbols {
@@ -36,7 +37,7 @@ func collectLocalSymbols(tree *syntax.Tree) localSymbols {
 			continue
 		}
 
-		kind := localDeclKindForNodeKind(syntax.KindName(n.Kind))
+		kind := localDeclKindForNodeKind(kindName(n.Kind))
 		if kind == localDeclUnknown {
 			continue
 		}
@@ -49,6 +50,7 @@ func collectLocalSymbols(tree *syntax.Tree) localSymbols {
 			continue
 		}
 		symbols.decls[name] = kind
+		symbols.names = append(symbols.names, name)
 	}
 
 	return symbols
@@ -157,7 +159,7 @@ func appendTypeDiagnostics(
 		return
 	}
 
-	switch syntax.KindName(n.Kind) {
+	switch kindName(n.Kind) {
 	case "base_type":
 		return
 	case "scoped_identifier":
@@ -187,7 +189,7 @@ func isTypeNodeKind(tree *syntax.Tree, nodeID syntax.NodeID) bool {
 	if n == nil {
 		return false
 	}
-	switch syntax.KindName(n.Kind) {
+	switch kindName(n.Kind) {
 	case "type", "base_type", "map_type", "list_type", "set_type", "scoped_identifier":
 		return true
 	default:
@@ -200,7 +202,7 @@ func hasNodeKind(tree *syntax.Tree, nodeID syntax.NodeID, want string) bool {
 		return false
 	}
 	n := tree.NodeByID(nodeID)
-	return n != nil && syntax.KindName(n.Kind) == want
+	return n != nil && kindName(n.Kind) == want
 }
 
 func hasAncestorKind(tree *syntax.Tree, nodeID syntax.NodeID, want string) bool {
@@ -209,7 +211,7 @@ func hasAncestorKind(tree *syntax.Tree, nodeID syntax.NodeID, want string) bool
 		if parent == nil {
 			return false
 		}
-		if syntax.KindName(parent.Kind) == want {
+		if kindName(parent.Kind) == want {
 			return true
 		}
 	}
@@ -0,0 +1,203 @@
+package lint
+
+import (
+	"context"
+	"slices"
+	"sync/atomic"
+	"time"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+// NodeRule is a ScopedRule that inspects nodes of selected kinds during one
+// shared pre-order pass over each declaration instead of walking the tree
+// itself. Rules that need the whole tree keep implementing Rule only.
+type NodeRule interface {
+	ScopedRule
+	// Kinds lists the named node kinds the rule visits.
+	Kinds() []string
+	// VisitNode inspects one named node of a subscribed kind.
+	VisitNode(v *Visit, n *syntax.Node)
+}
+
+// Visit is the state of one declaration pass handed to NodeRules.
+type Visit struct {
+	*Declaration
+	out *[]syntax.Diagnostic
+}
+
+// Report records a diagnostic for the visiting rule.
+func (v *Visit) Report(d syntax.Diagnostic) {
+	*v.out = append(*v.out, d)
+}
+
+// visitDeclaration implements RunDeclaration of a NodeRule on its own.
+func visitDeclaration(decl *Declaration, rule NodeRule) []syntax.Diagnostic {
+	kinds := rule.Kinds()
+	var out []syntax.Diagnostic
+	visit := Visit{Declaration: decl, out: &out}
+	forEachNamedNodeIn(decl.Tree, decl.ID, func(n *syntax.Node, kind string) {
+		if slices.Contains(kinds, kind) {
+			rule.VisitNode(&visit, n)
+		}
+	})
+	return out
+}
+
+// maxDispatchKinds bounds the per-kind tables; grammar kind ids stay far
+// below it, and larger ids take the slow path.
+const maxDispatchKinds = 1024
+
+// rulePass dispatches the named nodes of a declaration to the NodeRules
+// subscribed to their kind.
+type rulePass struct {
+	rules  []NodeRule
+	groups [][]int        // rule indexes subscribed to one kind
+	byName map[string]int // kind name to index into groups
+	// dispatch caches byName per kind id: 0 unresolved, 1 no rules, otherwise
+	// 2 plus the group index. Kind ids never change meaning, so concurrent
+	// runs may fill it in any order.
+	dispatch [maxDispatchKinds]atomic.Int32
+}
+
+func newRulePass(rules []NodeRule) *rulePass {
+	p := &rulePass{rules: rules, byName: make(map[string]int)}
+	for i, rule := range rules {
+		for _, kind := range rule.Kinds() {
+			group, ok := p.byName[kind]
+			if !ok {
+				group = len(p.groups)
+				p.byName[kind] = group
+				p.groups = append(p.groups, nil)
+			}
+			p.groups[group] = append(p.groups[group], i)
+		}
+	}
+	return p
+}
+
+// rulesFor returns the indexes of the rules subscribed to kind.
+func (p *rulePass) rulesFor(kind syntax.NodeKind) []int {
+	if int(kind) >= maxDispatchKinds {
+		if group, ok := p.byName[kindName(kind)]; ok {
+			return p.groups[group]
+		}
+		return nil
+	}
+	slot := &p.dispatch[kind]
+	if v := slot.Load(); v != 0 {
+		if v == 1 {
+			return nil
+		}
+		return p.groups[v-2]
+	}
+	name := kindName(kind)
+	group, ok := p.byName[name]
+	switch {
+	case ok:
+		slot.Store(int32(group) + 2)
+		return p.groups[group]
+	case name != "":
+		slot.Store(1)
+	}
+	return nil
+}
+
+// run visits the declaration once and appends the diagnostics of rule i to
+// outs[i]. A nil outs[i] skips the rule. When spent is set, the time spent in
+// rule i is added to spent[i].
+func (p *rulePass) run(decl *Declaration, outs []*[]syntax.Diagnostic, spent []time.Duration) {
+	tree := decl.Tree
+	visit := Visit{Declaration: decl}
+	end := subtreeEnd(tree, decl.ID)
+	for i := int(decl.ID); i < end; i++ {
+		n := &tree.Nodes[i]
+		if !n.Flags.Has(syntax.NodeFlagNamed) {
+			continue
+		}
+		for _, r := range p.rulesFor(n.Kind) {
+			if outs[r] == nil {
+				continue
+			}
+			visit.out = outs[r]
+			if spent == nil {
+				p.rules[r].VisitNode(&visit, n)
+				continue
+			}
+			start := time.Now()
+			p.rules[r].VisitNode(&visit, n)
+			spent[r] += time.Since(start)
+		}
+	}
+}
+
+// minDeclarationsPerChunk keeps chunks of a parallel run large enough that
+// scheduling stays cheap next to the pass itself.
+const minDeclarationsPerChunk = 128
+
+// chunks splits top-level declarations into contiguous runs, one per worker
+// at most, for a parallel pass. Small documents stay in one chunk.
+func (p *rulePass) chunks(decls []syntax.NodeID, workers int) [][]syntax.NodeID {
+	if len(p.rules) == 0 {
+		return nil
+	}
+	n := min(workers, len(decls)/minDeclarationsPerChunk)
+	if n <= 1 {
+		return [][]syntax.NodeID{decls}
+	}
+	out := make([][]syntax.NodeID, 0, n)
+	size := (len(decls) + n - 1) / n
+	for start := 0; start < len(decls); start += size {
+		out = append(out, decls[start:min(start+size, len(decls))])
+	}
+	return out
+}
+
+// runDeclarations lints the given top-level declarations in one shared pass.
+// When spent is set, the time spent in rule i is added to spent[i].
+func (p *rulePass) runDeclarations(ctx context.Context, facts *documentFacts, ids []syntax.NodeID, spent []time.Duration) ([]syntax.Diagnostic, error) {
+	out := make([]syntax.Diagnostic, 0, 8)
+	outs := make([]*[]syntax.Diagnostic, len(p.rules))
+	for i := range outs {
+		outs[i] = &out
+	}
+	for _, id := range ids {
+		if err := ctx.Err(); err != nil {
+			return nil, err
+		}
+		p.run(&Declaration{Tree: facts.tree, ID: id, facts: facts}, outs, spent)
+	}
+	return out, nil
+}
+
+// splitNodeRules separates rules that join the shared pass from the rest,
+// which keep running on their own.
+func splitNodeRules(rules []Rule) ([]NodeRule, []Rule) {
+	var nodeRules []NodeRule
+	var others []Rule
+	for _, rule := range rules {
+		if nr, ok := rule.(NodeRule); ok {
+			nodeRules = append(nodeRules, nr)
+			continue
+		}
+		others = append(others, rule)
+	}
+	return nodeRules, others
+}
+
+// kindNames memoizes syntax.KindName, which takes a lock per call.
+var kindNames [maxDispatchKinds]atomic.Pointer[string]
+
+func kindName(kind syntax.NodeKind) string {
+	if int(kind) >= maxDispatchKinds {
+		return syntax.KindName(kind)
+	}
+	if name := kindNames[kind].Load(); name != nil {
+		return *name
+	}
+	name := syntax.KindName(kind)
+	if name != "" {
+		kindNames[kind].Store(&name)
+	}
+	return name
+}
@@ -0,0 +1,40 @@
+package lsp
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"testing"
+
+	"github.com/kpumuk/thrift-weaver/internal/syntax"
+)
+
+func BenchmarkSelectionRangeLargeDocument(b *testing.B) {
+	var buf bytes.Buffer
+	for s := range 400 {
+		fmt.Fprintf(&buf, "struct Large%03d {\n", s)
+		for f := range 24 {
+			fmt.Fprintf(&buf, "  %d: optional map<string, list<i64>> field_%02d = {},\n", f+1, f)
+		}
+		buf.WriteString("}\n\n")
+	}
+	tree, err := syntax.Parse(context.Background(), buf.Bytes(), syntax.ParseOptions{URI: "file:///large.thrift"})
+	if err != nil {
+		b.Fatalf("Parse: %v", err)
+	}
+	defer tree.Close()
+
+	positions := make([]Position, 0, 64)
+	for i := range cap(positions) {
+		field := (i * 7919) % (400 * 24)
+		positions = append(positions, Position{Line: field/24*27 + 1 + field%24, Character: 4 + i%30})
+	}
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for b.Loop() {
+		if _, err := lspSelectionRangesFromSyntax(tree, positions); err != nil {
+			b.Fatalf("selection ranges: %v", err)
+		}
+	}
+}
@@ -510,26 +510,7 @@ func selectionRangeForOffset(tree *syntax.Tree, li *itext.LineIndex, off itext.B
 }
 
 func namedNodeAncestorChainAtOffset(tree *syntax.Tree, off itext.ByteOffset) []syntax.NodeID {
-	best := syntax.NoNode
-	bestLen := -1
-	bestDepth := -1
-
-	for i := 1; i < len(tree.Nodes); i++ {
-		n := &tree.Nodes[i]
-		if !n.Flags.Has(syntax.NodeFlagNamed) {
-			continue
-		}
-		if !spanContainsOffset(n.Span, off) {
-			continue
-		}
-		spanLen := int(n.Span.Len())
-		depth := nodeDepth(tree, n.ID)
-		if best == syntax.NoNode || spanLen < bestLen || (spanLen == bestLen && depth > bestDepth) {
-			best = n.ID
-			bestLen = spanLen
-			bestDepth = depth
-		}
-	}
+	best := tree.NodeAt(off)
 	if best == syntax.NoNode {
 		return nil
 	}
@@ -554,26 +535,3 @@ func namedNodeAncestorChainAtOffset(tree *syntax.Tree, off itext.ByteOffset) []s
 	}
 	return out
 }
-
-func nodeDepth(tree *syntax.Tree, id syntax.NodeID) int {
-	depth := 0
-	for cur := id; cur != syntax.NoNode; {
-		n := tree.NodeByID(cur)
-		if n == nil {
-			break
-		}
-		depth++
-		cur = n.Parent
-	}
-	return depth
-}
-
-func spanContainsOffset(sp itext.Span, off itext.ByteOffset) bool {
-	if !sp.IsValid() {
-		return false
-	}
-	if sp.IsEmpty() {
-		return sp.Start == off
-	}
-	return sp.Contains(off)
-}
@@ -0,0 +1,301 @@
+package lsp
+
+import (
+	"container/heap"
+	"context"
+	"runtime"
+	"sync"
+	"time"
+)
+
+// lintPriority orders due lint jobs; focused jobs start before background ones.
+type lintPriority uint8
+
+const (
+	// lintPriorityFocused covers the document the user is editing.
+	lintPriorityFocused lintPriority = iota
+	// lintPriorityBackground covers reverse dependencies and workspace-wide refreshes.
+	lintPriorityBackground
+)
+
+// lintTaskKey identifies the single pending job slot of a document per lint kind.
+type lintTaskKey struct {
+	uri       string
+	workspace bool
+}
+
+type lintTask struct {
+	key      lintTaskKey
+	priority lintPriority
+	due      time.Time
+	ctx      context.Context
+	run      func(context.Context)
+	done     func()
+	stop     func() bool
+	index    int // position in the waiting or ready heap, -1 once removed
+	ready    bool
+}
+
+// lintDocStats is the adaptive state of one document.
+type lintDocStats struct {
+	lastChange time.Time
+	cadence    time.Duration // smoothed interval between edits while typing
+	cost       [2]time.Duration
+}
+
+// lintScheduler runs debounced lint jobs from one timer and a bounded set of
+// workers. Scheduling a document again replaces its pending job; jobs whose
+// context ends leave the queue immediately.
+type lintScheduler struct {
+	mu              sync.Mutex
+	waiting         lintTaskHeap
+	ready           lintTaskHeap
+	pending         map[lintTaskKey]*lintTask
+	stats           map[string]*lintDocStats
+	timer           *time.Timer
+	running         int
+	runningBg       int
+	limit           int
+	backgroundLimit int
+}
+
+func newLintScheduler() *lintScheduler {
+	limit := max(2, runtime.GOMAXPROCS(0))
+	return &lintScheduler{
+		waiting:         lintTaskHeap{byPriority: false},
+		ready:           lintTaskHeap{byPriority: true},
+		pending:         make(map[lintTaskKey]*lintTask),
+		stats:           make(map[string]*lintDocStats),
+		limit:           limit,
+		backgroundLimit: max(1, limit/2),
+	}
+}
+
+// observeChange records an edit of uri for typing-cadence tracking.
+func (s *lintScheduler) observeChange(uri string, now time.Time, base time.Duration) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	st := s.statsLocked(uri)
+	if !st.lastChange.IsZero() {
+		interval := now.Sub(st.lastChange)
+		switch {
+		case interval > 4*base:
+			st.cadence = 0
+		case st.cadence == 0:
+			st.cadence = interval
+		default:
+			st.cadence += (interval - st.cadence) / 4
+		}
+	}
+	st.lastChange = now
+}
+
+// forget drops the adaptive state of a closed document.
+func (s *lintScheduler) forget(uri string) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	delete(s.stats, uri)
+}
+
+// debounceLocked picks the quiet period before a job runs. Focused jobs wait
+// between base/4 and base, background jobs between base and 4·base. Until a
+// document has a measured lint cost the wait is base. Afterwards it covers
+// twice the cost and, while the user types faster than the upper bound,
+// stretches just past the typing interval so a burst collapses into one run.
+func (s *lintScheduler) debounceLocked(key lintTaskKey, priority lintPriority, base time.Duration) time.Duration {
+	lo, hi := base/4, base
+	if priority == lintPriorityBackground {
+		lo, hi = base, 4*base
+	}
+	st := s.stats[key.uri]
+	if st == nil || st.cost[lintCostSlot(key)] == 0 {
+		return base
+	}
+	d := 2 * st.cost[lintCostSlot(key)]
+	if st.cadence > 0 && st.cadence < hi {
+		d = max(d, st.cadence+st.cadence/4)
+	}
+	return min(max(d, lo), hi)
+}
+
+// schedule queues run for key, replacing any pending job for the same key.
+// done runs exactly once, after run returns or when the job is dropped.
+func (s *lintScheduler) schedule(ctx context.Context, key lintTaskKey, priority lintPriority, base time.Duration, run func(context.Context), done func()) {
+	task := &lintTask{key: key, priority: priority, ctx: ctx, run: run, done: done, index: -1}
+
+	s.mu.Lock()
+	var replaced *lintTask
+	if old := s.pending[key]; old != nil && s.removeLocked(old) {
+		replaced = old
+	}
+	task.due = time.Now().Add(s.debounceLocked(key, priority, base))
+	s.pending[key] = task
+	heap.Push(&s.waiting, task)
+	// The callback takes s.mu, so it cannot observe the task before stop is set.
+	task.stop = context.AfterFunc(ctx, func() {
+		s.mu.Lock()
+		removed := s.pending[key] == task && s.removeLocked(task)
+		s.mu.Unlock()
+		if removed {
+			task.finish()
+		}
+	})
+	s.armLocked()
+	s.mu.Unlock()
+
+	if replaced != nil {
+		replaced.finish()
+	}
+}
+
+func (s *lintScheduler) statsLocked(uri string) *lintDocStats {
+	st := s.stats[uri]
+	if st == nil {
+		st = &lintDocStats{}
+		s.stats[uri] = st
+	}
+	return st
+}
+
+// removeLocked takes a queued task out of the scheduler.
+func (s *lintScheduler) removeLocked(task *lintTask) bool {
+	if task.index < 0 {
+		return false
+	}
+	if task.ready {
+		heap.Remove(&s.ready, task.index)
+	} else {
+		heap.Remove(&s.waiting, task.index)
+	}
+	if s.pending[task.key] == task {
+		delete(s.pending, task.key)
+	}
+	return true
+}
+
+// armLocked points the single timer at the earliest waiting job.
+func (s *lintScheduler) armLocked() {
+	if len(s.waiting.tasks) == 0 {
+		return
+	}
+	wait := max(time.Until(s.waiting.tasks[0].due), 0)
+	if s.timer == nil {
+		s.timer = time.AfterFunc(wait, s.fire)
+		return
+	}
+	s.timer.Reset(wait)
+}
+
+func (s *lintScheduler) fire() {
+	s.mu.Lock()
+	now := time.Now()
+	for len(s.waiting.tasks) > 0 && !s.waiting.tasks[0].due.After(now) {
+		task := heap.Pop(&s.waiting).(*lintTask)
+		task.ready = true
+		heap.Push(&s.ready, task)
+	}
+	s.armLocked()
+	s.startReadyLocked()
+	s.mu.Unlock()
+}
+
+// startReadyLocked starts ready jobs in priority order while worker slots
+// remain. Background jobs may use only part of the slots so a fan-out over
+// reverse dependencies cannot hold back the focused document.
+func (s *lintScheduler) startReadyLocked() {
+	for len(s.ready.tasks) > 0 && s.running < s.limit {
+		task := s.ready.tasks[0]
+		background := task.priority == lintPriorityBackground
+		if background && s.runningBg >= s.backgroundLimit {
+			return
+		}
+		heap.Pop(&s.ready)
+		delete(s.pending, task.key)
+		s.running++
+		if background {
+			s.runningBg++
+		}
+		go s.execute(task)
+	}
+}
+
+func (s *lintScheduler) execute(task *lintTask) {
+	start := time.Now()
+	if task.ctx.Err() == nil {
+		task.run(task.ctx)
+	}
+	elapsed := time.Since(start)
+
+	s.mu.Lock()
+	// Stats are created when a document is opened or edited; a job that
+	// ends after its document closed must not bring them back.
+	if st := s.stats[task.key.uri]; st != nil && task.ctx.Err() == nil {
+		slot := lintCostSlot(task.key)
+		if st.cost[slot] == 0 {
+			st.cost[slot] = elapsed
+		} else {
+			st.cost[slot] += (elapsed - st.cost[slot]) / 4
+		}
+	}
+	s.running--
+	if task.priority == lintPriorityBackground {
+		s.runningBg--
+	}
+	s.startReadyLocked()
+	s.mu.Unlock()
+
+	task.finish()
+}
+
+func (t *lintTask) finish() {
+	if t.stop != nil {
+		t.stop()
+	}
+	if t.done != nil {
+		t.done()
+	}
+}
+
+func lintCostSlot(key lintTaskKey) int {
+	if key.workspace {
+		return 1
+	}
+	return 0
+}
+
+// lintTaskHeap orders tasks by due time, or by priority then due time.
+type lintTaskHeap struct {
+	tasks      []*lintTask
+	byPriority bool
+}
+
+func (h lintTaskHeap) Len() int { return len(h.tasks) }
+
+func (h lintTaskHeap) Less(i, j int) bool {
+	a, b := h.tasks[i], h.tasks[j]
+	if h.byPriority && a.priority != b.priority {
+		return a.priority < b.priority
+	}
+	return a.due.Before(b.due)
+}
+
+func (h lintTaskHeap) Swap(i, j int) {
+	h.tasks[i], h.tasks[j] = h.tasks[j], h.tasks[i]
+	h.tasks[i].index = i
+	h.tasks[j].index = j
+}
+
+func (h *lintTaskHeap) Push(x any) {
+	task := x.(*lintTask)
+	task.index = len(h.tasks)
+	h.tasks = append(h.tasks, task)
+}
+
+func (h *lintTaskHeap) Pop() any {
+	last := len(h.tasks) - 1
+	task := h.tasks[last]
+	h.tasks[last] = nil
+	h.tasks = h.tasks[:last]
+	task.index = -1
+	return task
+}
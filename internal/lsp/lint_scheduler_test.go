@@ -0,0 +1,161 @@
+package lsp
+
+import (
+	"context"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+func TestLintSchedulerAdaptsDebounceToCostAndCadence(t *testing.T) {
+	t.Parallel()
+
+	s := newLintScheduler()
+	base := 200 * time.Millisecond
+	local := lintTaskKey{uri: "file:///a.thrift"}
+	workspace := lintTaskKey{uri: "file:///a.thrift", workspace: true}
+
+	if got := s.debounceLocked(local, lintPriorityFocused, base); got != base {
+		t.Fatalf("unmeasured focused debounce = %v, want %v", got, base)
+	}
+
+	s.statsLocked(local.uri).cost = [2]time.Duration{2 * time.Millisecond, 2 * time.Millisecond}
+	if got := s.debounceLocked(local, lintPriorityFocused, base); got != base/4 {
+		t.Fatalf("cheap focused debounce = %v, want %v", got, base/4)
+	}
+	if got := s.debounceLocked(workspace, lintPriorityBackground, base); got != base {
+		t.Fatalf("cheap background debounce = %v, want %v", got, base)
+	}
+
+	now := time.Now()
+	for i := range 5 {
+		s.observeChange(local.uri, now.Add(time.Duration(i)*100*time.Millisecond), base)
+	}
+	if got := s.debounceLocked(local, lintPriorityFocused, base); got != 125*time.Millisecond {
+		t.Fatalf("typing focused debounce = %v, want 125ms", got)
+	}
+
+	s.observeChange(local.uri, now.Add(5*time.Second), base)
+	s.statsLocked(local.uri).cost[0] = time.Second
+	if got := s.debounceLocked(local, lintPriorityFocused, base); got != base {
+		t.Fatalf("expensive focused debounce = %v, want cap %v", got, base)
+	}
+}
+
+func TestLintSchedulerDoesNotKeepStatsOfClosedDocuments(t *testing.T) {
+	t.Parallel()
+
+	s := newLintScheduler()
+	key := lintTaskKey{uri: "file:///a.thrift"}
+	s.observeChange(key.uri, time.Now(), time.Millisecond)
+	finished := make(chan struct{})
+	s.schedule(t.Context(), key, lintPriorityFocused, time.Millisecond, func(context.Context) {
+		s.forget(key.uri)
+	}, func() { close(finished) })
+	select {
+	case <-finished:
+	case <-time.After(5 * time.Second):
+		t.Fatal("lint job did not finish")
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if st := s.stats[key.uri]; st != nil {
+		t.Fatalf("stats of closed document = %+v, want none", st)
+	}
+}
+
+func TestLintSchedulerReplacesPendingJobPerURI(t *testing.T) {
+	t.Parallel()
+
+	s := newLintScheduler()
+	key := lintTaskKey{uri: "file:///a.thrift"}
+	var runs, dones atomic.Int32
+	finished := make(chan struct{}, 3)
+	job := func(last bool) func(context.Context) {
+		return func(context.Context) {
+			if !last {
+				t.Error("replaced job ran")
+			}
+			runs.Add(1)
+		}
+	}
+	for i := range 3 {
+		s.schedule(t.Context(), key, lintPriorityFocused, 20*time.Millisecond, job(i == 2), func() {
+			dones.Add(1)
+			finished <- struct{}{}
+		})
+	}
+	for range 3 {
+		select {
+		case <-finished:
+		case <-time.After(5 * time.Second):
+			t.Fatal("lint jobs did not finish")
+		}
+	}
+	if runs.Load() != 1 || dones.Load() != 3 {
+		t.Fatalf("runs=%d dones=%d, want 1 and 3", runs.Load(), dones.Load())
+	}
+}
+
+func TestLintSchedulerPrioritizesFocusedJobsOverBackgroundFanOut(t *testing.T) {
+	t.Parallel()
+
+	s := newLintScheduler()
+	s.limit, s.backgroundLimit = 2, 1
+
+	release := make(chan struct{})
+	var background, peak atomic.Int32
+	done := make(chan struct{}, 5)
+	for _, uri := range []string{"file:///b1.thrift", "file:///b2.thrift", "file:///b3.thrift", "file:///b4.thrift"} {
+		s.schedule(t.Context(), lintTaskKey{uri: uri, workspace: true}, lintPriorityBackground, 0, func(context.Context) {
+			n := background.Add(1)
+			if n > peak.Load() {
+				peak.Store(n)
+			}
+			<-release
+			background.Add(-1)
+		}, func() { done <- struct{}{} })
+	}
+
+	focused := make(chan struct{})
+	s.schedule(t.Context(), lintTaskKey{uri: "file:///active.thrift"}, lintPriorityFocused, 0, func(context.Context) {
+		close(focused)
+	}, func() { done <- struct{}{} })
+
+	select {
+	case <-focused:
+	case <-time.After(5 * time.Second):
+		t.Fatal("focused job waited behind the background fan-out")
+	}
+	close(release)
+	for range 5 {
+		<-done
+	}
+	if peak.Load() != 1 {
+		t.Fatalf("background concurrency peaked at %d, want 1", peak.Load())
+	}
+}
+
+func TestLintSchedulerDropsCanceledJobs(t *testing.T) {
+	t.Parallel()
+
+	s := newLintScheduler()
+	ctx, cancel := context.WithCancel(t.Context())
+	done := make(chan struct{})
+	s.schedule(ctx, lintTaskKey{uri: "file:///a.thrift"}, lintPriorityFocused, time.Hour, func(context.Context) {
+		t.Error("canceled job ran")
+	}, func() { close(done) })
+	cancel()
+
+	select {
+	case <-done:
+	case <-time.After(5 * time.Second):
+		t.Fatal("canceled job was not released")
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if len(s.pending) != 0 || len(s.waiting.tasks) != 0 {
+		t.Fatalf("pending=%d waiting=%d after cancel", len(s.pending), len(s.waiting.tasks))
+	}
+}
@@ -71,11 +71,12 @@ func TestLSPScenarioInitializeOpenChangeFormat(t *testing.T) {
 	if len(edits) == 0 {
 		t.Fatal("expected formatting edits")
 	}
-	if !strings.Contains(edits[0].NewText, "struct Scenario {") {
-		t.Fatalf("formatted output missing struct declaration: %q", edits[0].NewText)
+	formatted := string(applyWorkspaceTextEdits(t, []byte(changed), edits))
+	if !strings.Contains(formatted, "struct Scenario {") {
+		t.Fatalf("formatted output missing struct declaration: %q", formatted)
 	}
-	if !strings.Contains(edits[0].NewText, "optional string value,") {
-		t.Fatalf("formatted output missing normalized field separator: %q", edits[0].NewText)
+	if !strings.Contains(formatted, "optional string value,") {
+		t.Fatalf("formatted output missing normalized field separator: %q", formatted)
 	}
 }
 
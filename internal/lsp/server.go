@@ -1,7 +1,6 @@
 package lsp
 
 import (
-	"bufio"
 	"context"
 	"encoding/json"
 	"errors"
@@ -27,23 +26,27 @@ type Server struct {
 	lint  *lint.Runner
 
 	workspaceIndexWorkers int
+	watchWorkspaceFiles   bool
 
 	mu            sync.Mutex
 	shutdown      bool
 	exitRequested bool
-	output        io.Writer
+	output        *frameWriter
 	runCtx        context.Context
 
-	writeMu sync.Mutex
-
 	reqMu            sync.Mutex
 	requestCancels   map[string]context.CancelFunc
 	pendingCancelled map[string]struct{}
 
-	lintMu       sync.Mutex
-	lintDebounce time.Duration
-	lintJobs     map[string]lintJobState
-	lintWG       sync.WaitGroup
+	lintMu        sync.Mutex
+	lintDebounce  time.Duration
+	lintJobs      map[string]lintJobState
+	lintCaches    map[string]*lint.Incremental
+	lintWG        sync.WaitGroup
+	lintScheduler *lintScheduler
+
+	formatMu     sync.Mutex
+	formatCaches map[string]*fmtengine.Incremental
 
 	workspaceMu               sync.Mutex
 	workspace                 *index.Manager
@@ -94,6 +97,9 @@ const defaultLintDebounce = 150 * time.Millisecond
 // Options configures process-wide LSP server behavior.
 type Options struct {
 	WorkspaceIndexWorkers int
+	// WatchWorkspaceFiles enables the native workspace file watcher where
+	// the platform supports it, in addition to client watcher notifications.
+	WatchWorkspaceFiles bool
 }
 
 // NewServer creates a new LSP server instance.
@@ -105,12 +111,16 @@ func NewServer() *Server {
 func NewServerWithOptions(opts Options) *Server {
 	return &Server{
 		store:                 NewSnapshotStore(),
-		lint:                  lint.NewDefaultRunner(),
+		lint:                  lint.NewDefaultRunner().WithPool(lint.NewPool(0)),
 		workspaceIndexWorkers: opts.WorkspaceIndexWorkers,
+		watchWorkspaceFiles:   opts.WatchWorkspaceFiles,
 		requestCancels:        make(map[string]context.CancelFunc),
 		pendingCancelled:      make(map[string]struct{}),
 		lintDebounce:          defaultLintDebounce,
 		lintJobs:              make(map[string]lintJobState),
+		lintCaches:            make(map[string]*lint.Incremental),
+		formatCaches:          make(map[string]*fmtengine.Incremental),
+		lintScheduler:         newLintScheduler(),
 		workspaceLintJobs:     make(map[string]lintJobState),
 		diagnostics:           make(map[string]documentDiagnostics),
 	}
@@ -144,13 +154,14 @@ func (s *Server) Run(ctx context.Context, in io.Reader, out io.Writer) error {
 		s.detachRuntime()
 	}()
 
-	br := bufio.NewReader(in)
+	fr := newFrameReader(in)
+	defer fr.release()
 
 	for {
 		if err := runCtx.Err(); err != nil {
 			return err
 		}
-		body, err := readFramedMessage(br)
+		body, err := fr.next()
 		if err != nil {
 			if errors.Is(err, io.EOF) {
 				return nil
@@ -162,8 +173,8 @@ func (s *Server) Run(ctx context.Context, in io.Reader, out io.Writer) error {
 			continue
 		}
 
-		var req Request
-		if err := json.Unmarshal(body, &req); err != nil {
+		req, err := decodeRequest(body)
+		if err != nil {
 			_ = s.writeErrorResponse(nil, jsonRPCParseError, err.Error())
 			continue
 		}
@@ -517,6 +528,13 @@ func (s *Server) DidClose(ctx context.Context, p DidCloseParams) error {
 		return err
 	}
 	store.Close(uri)
+	s.lintScheduler.forget(uri)
+	s.lintMu.Lock()
+	delete(s.lintCaches, uri)
+	s.lintMu.Unlock()
+	s.formatMu.Lock()
+	delete(s.formatCaches, uri)
+	s.formatMu.Unlock()
 	if manager := s.workspaceManager(); manager != nil {
 		if err := manager.CloseOpenDocumentWithReason(ctx, uri, index.RebuildReasonClose); err != nil {
 			return err
@@ -559,11 +577,15 @@ func (s *Server) DidChangeWatchedFiles(ctx context.Context, p DidChangeWatchedFi
 		return nil
 	}
 
+	changes := make([]index.DocumentChange, 0, len(p.Changes))
 	for _, change := range p.Changes {
-		deleted := change.Type == FileChangeTypeDeleted
-		if err := manager.RefreshDocumentWithReason(ctx, change.URI, deleted, index.RebuildReasonWatch); err != nil {
-			return err
-		}
+		changes = append(changes, index.DocumentChange{
+			URI:     change.URI,
+			Deleted: change.Type == FileChangeTypeDeleted,
+		})
+	}
+	if err := manager.RefreshDocumentsWithReason(ctx, changes, index.RebuildReasonWatch); err != nil {
+		return err
 	}
 	s.scheduleWorkspaceLintPublishForAllOpenDocuments()
 	return nil
@@ -575,21 +597,23 @@ func (s *Server) Formatting(ctx context.Context, p DocumentFormattingParams) ([]
 	if err != nil {
 		return nil, err
 	}
-	res, err := fmtengine.Document(ctx, snap.Tree, formattingOptionsFromLSP(p.Options))
+	res, err := s.documentFormatter(snap.URI).DocumentEdits(ctx, snap.Tree, formattingOptionsFromLSP(p.Options))
 	if err != nil {
 		return nil, err
 	}
-	if !res.Changed {
-		return []TextEdit{}, nil
-	}
-	fullRange, err := fullDocumentRange(snap.Tree.LineIndex)
-	if err != nil {
-		return nil, err
+	return lspTextEditsFromByteEdits(snap.Tree.LineIndex, res.Edits)
+}
+
+// documentFormatter returns the incremental formatter of an open document.
+func (s *Server) documentFormatter(uri string) *fmtengine.Incremental {
+	s.formatMu.Lock()
+	defer s.formatMu.Unlock()
+	f := s.formatCaches[uri]
+	if f == nil {
+		f = fmtengine.NewIncremental()
+		s.formatCaches[uri] = f
 	}
-	return []TextEdit{{
-		Range:   fullRange,
-		NewText: string(res.Output),
-	}}, nil
+	return f
 }
 
 // RangeFormatting handles textDocument/rangeFormatting.
@@ -680,6 +704,13 @@ func (s *Server) configureWorkspaceManager(ctx context.Context, roots []string)
 	if err := manager.RefreshOpenDocumentClosureWithReason(ctx, index.RebuildReasonManualRescan); err != nil {
 		return err
 	}
+	if s.watchWorkspaceFiles {
+		// Client watcher notifications keep working when the native watcher
+		// is unsupported or the inotify watch limit is exhausted.
+		_ = manager.StartWatcher(index.WatchOptions{
+			OnRefresh: s.scheduleWorkspaceLintPublishForAllOpenDocuments,
+		})
+	}
 
 	s.workspaceMu.Lock()
 	old := s.workspace
@@ -932,7 +963,7 @@ func (s *Server) publishDiagnosticsForURI(ctx context.Context, uri string) error
 	if err != nil {
 		return err
 	}
-	localSyntaxDiags, err := s.collectLocalLintDiagnostics(ctx, snap.Tree)
+	localSyntaxDiags, err := s.collectLocalLintDiagnostics(ctx, snap.URI, snap.Tree)
 	if err != nil && !errors.Is(err, context.Canceled) {
 		localSyntaxDiags = nil
 	}
@@ -970,7 +1001,7 @@ func (s *Server) publishSyntaxDiagnosticsForURI(uri string) error {
 	)
 }
 
-func (s *Server) collectLocalLintDiagnostics(ctx context.Context, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
+func (s *Server) collectLocalLintDiagnostics(ctx context.Context, uri string, tree *syntax.Tree) ([]syntax.Diagnostic, error) {
 	if tree == nil {
 		return nil, errors.New("nil syntax tree")
 	}
@@ -978,7 +1009,15 @@ func (s *Server) collectLocalLintDiagnostics(ctx context.Context, tree *syntax.T
 		return []syntax.Diagnostic{}, nil
 	}
 
-	lintDiags, err := s.lint.Run(ctx, tree)
+	s.lintMu.Lock()
+	linter := s.lintCaches[uri]
+	if linter == nil {
+		linter = lint.NewIncremental(s.lint)
+		s.lintCaches[uri] = linter
+	}
+	s.lintMu.Unlock()
+
+	lintDiags, err := linter.Run(ctx, tree)
 	if err != nil {
 		return nil, err
 	}
@@ -1197,16 +1236,13 @@ func (s *Server) writeMessage(body []byte) error {
 	if out == nil {
 		return errors.New("lsp output is not attached")
 	}
-
-	s.writeMu.Lock()
-	defer s.writeMu.Unlock()
-	return writeFramedMessage(out, body)
+	return out.write(body)
 }
 
 func (s *Server) attachRuntime(ctx context.Context, out io.Writer) {
 	s.mu.Lock()
 	s.runCtx = ctx
-	s.output = out
+	s.output = newFrameWriter(out)
 	s.mu.Unlock()
 
 	s.workspaceLintMu.Lock()
@@ -1259,24 +1295,16 @@ func (s *Server) scheduleLintPublishForURI(uri string) {
 	s.lintWG.Add(1)
 	s.lintMu.Unlock()
 
-	go func() {
-		defer s.lintWG.Done()
-		defer s.finishLintJob(canonicalURI, version, generation)
-
-		timer := time.NewTimer(debounce)
-		defer timer.Stop()
-
-		select {
-		case <-ctx.Done():
-			return
-		case <-timer.C:
-		}
-
+	s.lintScheduler.observeChange(canonicalURI, time.Now(), debounce)
+	s.lintScheduler.schedule(ctx, lintTaskKey{uri: canonicalURI}, lintPriorityFocused, debounce, func(ctx context.Context) {
 		if !s.isLintJobCurrent(canonicalURI, version, generation) {
 			return
 		}
 		_ = s.publishDebouncedLintDiagnostics(ctx, canonicalURI, version, generation)
-	}()
+	}, func() {
+		s.finishLintJob(canonicalURI, version, generation)
+		s.lintWG.Done()
+	})
 }
 
 func (s *Server) publishDebouncedLintDiagnostics(ctx context.Context, uri string, version int32, generation uint64) error {
@@ -1288,7 +1316,7 @@ func (s *Server) publishDebouncedLintDiagnostics(ctx context.Context, uri string
 		return nil
 	}
 
-	localSyntaxDiags, err := s.collectLocalLintDiagnostics(ctx, snap.Tree)
+	localSyntaxDiags, err := s.collectLocalLintDiagnostics(ctx, snap.URI, snap.Tree)
 	if err != nil {
 		if errors.Is(err, context.Canceled) {
 			return err
@@ -1332,6 +1360,10 @@ func (s *Server) invalidateLintJob(uri string) {
 }
 
 func (s *Server) scheduleWorkspaceLintPublishForURI(uri string) {
+	s.scheduleWorkspaceLintPublish(uri, lintPriorityFocused)
+}
+
+func (s *Server) scheduleWorkspaceLintPublish(uri string, priority lintPriority) {
 	if s == nil || s.lint == nil || uri == "" {
 		return
 	}
@@ -1364,28 +1396,22 @@ func (s *Server) scheduleWorkspaceLintPublishForURI(uri string) {
 		state.cancel()
 	}
 	s.workspaceLintJobs[canonicalURI] = lintJobState{version: version, generation: generation, cancel: cancel}
-	debounce := s.lintDebounce
 	s.workspaceLintWG.Add(1)
 	s.workspaceLintMu.Unlock()
 
-	go func() {
-		defer s.workspaceLintWG.Done()
-		defer s.finishWorkspaceLintJob(canonicalURI, version, generation)
-
-		timer := time.NewTimer(debounce)
-		defer timer.Stop()
-
-		select {
-		case <-ctx.Done():
-			return
-		case <-timer.C:
-		}
+	s.lintMu.Lock()
+	debounce := s.lintDebounce
+	s.lintMu.Unlock()
 
+	s.lintScheduler.schedule(ctx, lintTaskKey{uri: canonicalURI, workspace: true}, priority, debounce, func(ctx context.Context) {
 		if !s.isWorkspaceLintJobCurrent(canonicalURI, version, generation) {
 			return
 		}
 		_ = s.publishWorkspaceLintDiagnostics(ctx, canonicalURI, version, generation)
-	}()
+	}, func() {
+		s.finishWorkspaceLintJob(canonicalURI, version, generation)
+		s.workspaceLintWG.Done()
+	})
 }
 
 func (s *Server) scheduleWorkspaceLintPublishForImpactedURI(uri string) {
@@ -1424,7 +1450,7 @@ func (s *Server) scheduleWorkspaceLintPublishForImpactedURI(uri string) {
 		if snap.URI == uri {
 			continue
 		}
-		s.scheduleWorkspaceLintPublishForURI(snap.URI)
+		s.scheduleWorkspaceLintPublish(snap.URI, lintPriorityBackground)
 	}
 }
 
@@ -1434,7 +1460,7 @@ func (s *Server) scheduleWorkspaceLintPublishForAllOpenDocuments() {
 		return
 	}
 	for _, snap := range store.Snapshots() {
-		s.scheduleWorkspaceLintPublishForURI(snap.URI)
+		s.scheduleWorkspaceLintPublish(snap.URI, lintPriorityBackground)
 	}
 }
 
@@ -1553,7 +1579,8 @@ func workspaceDocumentInput(snap *Snapshot) index.DocumentInput {
 		URI:        snap.URI,
 		Version:    snap.Version,
 		Generation: snap.Generation,
-		Source:     snap.Bytes(),
+		Source:     snap.Tree.Source,
+		Content:    snap.Content(),
 	}
 }
 
@@ -1734,20 +1761,6 @@ func formattingOptionsFromLSP(in FormattingOptions) fmtengine.Options {
 	return opts
 }
 
-func fullDocumentRange(li *itext.LineIndex) (Range, error) {
-	if li == nil {
-		return Range{}, errors.New("nil line index")
-	}
-	end, err := li.OffsetToUTF16Position(li.SourceLen())
-	if err != nil {
-		return Range{}, err
-	}
-	return Range{
-		Start: Position{Line: 0, Character: 0},
-		End:   Position{Line: end.Line, Character: end.Character},
-	}, nil
-}
-
 func byteSpanFromLSPRange(li *itext.LineIndex, r Range) (itext.Span, error) {
 	if li == nil {
 		return itext.Span{}, errors.New("nil line index")
@@ -1886,44 +1899,3 @@ func lspErrorCodeForQuery(err error) int {
 		return jsonRPCInternalError
 	}
 }
-
-func readFramedMessage(r *bufio.Reader) ([]byte, error) {
-	contentLen := -1
-	for {
-		line, err := r.ReadString('\n')
-		if err != nil {
-			return nil, err
-		}
-		if line == "\r\n" || line == "\n" {
-			break
-		}
-		line = strings.TrimRight(line, "\r\n")
-		name, value, ok := strings.Cut(line, ":")
-		if !ok {
-			return nil, fmt.Errorf("invalid header line %q", line)
-		}
-		if strings.EqualFold(strings.TrimSpace(name), "Content-Length") {
-			var n int
-			if _, err := fmt.Sscanf(strings.TrimSpace(value), "%d", &n); err != nil || n < 0 {
-				return nil, fmt.Errorf("invalid Content-Length %q", value)
-			}
-			contentLen = n
-		}
-	}
-	if contentLen < 0 {
-		return nil, errors.New("missing Content-Length")
-	}
-	body := make([]byte, contentLen)
-	if _, err := io.ReadFull(r, body); err != nil {
-		return nil, err
-	}
-	return body, nil
-}
-
-func writeFramedMessage(w io.Writer, body []byte) error {
-	if _, err := fmt.Fprintf(w, "Content-Length: %d\r\n\r\n", len(body)); err != nil {
-		return err
-	}
-	_, err := w.Write(body)
-	return err
-}
@@ -1914,11 +1914,16 @@ func TestServerRunDocumentFormattingSuccessNoOpRefusalAndStale(t *testing.T) {
 		}
 		var edits1 []TextEdit
 		marshalRoundtrip(t, resp1.Result, &edits1)
-		if len(edits1) != 1 {
-			t.Fatalf("edits1 len=%d, want 1", len(edits1))
+		if len(edits1) == 0 {
+			t.Fatal("expected formatting edits")
 		}
-		if !strings.Contains(edits1[0].NewText, "async void ping(1: i32 id),") {
-			t.Fatalf("unexpected formatting output: %q", edits1[0].NewText)
+		for _, e := range edits1 {
+			if strings.Contains(e.NewText, "ping") {
+				t.Fatalf("edit %+v rewrites an unchanged token, want whitespace and separator edits only", e)
+			}
+		}
+		if got := string(applyWorkspaceTextEdits(t, []byte(src), edits1)); got != "service S {\n  async void ping(1: i32 id),\n}\n" {
+			t.Fatalf("formatted output = %q", got)
 		}
 		var edits2 []TextEdit
 		marshalRoundtrip(t, resp2.Result, &edits2)
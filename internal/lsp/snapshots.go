@@ -29,6 +29,14 @@ func (s *Snapshot) Bytes() []byte {
 	return slices.Clone(s.Tree.Source)
 }
 
+// Content returns the snapshot's shared immutable source buffer.
+func (s *Snapshot) Content() *itext.Content {
+	if s == nil || s.Tree == nil {
+		return nil
+	}
+	return s.Tree.Content
+}
+
 // SnapshotStore stores versioned parsed documents.
 type SnapshotStore struct {
 	mu   sync.RWMutex
@@ -48,7 +56,8 @@ func NewSnapshotStore() *SnapshotStore {
 	return &SnapshotStore{docs: make(map[index.DocumentKey]*documentState)}
 }
 
-// Open parses and stores a document snapshot.
+// Open parses and stores a document snapshot. The snapshot takes ownership of
+// src, which must not be modified afterwards.
 func (s *SnapshotStore) Open(ctx context.Context, uri string, version int32, src []byte) (*Snapshot, error) {
 	if s == nil {
 		return nil, errors.New("nil SnapshotStore")
@@ -60,7 +69,7 @@ func (s *SnapshotStore) Open(ctx context.Context, uri string, version int32, src
 	doc.mu.Lock()
 	defer doc.mu.Unlock()
 
-	tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: canonicalURI, Version: version})
+	tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: canonicalURI, Version: version, Content: itext.NewContent(src)})
 	if err != nil {
 		return nil, err
 	}
@@ -94,11 +103,12 @@ func (s *SnapshotStore) Change(ctx context.Context, uri string, version int32, c
 	if err != nil {
 		return nil, err
 	}
+	opts := syntax.ParseOptions{URI: canonicalURI, Version: version, Content: itext.NewContent(nextSrc)}
 	var nextTree *syntax.Tree
 	if incrementalEligible {
-		nextTree, err = syntax.ApplyIncrementalEditsAndReparse(ctx, cur.Tree, nextSrc, syntax.ParseOptions{URI: canonicalURI, Version: version}, incrementalEdits)
+		nextTree, err = syntax.ApplyIncrementalEditsAndReparse(ctx, cur.Tree, nextSrc, opts, incrementalEdits)
 	} else {
-		nextTree, err = syntax.Reparse(ctx, cur.Tree, nextSrc, syntax.ParseOptions{URI: canonicalURI, Version: version})
+		nextTree, err = syntax.Reparse(ctx, cur.Tree, nextSrc, opts)
 	}
 	if err != nil {
 		return nil, err
@@ -258,7 +268,8 @@ func applyContentChanges(src []byte, changes []TextDocumentContentChangeEvent) (
 		return next, nil, false, err
 	}
 
-	cur := slices.Clone(src)
+	// Every change produces a fresh buffer, so src is never modified.
+	cur := src
 	edits := make([]syntax.InputEdit, 0, len(changes))
 	incrementalEligible := true
 	editedBytes := 0
@@ -315,7 +326,7 @@ func applyContentChanges(src []byte, changes []TextDocumentContentChangeEvent) (
 }
 
 func applyTextChanges(src []byte, changes []TextDocumentContentChangeEvent) ([]byte, error) {
-	cur := slices.Clone(src)
+	cur := src
 	for _, ch := range changes {
 		if ch.Range == nil {
 			cur = []byte(ch.Text)
@@ -116,6 +116,43 @@ func TestSnapshotStoreChangeUsesIncrementalReparseForRangedEdits(t *testing.T) {
 	}
 }
 
+func TestSnapshotStoreSharesOneContentBufferPerGeneration(t *testing.T) {
+	t.Parallel()
+
+	store := NewSnapshotStore()
+	uri := "file:///shared.thrift"
+	src := []byte("struct S {\n  1: string name,\n}\n")
+	snap, err := store.Open(context.Background(), uri, 1, src)
+	if err != nil {
+		t.Fatalf("Open: %v", err)
+	}
+	if !snap.Content().Holds(src) || !snap.Content().Holds(snap.Tree.Source) {
+		t.Fatal("Open copied the source instead of adopting it")
+	}
+
+	next, err := store.Change(context.Background(), uri, 2, []TextDocumentContentChangeEvent{{
+		Range: &Range{
+			Start: Position{Line: 1, Character: 12},
+			End:   Position{Line: 1, Character: 16},
+		},
+		Text: "xname",
+	}})
+	if err != nil {
+		t.Fatalf("Change: %v", err)
+	}
+	if next.Content() == snap.Content() || !next.Content().Holds(next.Tree.Source) {
+		t.Fatal("Change did not share its new buffer with the syntax tree")
+	}
+	if string(snap.Tree.Source) != string(src) {
+		t.Fatalf("previous generation source changed to %q", snap.Tree.Source)
+	}
+
+	in := workspaceDocumentInput(next)
+	if in.Content != next.Content() || !in.Content.Holds(in.Source) {
+		t.Fatal("workspace input does not hand over the snapshot buffer")
+	}
+}
+
 func TestSnapshotStoreChangeRejectsUnknownDocumentAndBadRange(t *testing.T) {
 	t.Parallel()
 
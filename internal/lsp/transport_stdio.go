@@ -1,11 +1,425 @@
 package lsp
 
 import (
+	"bufio"
+	"bytes"
 	"context"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
 	"os"
+	"strconv"
+	"sync"
+	"sync/atomic"
+)
+
+const (
+	frameWriterBufferSize = 64 << 10
+	// maxPooledFrameBytes bounds the body buffer kept for reuse; larger
+	// messages get a one-off buffer.
+	maxPooledFrameBytes = 8 << 20
+)
+
+var (
+	contentLengthHeader = []byte("Content-Length")
+	frameBodyPool       = sync.Pool{New: func() any { return new([]byte) }}
+
+	// knownMethods interns dispatched method names so decoding an envelope
+	// does not allocate a method string.
+	knownMethods = func() map[string]string {
+		methods := []string{
+			"initialize", "initialized", "shutdown", "exit", "$/cancelRequest",
+			"workspace/didChangeWorkspaceFolders", "workspace/didChangeWatchedFiles", "workspace/symbol",
+			"textDocument/didOpen", "textDocument/didChange", "textDocument/didSave", "textDocument/didClose",
+			"textDocument/formatting", "textDocument/rangeFormatting", "textDocument/definition",
+			"textDocument/documentLink", "textDocument/references", "textDocument/prepareRename",
+			"textDocument/rename", "textDocument/documentSymbol", "textDocument/foldingRange",
+			"textDocument/selectionRange", "textDocument/semanticTokens/full",
+		}
+		out := make(map[string]string, len(methods))
+		for _, method := range methods {
+			out[method] = method
+		}
+		return out
+	}()
 )
 
 // RunStdio serves LSP over stdio using Content-Length framing.
 func (s *Server) RunStdio(ctx context.Context) error {
 	return s.Run(ctx, os.Stdin, os.Stdout)
 }
+
+// frameReader reads Content-Length framed messages into a pooled body buffer.
+// A returned body is valid until the next call to next or release.
+type frameReader struct {
+	r   *bufio.Reader
+	buf *[]byte
+}
+
+func newFrameReader(r io.Reader) *frameReader {
+	return &frameReader{r: bufio.NewReader(r)}
+}
+
+func (fr *frameReader) next() ([]byte, error) {
+	n, err := readFrameHeader(fr.r)
+	if err != nil {
+		return nil, err
+	}
+	var body []byte
+	if n <= maxPooledFrameBytes {
+		if fr.buf == nil {
+			fr.buf = frameBodyPool.Get().(*[]byte)
+		}
+		if cap(*fr.buf) < n {
+			*fr.buf = make([]byte, n)
+		}
+		body = (*fr.buf)[:n]
+	} else {
+		body = make([]byte, n)
+	}
+	if _, err := io.ReadFull(fr.r, body); err != nil {
+		return nil, err
+	}
+	return body, nil
+}
+
+func (fr *frameReader) release() {
+	if fr.buf != nil {
+		frameBodyPool.Put(fr.buf)
+		fr.buf = nil
+	}
+}
+
+// readFramedMessage reads one framed message into a new buffer.
+func readFramedMessage(r *bufio.Reader) ([]byte, error) {
+	n, err := readFrameHeader(r)
+	if err != nil {
+		return nil, err
+	}
+	body := make([]byte, n)
+	if _, err := io.ReadFull(r, body); err != nil {
+		return nil, err
+	}
+	return body, nil
+}
+
+// readFrameHeader consumes the header block and returns the Content-Length.
+// Header lines are parsed in place from the reader's buffer.
+func readFrameHeader(r *bufio.Reader) (int, error) {
+	contentLen := -1
+	for {
+		line, err := r.ReadSlice('\n')
+		if errors.Is(err, bufio.ErrBufferFull) {
+			return 0, errors.New("header line too long")
+		}
+		if err != nil {
+			return 0, err
+		}
+		line = bytes.TrimRight(line, "\r\n")
+		if len(line) == 0 {
+			break
+		}
+		name, value, ok := bytes.Cut(line, []byte(":"))
+		if !ok {
+			return 0, fmt.Errorf("invalid header line %q", line)
+		}
+		if !bytes.EqualFold(bytes.TrimSpace(name), contentLengthHeader) {
+			continue
+		}
+		n, ok := parseContentLength(bytes.TrimSpace(value))
+		if !ok {
+			return 0, fmt.Errorf("invalid Content-Length %q", value)
+		}
+		contentLen = n
+	}
+	if contentLen < 0 {
+		return 0, errors.New("missing Content-Length")
+	}
+	return contentLen, nil
+}
+
+func parseContentLength(b []byte) (int, bool) {
+	if len(b) == 0 || len(b) > 10 {
+		return 0, false
+	}
+	n := 0
+	for _, c := range b {
+		if c < '0' || c > '9' {
+			return 0, false
+		}
+		n = n*10 + int(c-'0')
+	}
+	return n, true
+}
+
+// writeFramedMessage writes one framed message to w.
+func writeFramedMessage(w io.Writer, body []byte) error {
+	var header [32]byte
+	if _, err := w.Write(appendFrameHeader(header[:0], len(body))); err != nil {
+		return err
+	}
+	_, err := w.Write(body)
+	return err
+}
+
+func appendFrameHeader(dst []byte, n int) []byte {
+	dst = append(dst, "Content-Length: "...)
+	dst = strconv.AppendInt(dst, int64(n), 10)
+	return append(dst, "\r\n\r\n"...)
+}
+
+// frameWriter buffers framed messages and coalesces concurrent writers: a
+// writer that finds others queued behind it leaves the flush to the last one,
+// so a burst of notifications reaches the client in one write.
+type frameWriter struct {
+	mu      sync.Mutex
+	w       *bufio.Writer
+	header  [32]byte
+	waiting atomic.Int32
+}
+
+func newFrameWriter(w io.Writer) *frameWriter {
+	return &frameWriter{w: bufio.NewWriterSize(w, frameWriterBufferSize)}
+}
+
+func (fw *frameWriter) write(body []byte) error {
+	fw.waiting.Add(1)
+	fw.mu.Lock()
+	defer fw.mu.Unlock()
+
+	_, err := fw.w.Write(appendFrameHeader(fw.header[:0], len(body)))
+	if err == nil {
+		_, err = fw.w.Write(body)
+	}
+	if fw.waiting.Add(-1) == 0 || err != nil {
+		if flushErr := fw.w.Flush(); err == nil {
+			err = flushErr
+		}
+	}
+	return err
+}
+
+// decodeRequest extracts the JSON-RPC envelope from body without decoding
+// params, which handlers unmarshal once into their own types. ID and Params
+// alias body.
+func decodeRequest(body []byte) (Request, error) {
+	var req Request
+	d := envelopeDecoder{src: body}
+	if !d.consume('{') {
+		return Request{}, d.errorf("expected JSON object")
+	}
+	if d.consume('}') {
+		return req, d.end()
+	}
+	for {
+		key, err := d.stringToken()
+		if err != nil {
+			return Request{}, err
+		}
+		if !d.consume(':') {
+			return Request{}, d.errorf("expected ':' after object key")
+		}
+		d.skipSpace()
+		start := d.pos
+		if err := d.skipValue(0); err != nil {
+			return Request{}, err
+		}
+		value := body[start:d.pos]
+		switch {
+		case bytes.EqualFold(key, []byte("jsonrpc")):
+			if req.JSONRPC, err = decodeEnvelopeString(value); err != nil {
+				return Request{}, err
+			}
+		case bytes.EqualFold(key, []byte("method")):
+			if req.Method, err = decodeEnvelopeString(value); err != nil {
+				return Request{}, err
+			}
+		case bytes.EqualFold(key, []byte("id")):
+			if !json.Valid(value) {
+				return Request{}, d.errorf("invalid request id")
+			}
+			req.ID = json.RawMessage(value)
+		case bytes.EqualFold(key, []byte("params")):
+			req.Params = json.RawMessage(value)
+		}
+		if d.consume(',') {
+			continue
+		}
+		if d.consume('}') {
+			return req, d.end()
+		}
+		return Request{}, d.errorf("expected ',' or '}' after object value")
+	}
+}
+
+// decodeEnvelopeString decodes a JSON string value, interning known method
+// names and the protocol version.
+func decodeEnvelopeString(value []byte) (string, error) {
+	if len(value) < 2 || value[0] != '"' {
+		if bytes.Equal(value, []byte("null")) {
+			return "", nil
+		}
+		return "", fmt.Errorf("expected JSON string, got %q", value)
+	}
+	raw := value[1 : len(value)-1]
+	if bytes.IndexByte(raw, '\\') >= 0 {
+		var s string
+		if err := json.Unmarshal(value, &s); err != nil {
+			return "", err
+		}
+		return s, nil
+	}
+	if string(raw) == JSONRPCVersion {
+		return JSONRPCVersion, nil
+	}
+	if method, ok := knownMethods[string(raw)]; ok {
+		return method, nil
+	}
+	return string(raw), nil
+}
+
+// envelopeDecoder is a minimal JSON scanner for the request envelope. It
+// checks structure while skipping values; params are validated when a handler
+// unmarshals them.
+type envelopeDecoder struct {
+	src []byte
+	pos int
+}
+
+const maxEnvelopeDepth = 10000
+
+func (d *envelopeDecoder) errorf(format string, args ...any) error {
+	return fmt.Errorf("invalid JSON-RPC message at offset %d: %s", d.pos, fmt.Sprintf(format, args...))
+}
+
+func (d *envelopeDecoder) skipSpace() {
+	for d.pos < len(d.src) {
+		switch d.src[d.pos] {
+		case ' ', '\t', '\r', '\n':
+			d.pos++
+		default:
+			return
+		}
+	}
+}
+
+func (d *envelopeDecoder) consume(c byte) bool {
+	d.skipSpace()
+	if d.pos < len(d.src) && d.src[d.pos] == c {
+		d.pos++
+		return true
+	}
+	return false
+}
+
+func (d *envelopeDecoder) end() error {
+	d.skipSpace()
+	if d.pos != len(d.src) {
+		return d.errorf("unexpected data after JSON object")
+	}
+	return nil
+}
+
+// stringToken returns the raw contents of the next string.
+func (d *envelopeDecoder) stringToken() ([]byte, error) {
+	d.skipSpace()
+	start := d.pos
+	if err := d.skipString(); err != nil {
+		return nil, err
+	}
+	return d.src[start+1 : d.pos-1], nil
+}
+
+func (d *envelopeDecoder) skipString() error {
+	if d.pos >= len(d.src) || d.src[d.pos] != '"' {
+		return d.errorf("expected string")
+	}
+	for i := d.pos + 1; i < len(d.src); i++ {
+		switch c := d.src[i]; {
+		case c == '\\':
+			i++
+		case c == '"':
+			d.pos = i + 1
+			return nil
+		case c < 0x20:
+			return d.errorf("control character in string")
+		}
+	}
+	return d.errorf("unterminated string")
+}
+
+func (d *envelopeDecoder) skipValue(depth int) error {
+	if depth > maxEnvelopeDepth {
+		return d.errorf("exceeded max depth")
+	}
+	d.skipSpace()
+	if d.pos >= len(d.src) {
+		return d.errorf("unexpected end of JSON input")
+	}
+	switch d.src[d.pos] {
+	case '"':
+		return d.skipString()
+	case '{':
+		d.pos++
+		if d.consume('}') {
+			return nil
+		}
+		for {
+			d.skipSpace()
+			if err := d.skipString(); err != nil {
+				return err
+			}
+			if !d.consume(':') {
+				return d.errorf("expected ':' after object key")
+			}
+			if err := d.skipValue(depth + 1); err != nil {
+				return err
+			}
+			if d.consume(',') {
+				continue
+			}
+			if d.consume('}') {
+				return nil
+			}
+			return d.errorf("expected ',' or '}' after object value")
+		}
+	case '[':
+		d.pos++
+		if d.consume(']') {
+			return nil
+		}
+		for {
+			if err := d.skipValue(depth + 1); err != nil {
+				return err
+			}
+			if d.consume(',') {
+				continue
+			}
+			if d.consume(']') {
+				return nil
+			}
+			return d.errorf("expected ',' or ']' after array element")
+		}
+	default:
+		start := d.pos
+		for d.pos < len(d.src) && isLiteralByte(d.src[d.pos]) {
+			d.pos++
+		}
+		switch literal := d.src[start:d.pos]; {
+		case len(literal) == 0:
+			return d.errorf("unexpected character %q", d.src[d.pos])
+		case string(literal) == "true", string(literal) == "false", string(literal) == "null":
+			return nil
+		case literal[0] == '-' || (literal[0] >= '0' && literal[0] <= '9'):
+			return nil
+		default:
+			return d.errorf("invalid literal %q", literal)
+		}
+	}
+}
+
+// isLiteralByte reports whether c can appear in a JSON number or keyword.
+func isLiteralByte(c byte) bool {
+	return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'E'
+}
@@ -0,0 +1,182 @@
+package lsp
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/json"
+	"io"
+	"reflect"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+)
+
+func TestDecodeRequestMatchesJSONUnmarshal(t *testing.T) {
+	t.Parallel()
+
+	bodies := []string{
+		`{"jsonrpc":"2.0","id":1,"method":"initialize","params":{}}`,
+		` { "jsonrpc" : "2.0" , "method" : "textDocument/didChange" , "params" : {"a":[1,-2.5e3,true,null,{"b":"\"}"}]} } `,
+		`{"jsonrpc":"2.0","id":"req-1","method":"custom\/method"}`,
+		`{"Method":"exit","JSONRPC":"2.0","extra":[[],{}]}`,
+		`{"jsonrpc":"2.0","id":null,"method":"shutdown"}`,
+		`{"id":7,"result":{"ok":true}}`,
+		`{}`,
+		`[]`,
+		`{"method":5}`,
+		`{"method":"exit",}`,
+		`{"method":"exit"} trailing`,
+		`{"method":"exit","params":{"a":}}`,
+		`{"method":"exit","id":tru}`,
+		`{"method":"exit"`,
+		"{\"method\":\"a\nb\"}",
+	}
+	for _, body := range bodies {
+		var want Request
+		wantErr := json.Unmarshal([]byte(body), &want)
+		got, gotErr := decodeRequest([]byte(body))
+		if (wantErr != nil) != (gotErr != nil) {
+			t.Fatalf("decodeRequest(%s) error = %v, json.Unmarshal error = %v", body, gotErr, wantErr)
+		}
+		if wantErr != nil {
+			continue
+		}
+		if got.JSONRPC != want.JSONRPC || got.Method != want.Method || !bytes.Equal(got.ID, want.ID) {
+			t.Fatalf("decodeRequest(%s) = %+v, want %+v", body, got, want)
+		}
+		if !jsonEqual(t, got.Params, want.Params) {
+			t.Fatalf("decodeRequest(%s) params = %s, want %s", body, got.Params, want.Params)
+		}
+	}
+}
+
+func TestReadFrameHeaderParsesInPlace(t *testing.T) {
+	t.Parallel()
+
+	br := bufio.NewReader(strings.NewReader("content-length:  12 \r\nContent-Type: application/vscode-jsonrpc\r\n\r\n"))
+	n, err := readFrameHeader(br)
+	if err != nil || n != 12 {
+		t.Fatalf("readFrameHeader() = %d, %v; want 12", n, err)
+	}
+	for _, header := range []string{"Content-Length: -1\r\n\r\n", "Content-Length: 1x\r\n\r\n", "X-Other: 1\r\n\r\n", "bogus\r\n\r\n"} {
+		if _, err := readFrameHeader(bufio.NewReader(strings.NewReader(header))); err == nil {
+			t.Fatalf("readFrameHeader(%q) succeeded", header)
+		}
+	}
+}
+
+func TestFrameWriterCoalescesQueuedWriters(t *testing.T) {
+	t.Parallel()
+
+	var out countingWriter
+	fw := newFrameWriter(&out)
+
+	fw.mu.Lock()
+	var wg sync.WaitGroup
+	for i := range 4 {
+		wg.Go(func() {
+			if err := fw.write([]byte(`{"n":` + string(rune('0'+i)) + `}`)); err != nil {
+				t.Errorf("write: %v", err)
+			}
+		})
+	}
+	for fw.waiting.Load() != 4 {
+		time.Sleep(time.Millisecond)
+	}
+	fw.mu.Unlock()
+	wg.Wait()
+
+	if out.writes != 1 {
+		t.Fatalf("underlying writes = %d, want 1", out.writes)
+	}
+	br := bufio.NewReader(bytes.NewReader(out.Bytes()))
+	for range 4 {
+		if _, err := readFramedMessage(br); err != nil {
+			t.Fatalf("readFramedMessage: %v", err)
+		}
+	}
+	if _, err := readFramedMessage(br); err != io.EOF {
+		t.Fatalf("extra frame data, err = %v", err)
+	}
+}
+
+func BenchmarkStdioTransportDidChangeThroughput(b *testing.B) {
+	text := strings.Repeat("struct S {\n  1: optional string name,\n}\n", 1600)
+	body, err := json.Marshal(map[string]any{
+		"jsonrpc": JSONRPCVersion,
+		"method":  "textDocument/didChange",
+		"params": DidChangeParams{
+			TextDocument:   VersionedTextDocumentIdentifier{URI: "file:///bench.thrift", Version: 2},
+			ContentChanges: []TextDocumentContentChangeEvent{{Text: text}},
+		},
+	})
+	if err != nil {
+		b.Fatalf("json.Marshal: %v", err)
+	}
+	var frame bytes.Buffer
+	if err := writeFramedMessage(&frame, body); err != nil {
+		b.Fatalf("writeFramedMessage: %v", err)
+	}
+	const batch = 16
+	stream := bytes.Repeat(frame.Bytes(), batch)
+
+	b.SetBytes(int64(len(stream)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for b.Loop() {
+		fr := newFrameReader(bytes.NewReader(stream))
+		for range batch {
+			msg, err := fr.next()
+			if err != nil {
+				b.Fatalf("next: %v", err)
+			}
+			req, err := decodeRequest(msg)
+			if err != nil || req.Method != "textDocument/didChange" {
+				b.Fatalf("decodeRequest = %+v, %v", req, err)
+			}
+		}
+		fr.release()
+	}
+}
+
+func BenchmarkStdioTransportNotificationBurst(b *testing.B) {
+	body := []byte(`{"jsonrpc":"2.0","method":"textDocument/publishDiagnostics","params":{"uri":"file:///bench.thrift","diagnostics":[]}}`)
+	fw := newFrameWriter(io.Discard)
+
+	b.SetBytes(int64(len(body)))
+	b.ReportAllocs()
+	b.RunParallel(func(pb *testing.PB) {
+		for pb.Next() {
+			if err := fw.write(body); err != nil {
+				b.Errorf("write: %v", err)
+				return
+			}
+		}
+	})
+}
+
+type countingWriter struct {
+	bytes.Buffer
+	writes int
+}
+
+func (w *countingWriter) Write(p []byte) (int, error) {
+	w.writes++
+	return w.Buffer.Write(p)
+}
+
+func jsonEqual(t *testing.T, a, b json.RawMessage) bool {
+	t.Helper()
+	if len(a) == 0 || len(b) == 0 {
+		return len(a) == len(b)
+	}
+	var av, bv any
+	if err := json.Unmarshal(a, &av); err != nil {
+		t.Fatalf("json.Unmarshal(%s): %v", a, err)
+	}
+	if err := json.Unmarshal(b, &bv); err != nil {
+		t.Fatalf("json.Unmarshal(%s): %v", b, err)
+	}
+	return reflect.DeepEqual(av, bv)
+}
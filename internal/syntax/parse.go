@@ -313,16 +313,27 @@ func buildSyntaxTreeFromRawIncremental(
 	return buildSyntaxTreeFromRawWithLexResultAndReuse(ctx, src, opts, rawTree, lexRes, old, changed)
 }
 
+// treeContent adopts opts.Content when it holds src and otherwise copies src,
+// so a tree never aliases a buffer its caller may still modify.
+func treeContent(src []byte, opts ParseOptions) *text.Content {
+	if opts.Content.Holds(src) {
+		return opts.Content
+	}
+	return text.NewContent(slices.Clone(src))
+}
+
 func buildDegradedTreeForParserFailure(src []byte, opts ParseOptions, parseErr error) *Tree {
 	return buildDegradedTreeForParserFailureWithLexResult(src, opts, lexer.Lex(src), parseErr)
 }
 
 func buildDegradedTreeForParserFailureWithLexResult(src []byte, opts ParseOptions, lexRes lexer.Result, parseErr error) *Tree {
-	sourceCopy := slices.Clone(src)
+	content := treeContent(src, opts)
+	sourceCopy := content.Bytes()
 	out := &Tree{
 		URI:       opts.URI,
 		Version:   opts.Version,
 		Source:    sourceCopy,
+		Content:   content,
 		Tokens:    append([]lexer.Token(nil), lexRes.Tokens...),
 		Nodes:     make([]Node, 1),
 		Root:      NoNode,
@@ -354,11 +365,13 @@ func buildSyntaxTreeFromRawWithLexResultAndReuse(
 		ctx = context.Background()
 	}
 
-	sourceCopy := slices.Clone(src)
+	content := treeContent(src, opts)
+	sourceCopy := content.Bytes()
 	out := &Tree{
 		URI:       opts.URI,
 		Version:   opts.Version,
 		Source:    sourceCopy,
+		Content:   content,
 		Tokens:    append([]lexer.Token(nil), lexRes.Tokens...),
 		LineIndex: text.NewLineIndex(sourceCopy),
 	}
@@ -1,5 +1,11 @@
 package syntax
 
+import (
+	"sort"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
 // ChildNodeIDs returns direct child node ids (excluding token child refs) in source order.
 func (t *Tree) ChildNodeIDs(id NodeID) []NodeID {
 	n := t.NodeByID(id)
@@ -76,3 +82,114 @@ func (t *Tree) namedChildrenOnly(parent NodeID) []NodeID {
 	}
 	return out
 }
+
+// NodeAt returns the smallest named node containing off, preferring the
+// deeper node when spans tie. Spans are half-open; an empty node contains
+// only its start offset.
+func (t *Tree) NodeAt(off text.ByteOffset) NodeID {
+	return t.SmallestNamedNodeCovering(text.Span{Start: off, End: off})
+}
+
+// SmallestNamedNodeCovering returns the smallest named node whose span covers
+// r. An empty r covers like NodeAt.
+func (t *Tree) SmallestNamedNodeCovering(r text.Span) NodeID {
+	return t.SmallestNodeCovering(r, func(n *Node) bool {
+		return n.Flags.Has(NodeFlagNamed)
+	})
+}
+
+// SmallestNodeCovering returns the smallest node accepted by accept whose span
+// covers r, preferring the deeper node when spans tie.
+//
+// The lookup descends from the root and binary-searches each node's children
+// by start offset, so it costs O(depth·log(fan-out)) instead of a scan over
+// every node. Only the few children touching r (for example an empty missing
+// node next to its sibling) are followed.
+func (t *Tree) SmallestNodeCovering(r text.Span, accept func(*Node) bool) NodeID {
+	root := t.NodeByID(t.Root)
+	if root == nil || !r.IsValid() || !spanTouches(root.Span, r) {
+		return NoNode
+	}
+
+	best := NoNode
+	bestLen := text.ByteOffset(-1)
+	bestDepth := -1
+	var visit func(n *Node, depth int)
+	visit = func(n *Node, depth int) {
+		if spanCovers(n.Span, r) && (accept == nil || accept(n)) {
+			spanLen := n.Span.Len()
+			if best == NoNode || spanLen < bestLen || (spanLen == bestLen && depth > bestDepth) {
+				best, bestLen, bestDepth = n.ID, spanLen, depth
+			}
+		}
+		var buf [4]NodeID
+		for _, id := range t.childrenTouching(n, r, buf[:0]) {
+			visit(&t.Nodes[id], depth+1)
+		}
+	}
+	visit(root, 0)
+	return best
+}
+
+// childrenTouching appends, in source order, the node children of n whose
+// spans touch r. Sibling spans never overlap, so every candidate starts at or
+// before r.Start and only the last non-empty one can reach it.
+func (t *Tree) childrenTouching(n *Node, r text.Span, out []NodeID) []NodeID {
+	children := n.Children
+	end := sort.Search(len(children), func(i int) bool {
+		return t.childSpan(children[i]).Start > r.Start
+	})
+	first := end
+	for i := end - 1; i >= 0; i-- {
+		sp := t.childSpan(children[i])
+		first = i
+		if !sp.IsEmpty() && sp.Start < r.Start {
+			break
+		}
+	}
+	for i := first; i < end; i++ {
+		child := children[i]
+		if child.IsToken || int(child.Index) >= len(t.Nodes) {
+			continue
+		}
+		if spanTouches(t.Nodes[child.Index].Span, r) {
+			out = append(out, NodeID(child.Index))
+		}
+	}
+	return out
+}
+
+func (t *Tree) childSpan(child ChildRef) text.Span {
+	if child.IsToken {
+		if int(child.Index) < len(t.Tokens) {
+			return t.Tokens[child.Index].Span
+		}
+		return text.Span{}
+	}
+	if int(child.Index) < len(t.Nodes) {
+		return t.Nodes[child.Index].Span
+	}
+	return text.Span{}
+}
+
+// spanTouches reports whether sp contains r with both ends inclusive. The
+// descent follows touching nodes because recovered parses can attach an empty
+// node at the end of its parent's span.
+func spanTouches(sp, r text.Span) bool {
+	return sp.IsValid() && sp.Start <= r.Start && r.End <= sp.End
+}
+
+// spanCovers reports whether sp covers r. An empty r at off is covered by a
+// span containing off or by an empty span starting at off.
+func spanCovers(sp, r text.Span) bool {
+	if !sp.IsValid() {
+		return false
+	}
+	if r.IsEmpty() {
+		if sp.IsEmpty() {
+			return sp.Start == r.Start
+		}
+		return sp.Contains(r.Start)
+	}
+	return sp.ContainsSpan(r)
+}
@@ -0,0 +1,115 @@
+package syntax
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"testing"
+
+	"github.com/kpumuk/thrift-weaver/internal/text"
+)
+
+func TestNodeAtMatchesLinearScan(t *testing.T) {
+	t.Parallel()
+
+	sources := map[string]string{
+		"valid": "namespace go demo\n\n" +
+			"struct User {\n  1: required string name,\n  2: optional list<i32> ids = [1, 2],\n}\n\n" +
+			"service Users {\n  User get(1: i64 id) throws (1: Missing err),\n}\n",
+		"malformed": "struct Broken {\n  1: string name\n  2: i32\n}\nenum E { A = , B }\nconst map<string, i32> M = {\"a\": 1\n",
+	}
+	for name, src := range sources {
+		tree, err := Parse(context.Background(), []byte(src), ParseOptions{URI: "file:///" + name + ".thrift"})
+		if err != nil {
+			t.Fatalf("%s: Parse: %v", name, err)
+		}
+		for off := text.ByteOffset(0); off <= text.ByteOffset(len(src)); off++ {
+			if got, want := tree.NodeAt(off), linearSmallestNamedNode(tree, text.Span{Start: off, End: off}); got != want {
+				t.Fatalf("%s: NodeAt(%d) = %d, want %d", name, off, got, want)
+			}
+			for end := off + 1; end <= min(off+12, text.ByteOffset(len(src))); end++ {
+				r := text.Span{Start: off, End: end}
+				if got, want := tree.SmallestNamedNodeCovering(r), linearSmallestNamedNode(tree, r); got != want {
+					t.Fatalf("%s: SmallestNamedNodeCovering(%s) = %d, want %d", name, r, got, want)
+				}
+			}
+		}
+		tree.Close()
+	}
+}
+
+func BenchmarkNodeAtLargeDocument(b *testing.B) {
+	tree, offsets := largeNodeLookupFixture(b)
+	defer tree.Close()
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := range b.N {
+		if tree.NodeAt(offsets[i%len(offsets)]) == NoNode {
+			b.Fatal("NodeAt found no node")
+		}
+	}
+}
+
+func BenchmarkNodeAtLargeDocumentLinearScan(b *testing.B) {
+	tree, offsets := largeNodeLookupFixture(b)
+	defer tree.Close()
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := range b.N {
+		off := offsets[i%len(offsets)]
+		if linearSmallestNamedNode(tree, text.Span{Start: off, End: off}) == NoNode {
+			b.Fatal("linear scan found no node")
+		}
+	}
+}
+
+// largeNodeLookupFixture parses a document with over 50k nodes and returns
+// cursor offsets spread across it.
+func largeNodeLookupFixture(b *testing.B) (*Tree, []text.ByteOffset) {
+	b.Helper()
+
+	var buf bytes.Buffer
+	for s := range 400 {
+		fmt.Fprintf(&buf, "struct Large%03d {\n", s)
+		for f := range 24 {
+			fmt.Fprintf(&buf, "  %d: optional map<string, list<i64>> field_%02d = {},\n", f+1, f)
+		}
+		buf.WriteString("}\n\n")
+	}
+	src := buf.Bytes()
+	tree, err := Parse(context.Background(), src, ParseOptions{URI: "file:///large.thrift"})
+	if err != nil {
+		b.Fatalf("Parse: %v", err)
+	}
+	if len(tree.Nodes) < 50_000 {
+		b.Fatalf("fixture has %d nodes, want at least 50000", len(tree.Nodes))
+	}
+	offsets := make([]text.ByteOffset, 0, 1024)
+	for i := range cap(offsets) {
+		offsets = append(offsets, text.ByteOffset((i*7919)%len(src)))
+	}
+	return tree, offsets
+}
+
+// linearSmallestNamedNode is the reference scan NodeAt replaces.
+func linearSmallestNamedNode(tree *Tree, r text.Span) NodeID {
+	best := NoNode
+	bestLen := text.ByteOffset(-1)
+	bestDepth := -1
+	for i := 1; i < len(tree.Nodes); i++ {
+		n := &tree.Nodes[i]
+		if !n.Flags.Has(NodeFlagNamed) || !spanCovers(n.Span, r) {
+			continue
+		}
+		depth := 0
+		for cur := n.ID; cur != NoNode; cur = tree.Nodes[cur].Parent {
+			depth++
+		}
+		if best == NoNode || n.Span.Len() < bestLen || (n.Span.Len() == bestLen && depth > bestDepth) {
+			best, bestLen, bestDepth = n.ID, n.Span.Len(), depth
+		}
+	}
+	return best
+}
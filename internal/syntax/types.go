@@ -104,6 +104,9 @@ type ParseOptions struct {
 	URI            string
 	Version        int32
 	IncludeQueries bool
+	// Content, when it holds the parsed source, is adopted by the tree
+	// instead of copying the source.
+	Content *text.Content
 }
 
 // Tree is the immutable syntax parse result.
@@ -111,6 +114,7 @@ type Tree struct {
 	URI           string
 	Version       int32
 	Source        []byte
+	Content       *text.Content // shared immutable buffer behind Source
 	Tokens        []lexer.Token
 	Nodes         []Node // index 0 is unused sentinel; real NodeIDs are 1-based
 	Root          NodeID
@@ -0,0 +1,56 @@
+package text
+
+import (
+	"crypto/sha256"
+	"sync"
+)
+
+// Content is an immutable document buffer. Every layer that holds the same
+// document generation shares one Content instead of copying its bytes, and
+// the content hash is computed at most once.
+type Content struct {
+	bytes    []byte
+	hashOnce sync.Once
+	hash     [sha256.Size]byte
+}
+
+// NewContent takes ownership of b; callers must not modify b afterwards.
+func NewContent(b []byte) *Content {
+	return &Content{bytes: b}
+}
+
+// Bytes returns the shared buffer, which must not be modified.
+func (c *Content) Bytes() []byte {
+	if c == nil {
+		return nil
+	}
+	return c.bytes
+}
+
+// Len returns the content length in bytes.
+func (c *Content) Len() int {
+	if c == nil {
+		return 0
+	}
+	return len(c.bytes)
+}
+
+// Hash returns the SHA-256 digest of the content.
+func (c *Content) Hash() [sha256.Size]byte {
+	if c == nil {
+		return sha256.Sum256(nil)
+	}
+	c.hashOnce.Do(func() {
+		c.hash = sha256.Sum256(c.bytes)
+	})
+	return c.hash
+}
+
+// Holds reports whether b is exactly this content's buffer, so a caller
+// passing b alongside c hands over the shared buffer rather than a copy.
+func (c *Content) Holds(b []byte) bool {
+	if c == nil || len(b) != len(c.bytes) {
+		return false
+	}
+	return len(b) == 0 || &b[0] == &c.bytes[0]
+}
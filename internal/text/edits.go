@@ -32,7 +32,12 @@ func ApplyEdits(src []byte, edits []ByteEdit) ([]byte, error) {
 		return nil, err
 	}
 
+	size := len(src)
+	for _, e := range sorted {
+		size += len(e.NewText) - int(e.Span.Len())
+	}
 	var out bytes.Buffer
+	out.Grow(size)
 	cursor := ByteOffset(0)
 	for _, e := range sorted {
 		out.Write(src[cursor:e.Span.Start])
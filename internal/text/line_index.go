@@ -139,6 +139,15 @@ func (li *LineIndex) UTF16PositionToOffset(pos UTF16Position) (ByteOffset, error
 	return start + rel, nil
 }
 
+// UTF16ColumnToByteOffset converts a UTF-16 column within one line's content,
+// excluding the line terminator, to a byte offset from the line start.
+func UTF16ColumnToByteOffset(line []byte, character int) (ByteOffset, error) {
+	if character < 0 {
+		return 0, fmt.Errorf("character out of range: %d", character)
+	}
+	return utf16UnitsToByteOffset(line, character)
+}
+
 func (li *LineIndex) validateOffset(off ByteOffset) error {
 	if !off.IsValid() {
 		return fmt.Errorf("offset out of range: %d", off)
@@ -18,6 +18,8 @@ import (
 	"time"
 
 	"github.com/kpumuk/thrift-weaver/internal/format"
+	"github.com/kpumuk/thrift-weaver/internal/index"
+	"github.com/kpumuk/thrift-weaver/internal/lint"
 	"github.com/kpumuk/thrift-weaver/internal/lsp"
 	"github.com/kpumuk/thrift-weaver/internal/syntax"
 )
@@ -70,9 +72,24 @@ type benchSetReport struct {
 	Samples      int         `json:"samples"`
 	SkippedFiles int         `json:"skipped_files,omitempty"`
 	Stats        sampleStats `json:"stats"`
+	Cost         *opCost     `json:"cost,omitempty"`
 	Notes        []string    `json:"notes,omitempty"`
 }
 
+// opCost is the per-token time and per-call allocations of a benchmark.
+type opCost struct {
+	NsPerToken  float64 `json:"ns_per_token"`
+	AllocsPerOp float64 `json:"allocs_per_op"`
+	BytesPerOp  float64 `json:"bytes_per_op"`
+}
+
+// lintRuleReport is the standalone cost of one lint rule over a corpus set.
+type lintRuleReport struct {
+	Set    string  `json:"set"`
+	Rule   string  `json:"rule"`
+	MeanMS float64 `json:"mean_ms"`
+}
+
 type memSample struct {
 	Iteration int    `json:"iteration"`
 	HeapAlloc uint64 `json:"heap_alloc"`
@@ -90,6 +107,11 @@ type memoryReport struct {
 	HeapAllocGrowth     int64       `json:"heap_alloc_growth"`
 	HeapInuseGrowth     int64       `json:"heap_inuse_growth"`
 	UnboundedGrowthHint bool        `json:"unbounded_growth_hint"`
+	// OpenDocSourceBytes is the mean source size of the measured documents.
+	OpenDocSourceBytes int64 `json:"open_doc_source_bytes"`
+	// OpenDocResidentBytes is the mean heap held per document while it is open
+	// in both the snapshot store and the workspace index.
+	OpenDocResidentBytes int64 `json:"open_doc_resident_bytes"`
 }
 
 type report struct {
@@ -103,6 +125,8 @@ type report struct {
 	CorpusCounts map[string]int          `json:"corpus_counts"`
 	ParseBench   []benchSetReport        `json:"parse_bench"`
 	FormatBench  []benchSetReport        `json:"format_bench"`
+	LintBench    []benchSetReport        `json:"lint_bench"`
+	LintRules    []lintRuleReport        `json:"lint_rules"`
 	Memory       memoryReport            `json:"memory"`
 	Warnings     []string                `json:"warnings,omitempty"`
 }
@@ -157,6 +181,10 @@ func run(cfg config) error {
 	if err != nil {
 		return err
 	}
+	lintBench, lintRules, err := runLintBench(ctx, corpus, cfg)
+	if err != nil {
+		return err
+	}
 	memBench, memWarnings, err := runLSPMemoryLoop(ctx, corpus, cfg)
 	if err != nil {
 		return err
@@ -174,6 +202,8 @@ func run(cfg config) error {
 		CorpusCounts: mapCorpusCounts(corpus),
 		ParseBench:   parseBench,
 		FormatBench:  formatBench,
+		LintBench:    lintBench,
+		LintRules:    lintRules,
 		Memory:       memBench,
 		Warnings:     warnings,
 	}
@@ -437,7 +467,7 @@ func runFormatBench(ctx context.Context, corpus map[string][]corpusFile, cfg con
 	out := make([]benchSetReport, 0, len(sets))
 	for _, set := range sets {
 		files := corpus[set]
-		samples, skipped, notes, err := benchmarkFormat(ctx, files, cfg)
+		samples, skipped, cost, notes, err := benchmarkFormat(ctx, files, cfg)
 		if err != nil {
 			return nil, fmt.Errorf("format bench %s: %w", set, err)
 		}
@@ -448,6 +478,7 @@ func runFormatBench(ctx context.Context, corpus map[string][]corpusFile, cfg con
 			Samples:      len(samples),
 			SkippedFiles: skipped,
 			Stats:        durationStats(samples),
+			Cost:         cost,
 			Notes:        notes,
 		})
 	}
@@ -459,18 +490,18 @@ type parsedFixture struct {
 	tree *syntax.Tree
 }
 
-func benchmarkFormat(ctx context.Context, files []corpusFile, cfg config) ([]time.Duration, int, []string, error) {
+func benchmarkFormat(ctx context.Context, files []corpusFile, cfg config) ([]time.Duration, int, *opCost, []string, error) {
 	fixtures := make([]parsedFixture, 0, len(files))
 	var notes []string
 	skipped := 0
 	for _, f := range files {
 		src, err := os.ReadFile(f.Path)
 		if err != nil {
-			return nil, 0, nil, fmt.Errorf("read %s: %w", f.Path, err)
+			return nil, 0, nil, nil, fmt.Errorf("read %s: %w", f.Path, err)
 		}
 		tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: f.Path})
 		if err != nil {
-			return nil, 0, nil, fmt.Errorf("parse %s: %w", f.Path, err)
+			return nil, 0, nil, nil, fmt.Errorf("parse %s: %w", f.Path, err)
 		}
 		_, err = format.Document(ctx, tree, format.Options{LineWidth: cfg.lineWidth})
 		if err != nil {
@@ -479,31 +510,113 @@ func benchmarkFormat(ctx context.Context, files []corpusFile, cfg config) ([]tim
 				notes = append(notes, "skipped unsafe format: "+filepath.Base(f.Path))
 				continue
 			}
-			return nil, 0, nil, fmt.Errorf("format precheck %s: %w", f.Path, err)
+			return nil, 0, nil, nil, fmt.Errorf("format precheck %s: %w", f.Path, err)
 		}
 		fixtures = append(fixtures, parsedFixture{file: f, tree: tree})
 	}
 
-	var samples []time.Duration
+	var (
+		samples []time.Duration
+		tokens  int
+		before  runtime.MemStats
+		after   runtime.MemStats
+	)
+	runtime.ReadMemStats(&before)
 	for _, pf := range fixtures {
 		for range cfg.warmup {
 			if _, err := format.Document(ctx, pf.tree, format.Options{LineWidth: cfg.lineWidth}); err != nil {
-				return nil, 0, nil, fmt.Errorf("warmup format %s: %w", pf.file.Path, err)
+				return nil, 0, nil, nil, fmt.Errorf("warmup format %s: %w", pf.file.Path, err)
 			}
 		}
 		for range cfg.iterations {
 			start := time.Now()
 			if _, err := format.Document(ctx, pf.tree, format.Options{LineWidth: cfg.lineWidth}); err != nil {
-				return nil, 0, nil, fmt.Errorf("format %s: %w", pf.file.Path, err)
+				return nil, 0, nil, nil, fmt.Errorf("format %s: %w", pf.file.Path, err)
 			}
 			samples = append(samples, time.Since(start))
+			tokens += len(pf.tree.Tokens)
+		}
+	}
+	runtime.ReadMemStats(&after)
+	var cost *opCost
+	if len(samples) > 0 && tokens > 0 {
+		var total time.Duration
+		for _, s := range samples {
+			total += s
+		}
+		cost = &opCost{
+			NsPerToken:  float64(total.Nanoseconds()) / float64(tokens),
+			AllocsPerOp: float64(after.Mallocs-before.Mallocs) / float64(len(samples)),
+			BytesPerOp:  float64(after.TotalAlloc-before.TotalAlloc) / float64(len(samples)),
 		}
 	}
 	if len(notes) > 5 {
 		notes = notes[:5]
 		notes = append(notes, "additional files skipped")
 	}
-	return samples, skipped, notes, nil
+	return samples, skipped, cost, notes, nil
+}
+
+// runLintBench times the default rule set, which shares one pass over each
+// tree, and every rule on its own.
+func runLintBench(ctx context.Context, corpus map[string][]corpusFile, cfg config) ([]benchSetReport, []lintRuleReport, error) {
+	runner := lint.NewDefaultRunner()
+	sets := []string{setTypical, setLarge}
+	out := make([]benchSetReport, 0, len(sets))
+	var rules []lintRuleReport
+	for _, set := range sets {
+		trees := make([]*syntax.Tree, 0, len(corpus[set]))
+		for _, f := range corpus[set] {
+			src, err := os.ReadFile(f.Path)
+			if err != nil {
+				return nil, nil, fmt.Errorf("read %s: %w", f.Path, err)
+			}
+			tree, err := syntax.Parse(ctx, src, syntax.ParseOptions{URI: f.Path})
+			if err != nil {
+				return nil, nil, fmt.Errorf("parse %s: %w", f.Path, err)
+			}
+			trees = append(trees, tree)
+		}
+
+		samples, err := benchmarkLint(ctx, runner, trees, cfg)
+		if err != nil {
+			return nil, nil, fmt.Errorf("lint bench %s: %w", set, err)
+		}
+		out = append(out, benchSetReport{
+			Set:        set,
+			Files:      len(trees),
+			Iterations: cfg.iterations,
+			Samples:    len(samples),
+			Stats:      durationStats(samples),
+		})
+		for _, rule := range runner.Rules() {
+			samples, err := benchmarkLint(ctx, lint.NewRunner(rule), trees, cfg)
+			if err != nil {
+				return nil, nil, fmt.Errorf("lint bench %s/%s: %w", set, rule.ID(), err)
+			}
+			rules = append(rules, lintRuleReport{Set: set, Rule: rule.ID(), MeanMS: durationStats(samples).MeanMS})
+		}
+	}
+	return out, rules, nil
+}
+
+func benchmarkLint(ctx context.Context, runner *lint.Runner, trees []*syntax.Tree, cfg config) ([]time.Duration, error) {
+	var samples []time.Duration
+	for _, tree := range trees {
+		for range cfg.warmup {
+			if _, err := runner.Run(ctx, tree); err != nil {
+				return nil, err
+			}
+		}
+		for range cfg.iterations {
+			start := time.Now()
+			if _, err := runner.Run(ctx, tree); err != nil {
+				return nil, err
+			}
+			samples = append(samples, time.Since(start))
+		}
+	}
+	return samples, nil
 }
 
 func runLSPMemoryLoop(ctx context.Context, corpus map[string][]corpusFile, cfg config) (memoryReport, []string, error) {
@@ -588,9 +701,73 @@ func runLSPMemoryLoop(ctx context.Context, corpus map[string][]corpusFile, cfg c
 		rep.HeapInuseGrowth = int64Diff(last.HeapInuse, first.HeapInuse)
 		rep.UnboundedGrowthHint = isUnboundedGrowthHint(samples)
 	}
+
+	opened := make([]openDoc, 0, len(memDocs))
+	for _, d := range memDocs {
+		opened = append(opened, openDoc{uri: d.uri, src: d.open})
+	}
+	rep.OpenDocSourceBytes, rep.OpenDocResidentBytes, err = measureOpenDocResidency(ctx, opened)
+	if err != nil {
+		return memoryReport{}, warnings, err
+	}
 	return rep, warnings, nil
 }
 
+type openDoc struct {
+	uri string
+	src []byte
+}
+
+// measureOpenDocResidency opens every document in a snapshot store and a
+// workspace index, the way the language server does, and reports the mean
+// source size and the mean heap growth per open document.
+func measureOpenDocResidency(ctx context.Context, docs []openDoc) (int64, int64, error) {
+	if len(docs) == 0 {
+		return 0, 0, nil
+	}
+	heapInuse := func() uint64 {
+		runtime.GC()
+		var ms runtime.MemStats
+		runtime.ReadMemStats(&ms)
+		return ms.HeapInuse
+	}
+
+	srcs := make([][]byte, len(docs))
+	var sourceBytes int64
+	for i, d := range docs {
+		srcs[i] = slices.Clone(d.src)
+		sourceBytes += int64(len(d.src))
+	}
+
+	before := heapInuse()
+	store := lsp.NewSnapshotStore()
+	manager := index.NewManager(index.Options{})
+	defer manager.Close()
+	for i, d := range docs {
+		snap, err := store.Open(ctx, d.uri, 1, srcs[i])
+		if err != nil {
+			return 0, 0, fmt.Errorf("residency open: %w", err)
+		}
+		err = manager.UpsertOpenDocument(ctx, index.DocumentInput{
+			URI:        snap.URI,
+			Version:    snap.Version,
+			Generation: snap.Generation,
+			Source:     snap.Tree.Source,
+			Content:    snap.Content(),
+		})
+		if err != nil {
+			return 0, 0, fmt.Errorf("residency index: %w", err)
+		}
+	}
+	srcs = nil
+	after := heapInuse()
+	runtime.KeepAlive(store)
+	runtime.KeepAlive(manager)
+
+	n := int64(len(docs))
+	return sourceBytes / n, int64Diff(after, before) / n, nil
+}
+
 func selectMemoryDocs(corpus map[string][]corpusFile) ([]corpusFile, []string, error) {
 	var selected []corpusFile
 	var warnings []string
@@ -734,6 +911,11 @@ func printReport(rep report) {
 	printBenchTable("Parse + diagnostics (warm)", rep.ParseBench)
 	fmt.Println()
 	printBenchTable("Format document (warm, parse tree prebuilt)", rep.FormatBench)
+	printCostTable(rep.FormatBench)
+	fmt.Println()
+	printBenchTable("Lint document (warm, default rules, parse tree prebuilt)", rep.LintBench)
+	fmt.Println()
+	printLintRules(rep.LintRules)
 	fmt.Println()
 	printMemoryReport(rep.Memory)
 }
@@ -747,6 +929,23 @@ func printBenchTable(title string, rows []benchSetReport) {
 	}
 }
 
+func printCostTable(rows []benchSetReport) {
+	fmt.Println("set        ns/token  allocs/op    bytes/op")
+	for _, r := range rows {
+		if r.Cost == nil {
+			continue
+		}
+		fmt.Printf("%-10s %8.1f %10.0f %11.0f\n", r.Set, r.Cost.NsPerToken, r.Cost.AllocsPerOp, r.Cost.BytesPerOp)
+	}
+}
+
+func printLintRules(rows []lintRuleReport) {
+	fmt.Println("Lint rules run alone (mean ms per file)")
+	for _, r := range rows {
+		fmt.Printf("%-10s %-28s %8.3f\n", r.Set, r.Rule, r.MeanMS)
+	}
+}
+
 func printMemoryReport(rep memoryReport) {
 	fmt.Println("LSP memory loop (open/change/close)")
 	fmt.Printf("iterations=%d sample_every=%d docs=%d\n", rep.Iterations, rep.SampleEvery, rep.DocCount)
@@ -757,6 +956,7 @@ func printMemoryReport(rep memoryReport) {
 	last := rep.Samples[len(rep.Samples)-1]
 	fmt.Printf("final heap_alloc=%d heap_inuse=%d heap_sys=%d num_gc=%d\n", last.HeapAlloc, last.HeapInuse, last.HeapSys, last.NumGC)
 	fmt.Printf("growth heap_alloc=%d heap_inuse=%d unbounded_growth_hint=%v\n", rep.HeapAllocGrowth, rep.HeapInuseGrowth, rep.UnboundedGrowthHint)
+	fmt.Printf("per open doc source_bytes=%d resident_bytes=%d\n", rep.OpenDocSourceBytes, rep.OpenDocResidentBytes)
 }
 
 func writeJSON(path string, rep report) error {